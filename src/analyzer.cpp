@@ -0,0 +1,693 @@
+#include "analyzer.hpp"
+#include "ast_nodes.hpp"
+#include "dependency_graph.hpp"
+#include "lexer.hpp"
+#include "module_interface.hpp"
+#include "scheduler.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+
+// functions a task takes at once, the batch amortizes the shared counter
+#define FUNCTION_BATCH_SIZE 32
+
+static const AstFuncProto& get_proto(const AstNode* in_function_node) noexcept;
+static bool is_same_signature(const AstFuncProto& in_proto, const AstFuncProto& in_other_proto) noexcept;
+static bool is_function(const AstNode* in_node) noexcept;
+static bool is_numeric(AstTypeId in_type_id) noexcept;
+static bool is_integer(AstTypeId in_type_id) noexcept;
+static const char* get_binary_op_name(BinaryExprType in_op) noexcept;
+static AstNode* new_type_node(const TypeInfo* in_type_info) noexcept;
+static bool has_errors(const std::vector<Error>& in_errors, size_t in_first_error) noexcept;
+
+SemanticAnalyzer::SemanticAnalyzer(AstNode* in_source_code_node, std::vector<Error>& in_errors)
+    : source_code_node(in_source_code_node), file_name(in_source_code_node->source_code.file_name), errors(in_errors),
+    bool_type(types::get_named_type("bool")), void_type(types::get_named_type("void")) {
+    global_symbols.push_scope();
+}
+
+bool SemanticAnalyzer::analyze(const std::vector<const ModuleInterface*>& in_dependency_interfaces, Scheduler* io_scheduler,
+    DependencyGraph* io_graph) noexcept {
+    const size_t prev_error_count = errors.size();
+
+    for (auto dependency_interface : in_dependency_interfaces) {
+        declare_interface(*dependency_interface);
+    }
+
+    // first pass
+    for (auto child : source_code_node->source_code.children) {
+        switch (child->node_type) {
+        case AstNodeType::AstFuncDef:
+        case AstNodeType::AstFuncProto:
+            analizeFuncProto(child);
+            break;
+        case AstNodeType::AstVarDef:
+            analizeVarDef(child);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // second pass
+    if (io_graph) {
+        io_graph->compare(source_code_node);
+    }
+    std::vector<AstNode*> functions;
+    for (auto child : source_code_node->source_code.children) {
+        if (child->node_type != AstNodeType::AstFuncDef) {
+            continue;
+        }
+        if (io_graph && io_graph->is_unchanged(child)) {
+            io_graph->get_previous_diagnostics(child, file_name, errors);
+            continue;
+        }
+        functions.push_back(child);
+    }
+    analize_func_blocks(functions, io_scheduler);
+
+    // the same order whatever thread found them, errors are immutable so their indices are sorted
+    std::vector<size_t> error_order;
+    for (size_t i = prev_error_count; i < errors.size(); i++) {
+        error_order.push_back(i);
+    }
+    std::stable_sort(error_order.begin(), error_order.end(), [this](size_t in_error, size_t in_other_error) {
+        const Error& error = errors[in_error];
+        const Error& other_error = errors[in_other_error];
+        return error.line != other_error.line ? error.line < other_error.line : error.column < other_error.column;
+    });
+
+    std::vector<Error> sorted_errors;
+    sorted_errors.reserve(error_order.size());
+    for (auto error_index : error_order) {
+        sorted_errors.push_back(errors[error_index]);
+    }
+    while (errors.size() > prev_error_count) {
+        errors.pop_back();
+    }
+    for (auto& error : sorted_errors) {
+        errors.push_back(error);
+    }
+    return !has_errors(errors, prev_error_count);
+}
+
+void SemanticAnalyzer::declare_interface(const ModuleInterface& in_interface) noexcept {
+    auto& imported_nodes = source_code_node->source_code.imported_nodes;
+
+    for (uint32_t i = 0; i < in_interface.get_function_count(); i++) {
+        AstNode* proto_node = new AstNode(AstNodeType::AstFuncProto, 0, 0);
+        proto_node->function_proto.name = in_interface.get_function_name(i);
+        proto_node->function_proto.return_type = new_type_node(types::get_type_by_name(in_interface.get_return_type(i)));
+        imported_nodes.push_back(proto_node);
+        imported_nodes.push_back(proto_node->function_proto.return_type);
+
+        for (uint32_t j = 0; j < in_interface.get_param_count(i); j++) {
+            AstNode* param_node = new AstNode(AstNodeType::AstParamDecl, 0, 0);
+            param_node->param_decl.type = new_type_node(types::get_type_by_name(in_interface.get_param_type(i, j)));
+            proto_node->function_proto.params.push_back(param_node);
+            imported_nodes.push_back(param_node);
+            imported_nodes.push_back(param_node->param_decl.type);
+        }
+
+        declare_global(proto_node->function_proto.name, proto_node);
+    }
+
+    for (uint32_t i = 0; i < in_interface.get_global_count(); i++) {
+        AstNode* var_def_node = new AstNode(AstNodeType::AstVarDef, 0, 0);
+        var_def_node->var_def.name = in_interface.get_global_name(i);
+        var_def_node->var_def.type = new_type_node(types::get_type_by_name(in_interface.get_global_type(i)));
+        var_def_node->var_def.initializer = nullptr;
+        imported_nodes.push_back(var_def_node);
+        imported_nodes.push_back(var_def_node->var_def.type);
+
+        declare_global(var_def_node->var_def.name, var_def_node);
+    }
+}
+
+bool SemanticAnalyzer::analizeFuncProto(AstNode* in_declaration) noexcept {
+    const AstFuncProto& proto = get_proto(in_declaration);
+    bool is_valid = check_type(nullptr, proto.return_type, true);
+
+    for (size_t i = 0; i < proto.params.size(); i++) {
+        const AstParamDecl& param = proto.params[i]->param_decl;
+        is_valid &= check_type(nullptr, param.type, false);
+
+        for (size_t j = 0; j < i; j++) {
+            if (proto.params[j]->param_decl.name == param.name) {
+                semantic_error(nullptr, ERROR_TYPE::ERROR, proto.params[i], "redefinition of parameter '%s'", std::string(param.name).c_str());
+                is_valid = false;
+                break;
+            }
+        }
+    }
+
+    is_valid &= declare_global(proto.name, in_declaration);
+    return is_valid;
+}
+
+bool SemanticAnalyzer::analizeVarDef(AstNode* in_var_def_node) noexcept {
+    AstVarDef& var_def = in_var_def_node->var_def;
+    bool is_valid = check_type(nullptr, var_def.type, false);
+
+    if (var_def.initializer) {
+        AstBinaryExpr& assign_expr = var_def.initializer->binary_expr;
+        assign_expr.op1->symbol.declaration = in_var_def_node;
+
+        ExprType value_type = analize_expr(nullptr, assign_expr.op2);
+        is_valid &= is_valid && check_conversion(nullptr, assign_expr.op2, value_type, var_def.type->ast_type.type_info);
+    }
+
+    is_valid &= declare_global(var_def.name, in_var_def_node);
+    return is_valid;
+}
+
+bool SemanticAnalyzer::analizeFuncBlock(AstNode* in_func_def_node) noexcept {
+    const size_t prev_error_count = errors.size();
+    FunctionContext context{ NameTable(&global_names), SymbolTable(&global_symbols), in_func_def_node, errors };
+    analize_func_block(context);
+    return !has_errors(errors, prev_error_count);
+}
+
+void SemanticAnalyzer::analize_func_blocks(const std::vector<AstNode*>& in_functions, Scheduler* io_scheduler) noexcept {
+    const size_t batch_count = (in_functions.size() + FUNCTION_BATCH_SIZE - 1) / FUNCTION_BATCH_SIZE;
+    const size_t worker_count = io_scheduler ? io_scheduler->get_worker_count() : 1;
+    const size_t task_count = std::max<size_t>(std::min(worker_count, batch_count), 1);
+
+    // every task reuses its tables from one function to the next
+    std::atomic<size_t> next_function(0);
+    std::vector<std::vector<Error>> task_errors(task_count);
+    auto analize_batches = [this, &in_functions, &next_function](std::vector<Error>& out_errors) {
+        FunctionContext context{ NameTable(&global_names), SymbolTable(&global_symbols), nullptr, out_errors };
+        for (;;) {
+            const size_t first_function = next_function.fetch_add(FUNCTION_BATCH_SIZE, std::memory_order_relaxed);
+            if (first_function >= in_functions.size()) {
+                break;
+            }
+            const size_t last_function = std::min(first_function + FUNCTION_BATCH_SIZE, in_functions.size());
+            for (size_t i = first_function; i < last_function; i++) {
+                context.function = in_functions[i];
+                analize_func_block(context);
+            }
+        }
+    };
+
+    // no threads of its own, the caller may already be a worker of the scheduler
+    std::atomic<size_t> pending_tasks(task_count - 1);
+    for (size_t i = 1; i < task_count; i++) {
+        io_scheduler->submit([&analize_batches, &task_errors, &pending_tasks, i]() {
+            analize_batches(task_errors[i]);
+            --pending_tasks;
+        });
+    }
+    analize_batches(task_errors[0]);
+    if (io_scheduler) {
+        io_scheduler->wait_for(pending_tasks);
+    }
+
+    for (auto& function_errors : task_errors) {
+        for (auto& error : function_errors) {
+            errors.push_back(error);
+        }
+    }
+}
+
+void SemanticAnalyzer::analize_func_block(FunctionContext& io_context) noexcept {
+    // parameters shadow the globals
+    io_context.symbols.push_scope();
+    for (auto param : get_proto(io_context.function).params) {
+        // duplicates were reported with the prototype
+        (void)io_context.symbols.declare(io_context.names.intern(param->param_decl.name), param);
+    }
+
+    for (auto statement : io_context.function->function_def.block->block.statements) {
+        if (statement->node_type == AstNodeType::AstVarDef) {
+            analize_local_var_def(io_context, statement);
+        }
+        else {
+            (void)analize_expr(&io_context, statement);
+        }
+    }
+    io_context.symbols.pop_scope();
+}
+
+bool SemanticAnalyzer::analize_local_var_def(FunctionContext& io_context, AstNode* in_var_def_node) noexcept {
+    AstVarDef& var_def = in_var_def_node->var_def;
+    bool is_valid = check_type(&io_context, var_def.type, false);
+
+    // the initializer can't see the variable it initializes
+    if (var_def.initializer) {
+        AstBinaryExpr& assign_expr = var_def.initializer->binary_expr;
+        assign_expr.op1->symbol.declaration = in_var_def_node;
+
+        ExprType value_type = analize_expr(&io_context, assign_expr.op2);
+        is_valid &= is_valid && check_conversion(&io_context, assign_expr.op2, value_type, var_def.type->ast_type.type_info);
+    }
+
+    if (io_context.symbols.declare(io_context.names.intern(var_def.name), in_var_def_node)) {
+        semantic_error(&io_context, ERROR_TYPE::ERROR, in_var_def_node, "redefinition of '%s'", std::string(var_def.name).c_str());
+        return false;
+    }
+    return is_valid;
+}
+
+SemanticAnalyzer::ExprType SemanticAnalyzer::analize_expr(FunctionContext* io_context, AstNode* in_node) noexcept {
+    switch (in_node->node_type) {
+    case AstNodeType::AstSymbol:
+        return analize_symbol(io_context, in_node);
+    case AstNodeType::AstBinaryExpr:
+        return analize_binary_expr(io_context, in_node);
+    case AstNodeType::AstUnaryExpr:
+        return analize_unary_expr(io_context, in_node);
+    case AstNodeType::AstFuncCallExpr:
+        return analize_func_call(io_context, in_node);
+    default:
+        UNREACHEABLE;
+    }
+}
+
+SemanticAnalyzer::ExprType SemanticAnalyzer::analize_symbol(FunctionContext* io_context, AstNode* in_node) noexcept {
+    AstSymbol& symbol = in_node->symbol;
+
+    // literals
+    if (symbol.name.empty()) {
+        switch (symbol.token->id) {
+        case TokenId::INT_LIT:
+        case TokenId::UNICODE_CHAR:
+            return ExprType{ nullptr, AstTypeId::Integer, true };
+        case TokenId::FLOAT_LIT:
+            return ExprType{ nullptr, AstTypeId::FloatingPoint, true };
+        case TokenId::STRING:
+            // points to the first byte, the bytes end with a null
+            return ExprType{ types::get_pointer_type(types::get_named_type("u8")), AstTypeId::Void, true };
+        default:
+            semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "%s literals are not supported yet", token_id_name(symbol.token->id));
+            return ExprType{ nullptr, AstTypeId::Void, false };
+        }
+    }
+
+    AstNode* declaration = find_symbol(io_context, symbol.name);
+    if (!declaration) {
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "undeclared symbol '%s'", std::string(symbol.name).c_str());
+        return ExprType{ nullptr, AstTypeId::Void, false };
+    }
+
+    symbol.declaration = declaration;
+    switch (declaration->node_type) {
+    case AstNodeType::AstVarDef:
+        return ExprType{ declaration->var_def.type->ast_type.type_info, AstTypeId::Void, true };
+    case AstNodeType::AstParamDecl:
+        return ExprType{ declaration->param_decl.type->ast_type.type_info, AstTypeId::Void, true };
+    default:
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "function '%s' used as a value", std::string(symbol.name).c_str());
+        return ExprType{ nullptr, AstTypeId::Void, false };
+    }
+}
+
+SemanticAnalyzer::ExprType SemanticAnalyzer::analize_binary_expr(FunctionContext* io_context, AstNode* in_node) noexcept {
+    AstBinaryExpr& binary_expr = in_node->binary_expr;
+    const ExprType invalid_type = { nullptr, AstTypeId::Void, false };
+
+    if (binary_expr.bin_op == BinaryExprType::ASSIGN) {
+        ExprType value_type = analize_expr(io_context, binary_expr.op2);
+        if (binary_expr.op1->node_type != AstNodeType::AstSymbol || binary_expr.op1->symbol.name.empty()) {
+            semantic_error(io_context, ERROR_TYPE::ERROR, binary_expr.op1, "expression is not assignable");
+            return invalid_type;
+        }
+
+        ExprType target_type = analize_symbol(io_context, binary_expr.op1);
+        if (!target_type.is_valid || !check_conversion(io_context, binary_expr.op2, value_type, target_type.type_info)) {
+            return invalid_type;
+        }
+        return target_type;
+    }
+
+    ExprType op1_type = analize_expr(io_context, binary_expr.op1);
+    ExprType op2_type = analize_expr(io_context, binary_expr.op2);
+    if (!op1_type.is_valid || !op2_type.is_valid) {
+        return invalid_type;
+    }
+
+    // literals take the type of the other operand
+    const AstNode* literal_node = nullptr;
+    ExprType result_type = op1_type;
+    if (!op1_type.type_info && !op2_type.type_info) {
+        const bool is_float = op1_type.type_id == AstTypeId::FloatingPoint || op2_type.type_id == AstTypeId::FloatingPoint;
+        result_type = ExprType{ nullptr, is_float ? AstTypeId::FloatingPoint : AstTypeId::Integer, true };
+    }
+    else if (!op1_type.type_info || !op2_type.type_info) {
+        literal_node = op1_type.type_info ? binary_expr.op2 : binary_expr.op1;
+        result_type = op1_type.type_info ? op1_type : op2_type;
+    }
+
+    const AstTypeId type_id1 = op1_type.type_info ? op1_type.type_info->type_id : op1_type.type_id;
+    const AstTypeId type_id2 = op2_type.type_info ? op2_type.type_info->type_id : op2_type.type_id;
+    const bool is_pointer1 = type_id1 == AstTypeId::Pointer;
+    const bool is_pointer2 = type_id2 == AstTypeId::Pointer;
+
+    bool is_valid;
+    switch (binary_expr.bin_op) {
+    case BinaryExprType::LSHIFT:
+    case BinaryExprType::RSHIFT:
+    case BinaryExprType::BIT_XOR:
+    case BinaryExprType::BIT_AND:
+        is_valid = is_integer(type_id1) && is_integer(type_id2);
+        break;
+    case BinaryExprType::ADD:
+    case BinaryExprType::SUB:
+        // pointer arithmetic, the pointer is the result
+        if (is_pointer1 != is_pointer2) {
+            is_valid = is_integer(is_pointer1 ? type_id2 : type_id1);
+            result_type = is_pointer1 ? op1_type : op2_type;
+            literal_node = nullptr;
+            break;
+        }
+        LL_FALLTHROUGH
+    default:
+        is_valid = (is_numeric(type_id1) && is_numeric(type_id2))
+            || (is_pointer1 && is_pointer2 && op1_type.type_info == op2_type.type_info && binary_expr.bin_op >= BinaryExprType::EQUALS);
+        break;
+    }
+
+    if (!is_valid) {
+        auto get_type_name = [](const ExprType& in_type) {
+            if (in_type.type_info) {
+                return std::string(in_type.type_info->name);
+            }
+            return std::string(in_type.type_id == AstTypeId::FloatingPoint ? "floating point constant" : "integer constant");
+        };
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "invalid operands of types '%s' and '%s' for '%s'",
+            get_type_name(op1_type).c_str(), get_type_name(op2_type).c_str(), get_binary_op_name(binary_expr.bin_op));
+        return invalid_type;
+    }
+
+    if (literal_node) {
+        const ExprType& literal_type = literal_node == binary_expr.op1 ? op1_type : op2_type;
+        (void)check_conversion(io_context, literal_node, literal_type, result_type.type_info);
+    }
+    else if (op1_type.type_info && op2_type.type_info && !is_pointer1 && !is_pointer2) {
+        // the narrower operand is extended, floating point wins over integers
+        const TypeInfo* type1 = op1_type.type_info;
+        const TypeInfo* type2 = op2_type.type_info;
+        const bool is_float1 = type1->type_id == AstTypeId::FloatingPoint;
+        const bool is_float2 = type2->type_id == AstTypeId::FloatingPoint;
+        const bool is_wider2 = is_float1 == is_float2 ? type2->bit_size > type1->bit_size : is_float2;
+        result_type = is_wider2 ? op2_type : op1_type;
+    }
+
+    // comparisons
+    if (binary_expr.bin_op >= BinaryExprType::EQUALS && binary_expr.bin_op <= BinaryExprType::LESS) {
+        return ExprType{ bool_type, AstTypeId::Void, true };
+    }
+    return result_type;
+}
+
+SemanticAnalyzer::ExprType SemanticAnalyzer::analize_unary_expr(FunctionContext* io_context, AstNode* in_node) noexcept {
+    AstUnaryExpr& unary_expr = in_node->unary_expr;
+    const ExprType invalid_type = { nullptr, AstTypeId::Void, false };
+
+    if (unary_expr.op == UnaryExprType::RET) {
+        assert(io_context);
+        const AstFuncProto& proto = get_proto(io_context->function);
+        const TypeInfo* return_type = proto.return_type->ast_type.type_info;
+        const ExprType void_value = { void_type, AstTypeId::Void, true };
+
+        if (!unary_expr.expr) {
+            if (return_type->type_id != AstTypeId::Void) {
+                semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "function '%s' must return a value of type '%s'",
+                    std::string(proto.name).c_str(), std::string(return_type->name).c_str());
+                return invalid_type;
+            }
+            return void_value;
+        }
+
+        ExprType value_type = analize_expr(io_context, unary_expr.expr);
+        if (return_type->type_id == AstTypeId::Void) {
+            semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "function '%s' returns 'void' but a value is returned", std::string(proto.name).c_str());
+            return invalid_type;
+        }
+        return check_conversion(io_context, unary_expr.expr, value_type, return_type) ? void_value : invalid_type;
+    }
+
+    ExprType value_type = analize_expr(io_context, unary_expr.expr);
+    if (!value_type.is_valid) {
+        return invalid_type;
+    }
+    const AstTypeId type_id = value_type.type_info ? value_type.type_info->type_id : value_type.type_id;
+
+    if (unary_expr.op == UnaryExprType::NEG) {
+        if (!is_numeric(type_id)) {
+            semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "operator '~' needs a numeric operand");
+            return invalid_type;
+        }
+        return value_type;
+    }
+
+    // ++ and --
+    const bool is_variable = unary_expr.expr->node_type == AstNodeType::AstSymbol && !unary_expr.expr->symbol.name.empty();
+    if (!is_variable || (type_id != AstTypeId::Integer && type_id != AstTypeId::Pointer)) {
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "operator '%s' needs an integer or pointer variable", unary_expr.op == UnaryExprType::INC ? "++" : "--");
+        return invalid_type;
+    }
+    return value_type;
+}
+
+SemanticAnalyzer::ExprType SemanticAnalyzer::analize_func_call(FunctionContext* io_context, AstNode* in_node) noexcept {
+    AstFuncCallExpr& func_call = in_node->func_call;
+    const ExprType invalid_type = { nullptr, AstTypeId::Void, false };
+
+    // the arguments are resolved even if the function is not
+    std::vector<ExprType> param_types;
+    for (auto param : func_call.params) {
+        param_types.push_back(analize_expr(io_context, param));
+    }
+
+    AstNode* function = find_symbol(io_context, func_call.fn_name);
+    if (!function) {
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "undeclared function '%s'", std::string(func_call.fn_name).c_str());
+        return invalid_type;
+    }
+    if (!is_function(function)) {
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "'%s' is not a function", std::string(func_call.fn_name).c_str());
+        return invalid_type;
+    }
+    func_call.fn_ref = function;
+
+    const AstFuncProto& proto = get_proto(function);
+    if (proto.params.size() != func_call.params.size()) {
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_node, "function '%s' takes %zu arguments but %zu were given",
+            std::string(func_call.fn_name).c_str(), proto.params.size(), func_call.params.size());
+        return invalid_type;
+    }
+
+    bool is_valid = true;
+    for (size_t i = 0; i < func_call.params.size(); i++) {
+        is_valid &= check_conversion(io_context, func_call.params[i], param_types[i], proto.params[i]->param_decl.type->ast_type.type_info);
+    }
+    if (!is_valid) {
+        return invalid_type;
+    }
+    return ExprType{ proto.return_type->ast_type.type_info, AstTypeId::Void, true };
+}
+
+bool SemanticAnalyzer::check_conversion(FunctionContext* io_context, const AstNode* in_value_node, const ExprType& in_value_type, const TypeInfo* in_type_info) noexcept {
+    if (!in_value_type.is_valid) {
+        return false;
+    }
+
+    const std::string type_name(in_type_info->name);
+    const AstTypeId type_id = in_type_info->type_id;
+
+    // literals
+    if (!in_value_type.type_info) {
+        if (in_value_type.type_id == AstTypeId::FloatingPoint && is_integer(type_id)) {
+            semantic_error(io_context, ERROR_TYPE::WARNING_0, in_value_node, "floating point constant converted to '%s', the fractional part is discarded", type_name.c_str());
+            return true;
+        }
+        if (in_value_type.type_id == AstTypeId::FloatingPoint ? type_id == AstTypeId::FloatingPoint : is_numeric(type_id)) {
+            return true;
+        }
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_value_node, "can't convert %s to '%s'",
+            in_value_type.type_id == AstTypeId::FloatingPoint ? "floating point constant" : "integer constant", type_name.c_str());
+        return false;
+    }
+
+    const TypeInfo* value_type = in_value_type.type_info;
+    if (value_type == in_type_info) {
+        return true;
+    }
+
+    const std::string value_type_name(value_type->name);
+    if (value_type->type_id == AstTypeId::Void) {
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_value_node, "void value can't be converted to '%s'", type_name.c_str());
+        return false;
+    }
+
+    if (is_numeric(value_type->type_id) && is_numeric(type_id)) {
+        if (value_type->type_id == AstTypeId::FloatingPoint && type_id != AstTypeId::FloatingPoint) {
+            semantic_error(io_context, ERROR_TYPE::WARNING_0, in_value_node, "implicit conversion from '%s' to '%s' discards the fractional part", value_type_name.c_str(), type_name.c_str());
+        }
+        else if (value_type->type_id == type_id && value_type->bit_size > in_type_info->bit_size) {
+            const char* format = type_id == AstTypeId::FloatingPoint
+                ? "implicit conversion from '%s' to '%s' loses precision"
+                : "implicit truncation from '%s' to '%s'";
+            semantic_error(io_context, ERROR_TYPE::WARNING_0, in_value_node, format, value_type_name.c_str(), type_name.c_str());
+        }
+        return true;
+    }
+
+    // *void takes and gives any pointer
+    if (value_type->type_id == AstTypeId::Pointer && type_id == AstTypeId::Pointer
+        && (value_type->element_type->type_id == AstTypeId::Void || in_type_info->element_type->type_id == AstTypeId::Void)) {
+        return true;
+    }
+
+    semantic_error(io_context, ERROR_TYPE::ERROR, in_value_node, "can't convert '%s' to '%s'", value_type_name.c_str(), type_name.c_str());
+    return false;
+}
+
+bool SemanticAnalyzer::check_type(FunctionContext* io_context, const AstNode* in_type_node, bool in_is_return_type) noexcept {
+    const TypeInfo* type_info = in_type_node->ast_type.type_info;
+
+    if (type_info->type_id == AstTypeId::Void && !in_is_return_type) {
+        semantic_error(io_context, ERROR_TYPE::ERROR, in_type_node, "values can't have type 'void'");
+        return false;
+    }
+
+    // void is only valid behind a pointer, besides return types
+    for (const TypeInfo* element_type = type_info; element_type; element_type = element_type->element_type) {
+        switch (element_type->type_id) {
+        case AstTypeId::Struct:
+            semantic_error(io_context, ERROR_TYPE::ERROR, in_type_node, "unknown type '%s'", std::string(element_type->name).c_str());
+            return false;
+        case AstTypeId::Array:
+            semantic_error(io_context, ERROR_TYPE::ERROR, in_type_node, "array types are not supported yet");
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+// returns false if the name was already declared by something else
+bool SemanticAnalyzer::declare_global(std::string_view in_name, AstNode* in_declaration) noexcept {
+    AstNode* previous_declaration = global_symbols.declare(global_names.intern(in_name), in_declaration);
+    if (!previous_declaration) {
+        return true;
+    }
+
+    // the same function can be declared many times, but defined once
+    const bool are_protos = previous_declaration->node_type == AstNodeType::AstFuncProto && in_declaration->node_type == AstNodeType::AstFuncProto;
+    if (are_protos && is_same_signature(previous_declaration->function_proto, in_declaration->function_proto)) {
+        return true;
+    }
+
+    semantic_error(nullptr, ERROR_TYPE::ERROR, in_declaration, "redefinition of '%s'", std::string(in_name).c_str());
+    return false;
+}
+
+AstNode* SemanticAnalyzer::find_symbol(const FunctionContext* in_context, std::string_view in_name) const noexcept {
+    if (in_context) {
+        // the local names extend the global ones
+        const uint32_t name_id = in_context->names.find(in_name);
+        return name_id != INVALID_NAME_ID ? in_context->symbols.find(name_id) : nullptr;
+    }
+
+    const uint32_t name_id = global_names.find(in_name);
+    return name_id != INVALID_NAME_ID ? global_symbols.find(name_id) : nullptr;
+}
+
+void SemanticAnalyzer::semantic_error(FunctionContext* io_context, ERROR_TYPE in_type, const AstNode* in_node, const char* format, ...) noexcept {
+    va_list ap, ap2;
+    va_start(ap, format);
+    va_copy(ap2, ap);
+
+    int len = vsnprintf(nullptr, 0, format, ap);
+    assert(len >= 0);
+    va_end(ap);
+
+    std::string msg(len, '\0');
+    vsnprintf(msg.data(), len + 1, format, ap2);
+    va_end(ap2);
+
+    Error error(in_type,
+        in_node->line,
+        in_node->column,
+        std::string(file_name), msg);
+    // function bodies are analyzed in parallel, each thread has its own list
+    (io_context ? io_context->errors : errors).push_back(error);
+}
+
+const AstFuncProto& get_proto(const AstNode* in_function_node) noexcept {
+    if (in_function_node->node_type == AstNodeType::AstFuncDef) {
+        return in_function_node->function_def.proto->function_proto;
+    }
+    return in_function_node->function_proto;
+}
+
+bool is_same_signature(const AstFuncProto& in_proto, const AstFuncProto& in_other_proto) noexcept {
+    if (in_proto.return_type->ast_type.type_info != in_other_proto.return_type->ast_type.type_info
+        || in_proto.params.size() != in_other_proto.params.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < in_proto.params.size(); i++) {
+        if (in_proto.params[i]->param_decl.type->ast_type.type_info != in_other_proto.params[i]->param_decl.type->ast_type.type_info) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool is_function(const AstNode* in_node) noexcept {
+    return in_node->node_type == AstNodeType::AstFuncDef || in_node->node_type == AstNodeType::AstFuncProto;
+}
+
+bool is_numeric(AstTypeId in_type_id) noexcept {
+    return in_type_id == AstTypeId::Bool || in_type_id == AstTypeId::Integer || in_type_id == AstTypeId::FloatingPoint;
+}
+
+bool is_integer(AstTypeId in_type_id) noexcept {
+    return in_type_id == AstTypeId::Bool || in_type_id == AstTypeId::Integer;
+}
+
+const char* get_binary_op_name(BinaryExprType in_op) noexcept {
+    switch (in_op) {
+    case BinaryExprType::ADD:               return "+";
+    case BinaryExprType::SUB:               return "-";
+    case BinaryExprType::MUL:               return "*";
+    case BinaryExprType::DIV:               return "/";
+    case BinaryExprType::MOD:               return "%";
+    case BinaryExprType::EQUALS:            return "==";
+    case BinaryExprType::NOT_EQUALS:        return "!=";
+    case BinaryExprType::GREATER_OR_EQUALS: return ">=";
+    case BinaryExprType::LESS_OR_EQUALS:    return "<=";
+    case BinaryExprType::GREATER:           return ">";
+    case BinaryExprType::LESS:              return "<";
+    case BinaryExprType::LSHIFT:            return "<<";
+    case BinaryExprType::RSHIFT:            return ">>";
+    case BinaryExprType::BIT_XOR:           return "^";
+    case BinaryExprType::BIT_AND:           return "&";
+    case BinaryExprType::ASSIGN:            return "=";
+    default:
+        UNREACHEABLE;
+    }
+}
+
+AstNode* new_type_node(const TypeInfo* in_type_info) noexcept {
+    AstNode* type_node = new AstNode(AstNodeType::AstType, 0, 0);
+    type_node->ast_type.type_id = in_type_info->type_id;
+    type_node->ast_type.child_type = nullptr;
+    type_node->ast_type.type_info = const_cast<TypeInfo*>(in_type_info);
+    return type_node;
+}
+
+bool has_errors(const std::vector<Error>& in_errors, size_t in_first_error) noexcept {
+    for (size_t i = in_first_error; i < in_errors.size(); i++) {
+        if (in_errors[i].type == ERROR_TYPE::ERROR) {
+            return true;
+        }
+    }
+    return false;
+}
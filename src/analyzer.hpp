@@ -0,0 +1,90 @@
+#pragma once
+#include "ast_nodes.hpp"
+#include "common_defs.hpp"
+#include "error.hpp"
+#include "symbol_table.hpp"
+#include <string_view>
+#include <vector>
+
+class DependencyGraph;
+class ModuleInterface;
+class Scheduler;
+struct TypeInfo;
+
+/*
+* Semantic pass run before IR generation, once the interfaces of the
+* loaded modules are known.
+* Resolves every name to its declaration (AstSymbol::declaration and
+* AstFuncCallExpr::fn_ref) so code generation never looks names up, and
+* checks the type of every expression.
+* Numeric values convert implicitly, conversions that can lose
+* information are warned about.
+* Function bodies only read the global scope, so they are analyzed in
+* parallel on the scheduler of the build, each task with its own local
+* tables and diagnostics.
+*/
+class SemanticAnalyzer {
+    // the state of the function body being analyzed
+    struct FunctionContext {
+        NameTable       names;      // extends the global names with the local ones
+        SymbolTable     symbols;    // local scopes, the global scope is the parent
+        const AstNode*  function;
+        std::vector<Error>& errors; // of the task
+    };
+
+    // type of an expression
+    struct ExprType {
+        const TypeInfo* type_info;  // null for literals, they take the type they are converted to
+        AstTypeId       type_id;    // of the literal if type_info is null
+        bool            is_valid;   // errors were already reported otherwise
+    };
+
+    AstNode*            source_code_node;
+    std::string_view    file_name;
+    std::vector<Error>& errors;
+    NameTable           global_names;
+    SymbolTable         global_symbols;
+    const TypeInfo*     bool_type;
+    const TypeInfo*     void_type;
+
+public:
+    SemanticAnalyzer(AstNode* in_source_code_node, std::vector<Error>& in_errors);
+
+    // runs both passes over the module, function bodies are spread over the workers of io_scheduler if any.
+    // it can be called from a task of io_scheduler, the task runs batches while waiting for the others.
+    // the bodies in_graph finds unchanged are skipped, their previous diagnostics are used instead.
+    // new diagnostics are sorted by position. returns false if there were errors
+    bool analyze(const std::vector<const ModuleInterface*>& in_dependency_interfaces, Scheduler* io_scheduler = nullptr,
+        DependencyGraph* io_graph = nullptr) noexcept;
+
+    // declares the functions and globals of a loaded module
+    void declare_interface(const ModuleInterface& in_interface) noexcept;
+
+    // first pass, declares the top level symbols. return false if invalid
+    bool analizeFuncProto(AstNode* in_declaration) noexcept;
+    bool analizeVarDef(AstNode* in_var_def_node) noexcept;
+
+    // second pass, the global scope is read only from here
+    bool analizeFuncBlock(AstNode* in_func_def_node) noexcept;
+
+private:
+    void analize_func_blocks(const std::vector<AstNode*>& in_functions, Scheduler* io_scheduler) noexcept;
+    void analize_func_block(FunctionContext& io_context) noexcept;
+    bool analize_local_var_def(FunctionContext& io_context, AstNode* in_var_def_node) noexcept;
+    ExprType analize_expr(FunctionContext* io_context, AstNode* in_node) noexcept;
+    ExprType analize_symbol(FunctionContext* io_context, AstNode* in_node) noexcept;
+    ExprType analize_binary_expr(FunctionContext* io_context, AstNode* in_node) noexcept;
+    ExprType analize_unary_expr(FunctionContext* io_context, AstNode* in_node) noexcept;
+    ExprType analize_func_call(FunctionContext* io_context, AstNode* in_node) noexcept;
+
+    // returns false if in_value_type can't be converted to in_type_info
+    bool check_conversion(FunctionContext* io_context, const AstNode* in_value_node, const ExprType& in_value_type, const TypeInfo* in_type_info) noexcept;
+    // returns false and reports the error if in_type_node can't be used, void is only valid for return types
+    bool check_type(FunctionContext* io_context, const AstNode* in_type_node, bool in_is_return_type) noexcept;
+
+    bool declare_global(std::string_view in_name, AstNode* in_declaration) noexcept;
+    AstNode* find_symbol(const FunctionContext* in_context, std::string_view in_name) const noexcept;
+
+    // goes to the errors of io_context if not null
+    void semantic_error(FunctionContext* io_context, ERROR_TYPE in_type, const AstNode* in_node, const char* format, ...) noexcept;
+};
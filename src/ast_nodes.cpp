@@ -1,4 +1,5 @@
 #include "ast_nodes.hpp"
+#include "lexer.hpp"
 
 static std::vector<const char*> directives_keywords = {
     "run",
@@ -10,3 +11,81 @@ const std::string get_directive_type_name(const DirectiveType directive_type) no
 {
     return directives_keywords.at((size_t)directive_type);
 }
+
+bool get_directive_type(std::string_view in_name, DirectiveType* out_type) noexcept
+{
+    for (size_t i = 0; i < directives_keywords.size(); i++) {
+        if (in_name == directives_keywords[i]) {
+            *out_type = (DirectiveType)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void delete_comptime_token(const Token* in_token) noexcept
+{
+    delete in_token;
+}
+
+size_t count_nodes(const AstNode* in_node) noexcept
+{
+    if (!in_node) {
+        return 0;
+    }
+
+    size_t count = 1;
+    switch (in_node->node_type) {
+    case AstNodeType::AstSourceCode:
+        for (auto child : in_node->source_code.children) {
+            count += count_nodes(child);
+        }
+        break;
+    case AstNodeType::AstDirective:
+        count += count_nodes(in_node->directive.expr);
+        break;
+    case AstNodeType::AstFuncDef:
+        count += count_nodes(in_node->function_def.proto);
+        count += count_nodes(in_node->function_def.block);
+        break;
+    case AstNodeType::AstFuncProto:
+        for (auto param : in_node->function_proto.params) {
+            count += count_nodes(param);
+        }
+        count += count_nodes(in_node->function_proto.return_type);
+        break;
+    case AstNodeType::AstParamDecl:
+        count += count_nodes(in_node->param_decl.type);
+        break;
+    case AstNodeType::AstBlock:
+        for (auto statement : in_node->block.statements) {
+            count += count_nodes(statement);
+        }
+        break;
+    case AstNodeType::AstVarDef:
+        count += count_nodes(in_node->var_def.type);
+        count += count_nodes(in_node->var_def.initializer);
+        break;
+    case AstNodeType::AstType:
+        // only set for derived types
+        if (in_node->ast_type.type_id == AstTypeId::Pointer || in_node->ast_type.type_id == AstTypeId::Array) {
+            count += count_nodes(in_node->ast_type.child_type);
+        }
+        break;
+    case AstNodeType::AstUnaryExpr:
+        count += count_nodes(in_node->unary_expr.expr);
+        break;
+    case AstNodeType::AstBinaryExpr:
+        count += count_nodes(in_node->binary_expr.op1);
+        count += count_nodes(in_node->binary_expr.op2);
+        break;
+    case AstNodeType::AstFuncCallExpr:
+        for (auto param : in_node->func_call.params) {
+            count += count_nodes(param);
+        }
+        break;
+    default:
+        break;
+    }
+    return count;
+}
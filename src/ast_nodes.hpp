@@ -9,6 +9,7 @@
 
 // ast nodes
 struct Token;
+class LiteralPool;
 struct AstNode;
 struct AstDirective;
 struct AstType;
@@ -32,9 +33,13 @@ enum class DirectiveType {
 
 const std::string get_directive_type_name(const DirectiveType) noexcept;
 
+// returns false if in_name is not a directive
+bool get_directive_type(std::string_view in_name, DirectiveType* out_type) noexcept;
+
 struct AstDirective {
     DirectiveType       directive_type;
-    std::string_view    argument;
+    std::string_view    argument;       // module name if directive_type == Load
+    AstNode*            expr = nullptr; // expression to evaluate if directive_type == Run
 };
 
 struct AstFuncDef {
@@ -67,12 +72,23 @@ struct AstVarDef {
 };
 
 struct AstSymbol {
-    const Token* token;
+    const Token*        token;
+    std::string_view    name;   // empty if the symbol is a literal
+    // AstVarDef, AstParamDecl or function the name refers to, set by the semantic analysis
+    AstNode*            declaration = nullptr;
+    // the token was created by compile time evaluation and is owned by this node
+    bool                is_comptime_value = false;
 };
 
+// deletes a token created for a comptime value
+void delete_comptime_token(const Token* in_token) noexcept;
+
+// number of nodes in the tree of in_node, in_node included
+size_t count_nodes(const AstNode* in_node) noexcept;
+
 struct AstFuncCallExpr {
     std::string_view        fn_name;
-    AstNode*                fn_ref;
+    AstNode*                fn_ref = nullptr;   // AstFuncDef or AstFuncProto, set by the semantic analysis
     std::vector<AstNode*>   params;
 };
 
@@ -118,6 +134,11 @@ struct AstUnaryExpr {
 
 struct AstSourceCode {
     std::vector<AstNode*> children;
+    std::string_view      file_name;
+    std::string_view      source;   // owned by the lexer
+    LiteralPool*          literals = nullptr; // owned by the lexer
+    // declarations of the loaded modules and their nodes, made by the semantic analysis
+    std::vector<AstNode*> imported_nodes;
 };
 
 
@@ -131,17 +152,20 @@ enum class AstTypeId {
     Struct
 };
 
+// interned, see types.hpp
 struct TypeInfo {
     std::string_view    name;
-    LLVMTypeRef         llvm_type;
+    TypeInfo*           element_type;   // Not null if type == (pointer | array)
+    uint32_t            id;             // dense index, used to memoize per module data
     uint32_t            bit_size;
+    AstTypeId           type_id;
     bool                is_signed;
 };
 
 struct AstType {
     AstTypeId       type_id;    // Pointer Array Integer FloatingPoint
     AstNode*        child_type; // Not null if type == (pointer | array)
-    TypeInfo*       type_info;  // null if type == (pointer | array)
+    TypeInfo*       type_info;  // canonical type, compare by pointer
 
     AstType() : type_id(AstTypeId::Void), child_type(nullptr), type_info(nullptr) {}
 };
@@ -198,10 +222,17 @@ struct AstNode {
             for (auto node : source_code.children) {
                 delete node;
             }
+            for (auto node : source_code.imported_nodes) {
+                delete node;
+            }
         }else if (node_type == AstNodeType::AstFuncCallExpr) {
             for (auto node : func_call.params) {
                 delete node;
             }
+        } else if (node_type == AstNodeType::AstDirective) {
+            delete directive.expr;
+        } else if (node_type == AstNodeType::AstSymbol && symbol.is_comptime_value) {
+            delete_comptime_token(symbol.token);
         }
     }
 };
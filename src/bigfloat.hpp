@@ -0,0 +1,22 @@
+#pragma once
+#include "common_defs.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+// binary128 bits, v[0] holds the low bits
+typedef struct { uint64_t v[2]; } float128_t;
+
+// value of a float literal, rounded once to each floating point type
+// so the narrow ones don't suffer a double rounding through binary128
+struct BigFloat {
+    float128_t  value;      // binary128
+    uint64_t    f64_bits;   // binary64
+    uint32_t    f32_bits;   // binary32
+    bool        overflow;   // too big for binary128, value is infinite
+};
+
+// parses the text of a float literal: decimal or 0x hexadecimal digits with '_' separators,
+// an optional fraction, an optional exponent ('e' for decimal, 'p' for hexadecimal) and an optional 'f'.
+// rounds to nearest, ties to even. the text is expected to be valid, parsing stops at the first
+// unexpected character
+void bigfloat_init_buf(BigFloat *dest, const uint8_t *buf_ptr, size_t buf_len);
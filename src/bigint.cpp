@@ -11,28 +11,83 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <vector>
+
+// below this many digits schoolbook multiplication is faster
+#define KARATSUBA_THRESHOLD 32
+// digits of scratch used by a karatsuba product of in_count digits operands, every level takes 4 halves
+#define KARATSUBA_SCRATCH_SIZE(in_count) (6 * (in_count) + 640)
+
+enum BitwiseOp {
+    BitwiseAnd,
+    BitwiseOr,
+    BitwiseXor,
+};
+
+static uint64_t *bigint_reserve(BigInt *dest, size_t digit_count);
+static uint64_t *bigint_mut_ptr(BigInt *bigint);
+static void bigint_normalize(BigInt *dest);
+static void bigint_move(BigInt *dest, BigInt *src, const BigInt *op1, const BigInt *op2);
+static uint64_t bigint_as_unsigned(const BigInt* bigint);
+static Cmp digits_cmp(const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count);
+static void digits_add(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count);
+static void digits_sub(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count);
+static void digits_add_into(uint64_t *dest, size_t dest_count, const uint64_t *src, size_t src_count);
+static void digits_sub_into(uint64_t *dest, size_t dest_count, const uint64_t *src, size_t src_count);
+static void digits_negate(uint64_t *digits, size_t count);
+static size_t digits_significant(const uint64_t *digits, size_t count);
+static void digits_mul(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count);
+static void digits_mul_schoolbook(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count);
+static void digits_mul_karatsuba(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count, uint64_t *scratch);
+static uint64_t digits_div_scalar(uint64_t *quotient, const uint64_t *op, size_t count, uint64_t divisor);
+static void digits_divmod(uint64_t *quotient, uint64_t *remainder, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count);
+static void bigint_add_signed(BigInt *dest, const BigInt *op1, const BigInt *op2, bool op2_is_negative);
+static void bigint_to_twos_complement(const BigInt *op, uint64_t *digits, size_t count);
+static void bigint_from_twos_complement(BigInt *dest);
+static void bigint_bitwise(BigInt *dest, const BigInt *op1, const BigInt *op2, BitwiseOp op);
+
+// sets the digit count of an uninitialized dest, the digits are not initialized
+uint64_t *bigint_reserve(BigInt *dest, size_t digit_count) {
+    dest->digit_count = digit_count;
+    if (digit_count <= BIGINT_INLINE_DIGITS) {
+        return dest->data.inline_digits;
+    }
+    dest->data.digits = (uint64_t*) malloc(sizeof(uint64_t) * digit_count);
+    return dest->data.digits;
+}
+
+uint64_t *bigint_mut_ptr(BigInt *bigint) {
+    return bigint_is_inline(bigint) ? bigint->data.inline_digits : bigint->data.digits;
+}
 
-static void bigint_normalize(BigInt *dest) {
+// drops the leading zero digits, values that fit inline again leave the heap
+void bigint_normalize(BigInt *dest) {
     const uint64_t *digits = bigint_ptr(dest);
 
-    size_t last_nonzero_digit = SIZE_MAX;
-    for (size_t i = 0; i < dest->digit_count; i += 1) {
-        uint64_t digit = digits[i];
-        if (digit != 0) {
-            last_nonzero_digit = i;
-        }
+    size_t digit_count = dest->digit_count;
+    while (digit_count > 0 && digits[digit_count - 1] == 0) {
+        digit_count -= 1;
+    }
+
+    if (!bigint_is_inline(dest) && digit_count <= BIGINT_INLINE_DIGITS) {
+        uint64_t *heap_digits = dest->data.digits;
+        memcpy(dest->data.inline_digits, heap_digits, sizeof(uint64_t) * digit_count);
+        free(heap_digits);
     }
-    if (last_nonzero_digit == SIZE_MAX) {
+    dest->digit_count = digit_count;
+    if (digit_count == 0) {
         dest->is_negative = false;
-        dest->digit_count = 0;
-    } else {
-        dest->digit_count = last_nonzero_digit + 1;
-        if (last_nonzero_digit == 0) {
-            dest->data.digit = digits[0];
-        }
     }
 }
 
+// src is computed before dest is written, so dest can be one of the operands
+void bigint_move(BigInt *dest, BigInt *src, const BigInt *op1, const BigInt *op2) {
+    if (dest == op1 || dest == op2) {
+        bigint_deinit(dest);
+    }
+    *dest = *src;
+}
+
 void bigint_init_unsigned(BigInt *dest, uint64_t x) {
     if (x == 0) {
         dest->digit_count = 0;
@@ -40,7 +95,7 @@ void bigint_init_unsigned(BigInt *dest, uint64_t x) {
         return;
     }
     dest->digit_count = 1;
-    dest->data.digit = x;
+    dest->data.inline_digits[0] = x;
     dest->is_negative = false;
 }
 
@@ -50,55 +105,43 @@ void bigint_init_signed(BigInt *dest, int64_t x) {
     }
     dest->is_negative = true;
     dest->digit_count = 1;
-    dest->data.digit = ((uint64_t)(-(x + 1))) + 1;
+    dest->data.inline_digits[0] = ((uint64_t)(-(x + 1))) + 1;
 }
 
 void bigint_init_data(BigInt *dest, const uint64_t *digits, size_t digit_count, bool is_negative) {
-    if (digit_count == 0) {
-        return bigint_init_unsigned(dest, 0);
-    } else if (digit_count == 1) {
-        dest->digit_count = 1;
-        dest->data.digit = digits[0];
-        dest->is_negative = is_negative;
-        bigint_normalize(dest);
-        return;
-    }
-
-    dest->digit_count = digit_count;
+    uint64_t *dest_digits = bigint_reserve(dest, digit_count);
+    memcpy(dest_digits, digits, sizeof(uint64_t) * digit_count);
     dest->is_negative = is_negative;
-    dest->data.digits = (uint64_t*) malloc(digit_count + sizeof(uint64_t));
-    memcpy(dest->data.digits, digits, sizeof(uint64_t) * digit_count);
-
     bigint_normalize(dest);
 }
 
 void bigint_init_bigint(BigInt *dest, const BigInt *src) {
-    if (src->digit_count == 0) {
-        return bigint_init_unsigned(dest, 0);
-    } else if (src->digit_count == 1) {
-        dest->digit_count = 1;
-        dest->data.digit = src->data.digit;
-        dest->is_negative = src->is_negative;
+    if (dest == src) {
         return;
     }
+    if (bigint_is_inline(src)) {
+        *dest = *src;
+        return;
+    }
+    uint64_t *dest_digits = bigint_reserve(dest, src->digit_count);
+    memcpy(dest_digits, src->data.digits, sizeof(uint64_t) * src->digit_count);
     dest->is_negative = src->is_negative;
-    dest->digit_count = src->digit_count;
-    dest->data.digits = (uint64_t*)malloc(dest->digit_count + sizeof(uint64_t));
-    memcpy(dest->data.digits, src->data.digits, sizeof(uint64_t) * dest->digit_count);
 }
 
 void bigint_deinit(BigInt *bi) {
-    if (bi->digit_count > 1)
+    if (!bigint_is_inline(bi))
         free(bi->data.digits);
+    bi->digit_count = 0;
+    bi->is_negative = false;
 }
 
-static uint64_t bigint_as_unsigned(const BigInt* bigint) {
+uint64_t bigint_as_unsigned(const BigInt* bigint) {
     assert(!bigint->is_negative);
     if (bigint->digit_count == 0) {
         return 0;
     }
     else if (bigint->digit_count == 1) {
-        return bigint->data.digit;
+        return bigint->data.inline_digits[0];
     }
     else {
         UNREACHEABLE;
@@ -148,125 +191,12 @@ bool mul_u64_overflow(uint64_t op1, uint64_t op2, uint64_t *result) {
 }
 #endif
 
-void bigint_add(BigInt *dest, const BigInt *op1, const BigInt *op2) {
-    if (op1->digit_count == 0) {
-        return bigint_init_bigint(dest, op2);
-    }
-    if (op2->digit_count == 0) {
-        return bigint_init_bigint(dest, op1);
-    }
-    if (op1->is_negative == op2->is_negative) {
-        dest->is_negative = op1->is_negative;
-
-        const uint64_t *op1_digits = bigint_ptr(op1);
-        const uint64_t *op2_digits = bigint_ptr(op2);
-        bool overflow = add_u64_overflow(op1_digits[0], op2_digits[0], &dest->data.digit);
-        if (overflow == 0 && op1->digit_count == 1 && op2->digit_count == 1) {
-            dest->digit_count = 1;
-            bigint_normalize(dest);
-            return;
-        }
-        size_t i = 1;
-        uint64_t first_digit = dest->data.digit;
-        dest->data.digits = (uint64_t*) malloc(sizeof(uint64_t) + std::max(op1->digit_count, op2->digit_count) + 1);
-        dest->data.digits[0] = first_digit;
-
-        for (;;) {
-            bool found_digit = false;
-            uint64_t x = overflow;
-            overflow = 0;
-
-            if (i < op1->digit_count) {
-                found_digit = true;
-                uint64_t digit = op1_digits[i];
-                overflow += add_u64_overflow(x, digit, &x);
-            }
-
-            if (i < op2->digit_count) {
-                found_digit = true;
-                uint64_t digit = op2_digits[i];
-                overflow += add_u64_overflow(x, digit, &x);
-            }
-
-            dest->data.digits[i] = x;
-            i += 1;
-
-            if (!found_digit) {
-                dest->digit_count = i;
-                bigint_normalize(dest);
-                return;
-            }
-        }
-    }
-    const BigInt *op_pos;
-    const BigInt *op_neg;
-    if (op1->is_negative) {
-        op_neg = op1;
-        op_pos = op2;
-    } else {
-        op_pos = op1;
-        op_neg = op2;
-    }
-
-    BigInt op_neg_abs = {0};
-    bigint_negate(&op_neg_abs, op_neg);
-    const BigInt *bigger_op;
-    const BigInt *smaller_op;
-    switch (bigint_cmp(op_pos, &op_neg_abs)) {
-        case CmpEQ:
-            bigint_init_unsigned(dest, 0);
-            return;
-        case CmpLT:
-            bigger_op = &op_neg_abs;
-            smaller_op = op_pos;
-            dest->is_negative = true;
-            break;
-        case CmpGT:
-            bigger_op = op_pos;
-            smaller_op = &op_neg_abs;
-            dest->is_negative = false;
-            break;
-    }
-    const uint64_t *bigger_op_digits = bigint_ptr(bigger_op);
-    const uint64_t *smaller_op_digits = bigint_ptr(smaller_op);
-    uint64_t overflow = sub_u64_overflow(bigger_op_digits[0], smaller_op_digits[0], &dest->data.digit);
-    if (overflow == 0 && bigger_op->digit_count == 1 && smaller_op->digit_count == 1) {
-        dest->digit_count = 1;
-        bigint_normalize(dest);
-        return;
-    }
-    uint64_t first_digit = dest->data.digit;
-    dest->data.digits = (uint64_t*)malloc(sizeof(uint64_t) + bigger_op->digit_count);
-    dest->data.digits[0] = first_digit;
-    size_t i = 1;
-
-    for (;;) {
-        bool found_digit = false;
-        uint64_t x = bigger_op_digits[i];
-        uint64_t prev_overflow = overflow;
-        overflow = 0;
-
-        if (i < smaller_op->digit_count) {
-            found_digit = true;
-            uint64_t digit = smaller_op_digits[i];
-            overflow += sub_u64_overflow(x, digit, &x);
-        }
-        if (sub_u64_overflow(x, prev_overflow, &x)) {
-            found_digit = true;
-            overflow += 1;
-        }
-        dest->data.digits[i] = x;
-        i += 1;
-
-        if (!found_digit || i >= bigger_op->digit_count)
-            break;
-    }
-    assert(overflow == 0);
-    dest->digit_count = i;
-    bigint_normalize(dest);
-}
-
 static void mul_overflow(uint64_t op1, uint64_t op2, uint64_t *lo, uint64_t *hi) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)op1 * op2;
+    *lo = (uint64_t)product;
+    *hi = (uint64_t)(product >> 64);
+#else
     uint64_t u1 = (op1 & 0xffffffff);
     uint64_t v1 = (op2 & 0xffffffff);
     uint64_t t = (u1 * v1);
@@ -284,85 +214,371 @@ static void mul_overflow(uint64_t op1, uint64_t op2, uint64_t *lo, uint64_t *hi)
 
     *hi = (op1 * op2) + w1 + k;
     *lo = (t << 32) + w3;
+#endif
 }
 
-static void mul_scalar(BigInt *dest, const BigInt *op, uint64_t scalar) {
-    bigint_init_unsigned(dest, 0);
+// (hi * 2^64 + lo) / divisor, hi < divisor
+static uint64_t div_wide(uint64_t hi, uint64_t lo, uint64_t divisor, uint64_t *remainder) {
+    assert(hi < divisor);
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 dividend = ((unsigned __int128)hi << 64) | lo;
+    *remainder = (uint64_t)(dividend % divisor);
+    return (uint64_t)(dividend / divisor);
+#else
+    // restoring division, one quotient bit at a time
+    for (int i = 0; i < 64; i += 1) {
+        uint64_t carry = hi >> 63;
+        hi = (hi << 1) | (lo >> 63);
+        lo <<= 1;
+        if (carry || hi >= divisor) {
+            hi -= divisor;
+            lo |= 1;
+        }
+    }
+    *remainder = hi;
+    return lo;
+#endif
+}
 
-    BigInt bi_64;
-    bigint_init_unsigned(&bi_64, 64);
+static unsigned count_leading_zeros(uint64_t x) {
+    assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_clzll((unsigned long long)x);
+#else
+    unsigned count = 0;
+    for (unsigned shift = 32; shift > 0; shift /= 2) {
+        if ((x >> (64 - shift)) == 0) {
+            count += shift;
+            x <<= shift;
+        }
+    }
+    return count;
+#endif
+}
 
-    const uint64_t *op_digits = bigint_ptr(op);
-    size_t i = op->digit_count - 1;
+// magnitudes only, the counts have no leading zeros
+Cmp digits_cmp(const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count) {
+    if (op1_count != op2_count) {
+        return op1_count > op2_count ? CmpGT : CmpLT;
+    }
+    for (size_t i = op1_count; i > 0; i -= 1) {
+        if (op1[i - 1] != op2[i - 1]) {
+            return op1[i - 1] > op2[i - 1] ? CmpGT : CmpLT;
+        }
+    }
+    return CmpEQ;
+}
 
-    for (;;) {
-        BigInt shifted;
-        bigint_shl(&shifted, dest, &bi_64);
+// dest has op1_count + 1 digits, op1_count >= op2_count
+void digits_add(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < op1_count; i += 1) {
+        uint64_t x;
+        uint64_t overflow = add_u64_overflow(op1[i], carry, &x);
+        if (i < op2_count) {
+            overflow += add_u64_overflow(x, op2[i], &x);
+        }
+        dest[i] = x;
+        carry = overflow;
+    }
+    dest[op1_count] = carry;
+}
 
-        uint64_t result_scalar;
-        uint64_t carry_scalar;
-        mul_overflow(scalar, op_digits[i], &result_scalar, &carry_scalar);
+// dest has op1_count digits, op1 >= op2
+void digits_sub(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < op1_count; i += 1) {
+        uint64_t x;
+        uint64_t overflow = sub_u64_overflow(op1[i], borrow, &x);
+        if (i < op2_count) {
+            overflow += sub_u64_overflow(x, op2[i], &x);
+        }
+        dest[i] = x;
+        borrow = overflow;
+    }
+    assert(borrow == 0);
+}
 
-        BigInt result;
-        bigint_init_unsigned(&result, result_scalar);
+// dest += src, the sum fits in dest_count digits
+void digits_add_into(uint64_t *dest, size_t dest_count, const uint64_t *src, size_t src_count) {
+    assert(src_count <= dest_count);
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < src_count; i += 1) {
+        uint64_t overflow = add_u64_overflow(dest[i], src[i], &dest[i]);
+        overflow += add_u64_overflow(dest[i], carry, &dest[i]);
+        carry = overflow;
+    }
+    for (; carry != 0; i += 1) {
+        assert(i < dest_count);
+        carry = add_u64_overflow(dest[i], carry, &dest[i]);
+    }
+}
 
-        BigInt carry;
-        bigint_init_unsigned(&carry, carry_scalar);
+// dest -= src, dest >= src
+void digits_sub_into(uint64_t *dest, size_t dest_count, const uint64_t *src, size_t src_count) {
+    assert(src_count <= dest_count);
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < src_count; i += 1) {
+        uint64_t overflow = sub_u64_overflow(dest[i], src[i], &dest[i]);
+        overflow += sub_u64_overflow(dest[i], borrow, &dest[i]);
+        borrow = overflow;
+    }
+    for (; borrow != 0; i += 1) {
+        assert(i < dest_count);
+        borrow = sub_u64_overflow(dest[i], borrow, &dest[i]);
+    }
+}
 
-        BigInt carry_shifted;
-        bigint_shl(&carry_shifted, &carry, &bi_64);
+// two's complement negation modulo 2^(64 * count)
+void digits_negate(uint64_t *digits, size_t count) {
+    uint64_t carry = 1;
+    for (size_t i = 0; i < count; i += 1) {
+        carry = add_u64_overflow(~digits[i], carry, &digits[i]);
+    }
+}
 
-        BigInt tmp;
-        bigint_add(&tmp, &shifted, &carry_shifted);
+size_t digits_significant(const uint64_t *digits, size_t count) {
+    while (count > 0 && digits[count - 1] == 0) {
+        count -= 1;
+    }
+    return count;
+}
 
-        bigint_add(dest, &tmp, &result);
+// dest has op1_count + op2_count digits
+void digits_mul(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count) {
+    if (std::min(op1_count, op2_count) < KARATSUBA_THRESHOLD) {
+        return digits_mul_schoolbook(dest, op1, op1_count, op2, op2_count);
+    }
+    std::vector<uint64_t> scratch(KARATSUBA_SCRATCH_SIZE(std::max(op1_count, op2_count)));
+    digits_mul_karatsuba(dest, op1, op1_count, op2, op2_count, scratch.data());
+}
 
-        if (i == 0) {
-            break;
+void digits_mul_schoolbook(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count) {
+    memset(dest, 0, sizeof(uint64_t) * (op1_count + op2_count));
+    for (size_t i = 0; i < op2_count; i += 1) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < op1_count; j += 1) {
+            uint64_t lo, hi;
+            mul_overflow(op1[j], op2[i], &lo, &hi);
+            hi += add_u64_overflow(lo, carry, &lo);
+            hi += add_u64_overflow(dest[i + j], lo, &dest[i + j]);
+            carry = hi;
         }
-        i -= 1;
+        dest[i + op1_count] = carry;
     }
 }
 
-void bigint_mul(BigInt *dest, const BigInt *op1, const BigInt *op2) {
-    if (op1->digit_count == 0 || op2->digit_count == 0) {
-        return bigint_init_unsigned(dest, 0);
+// op1 = a1 * 2^(64 * half) + a0, op2 = b1 * 2^(64 * half) + b0
+// op1 * op2 = z2 * 2^(128 * half) + z1 * 2^(64 * half) + z0, with
+// z0 = a0 * b0, z2 = a1 * b1 and z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+void digits_mul_karatsuba(uint64_t *dest, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count, uint64_t *scratch) {
+    if (op1_count < op2_count) {
+        std::swap(op1, op2);
+        std::swap(op1_count, op2_count);
+    }
+    if (op2_count < KARATSUBA_THRESHOLD) {
+        return digits_mul_schoolbook(dest, op1, op1_count, op2, op2_count);
     }
-    const uint64_t *op1_digits = bigint_ptr(op1);
-    const uint64_t *op2_digits = bigint_ptr(op2);
 
-    uint64_t carry;
-    mul_overflow(op1_digits[0], op2_digits[0], &dest->data.digit, &carry);
-    if (carry == 0 && op1->digit_count == 1 && op2->digit_count == 1) {
-        dest->is_negative = (op1->is_negative != op2->is_negative);
-        dest->digit_count = 1;
-        bigint_normalize(dest);
+    const size_t half = (op1_count + 1) / 2;
+    if (op2_count <= half) {
+        // unbalanced, op1 is multiplied in pieces of the size of op2
+        memset(dest, 0, sizeof(uint64_t) * (op1_count + op2_count));
+        uint64_t *product = scratch;
+        for (size_t offset = 0; offset < op1_count; offset += op2_count) {
+            const size_t piece_count = std::min(op2_count, op1_count - offset);
+            digits_mul_karatsuba(product, op1 + offset, piece_count, op2, op2_count, scratch + 2 * op2_count);
+            digits_add_into(dest + offset, op1_count + op2_count - offset, product, piece_count + op2_count);
+        }
         return;
     }
 
-    bigint_init_unsigned(dest, 0);
+    const size_t a1_count = op1_count - half;
+    const size_t b1_count = op2_count - half;
+    digits_mul_karatsuba(dest, op1, half, op2, half, scratch);
+    digits_mul_karatsuba(dest + 2 * half, op1 + half, a1_count, op2 + half, b1_count, scratch);
+
+    uint64_t *a_sum = scratch;
+    uint64_t *b_sum = a_sum + half + 1;
+    uint64_t *z1 = b_sum + half + 1;
+    const size_t z1_count = 2 * half + 2;
+    digits_add(a_sum, op1, half, op1 + half, a1_count);
+    digits_add(b_sum, op2, half, op2 + half, b1_count);
+    digits_mul_karatsuba(z1, a_sum, half + 1, b_sum, half + 1, z1 + z1_count);
+    digits_sub_into(z1, z1_count, dest, 2 * half);
+    digits_sub_into(z1, z1_count, dest + 2 * half, a1_count + b1_count);
+    digits_add_into(dest + half, op1_count + op2_count - half, z1, digits_significant(z1, z1_count));
+}
 
-    BigInt bi_64;
-    bigint_init_unsigned(&bi_64, 64);
+// quotient has count digits, it can be op. returns the remainder
+uint64_t digits_div_scalar(uint64_t *quotient, const uint64_t *op, size_t count, uint64_t divisor) {
+    uint64_t remainder = 0;
+    for (size_t i = count; i > 0; i -= 1) {
+        quotient[i - 1] = div_wide(remainder, op[i - 1], divisor, &remainder);
+    }
+    return remainder;
+}
 
-    size_t i = op2->digit_count - 1;
-    for (;;) {
-        BigInt shifted;
-        bigint_shl(&shifted, dest, &bi_64);
+uint64_t bigint_digits_mul_add(uint64_t *digits, size_t digit_count, uint64_t factor, uint64_t addend) {
+    uint64_t carry = addend;
+    for (size_t i = 0; i < digit_count; i += 1) {
+        uint64_t lo, hi;
+        mul_overflow(digits[i], factor, &lo, &hi);
+        hi += add_u64_overflow(lo, carry, &digits[i]);
+        carry = hi;
+    }
+    return carry;
+}
 
-        BigInt scalar_result;
-        mul_scalar(&scalar_result, op1, op2_digits[i]);
+size_t bigint_digits_bit_count(const uint64_t *digits, size_t digit_count) {
+    while (digit_count > 0 && digits[digit_count - 1] == 0) {
+        digit_count -= 1;
+    }
+    if (digit_count == 0) {
+        return 0;
+    }
+    return digit_count * 64 - count_leading_zeros(digits[digit_count - 1]);
+}
 
-        bigint_add(dest, &scalar_result, &shifted);
+// Knuth, The Art of Computer Programming vol. 2, 4.3.1 algorithm D.
+// op1_count >= op2_count and op2 has no leading zeros.
+// quotient has op1_count - op2_count + 1 digits, remainder has op2_count
+void digits_divmod(uint64_t *quotient, uint64_t *remainder, const uint64_t *op1, size_t op1_count, const uint64_t *op2, size_t op2_count) {
+    assert(op1_count >= op2_count && op2_count > 0 && op2[op2_count - 1] != 0);
+    if (op2_count == 1) {
+        remainder[0] = digits_div_scalar(quotient, op1, op1_count, op2[0]);
+        return;
+    }
 
-        if (i == 0) {
-            break;
+    // D1, the top digit of the divisor gets its high bit set so the quotient digit estimates are off by 2 at most
+    const unsigned shift = count_leading_zeros(op2[op2_count - 1]);
+    std::vector<uint64_t> normalized(op2_count + op1_count + 1);
+    uint64_t *divisor = normalized.data();
+    uint64_t *dividend = divisor + op2_count;
+    const size_t n = op2_count;
+    const size_t m = op1_count - op2_count;
+    for (size_t i = n; i > 0; i -= 1) {
+        divisor[i - 1] = (op2[i - 1] << shift) | (shift != 0 && i > 1 ? op2[i - 2] >> (64 - shift) : 0);
+    }
+    dividend[op1_count] = shift != 0 ? op1[op1_count - 1] >> (64 - shift) : 0;
+    for (size_t i = op1_count; i > 0; i -= 1) {
+        dividend[i - 1] = (op1[i - 1] << shift) | (shift != 0 && i > 1 ? op1[i - 2] >> (64 - shift) : 0);
+    }
+
+    for (size_t j = m + 1; j > 0; j -= 1) {
+        uint64_t *window = dividend + j - 1;
+
+        // D3, estimate the quotient digit from the top two digits
+        uint64_t qhat, rhat;
+        bool rhat_overflow = false;
+        if (window[n] >= divisor[n - 1]) {
+            qhat = UINT64_MAX;
+            rhat_overflow = add_u64_overflow(window[n - 1], divisor[n - 1], &rhat);
+        } else {
+            qhat = div_wide(window[n], window[n - 1], divisor[n - 1], &rhat);
         }
-        i -= 1;
+        while (!rhat_overflow) {
+            uint64_t lo, hi;
+            mul_overflow(qhat, divisor[n - 2], &lo, &hi);
+            if (hi < rhat || (hi == rhat && lo <= window[n - 2])) {
+                break;
+            }
+            qhat -= 1;
+            rhat_overflow = add_u64_overflow(rhat, divisor[n - 1], &rhat);
+        }
+
+        // D4, window -= qhat * divisor
+        uint64_t mul_carry = 0;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < n; i += 1) {
+            uint64_t lo, hi;
+            mul_overflow(qhat, divisor[i], &lo, &hi);
+            hi += add_u64_overflow(lo, mul_carry, &lo);
+            mul_carry = hi;
+
+            uint64_t overflow = sub_u64_overflow(window[i], lo, &window[i]);
+            overflow += sub_u64_overflow(window[i], borrow, &window[i]);
+            borrow = overflow;
+        }
+        uint64_t overflow = sub_u64_overflow(window[n], mul_carry, &window[n]);
+        overflow += sub_u64_overflow(window[n], borrow, &window[n]);
+
+        // D6, qhat was one too big, add the divisor back
+        if (overflow != 0) {
+            qhat -= 1;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; i += 1) {
+                uint64_t digit_carry = add_u64_overflow(window[i], divisor[i], &window[i]);
+                digit_carry += add_u64_overflow(window[i], carry, &window[i]);
+                carry = digit_carry;
+            }
+            window[n] += carry;
+        }
+        quotient[j - 1] = qhat;
     }
 
-    dest->is_negative = (op1->is_negative != op2->is_negative);
-    bigint_normalize(dest);
+    // D8, the remainder is what is left of the dividend
+    for (size_t i = 0; i < n; i += 1) {
+        remainder[i] = (dividend[i] >> shift) | (shift != 0 ? dividend[i + 1] << (64 - shift) : 0);
+    }
+}
+
+void bigint_add(BigInt *dest, const BigInt *op1, const BigInt *op2) {
+    bigint_add_signed(dest, op1, op2, op2->is_negative);
+}
+
+void bigint_sub(BigInt *dest, const BigInt *op1, const BigInt *op2) {
+    bigint_add_signed(dest, op1, op2, !op2->is_negative);
+}
+
+// op1 + op2 with op2_is_negative as the sign of op2
+void bigint_add_signed(BigInt *dest, const BigInt *op1, const BigInt *op2, bool op2_is_negative) {
+    if (op1->digit_count == 0) {
+        bigint_init_bigint(dest, op2);
+        dest->is_negative = op2_is_negative && dest->digit_count != 0;
+        return;
+    }
+    if (op2->digit_count == 0) {
+        return bigint_init_bigint(dest, op1);
+    }
+
+    const BigInt *bigger_op = op1;
+    const BigInt *smaller_op = op2;
+    Cmp magnitude_cmp = digits_cmp(bigint_ptr(op1), op1->digit_count, bigint_ptr(op2), op2->digit_count);
+    if (magnitude_cmp == CmpLT) {
+        std::swap(bigger_op, smaller_op);
+    }
+
+    BigInt result;
+    if (op1->is_negative == op2_is_negative) {
+        uint64_t *result_digits = bigint_reserve(&result, bigger_op->digit_count + 1);
+        digits_add(result_digits, bigint_ptr(bigger_op), bigger_op->digit_count, bigint_ptr(smaller_op), smaller_op->digit_count);
+    } else if (magnitude_cmp == CmpEQ) {
+        bigint_init_unsigned(&result, 0);
+    } else {
+        uint64_t *result_digits = bigint_reserve(&result, bigger_op->digit_count);
+        digits_sub(result_digits, bigint_ptr(bigger_op), bigger_op->digit_count, bigint_ptr(smaller_op), smaller_op->digit_count);
+    }
+    // the sign of the bigger magnitude wins
+    result.is_negative = bigger_op == op1 ? op1->is_negative : op2_is_negative;
+    bigint_normalize(&result);
+    bigint_move(dest, &result, op1, op2);
+}
+
+void bigint_mul(BigInt *dest, const BigInt *op1, const BigInt *op2) {
+    BigInt result;
+    if (op1->digit_count == 0 || op2->digit_count == 0) {
+        bigint_init_unsigned(&result, 0);
+        return bigint_move(dest, &result, op1, op2);
+    }
+
+    uint64_t *result_digits = bigint_reserve(&result, op1->digit_count + op2->digit_count);
+    digits_mul(result_digits, bigint_ptr(op1), op1->digit_count, bigint_ptr(op2), op2->digit_count);
+    result.is_negative = (op1->is_negative != op2->is_negative);
+    bigint_normalize(&result);
+    bigint_move(dest, &result, op1, op2);
 }
 
 void bigint_shl(BigInt *dest, const BigInt *op1, const BigInt *op2) {
@@ -384,44 +600,249 @@ void bigint_shl(BigInt *dest, const BigInt *op1, const BigInt *op2) {
 
     const uint64_t *op1_digits = bigint_ptr(op1);
     uint64_t shift_amt = bigint_as_unsigned(op2);
-
-    if (op1->digit_count == 1 && shift_amt < 64) {
-        dest->data.digit = op1_digits[0] << shift_amt;
-        if (dest->data.digit > op1_digits[0]) {
-            dest->digit_count = 1;
-            dest->is_negative = op1->is_negative;
-            return;
-        }
-    }
-
     uint64_t digit_shift_count = shift_amt / 64;
     uint64_t leftover_shift_count = shift_amt % 64;
 
-    dest->data.digits = (uint64_t*)malloc(sizeof(uint64_t) + op1->digit_count + digit_shift_count + 1);
-    dest->digit_count = digit_shift_count;
+    BigInt result;
+    uint64_t *result_digits = bigint_reserve(&result, op1->digit_count + digit_shift_count + 1);
+    memset(result_digits, 0, sizeof(uint64_t) * digit_shift_count);
     uint64_t carry = 0;
     for (size_t i = 0; i < op1->digit_count; i += 1) {
         uint64_t digit = op1_digits[i];
-        dest->data.digits[dest->digit_count] = carry | (digit << leftover_shift_count);
-        dest->digit_count += 1;
+        result_digits[digit_shift_count + i] = carry | (digit << leftover_shift_count);
         if (leftover_shift_count > 0) {
             carry = digit >> (64 - leftover_shift_count);
         } else {
             carry = 0;
         }
     }
-    dest->data.digits[dest->digit_count] = carry;
-    dest->digit_count += 1;
-    dest->is_negative = op1->is_negative;
+    result_digits[digit_shift_count + op1->digit_count] = carry;
+    result.is_negative = op1->is_negative;
+    bigint_normalize(&result);
+    bigint_move(dest, &result, op1, op2);
+}
+
+void bigint_divmod(BigInt *quotient, BigInt *remainder, const BigInt *op1, const BigInt *op2) {
+    assert(op2->digit_count != 0 && quotient != remainder);
+
+    BigInt quotient_result;
+    BigInt remainder_result;
+    const uint64_t *op1_digits = bigint_ptr(op1);
+    const uint64_t *op2_digits = bigint_ptr(op2);
+    if (digits_cmp(op1_digits, op1->digit_count, op2_digits, op2->digit_count) == CmpLT) {
+        bigint_init_unsigned(&quotient_result, 0);
+        bigint_init_bigint(&remainder_result, op1);
+    } else {
+        uint64_t *quotient_digits = bigint_reserve(&quotient_result, op1->digit_count - op2->digit_count + 1);
+        uint64_t *remainder_digits = bigint_reserve(&remainder_result, op2->digit_count);
+        digits_divmod(quotient_digits, remainder_digits, op1_digits, op1->digit_count, op2_digits, op2->digit_count);
+        quotient_result.is_negative = op1->is_negative != op2->is_negative;
+        remainder_result.is_negative = op1->is_negative;
+        bigint_normalize(&quotient_result);
+        bigint_normalize(&remainder_result);
+    }
+
+    if (quotient) {
+        bigint_move(quotient, &quotient_result, op1, op2);
+    } else {
+        bigint_deinit(&quotient_result);
+    }
+    if (remainder) {
+        bigint_move(remainder, &remainder_result, op1, op2);
+    } else {
+        bigint_deinit(&remainder_result);
+    }
+}
+
+void bigint_shr(BigInt *dest, const BigInt *op1, const BigInt *op2) {
+    assert(!op2->is_negative);
+
+    if (op2->digit_count == 0) {
+        bigint_init_bigint(dest, op1);
+        return;
+    }
+
+    BigInt result;
+    BigInt minus_one;
+    bigint_init_signed(&minus_one, -1);
+
+    // every digit is shifted out
+    if (op2->digit_count > 1 || bigint_as_unsigned(op2) >= op1->digit_count * 64) {
+        bigint_init_signed(&result, op1->is_negative ? -1 : 0);
+        return bigint_move(dest, &result, op1, op2);
+    }
+
+    const uint64_t *op1_digits = bigint_ptr(op1);
+    uint64_t shift_amt = bigint_as_unsigned(op2);
+    uint64_t digit_shift_count = shift_amt / 64;
+    uint64_t leftover_shift_count = shift_amt % 64;
+
+    bool is_exact = leftover_shift_count == 0 || (op1_digits[digit_shift_count] << (64 - leftover_shift_count)) == 0;
+    for (size_t i = 0; i < digit_shift_count; i += 1) {
+        is_exact = is_exact && op1_digits[i] == 0;
+    }
+
+    const size_t result_count = op1->digit_count - digit_shift_count;
+    uint64_t *result_digits = bigint_reserve(&result, result_count);
+    for (size_t i = 0; i < result_count; i += 1) {
+        uint64_t digit = op1_digits[digit_shift_count + i] >> leftover_shift_count;
+        if (leftover_shift_count > 0 && i + 1 < result_count) {
+            digit |= op1_digits[digit_shift_count + i + 1] << (64 - leftover_shift_count);
+        }
+        result_digits[i] = digit;
+    }
+    result.is_negative = op1->is_negative;
+    bigint_normalize(&result);
+
+    // rounds towards negative infinity, as an arithmetic shift of the two's complement
+    if (op1->is_negative && !is_exact) {
+        bigint_add(&result, &result, &minus_one);
+    }
+    bigint_move(dest, &result, op1, op2);
+}
+
+// digits has more digits than op, the bits above op are its sign
+void bigint_to_twos_complement(const BigInt *op, uint64_t *digits, size_t count) {
+    assert(count > op->digit_count);
+    memcpy(digits, bigint_ptr(op), sizeof(uint64_t) * op->digit_count);
+    memset(digits + op->digit_count, 0, sizeof(uint64_t) * (count - op->digit_count));
+    if (op->is_negative) {
+        digits_negate(digits, count);
+    }
+}
+
+// dest holds reserved two's complement digits, the top bit is the sign
+void bigint_from_twos_complement(BigInt *dest) {
+    uint64_t *digits = bigint_mut_ptr(dest);
+    dest->is_negative = (digits[dest->digit_count - 1] >> 63) != 0;
+    if (dest->is_negative) {
+        digits_negate(digits, dest->digit_count);
+    }
     bigint_normalize(dest);
 }
 
+void bigint_bitwise(BigInt *dest, const BigInt *op1, const BigInt *op2, BitwiseOp op) {
+    const size_t count = std::max(op1->digit_count, op2->digit_count) + 1;
+    BigInt result;
+    BigInt op2_bits;
+    uint64_t *result_digits = bigint_reserve(&result, count);
+    uint64_t *op2_digits = bigint_reserve(&op2_bits, count);
+    bigint_to_twos_complement(op1, result_digits, count);
+    bigint_to_twos_complement(op2, op2_digits, count);
+
+    for (size_t i = 0; i < count; i += 1) {
+        switch (op) {
+        case BitwiseAnd:
+            result_digits[i] &= op2_digits[i];
+            break;
+        case BitwiseOr:
+            result_digits[i] |= op2_digits[i];
+            break;
+        case BitwiseXor:
+            result_digits[i] ^= op2_digits[i];
+            break;
+        }
+    }
+    bigint_deinit(&op2_bits);
+    bigint_from_twos_complement(&result);
+    bigint_move(dest, &result, op1, op2);
+}
+
+void bigint_and(BigInt *dest, const BigInt *op1, const BigInt *op2) {
+    bigint_bitwise(dest, op1, op2, BitwiseAnd);
+}
+
+void bigint_or(BigInt *dest, const BigInt *op1, const BigInt *op2) {
+    bigint_bitwise(dest, op1, op2, BitwiseOr);
+}
+
+void bigint_xor(BigInt *dest, const BigInt *op1, const BigInt *op2) {
+    bigint_bitwise(dest, op1, op2, BitwiseXor);
+}
+
+// ~x = -x - 1
+void bigint_not(BigInt *dest, const BigInt *op) {
+    BigInt minus_one;
+    bigint_init_signed(&minus_one, -1);
+    BigInt result;
+    bigint_negate(&result, op);
+    bigint_add(&result, &result, &minus_one);
+    bigint_move(dest, &result, op, nullptr);
+}
+
+void bigint_truncate(BigInt *dest, const BigInt *op, size_t bit_count, bool is_signed) {
+    BigInt result;
+    if (bit_count == 0) {
+        bigint_init_unsigned(&result, 0);
+        return bigint_move(dest, &result, op, nullptr);
+    }
+
+    // the low digits of the two's complement are the value modulo 2^bit_count
+    const size_t count = (bit_count + 63) / 64;
+    const size_t copied_count = std::min(count, op->digit_count);
+    const uint64_t top_mask = bit_count % 64 == 0 ? UINT64_MAX : (uint64_t(1) << (bit_count % 64)) - 1;
+    uint64_t *result_digits = bigint_reserve(&result, count);
+    memcpy(result_digits, bigint_ptr(op), sizeof(uint64_t) * copied_count);
+    memset(result_digits + copied_count, 0, sizeof(uint64_t) * (count - copied_count));
+    if (op->is_negative) {
+        digits_negate(result_digits, count);
+    }
+    result_digits[count - 1] &= top_mask;
+
+    // the sign bit is set, the value is 2^bit_count below
+    const uint64_t sign_bit = uint64_t(1) << ((bit_count - 1) % 64);
+    result.is_negative = is_signed && (result_digits[count - 1] & sign_bit) != 0;
+    if (result.is_negative) {
+        digits_negate(result_digits, count);
+        result_digits[count - 1] &= top_mask;
+    }
+    bigint_normalize(&result);
+    bigint_move(dest, &result, op, nullptr);
+}
+
 void bigint_negate(BigInt *dest, const BigInt *op) {
     bigint_init_bigint(dest, op);
     dest->is_negative = !dest->is_negative;
     bigint_normalize(dest);
 }
 
+std::string bigint_to_string(const BigInt *op, uint32_t radix) {
+    assert(radix >= 2 && radix <= 36);
+    if (op->digit_count == 0) {
+        return "0";
+    }
+
+    // every division by the largest power of radix in a digit gives chunk_length characters
+    uint64_t chunk_divisor = radix;
+    size_t chunk_length = 1;
+    while (chunk_divisor <= UINT64_MAX / radix) {
+        chunk_divisor *= radix;
+        chunk_length += 1;
+    }
+
+    BigInt magnitude;
+    bigint_init_bigint(&magnitude, op);
+    uint64_t *digits = bigint_mut_ptr(&magnitude);
+    size_t count = magnitude.digit_count;
+
+    std::string text;
+    while (count > 0) {
+        uint64_t chunk = digits_div_scalar(digits, digits, count, chunk_divisor);
+        count = digits_significant(digits, count);
+        // the last chunk has no leading zeros
+        for (size_t i = 0; i < chunk_length && (count > 0 || chunk != 0); i += 1) {
+            text.push_back("0123456789abcdefghijklmnopqrstuvwxyz"[chunk % radix]);
+            chunk /= radix;
+        }
+    }
+    if (op->is_negative) {
+        text.push_back('-');
+    }
+    std::reverse(text.begin(), text.end());
+    bigint_deinit(&magnitude);
+    return text;
+}
+
 Cmp bigint_cmp(const BigInt *op1, const BigInt *op2) {
     if (op1->is_negative && !op2->is_negative) {
         return CmpLT;
@@ -9,13 +9,18 @@
 #include "common_defs.hpp"
 #include <stdint.h>
 #include <stddef.h>
+#include <string>
+
+// digits stored in the BigInt itself. every 128 bit value and the product of
+// two of them fit, larger values go to the heap
+#define BIGINT_INLINE_DIGITS 4
 
 struct BigInt {
     size_t digit_count;
     union {
-        uint64_t digit;
-        uint64_t *digits; // Least significant digit first
-    } data;
+        uint64_t inline_digits[BIGINT_INLINE_DIGITS];
+        uint64_t *digits; // only if digit_count > BIGINT_INLINE_DIGITS
+    } data; // Least significant digit first
     bool is_negative;
 };
 
@@ -24,24 +29,53 @@ struct BigFloat;
 
 void bigint_init_unsigned(BigInt *dest, uint64_t x);
 void bigint_init_signed(BigInt *dest, int64_t x);
+// digits are least significant first
+void bigint_init_data(BigInt *dest, const uint64_t *digits, size_t digit_count, bool is_negative);
 void bigint_init_bigint(BigInt *dest, const BigInt *src);
 void bigint_deinit(BigInt *bi);
 
+static inline bool bigint_is_inline(const BigInt *bigint) {
+    return bigint->digit_count <= BIGINT_INLINE_DIGITS;
+}
+
 static inline const uint64_t *bigint_ptr(const BigInt *bigint) {
-    if (bigint->digit_count == 1) {
-        return &bigint->data.digit;
+    if (bigint_is_inline(bigint)) {
+        return bigint->data.inline_digits;
     } else {
         return bigint->data.digits;
     }
 }
 
+// the storage of dest is not freed, unless dest is one of the operands
 void bigint_add(BigInt *dest, const BigInt *op1, const BigInt *op2);
+void bigint_sub(BigInt *dest, const BigInt *op1, const BigInt *op2);
 void bigint_mul(BigInt *dest, const BigInt *op1, const BigInt *op2);
+// truncates towards zero, the remainder has the sign of op1. op2 can't be zero, either result can be null
+void bigint_divmod(BigInt *quotient, BigInt *remainder, const BigInt *op1, const BigInt *op2);
 
 void bigint_shl(BigInt *dest, const BigInt *op1, const BigInt *op2);
+// rounds towards negative infinity
+void bigint_shr(BigInt *dest, const BigInt *op1, const BigInt *op2);
+
+// on the two's complement, negative values have infinite leading ones
+void bigint_and(BigInt *dest, const BigInt *op1, const BigInt *op2);
+void bigint_or(BigInt *dest, const BigInt *op1, const BigInt *op2);
+void bigint_xor(BigInt *dest, const BigInt *op1, const BigInt *op2);
+void bigint_not(BigInt *dest, const BigInt *op);
+
+// wraps op to the range of a bit_count bits integer
+void bigint_truncate(BigInt *dest, const BigInt *op, size_t bit_count, bool is_signed);
 
 void bigint_negate(BigInt *dest, const BigInt *op);
 
+// digits = digits * factor + addend in place, on digit_count digits. returns the digit carried out
+uint64_t bigint_digits_mul_add(uint64_t *digits, size_t digit_count, uint64_t factor, uint64_t addend);
+// bits up to the highest one set, leading zero digits are allowed
+size_t bigint_digits_bit_count(const uint64_t *digits, size_t digit_count);
+
+// radix from 2 to 36, lowercase letters
+std::string bigint_to_string(const BigInt *op, uint32_t radix);
+
 enum Cmp {
     CmpLT,
     CmpGT,
@@ -0,0 +1,478 @@
+#include "builder.hpp"
+#include "ast_nodes.hpp"
+#include "cache.hpp"
+#include "compiler.hpp"
+#include "console.hpp"
+#include "dependency_graph.hpp"
+#include "emitter.hpp"
+#include "lexer.hpp"
+#include "module_interface.hpp"
+#include "parser.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/TimeProfiler.h>
+
+#define SOURCE_FILE_EXTENSION ".llang"
+
+static bool read_source_file(const std::string& in_file_path, std::string& out_source) noexcept;
+
+ModuleBuilder::ModuleBuilder(const BuildOptions& in_options)
+    : options(in_options), has_output_errors(false), scheduler(in_options.thread_count) {
+    if (!options.cache_directory.empty()) {
+        cache = std::make_unique<CompilationCache>(options.cache_directory);
+    }
+}
+
+ModuleBuilder::~ModuleBuilder() {
+    // the tree points to the lexer tokens
+    for (auto& source_module : modules) {
+        delete source_module.source_code_node;
+    }
+}
+
+int ModuleBuilder::build(const std::vector<RootSource>& in_roots) {
+    // a root given twice is built once
+    for (auto& root : in_roots) {
+        const std::string root_name = std::filesystem::path(root.file_path).stem().string();
+        add_module(root_name, root.file_path, root.source ? &*root.source : nullptr);
+    }
+
+    // the back end of each module starts once the modules it reaches are discovered
+    scheduler.wait();
+
+    if (!print_diagnostics() || has_output_errors) {
+        return -1;
+    }
+
+    // run in-process instead of writing the output
+    if (!options.run_entry_point.empty()) {
+        std::vector<jit::JitModule> jit_modules;
+        for (auto& source_module : modules) {
+            jit_modules.push_back(std::move(source_module.jit_module));
+        }
+        return jit::run(std::move(jit_modules), options.run_entry_point);
+    }
+
+    // generate exe|lib|dll output
+    return 0;
+}
+
+SourceModule* ModuleBuilder::add_module(std::string_view in_name, const std::string& in_file_path, const std::string* in_source) noexcept {
+    const std::string file_path = std::filesystem::absolute(in_file_path).lexically_normal().string();
+
+    SourceModule* source_module;
+    {
+        std::lock_guard<std::mutex> lock(modules_mutex);
+        auto module_it = modules_by_path.find(file_path);
+        if (module_it != modules_by_path.end()) {
+            return module_it->second;
+        }
+
+        source_module = &modules.emplace_back();
+        if (!root_module) {
+            root_module = source_module;
+        }
+        source_module->name = in_name;
+        source_module->file_path = file_path;
+        if (in_source) {
+            source_module->source = *in_source;
+            source_module->is_source_read = true;
+        }
+        modules_by_path.emplace(file_path, source_module);
+    }
+
+    scheduler.submit([this, source_module] { discover(*source_module); });
+    return source_module;
+}
+
+/*
+* Reads the module and finds the modules it loads.
+* The loads of a source never change, so they are cached by its hash
+* and known sources are not parsed here.
+*/
+void ModuleBuilder::discover(SourceModule& io_module) noexcept {
+    if (!io_module.is_source_read) {
+        llvm::TimeTraceScope trace_scope("ReadFile", io_module.file_path);
+        PhaseTimer timer(Phase::ReadFile);
+        io_module.is_source_read = read_source_file(io_module.file_path, io_module.source);
+    }
+    if (!io_module.is_source_read) {
+        Error error(ERROR_TYPE::ERROR, 0, 0, io_module.file_path, "could not read module \"" + io_module.name + "\"");
+        io_module.errors.push_back(error);
+        to_string(error, io_module.diagnostics);
+        io_module.has_errors = true;
+        finish_discovery(io_module);
+        return;
+    }
+    io_module.source_key = cache::get_source_key(io_module.source);
+
+    auto cached_loads = cache ? cache->load(io_module.source_key, ".loads") : nullptr;
+    if (cached_loads) {
+        llvm::SmallVector<llvm::StringRef, 8> load_names;
+        cached_loads->getBuffer().split(load_names, '\n', -1, false);
+        for (auto load_name : load_names) {
+            io_module.load_names.push_back(load_name.str());
+        }
+    }
+    else {
+        parse(io_module);
+        io_module.front_end = FrontEnd::Done;
+
+        std::string loads;
+        for (auto child : io_module.source_code_node->source_code.children) {
+            if (child->node_type == AstNodeType::AstDirective && child->directive.directive_type == DirectiveType::Load) {
+                io_module.load_names.emplace_back(child->directive.argument);
+                loads += std::string(child->directive.argument) + "\n";
+            }
+        }
+        if (cache) {
+            cache->store(io_module.source_key, ".loads", loads);
+        }
+    }
+
+    // loaded modules are next to the module loading them
+    const std::filesystem::path directory = std::filesystem::path(io_module.file_path).parent_path();
+    for (auto& load_name : io_module.load_names) {
+        SourceModule* dependency = add_module(load_name, (directory / (load_name + SOURCE_FILE_EXTENSION)).string());
+        const bool is_new = std::find(io_module.dependencies.begin(), io_module.dependencies.end(), dependency) == io_module.dependencies.end();
+        if (dependency != &io_module && is_new) {
+            io_module.dependencies.push_back(dependency);
+        }
+    }
+
+    finish_discovery(io_module);
+}
+
+void ModuleBuilder::finish_discovery(SourceModule& io_module) noexcept {
+    std::vector<SourceModule*> complete_modules;
+    {
+        std::lock_guard<std::mutex> lock(modules_mutex);
+        io_module.is_discovered = true;
+        for (auto& source_module : modules) {
+            if (!source_module.is_back_end_started && is_graph_discovered(source_module)) {
+                source_module.is_back_end_started = true;
+                complete_modules.push_back(&source_module);
+            }
+        }
+    }
+
+    for (auto complete_module : complete_modules) {
+        scheduler.submit([this, complete_module] { start_back_end(*complete_module); });
+    }
+}
+
+// called with modules_mutex locked, the dependencies of a module are only read once it is discovered
+bool ModuleBuilder::is_graph_discovered(const SourceModule& in_module) const noexcept {
+    std::unordered_set<const SourceModule*> visited = { &in_module };
+    std::vector<const SourceModule*> pending = { &in_module };
+    while (!pending.empty()) {
+        const SourceModule* current = pending.back();
+        pending.pop_back();
+        if (!current->is_discovered) {
+            return false;
+        }
+
+        for (auto dependency : current->dependencies) {
+            if (visited.insert(dependency).second) {
+                pending.push_back(dependency);
+            }
+        }
+    }
+    return true;
+}
+
+void ModuleBuilder::parse(SourceModule& io_module) noexcept {
+    const std::string file_name = std::filesystem::path(io_module.file_path).filename().string();
+    const size_t first_syntax_error = io_module.errors.size();
+    {
+        llvm::TimeTraceScope trace_scope("Lex", file_name);
+        PhaseTimer timer(Phase::Tokenize);
+        io_module.lexer = std::make_unique<Lexer>(io_module.source, file_name, io_module.errors);
+        io_module.lexer->tokenize();
+    }
+    // the tokens are still parsed, literals that don't fit their suffix keep their value.
+    // the statements that don't parse are skipped, the rest is still analyzed
+    {
+        llvm::TimeTraceScope trace_scope("Parse", file_name);
+        PhaseTimer timer(Phase::Parse);
+        Parser parser(*io_module.lexer, io_module.errors);
+        io_module.source_code_node = parser.parse();
+    }
+    const bool has_syntax_errors = io_module.errors.size() != first_syntax_error;
+    for (size_t i = first_syntax_error; i < io_module.errors.size(); i++) {
+        std::string error_msg;
+        to_string(io_module.errors[i], error_msg);
+        io_module.diagnostics += io_module.diagnostics.empty() ? error_msg : "\n" + error_msg;
+    }
+    {
+        llvm::TimeTraceScope trace_scope("Analyze", file_name);
+        PhaseTimer timer(Phase::Analyze);
+        io_module.has_errors = !compiler::analyze(io_module.source_code_node, io_module.errors, io_module.diagnostics) || has_syntax_errors;
+    }
+
+    if (stats::is_enabled()) {
+        stats::add_tokens(io_module.lexer->get_token_count());
+        stats::add_nodes(count_nodes(io_module.source_code_node));
+    }
+
+    // a cached interface might be in use by the modules loading this one already
+    if (io_module.has_errors || io_module.module_interface) {
+        return;
+    }
+    std::string interface_bytes = ModuleInterface::write(io_module.source_code_node);
+    if (cache) {
+        cache->store(io_module.source_key, ".llif", interface_bytes);
+    }
+    io_module.module_interface = ModuleInterface::open(llvm::MemoryBuffer::getMemBufferCopy(interface_bytes, io_module.name));
+}
+
+void ModuleBuilder::compute_module_key(SourceModule& io_module) noexcept {
+    // the output depends on the declarations of every module reachable from this one
+    std::unordered_set<const SourceModule*> visited = { &io_module };
+    std::vector<const SourceModule*> pending = { &io_module };
+    std::vector<std::string> reachable_keys;
+
+    while (!pending.empty()) {
+        const SourceModule* current = pending.back();
+        pending.pop_back();
+
+        for (auto dependency : current->dependencies) {
+            if (visited.insert(dependency).second) {
+                reachable_keys.push_back(dependency->source_key);
+                pending.push_back(dependency);
+            }
+        }
+    }
+
+    // discovery order depends on timing
+    std::sort(reachable_keys.begin(), reachable_keys.end());
+    reachable_keys.insert(reachable_keys.begin(), io_module.source_key);
+    io_module.module_key = cache::get_module_key(get_output_name(io_module), reachable_keys);
+}
+
+// returns false if the module has to be parsed to get its interface
+bool ModuleBuilder::load_interface(SourceModule& io_module) noexcept {
+    if (io_module.module_interface) {
+        return true;
+    }
+    if (!cache) {
+        return false;
+    }
+
+    // only depends on the source
+    auto interface_buffer = cache->load(io_module.source_key, ".llif");
+    if (interface_buffer) {
+        io_module.module_interface = ModuleInterface::open(std::move(interface_buffer));
+    }
+    return io_module.module_interface != nullptr;
+}
+
+/*
+* A cached module is output right away, the others are generated once
+* their front end is done and the interfaces of their dependencies are
+* ready, which only takes a front end if the cache doesn't have them.
+* A dependency that is being parsed anyway is waited for, so nothing
+* reads the module while its front end writes it.
+*/
+void ModuleBuilder::start_back_end(SourceModule& io_module) noexcept {
+    // reported by discover
+    if (!io_module.is_source_read) {
+        return;
+    }
+    for (auto dependency : io_module.dependencies) {
+        if (!dependency->is_source_read) {
+            return;
+        }
+    }
+
+    compute_module_key(io_module);
+    if (cache) {
+        io_module.cached_bitcode = cache->load(io_module.module_key, ".bc");
+        io_module.is_cached = io_module.cached_bitcode != nullptr;
+    }
+    if (io_module.is_cached) {
+        load_cached(io_module);
+        return;
+    }
+
+    // one more until every front end is registered, they might finish meanwhile
+    io_module.pending_front_ends = 1;
+    std::vector<SourceModule*> front_ends;
+    {
+        std::lock_guard<std::mutex> lock(back_end_mutex);
+        auto wait_for_front_end = [&](SourceModule& needed_module) {
+            if (needed_module.front_end == FrontEnd::Done) {
+                return;
+            }
+            if (needed_module.front_end == FrontEnd::NotStarted) {
+                needed_module.front_end = FrontEnd::Running;
+                front_ends.push_back(&needed_module);
+            }
+            needed_module.waiting_modules.push_back(&io_module);
+            io_module.pending_front_ends++;
+        };
+
+        wait_for_front_end(io_module);
+        for (auto dependency : io_module.dependencies) {
+            if (dependency->front_end == FrontEnd::NotStarted && load_interface(*dependency)) {
+                continue;
+            }
+            wait_for_front_end(*dependency);
+        }
+    }
+
+    for (auto front_end : front_ends) {
+        scheduler.submit([this, front_end] { finish_front_end(*front_end); });
+    }
+    if (--io_module.pending_front_ends == 0) {
+        generate(io_module);
+    }
+}
+
+void ModuleBuilder::finish_front_end(SourceModule& io_module) noexcept {
+    parse(io_module);
+
+    std::vector<SourceModule*> waiting_modules;
+    {
+        std::lock_guard<std::mutex> lock(back_end_mutex);
+        io_module.front_end = FrontEnd::Done;
+        waiting_modules.swap(io_module.waiting_modules);
+    }
+
+    for (auto waiting_module : waiting_modules) {
+        if (--waiting_module->pending_front_ends == 0) {
+            scheduler.submit([this, waiting_module] { generate(*waiting_module); });
+        }
+    }
+}
+
+void ModuleBuilder::generate(SourceModule& io_module) noexcept {
+    std::vector<const ModuleInterface*> dependency_interfaces;
+    // has_errors of a dependency is written by its own back end, only a front end without errors has an interface
+    for (auto dependency : io_module.dependencies) {
+        if (!dependency->module_interface) {
+            has_output_errors = true;
+            return;
+        }
+        dependency_interfaces.push_back(dependency->module_interface.get());
+    }
+    if (io_module.has_errors) {
+        return;
+    }
+
+    // the declarations unchanged since the previous build of the module are reused.
+    // the graph is named after the output, the keys it has make sure nothing stale is reused
+    const std::string output_name = get_output_name(io_module);
+    const std::string graph_key = cache::get_key({ "dependency graph", output_name });
+    std::unique_ptr<DependencyGraph> dependency_graph;
+    if (cache) {
+        dependency_graph = std::make_unique<DependencyGraph>(cache.get());
+        auto previous_graph = cache->load(graph_key, ".deps");
+        if (previous_graph) {
+            (void)dependency_graph->read_previous(std::string_view(previous_graph->getBufferStart(), previous_graph->getBufferSize()));
+        }
+    }
+
+    // names of the loaded modules are only known from here
+    if (!compiler::check(io_module.source_code_node, dependency_interfaces, &scheduler, dependency_graph.get(),
+        io_module.errors, io_module.diagnostics)) {
+        io_module.has_errors = true;
+        return;
+    }
+
+    auto& jit_module = io_module.jit_module;
+    jit_module.code_module = compiler::generate(options, output_name, io_module.source_code_node, dependency_interfaces, dependency_graph.get(), jit_module.context);
+
+    if (cache) {
+        std::string bitcode;
+        llvm::raw_string_ostream bitcode_stream(bitcode);
+        llvm::WriteBitcodeToFile(*jit_module.code_module, bitcode_stream);
+        bitcode_stream.flush();
+
+        cache->store(io_module.module_key, ".diag", io_module.diagnostics);
+        cache->store(io_module.module_key, ".bc", bitcode);
+        cache->store(graph_key, ".deps", dependency_graph->write());
+    }
+
+    output(io_module);
+}
+
+void ModuleBuilder::load_cached(SourceModule& io_module) noexcept {
+    llvm::TimeTraceScope trace_scope("LoadCachedModule", io_module.name);
+    auto& jit_module = io_module.jit_module;
+    jit_module.context = std::make_unique<llvm::LLVMContext>();
+
+    auto code_module = llvm::parseBitcodeFile(io_module.cached_bitcode->getMemBufferRef(), *jit_module.context);
+    if (!code_module) {
+        console::WriteLine("corrupted cache entry for module \"" + io_module.name + "\": " + llvm::toString(code_module.takeError()) + ", build with --no-cache");
+        has_output_errors = true;
+        return;
+    }
+    jit_module.code_module = std::move(*code_module);
+    // named after the buffer otherwise
+    jit_module.code_module->setModuleIdentifier(get_output_name(io_module));
+
+    // the warnings of the build that stored the entry
+    auto diagnostics = cache->load(io_module.module_key, ".diag");
+    if (diagnostics) {
+        io_module.cached_diagnostics = diagnostics->getBuffer().str();
+    }
+
+    output(io_module);
+}
+
+void ModuleBuilder::output(SourceModule& io_module) noexcept {
+    // kept to run every module together
+    if (!options.run_entry_point.empty()) {
+        return;
+    }
+
+    auto& jit_module = io_module.jit_module;
+    if (!emitter::write_module(*jit_module.code_module, get_output_name(io_module), options)) {
+        has_output_errors = true;
+    }
+
+    // the module must be destroyed before its context
+    jit_module.code_module.reset();
+    jit_module.context.reset();
+}
+
+const std::string& ModuleBuilder::get_output_name(const SourceModule& in_module) const noexcept {
+    // -o names the output of the root module, there is only one then
+    if (&in_module == root_module && !options.output_name.empty()) {
+        return options.output_name;
+    }
+    return in_module.name;
+}
+
+// returns false if any module has errors
+bool ModuleBuilder::print_diagnostics() const noexcept {
+    bool has_errors = false;
+    for (auto& source_module : modules) {
+        const std::string& diagnostics = source_module.is_cached ? source_module.cached_diagnostics : source_module.diagnostics;
+        if (!diagnostics.empty()) {
+            console::WriteLine(diagnostics);
+        }
+        has_errors |= source_module.has_errors;
+    }
+    return !has_errors;
+}
+
+bool read_source_file(const std::string& in_file_path, std::string& out_source) noexcept {
+    std::ifstream source_file(in_file_path, std::ios::binary);
+    if (!source_file.is_open() || source_file.bad()) {
+        return false;
+    }
+
+    source_file.seekg(0, std::ios::end);
+    out_source.resize(size_t(source_file.tellg()));
+    source_file.seekg(0, std::ios::beg);
+    source_file.read(out_source.data(), out_source.size());
+    return !source_file.bad();
+}
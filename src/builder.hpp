@@ -0,0 +1,112 @@
+#pragma once
+#include "error.hpp"
+#include "jit.hpp"
+#include "scheduler.hpp"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace llvm {
+    class MemoryBuffer;
+}
+class CompilationCache;
+class Lexer;
+class ModuleInterface;
+struct AstNode;
+struct BuildOptions;
+struct RootSource;
+
+enum class FrontEnd {
+    NotStarted,
+    Running,
+    Done,
+};
+
+// a source file and the modules it loads with #load
+struct SourceModule {
+    std::string                 name;
+    std::string                 file_path;
+    std::string                 source;
+    bool                        is_source_read = false; // given instead of read from file_path
+    std::string                 source_key;     // hash of source
+    std::string                 module_key;     // hash of source and the sources of every reachable module
+    std::vector<std::string>    load_names;
+    std::vector<SourceModule*>  dependencies;
+    bool                        is_discovered = false;          // the fields above are final
+    bool                        is_back_end_started = false;    // every reachable module is discovered
+
+    // front end
+    std::unique_ptr<Lexer>      lexer;          // owns the source the tree points to
+    AstNode*                    source_code_node = nullptr;
+    std::vector<Error>          errors;
+    std::string                 diagnostics;    // printed once the build ends
+    bool                        has_errors = false;
+    FrontEnd                    front_end = FrontEnd::NotStarted;   // parsed while discovering if the cache doesn't know the loads
+    // declarations other modules see, from the front end or the cache
+    std::unique_ptr<ModuleInterface> module_interface;
+
+    // back end
+    std::vector<SourceModule*>  waiting_modules;        // need this front end before generating
+    std::atomic<size_t>         pending_front_ends = 0; // front ends this module still waits for
+    std::unique_ptr<llvm::MemoryBuffer> cached_bitcode;
+    std::string                 cached_diagnostics;
+    bool                        is_cached = false;
+    jit::JitModule              jit_module;             // kept for --run
+};
+
+/*
+* Builds the root modules and every module they load.
+* Modules are lexed and parsed as they are discovered. Once every module
+* reachable from a module is discovered its key is known, and it is
+* generated as soon as its own front end and the interfaces of the
+* modules it loads are ready, since only their declarations are needed.
+* Interfaces of known sources come from the cache without parsing them.
+* Each module has its own output.
+* Work is spread over a work stealing scheduler.
+*/
+class ModuleBuilder {
+    const BuildOptions&                 options;
+    std::unique_ptr<CompilationCache>   cache;
+
+    std::mutex                                      modules_mutex;
+    std::deque<SourceModule>                        modules;    // in discovery order, the root first
+    std::unordered_map<std::string, SourceModule*>  modules_by_path;
+    const SourceModule*                             root_module = nullptr;  // the first root, named by -o
+    std::mutex                                      back_end_mutex;         // front_end and waiting_modules
+    std::atomic<bool>                               has_output_errors;
+
+    // last, so the workers stop before the modules are destroyed
+    Scheduler                                       scheduler;
+
+public:
+    explicit ModuleBuilder(const BuildOptions& in_options);
+    ~ModuleBuilder();
+
+    // returns the process exit code
+    int build(const std::vector<RootSource>& in_roots);
+
+private:
+    // returns the module of in_file_path, it's discovered if new.
+    // in_source is the source of a file that is not read, if any
+    SourceModule* add_module(std::string_view in_name, const std::string& in_file_path, const std::string* in_source = nullptr) noexcept;
+
+    void discover(SourceModule& io_module) noexcept;
+    void finish_discovery(SourceModule& io_module) noexcept;
+    bool is_graph_discovered(const SourceModule& in_module) const noexcept;
+    void parse(SourceModule& io_module) noexcept;
+    void compute_module_key(SourceModule& io_module) noexcept;
+    bool load_interface(SourceModule& io_module) noexcept;
+    void start_back_end(SourceModule& io_module) noexcept;
+    void finish_front_end(SourceModule& io_module) noexcept;
+    void generate(SourceModule& io_module) noexcept;
+    void load_cached(SourceModule& io_module) noexcept;
+    void output(SourceModule& io_module) noexcept;
+
+    const std::string& get_output_name(const SourceModule& in_module) const noexcept;
+    bool print_diagnostics() const noexcept;
+};
@@ -0,0 +1,318 @@
+#include "cache.hpp"
+#include "ast_nodes.hpp"
+#include "lexer.hpp"
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+#ifndef LLAMALANG_VERSION
+#define LLAMALANG_VERSION "dev"
+#endif
+
+namespace {
+    class KeyHasher {
+        llvm::SHA1 sha1;
+
+    public:
+        KeyHasher() {
+            // artifacts of other compilers are never reused
+            add(LLAMALANG_VERSION);
+            add(LLVM_VERSION_STRING);
+        }
+
+        void add(std::string_view in_value) noexcept {
+            // the length keeps "ab" + "c" and "a" + "bc" apart
+            add(uint64_t(in_value.size()));
+            sha1.update(llvm::StringRef(in_value.data(), in_value.size()));
+        }
+
+        void add(uint64_t in_value) noexcept {
+            uint8_t bytes[sizeof(uint64_t)];
+            for (size_t i = 0; i < sizeof(uint64_t); i++) {
+                bytes[i] = uint8_t(in_value >> (i * 8));
+            }
+            sha1.update(llvm::ArrayRef<uint8_t>(bytes, sizeof(bytes)));
+        }
+
+        std::string finish() noexcept {
+            return llvm::toHex(sha1.final(), true);
+        }
+    };
+}
+
+static void hash_node(KeyHasher& in_hasher, const AstNode* in_node, const AstSourceCode& in_source_code) noexcept;
+static llvm::MemoryBuffer* keep_in_memory(const std::string& in_entry_path, std::unique_ptr<llvm::MemoryBuffer> in_buffer) noexcept;
+static std::unique_ptr<llvm::MemoryBuffer> get_memory_view(const llvm::MemoryBuffer* in_buffer) noexcept;
+
+// entries kept in memory by long running processes, by path.
+// entries never change, so they are never invalidated, only trimmed.
+static std::unordered_map<std::string, std::unique_ptr<llvm::MemoryBuffer>> memory_entries;
+static std::deque<std::string> memory_entry_order;    // oldest first
+static size_t memory_size = 0;
+static size_t memory_limit = 0;
+static std::mutex memory_mutex;
+
+CompilationCache::CompilationCache(const std::string& in_directory)
+    : directory(in_directory) {}
+
+bool CompilationCache::contains(const std::string& in_key, const char* in_extension) const noexcept {
+    std::filesystem::path entry_path(directory);
+    entry_path /= in_key + in_extension;
+
+    if (memory_limit) {
+        std::lock_guard<std::mutex> lock(memory_mutex);
+        if (memory_entries.count(entry_path.string())) {
+            return true;
+        }
+    }
+    return llvm::sys::fs::exists(entry_path.string());
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompilationCache::load(const std::string& in_key, const char* in_extension) const noexcept {
+    std::filesystem::path entry_path(directory);
+    entry_path /= in_key + in_extension;
+
+    if (memory_limit) {
+        std::lock_guard<std::mutex> lock(memory_mutex);
+        auto entry_it = memory_entries.find(entry_path.string());
+        if (entry_it != memory_entries.end()) {
+            return get_memory_view(entry_it->second.get());
+        }
+    }
+
+    auto buffer = llvm::MemoryBuffer::getFile(entry_path.string(), false, false);
+    if (!buffer) {
+        return nullptr;
+    }
+    if (memory_limit) {
+        return get_memory_view(keep_in_memory(entry_path.string(), std::move(*buffer)));
+    }
+    return std::move(*buffer);
+}
+
+void CompilationCache::store(const std::string& in_key, const char* in_extension, llvm::StringRef in_data) const noexcept {
+    std::error_code error_code;
+    std::filesystem::create_directories(directory, error_code);
+    if (error_code) {
+        return;
+    }
+
+    std::filesystem::path entry_path(directory);
+    entry_path /= in_key + in_extension;
+    if (memory_limit) {
+        (void)keep_in_memory(entry_path.string(), llvm::MemoryBuffer::getMemBufferCopy(in_data, entry_path.string()));
+    }
+
+    std::filesystem::path temp_model(directory);
+    temp_model /= "entry-%%%%%%%%.tmp";
+
+    int temp_fd;
+    llvm::SmallString<128> temp_path;
+    if (llvm::sys::fs::createUniqueFile(temp_model.string(), temp_fd, temp_path)) {
+        return;
+    }
+
+    {
+        llvm::raw_fd_ostream temp_file(temp_fd, true);
+        temp_file << in_data;
+        temp_file.close();
+        if (temp_file.has_error()) {
+            temp_file.clear_error();
+            llvm::sys::fs::remove(temp_path);
+            return;
+        }
+    }
+
+    if (llvm::sys::fs::rename(temp_path, entry_path.string())) {
+        llvm::sys::fs::remove(temp_path);
+    }
+}
+
+void cache::set_memory_limit(size_t in_limit) noexcept {
+    memory_limit = in_limit;
+}
+
+void cache::trim_memory() noexcept {
+    std::lock_guard<std::mutex> lock(memory_mutex);
+    while (memory_size > memory_limit && !memory_entry_order.empty()) {
+        auto entry_it = memory_entries.find(memory_entry_order.front());
+        memory_size -= entry_it->second->getBufferSize();
+        memory_entries.erase(entry_it);
+        memory_entry_order.pop_front();
+    }
+}
+
+std::string cache::get_source_key(std::string_view in_source_code) noexcept {
+    KeyHasher hasher;
+    hasher.add(in_source_code);
+    return hasher.finish();
+}
+
+std::string cache::get_module_key(const std::string& in_output_name, const std::vector<std::string>& in_source_keys) noexcept {
+    KeyHasher hasher;
+    // the module is named after the output
+    hasher.add(in_output_name);
+    for (auto& source_key : in_source_keys) {
+        hasher.add(source_key);
+    }
+    return hasher.finish();
+}
+
+std::string cache::get_node_key(const AstNode* in_node, const AstSourceCode& in_source_code) noexcept {
+    KeyHasher hasher;
+    hash_node(hasher, in_node, in_source_code);
+    return hasher.finish();
+}
+
+std::string cache::get_signature_key(const AstNode* in_declaration_node, const AstSourceCode& in_source_code) noexcept {
+    KeyHasher hasher;
+    switch (in_declaration_node->node_type) {
+    case AstNodeType::AstFuncDef:
+        hash_node(hasher, in_declaration_node->function_def.proto, in_source_code);
+        break;
+    case AstNodeType::AstFuncProto:
+        hash_node(hasher, in_declaration_node, in_source_code);
+        break;
+    case AstNodeType::AstVarDef:
+        // the initializer is only seen by the module defining the global
+        hasher.add(in_declaration_node->var_def.name);
+        hash_node(hasher, in_declaration_node->var_def.type, in_source_code);
+        break;
+    default:
+        UNREACHEABLE;
+    }
+    return hasher.finish();
+}
+
+std::string cache::get_key(const std::vector<std::string_view>& in_parts) noexcept {
+    KeyHasher hasher;
+    for (auto part : in_parts) {
+        hasher.add(part);
+    }
+    return hasher.finish();
+}
+
+// returns the buffer kept, another thread might have kept the same entry first
+llvm::MemoryBuffer* keep_in_memory(const std::string& in_entry_path, std::unique_ptr<llvm::MemoryBuffer> in_buffer) noexcept {
+    std::lock_guard<std::mutex> lock(memory_mutex);
+    auto [entry_it, is_new] = memory_entries.emplace(in_entry_path, nullptr);
+    if (is_new) {
+        memory_size += in_buffer->getBufferSize();
+        memory_entry_order.push_back(in_entry_path);
+        entry_it->second = std::move(in_buffer);
+    }
+    return entry_it->second.get();
+}
+
+// the entry outlives the view, entries are only trimmed between builds
+std::unique_ptr<llvm::MemoryBuffer> get_memory_view(const llvm::MemoryBuffer* in_buffer) noexcept {
+    return llvm::MemoryBuffer::getMemBuffer(in_buffer->getMemBufferRef(), false);
+}
+
+/*
+* Hashes the structure of the tree, positions and comments are left out
+* so moving or commenting a declaration keeps its key.
+*/
+void hash_node(KeyHasher& in_hasher, const AstNode* in_node, const AstSourceCode& in_source_code) noexcept {
+    if (!in_node) {
+        in_hasher.add(uint64_t(-1));
+        return;
+    }
+
+    in_hasher.add(uint64_t(in_node->node_type));
+    switch (in_node->node_type) {
+    case AstNodeType::AstDirective:
+        in_hasher.add(uint64_t(in_node->directive.directive_type));
+        in_hasher.add(in_node->directive.argument);
+        hash_node(in_hasher, in_node->directive.expr, in_source_code);
+        break;
+    case AstNodeType::AstFuncDef:
+        hash_node(in_hasher, in_node->function_def.proto, in_source_code);
+        hash_node(in_hasher, in_node->function_def.block, in_source_code);
+        break;
+    case AstNodeType::AstFuncProto:
+        in_hasher.add(in_node->function_proto.name);
+        in_hasher.add(uint64_t(in_node->function_proto.params.size()));
+        for (auto param : in_node->function_proto.params) {
+            hash_node(in_hasher, param, in_source_code);
+        }
+        hash_node(in_hasher, in_node->function_proto.return_type, in_source_code);
+        break;
+    case AstNodeType::AstParamDecl:
+        in_hasher.add(in_node->param_decl.name);
+        hash_node(in_hasher, in_node->param_decl.type, in_source_code);
+        break;
+    case AstNodeType::AstBlock:
+        in_hasher.add(uint64_t(in_node->block.statements.size()));
+        for (auto statement : in_node->block.statements) {
+            hash_node(in_hasher, statement, in_source_code);
+        }
+        break;
+    case AstNodeType::AstType:
+        // interned names are unique per type
+        in_hasher.add(in_node->ast_type.type_info->name);
+        break;
+    case AstNodeType::AstVarDef:
+        in_hasher.add(in_node->var_def.name);
+        hash_node(in_hasher, in_node->var_def.type, in_source_code);
+        hash_node(in_hasher, in_node->var_def.initializer, in_source_code);
+        break;
+    case AstNodeType::AstSymbol: {
+        const Token* token = in_node->symbol.token;
+        in_hasher.add(uint64_t(token->id));
+        if (!in_node->symbol.name.empty()) {
+            in_hasher.add(in_node->symbol.name);
+        }
+        else if (token->id == TokenId::INT_LIT) {
+            const BigInt& value = in_source_code.literals->get_int(token->int_lit);
+            in_hasher.add(uint64_t(token->lit_type));
+            in_hasher.add(uint64_t(value.is_negative));
+            in_hasher.add(uint64_t(value.digit_count));
+            for (size_t i = 0; i < value.digit_count; i++) {
+                in_hasher.add(bigint_ptr(&value)[i]);
+            }
+        }
+        else if (token->id == TokenId::FLOAT_LIT) {
+            const BigFloat& value = in_source_code.literals->get_float(token->float_lit);
+            in_hasher.add(value.value.v[0]);
+            in_hasher.add(value.value.v[1]);
+            in_hasher.add(value.f64_bits);
+            in_hasher.add(uint64_t(value.f32_bits));
+        }
+        else if (token->id == TokenId::UNICODE_CHAR) {
+            in_hasher.add(uint64_t(token->char_lit));
+        }
+        else if (token->id == TokenId::STRING) {
+            in_hasher.add(in_source_code.literals->get_string(token->string_lit));
+        }
+        else {
+            in_hasher.add(in_source_code.source.substr(token->start_pos, token->end_pos + 1 - token->start_pos));
+        }
+    } break;
+    case AstNodeType::AstFuncCallExpr:
+        in_hasher.add(in_node->func_call.fn_name);
+        in_hasher.add(uint64_t(in_node->func_call.params.size()));
+        for (auto param : in_node->func_call.params) {
+            hash_node(in_hasher, param, in_source_code);
+        }
+        break;
+    case AstNodeType::AstBinaryExpr:
+        in_hasher.add(uint64_t(in_node->binary_expr.bin_op));
+        hash_node(in_hasher, in_node->binary_expr.op1, in_source_code);
+        hash_node(in_hasher, in_node->binary_expr.op2, in_source_code);
+        break;
+    case AstNodeType::AstUnaryExpr:
+        in_hasher.add(uint64_t(in_node->unary_expr.op));
+        hash_node(in_hasher, in_node->unary_expr.expr, in_source_code);
+        break;
+    default:
+        UNREACHEABLE;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "common_defs.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace llvm {
+    class MemoryBuffer;
+    class StringRef;
+}
+struct AstNode;
+struct AstSourceCode;
+
+/*
+* Content addressed on-disk cache of compilation artifacts.
+* Entries are named after the hash of everything that produced them
+* (compiler version, build flags and source), so they are never
+* invalidated: any change produces a different key.
+* The dependency graph of a module is the exception, it's named after
+* the module and replaced by every build.
+*/
+class CompilationCache {
+    std::string directory;
+
+public:
+    explicit CompilationCache(const std::string& in_directory);
+
+    LL_NODISCARD bool contains(const std::string& in_key, const char* in_extension) const noexcept;
+
+    // returns nullptr if there is no entry
+    std::unique_ptr<llvm::MemoryBuffer> load(const std::string& in_key, const char* in_extension) const noexcept;
+
+    // entries are written to a temporary file and renamed, so readers never see partial entries.
+    // failing to store is not an error, the entry is just missing next time.
+    void store(const std::string& in_key, const char* in_extension, llvm::StringRef in_data) const noexcept;
+};
+
+namespace cache {
+    // long running processes keep the entries they load and store in memory, about in_limit bytes.
+    // 0, the default, always reads from disk.
+    void set_memory_limit(size_t in_limit) noexcept;
+
+    // drops the oldest entries over the limit.
+    // buffers loaded before are invalidated, call it between builds only.
+    void trim_memory() noexcept;
+
+    // key of the source bytes alone
+    LL_NODISCARD std::string get_source_key(std::string_view in_source_code) noexcept;
+
+    // key of the whole output of a module. in_source_keys has the key of its own source first,
+    // then the ones of every module it can reach through #load.
+    LL_NODISCARD std::string get_module_key(const std::string& in_output_name, const std::vector<std::string>& in_source_keys) noexcept;
+
+    // key of the structure of a tree of in_source_code, positions and comments are left out
+    LL_NODISCARD std::string get_node_key(const AstNode* in_node, const AstSourceCode& in_source_code) noexcept;
+
+    // key of what the code referencing a top level declaration depends on,
+    // the prototype of a function or the type of a global
+    LL_NODISCARD std::string get_signature_key(const AstNode* in_declaration_node, const AstSourceCode& in_source_code) noexcept;
+
+    // key of a list of keys or names
+    LL_NODISCARD std::string get_key(const std::vector<std::string_view>& in_parts) noexcept;
+}
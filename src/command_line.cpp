@@ -0,0 +1,235 @@
+#include "command_line.hpp"
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/StringSaver.h>
+
+#define ARG_SRC_FILE "-s"
+#define ARG_OUT_NAME "-o"
+#define ARG_OUT_DIR  "-O"
+#define ARG_JOBS     "-j"
+#define ARG_STDIN    "--stdin"
+#define ARG_RESPONSE_FILE '@'
+#define ARG_RUN      "--run"
+#define ARG_EMIT     "--emit="
+#define ARG_MODULE_SUMMARY "--module-summary"
+#define ARG_COMPRESS_IR    "--compress-ir"
+#define ARG_CACHE_DIR      "--cache-dir"
+#define ARG_NO_CACHE       "--no-cache"
+#define ARG_TIME_REPORT    "--time-report"
+#define ARG_TIME_REPORT_JSON "--time-report=json"
+#define ARG_TRACE          "--trace="
+#define DEFAULT_CACHE_DIR  ".llcache"
+// name of the module read from --stdin, its outputs are named after it
+#define STDIN_SOURCE_NAME  "stdin.llang"
+// response files can include other response files up to this depth
+#define MAX_RESPONSE_FILE_DEPTH 8
+
+static bool get_emit_type(const char* in_name, EmitType* out_emit_type) noexcept;
+static bool check_sources(const CommandLine& in_command_line);
+
+bool command_line::expand_response_files(const std::string& in_working_dir, const std::vector<std::string>& in_args,
+    uint32_t in_depth, std::vector<std::string>& out_args) {
+    for (auto& arg : in_args) {
+        if (arg.empty() || arg[0] != ARG_RESPONSE_FILE) {
+            out_args.push_back(arg);
+            continue;
+        }
+
+        if (in_depth >= MAX_RESPONSE_FILE_DEPTH) {
+            std::cout << "response files nested too deep: " << arg << std::endl;
+            return false;
+        }
+
+        const std::string file_path = (std::filesystem::path(in_working_dir) / arg.substr(1)).string();
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file) {
+            std::cout << "can't read response file: " << file_path << std::endl;
+            return false;
+        }
+        const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        llvm::BumpPtrAllocator allocator;
+        llvm::StringSaver saver(allocator);
+        llvm::SmallVector<const char*, 64> tokens;
+        llvm::cl::TokenizeGNUCommandLine(contents, saver, tokens);
+
+        if (!expand_response_files(in_working_dir, std::vector<std::string>(tokens.begin(), tokens.end()), in_depth + 1, out_args)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool command_line::parse_thread_count(const std::string& in_value, uint32_t* out_thread_count) noexcept {
+    const char* end = in_value.data() + in_value.size();
+    auto [ptr, error] = std::from_chars(in_value.data(), end, *out_thread_count);
+    return error == std::errc() && ptr == end && !in_value.empty();
+}
+
+bool command_line::parse(const std::string& in_working_dir, const std::vector<std::string>& in_args, bool in_is_stdin_allowed,
+    CommandLine& out_command_line) {
+    namespace fs = std::filesystem;
+    const fs::path working_dir_path(in_working_dir);
+
+    std::vector<std::string> args;
+    if (!expand_response_files(in_working_dir, in_args, 0, args)) {
+        return false;
+    }
+
+    BuildOptions& build_options = out_command_line.build_options;
+    bool use_cache = true;
+    for (size_t i = 0; i < args.size(); i++) {
+        const char* option = args[i].c_str();
+
+        // sources
+        if (option[0] != '-') {
+            out_command_line.sources.push_back(RootSource{ (working_dir_path / option).string(), std::nullopt });
+            continue;
+        }
+        if (strcmp(option, ARG_STDIN) == 0) {
+            if (!in_is_stdin_allowed) {
+                std::cout << ARG_STDIN << " is not supported by the server" << std::endl;
+                return false;
+            }
+            out_command_line.read_stdin = true;
+            continue;
+        }
+
+        // -jN
+        if (strncmp(option, ARG_JOBS, strlen(ARG_JOBS)) == 0 && option[strlen(ARG_JOBS)] != '\0') {
+            if (!parse_thread_count(option + strlen(ARG_JOBS), &build_options.thread_count)) {
+                std::cout << "bad job count: " << option << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        // flags
+        if (strncmp(option, ARG_EMIT, strlen(ARG_EMIT)) == 0) {
+            if (!get_emit_type(option + strlen(ARG_EMIT), &build_options.emit_type)) {
+                std::cout << "bad emit type: " << option << " (expected bc, ll, obj or asm)" << std::endl;
+                return false;
+            }
+            continue;
+        }
+        if (strcmp(option, ARG_MODULE_SUMMARY) == 0) {
+            build_options.emit_module_summary = true;
+            continue;
+        }
+        if (strcmp(option, ARG_COMPRESS_IR) == 0) {
+            build_options.compress_ir = true;
+            continue;
+        }
+        if (strcmp(option, ARG_NO_CACHE) == 0) {
+            use_cache = false;
+            continue;
+        }
+        if (strcmp(option, ARG_TIME_REPORT) == 0 || strcmp(option, ARG_TIME_REPORT_JSON) == 0) {
+            out_command_line.time_report = true;
+            out_command_line.time_report_json = strcmp(option, ARG_TIME_REPORT_JSON) == 0;
+            continue;
+        }
+        if (strncmp(option, ARG_TRACE, strlen(ARG_TRACE)) == 0) {
+            out_command_line.trace_path = (working_dir_path / (option + strlen(ARG_TRACE))).string();
+            continue;
+        }
+
+        // options with a value
+        if (i + 1 >= args.size()) {
+            std::cout << "missing value for argument: " << option << std::endl;
+            return false;
+        }
+        const char* value = args[++i].c_str();
+
+        if (strcmp(option, ARG_RUN) == 0) {
+            build_options.run_entry_point = value;
+        }
+        else if (strcmp(option, ARG_CACHE_DIR) == 0) {
+            build_options.cache_directory = (working_dir_path / value).string();
+        }
+        else if (strcmp(option, ARG_SRC_FILE) == 0) {
+            out_command_line.sources.push_back(RootSource{ (working_dir_path / value).string(), std::nullopt });
+        }
+        else if (strcmp(option, ARG_OUT_NAME) == 0) {
+            build_options.output_name = value;
+        }
+        else if (strcmp(option, ARG_OUT_DIR) == 0) {
+            build_options.output_directory = (working_dir_path / value).string();
+        }
+        else if (strcmp(option, ARG_JOBS) == 0) {
+            if (!parse_thread_count(value, &build_options.thread_count)) {
+                std::cout << "bad job count: " << value << std::endl;
+                return false;
+            }
+        }
+        else {
+            std::cout << "bad argument: " << option << std::endl;
+            return false;
+        }
+    }
+
+    if (build_options.output_directory.empty()) {
+        build_options.output_directory = in_working_dir;
+    }
+
+    if (!use_cache) {
+        build_options.cache_directory.clear();
+    } else if (build_options.cache_directory.empty()) {
+        build_options.cache_directory = (fs::path(build_options.output_directory) / DEFAULT_CACHE_DIR).string();
+    }
+
+    // the modules it loads are found in the working directory
+    if (out_command_line.read_stdin) {
+        out_command_line.sources.push_back(RootSource{ (working_dir_path / STDIN_SOURCE_NAME).string(), std::string() });
+    }
+
+    return check_sources(out_command_line);
+}
+
+bool get_emit_type(const char* in_name, EmitType* out_emit_type) noexcept {
+    if (strcmp(in_name, "bc") == 0) {
+        *out_emit_type = EmitType::Bitcode;
+    } else if (strcmp(in_name, "ll") == 0) {
+        *out_emit_type = EmitType::LlvmIr;
+    } else if (strcmp(in_name, "obj") == 0) {
+        *out_emit_type = EmitType::Object;
+    } else if (strcmp(in_name, "asm") == 0) {
+        *out_emit_type = EmitType::Assembly;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool check_sources(const CommandLine& in_command_line) {
+    const auto& sources = in_command_line.sources;
+    if (sources.empty()) {
+        std::cout << "missing source file, use " << ARG_SRC_FILE << " <file>, <file>..., @<response file> or " << ARG_STDIN << std::endl;
+        return false;
+    }
+    if (sources.size() > 1 && !in_command_line.build_options.output_name.empty()) {
+        std::cout << ARG_OUT_NAME << " can't be used with more than one source, outputs are named after their sources" << std::endl;
+        return false;
+    }
+
+    // the outputs are named after the sources, a source given twice is built once
+    std::unordered_map<std::string, std::string> source_paths;
+    for (auto& source : sources) {
+        const std::string output_name = std::filesystem::path(source.file_path).stem().string();
+        const std::string file_path = std::filesystem::path(source.file_path).lexically_normal().string();
+        auto [source_it, is_new] = source_paths.emplace(output_name, file_path);
+        if (!is_new && source_it->second != file_path) {
+            std::cout << "two sources have the same output name \"" << output_name << "\"" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "compiler.hpp"
+#include <string>
+#include <vector>
+
+// what a command line asks for, its paths are made absolute
+struct CommandLine {
+    std::vector<RootSource> sources;
+    // the last source is read from the standard input by the caller
+    bool                    read_stdin = false;
+    BuildOptions            build_options;
+    bool                    time_report = false;
+    bool                    time_report_json = false;
+    std::string             trace_path;
+};
+
+namespace command_line {
+    // replaces every @<file> with the arguments in it, quoted as in a shell.
+    // the paths in a response file are relative to the working directory too.
+    // returns false if a response file can't be read or they are nested too deep
+    bool expand_response_files(const std::string& in_working_dir, const std::vector<std::string>& in_args,
+        uint32_t in_depth, std::vector<std::string>& out_args);
+
+    // the value of -j, 0 uses every hardware thread
+    bool parse_thread_count(const std::string& in_value, uint32_t* out_thread_count) noexcept;
+
+    // parses in_args after expanding the response files, the paths are relative to in_working_dir.
+    // prints why and returns false if they don't make a build
+    bool parse(const std::string& in_working_dir, const std::vector<std::string>& in_args, bool in_is_stdin_allowed,
+        CommandLine& out_command_line);
+}
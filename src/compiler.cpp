@@ -1,24 +1,96 @@
 #include "compiler.hpp"
+#include "analyzer.hpp"
+#include "builder.hpp"
+#include "cache.hpp"
+#include "comptime.hpp"
+#include "console.hpp"
+#include "constant_folder.hpp"
+#include "dependency_graph.hpp"
+#include "emitter.hpp"
+#include "error.hpp"
 #include "ir.hpp"
+#include "jit.hpp"
+#include "module_interface.hpp"
+#include "scheduler.hpp"
+#include "stats.hpp"
+#include "types.hpp"
+#include <optional>
+#include <llvm/Support/TimeProfiler.h>
 
-void compiler::compile(const std::string& in_output_directory, const std::string& in_executable_name, AstNode* in_source_code_node) {
+static bool append_diagnostics(const std::vector<Error>& in_errors, size_t in_first_error, std::string& out_diagnostics);
+
+int compiler::build(const BuildOptions& in_options, const std::vector<RootSource>& in_roots) {
+    ModuleBuilder builder(in_options);
+    return builder.build(in_roots);
+}
+
+bool compiler::analyze(AstNode* in_source_code_node, std::vector<Error>& in_errors, std::string& out_diagnostics) {
+    assert(in_source_code_node->node_type == AstNodeType::AstSourceCode);
+
+    // compile time execution and constant folding
+    const size_t prev_error_count = in_errors.size();
+    ComptimeEvaluator evaluator(in_source_code_node, in_errors);
+    evaluator.run_directives(in_source_code_node);
+
+    // folding trees comptime failed to evaluate would only repeat its errors
+    if (in_errors.size() == prev_error_count) {
+        ConstantFolder folder(in_source_code_node, in_errors);
+        folder.fold(in_source_code_node);
+    }
+
+    return append_diagnostics(in_errors, prev_error_count, out_diagnostics);
+}
+
+bool compiler::check(AstNode* in_source_code_node, const std::vector<const ModuleInterface*>& in_dependency_interfaces,
+    Scheduler* io_scheduler, DependencyGraph* io_graph, std::vector<Error>& in_errors, std::string& out_diagnostics) {
     assert(in_source_code_node->node_type == AstNodeType::AstSourceCode);
-    static LlvmIrGenerator generator(in_output_directory, in_executable_name);
+    llvm::TimeTraceScope trace_scope("Check", in_source_code_node->source_code.file_name);
+    PhaseTimer timer(Phase::Check);
+
+    const size_t prev_error_count = in_errors.size();
+    SemanticAnalyzer analyzer(in_source_code_node, in_errors);
+    analyzer.analyze(in_dependency_interfaces, io_scheduler, io_graph);
+    if (io_graph) {
+        io_graph->record(in_source_code_node, in_errors, prev_error_count);
+    }
+    return append_diagnostics(in_errors, prev_error_count, out_diagnostics);
+}
+
+std::unique_ptr<llvm::Module> compiler::generate(const BuildOptions& in_options, const std::string& in_output_name, AstNode* in_source_code_node,
+    const std::vector<const ModuleInterface*>& in_dependency_interfaces, const DependencyGraph* in_graph,
+    std::unique_ptr<llvm::LLVMContext>& out_context) {
+    llvm::TimeTraceScope trace_scope("Generate", in_output_name);
+    LlvmIrGenerator generator(in_options.output_directory, in_output_name, *in_source_code_node->source_code.literals);
+    std::optional<PhaseTimer> timer(std::in_place, Phase::FirstPass);
+
+    // declarations of the loaded modules
+    std::vector<const TypeInfo*> param_types;
+    for (auto dependency_interface : in_dependency_interfaces) {
+        for (uint32_t i = 0; i < dependency_interface->get_function_count(); i++) {
+            param_types.clear();
+            for (uint32_t j = 0; j < dependency_interface->get_param_count(i); j++) {
+                param_types.push_back(types::get_type_by_name(dependency_interface->get_param_type(i, j)));
+            }
+            const TypeInfo* return_type = types::get_type_by_name(dependency_interface->get_return_type(i));
+            generator.generateExternFuncDecl(dependency_interface->get_function_name(i), return_type, param_types);
+        }
+        for (uint32_t i = 0; i < dependency_interface->get_global_count(); i++) {
+            const TypeInfo* type = types::get_type_by_name(dependency_interface->get_global_type(i));
+            generator.generateExternVarDecl(dependency_interface->get_global_name(i), type);
+        }
+    }
 
     // first pass
     for (auto child : in_source_code_node->source_code.children) {
         switch (child->node_type) {
         case AstNodeType::AstFuncDef:
-            //if (analyzer.analizeFuncProto(child->function_def.proto->function_proto))
             generator.generateFuncProto(child->function_def.proto->function_proto, &child->function_def);
             break;
         case AstNodeType::AstFuncProto:
-            //if (analyzer.analizeFuncProto(child->function_proto))
             generator.generateFuncProto(child->function_proto, nullptr);
             break;
         case AstNodeType::AstVarDef:
             // global variables
-            //if (analyzer.analizeVarDef(child->var_def))
             generator.generateVarDef(child->var_def, true);
             break;
         default:
@@ -26,20 +98,81 @@ void compiler::compile(const std::string& in_output_directory, const std::string
         }
     }
 
+    std::unique_ptr<CompilationCache> cache;
+    if (in_graph && !in_options.cache_directory.empty()) {
+        cache = std::make_unique<CompilationCache>(in_options.cache_directory);
+    }
+
     // second pass
+    timer.emplace(Phase::SecondPass);
     for (auto child : in_source_code_node->source_code.children) {
         switch (child->node_type) {
-        case AstNodeType::AstFuncDef:
-            //if (analyzer.analizeFuncBlock(child->function_def.block->block))
-            generator.generateFuncBlock(child->function_def.block->block, child->function_def);
-            break;
+        case AstNodeType::AstFuncDef: {
+            if (!cache) {
+                generator.generateFuncBlock(child->function_def.block->block, child->function_def);
+                break;
+            }
+
+            // unchanged functions are linked from the cache instead of generated again
+            const std::string declaration_key = in_graph->get_declaration_key(child);
+            auto cached_bitcode = cache->load(declaration_key, ".bc");
+            if (cached_bitcode) {
+                llvm::TimeTraceScope link_scope("LinkCachedFunction", child->function_def.proto->function_proto.name);
+                if (generator.linkFunctionBitcode(child->function_def, *cached_bitcode)) {
+                    break;
+                }
+            }
+
+            if (generator.generateFuncBlock(child->function_def.block->block, child->function_def)) {
+                cache->store(declaration_key, ".bc", generator.getFunctionBitcode(child->function_def));
+            }
+        } break;
         default:
             continue;
         }
     }
 
+    return generator.release_module(out_context);
+}
+
+int compiler::compile(const BuildOptions& in_options, AstNode* in_source_code_node, std::vector<Error>& in_errors) {
+    std::string diagnostics;
+    Scheduler scheduler(in_options.thread_count);
+    const bool is_valid = analyze(in_source_code_node, in_errors, diagnostics)
+        && check(in_source_code_node, {}, &scheduler, nullptr, in_errors, diagnostics);
+    if (!diagnostics.empty()) {
+        console::WriteLine(diagnostics);
+    }
+    if (!is_valid) {
+        return -1;
+    }
+
+    jit::JitModule jit_module;
+    jit_module.code_module = generate(in_options, in_options.output_name, in_source_code_node, {}, nullptr, jit_module.context);
+
+    // run in-process instead of writing the output
+    if (!in_options.run_entry_point.empty()) {
+        std::vector<jit::JitModule> jit_modules;
+        jit_modules.push_back(std::move(jit_module));
+        return jit::run(std::move(jit_modules), in_options.run_entry_point);
+    }
+
     // generate IR output
-    generator.flush();
+    const bool is_written = emitter::write_module(*jit_module.code_module, in_options.output_name, in_options);
+
+    // the module must be destroyed before its context
+    jit_module.code_module.reset();
+    return is_written ? 0 : -1;
+}
 
-    // generate exe|lib|dll output
+// returns false if any of the new diagnostics is an error
+bool append_diagnostics(const std::vector<Error>& in_errors, size_t in_first_error, std::string& out_diagnostics) {
+    bool has_errors = false;
+    for (size_t i = in_first_error; i < in_errors.size(); i++) {
+        std::string error_msg;
+        to_string(in_errors[i], error_msg);
+        out_diagnostics += out_diagnostics.empty() ? error_msg : "\n" + error_msg;
+        has_errors |= in_errors[i].type == ERROR_TYPE::ERROR;
+    }
+    return !has_errors;
 }
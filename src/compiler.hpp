@@ -1,9 +1,77 @@
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+namespace llvm {
+    class LLVMContext;
+    class Module;
+}
+class DependencyGraph;
+class ModuleInterface;
+class Scheduler;
 struct AstNode;
+struct Error;
+
+enum class EmitType {
+    Bitcode,    // .bc
+    LlvmIr,     // .ll
+    Object,     // .o
+    Assembly    // .s
+};
+
+struct BuildOptions {
+    std::string output_directory;
+    std::string output_name;
+    // function executed in-process through the JIT when not empty
+    std::string run_entry_point;
+    EmitType    emit_type = EmitType::Bitcode;
+    // adds the module summary ThinLTO needs to the bitcode
+    bool        emit_module_summary = false;
+    // also writes the IR compressed (.ll.z) for archiving
+    bool        compress_ir = false;
+    // artifacts of previous builds are reused from here, no caching if empty
+    std::string cache_directory;
+    // modules are built in parallel, 0 uses every hardware thread
+    uint32_t    thread_count = 0;
+};
+
+// a module given to the compiler, the modules it loads are next to it
+struct RootSource {
+    std::string                 file_path;
+    std::optional<std::string>  source;     // read from file_path if not given
+};
 
 namespace compiler {
-    void compile(const std::string& in_output_directory, const std::string& in_executable_name, AstNode* in_source_code_node);
-}
+    // builds the root modules and every module they load in one process, one output per module.
+    // modules loaded by several roots are built once, whatever the cache already has is skipped.
+    // the outputs are named after the roots, two roots can't have the same file name.
+    // returns the process exit code
+    int build(const BuildOptions& in_options, const std::vector<RootSource>& in_roots);
 
+    // runs compile time code and folds constants.
+    // new diagnostics are appended to out_diagnostics, one per line.
+    // returns false if there were errors
+    bool analyze(AstNode* in_source_code_node, std::vector<Error>& in_errors, std::string& out_diagnostics);
+
+    // resolves names and checks types once the interfaces of the loaded modules are known.
+    // function bodies are checked by the workers of io_scheduler, serially without one.
+    // io_graph, if any, skips the bodies unchanged since the previous build and records the references of the others.
+    // new diagnostics are appended to out_diagnostics, one per line.
+    // returns false if there were errors
+    bool check(AstNode* in_source_code_node, const std::vector<const ModuleInterface*>& in_dependency_interfaces,
+        Scheduler* io_scheduler, DependencyGraph* io_graph, std::vector<Error>& in_errors, std::string& out_diagnostics);
+
+    // generates the IR of an analyzed module, the symbols of the loaded modules are declared as external
+    // from their interfaces, their sources are not needed.
+    // with a cache, the functions are keyed by in_graph and the ones already in the cache are linked instead of generated
+    std::unique_ptr<llvm::Module> generate(const BuildOptions& in_options, const std::string& in_output_name, AstNode* in_source_code_node,
+        const std::vector<const ModuleInterface*>& in_dependency_interfaces, const DependencyGraph* in_graph,
+        std::unique_ptr<llvm::LLVMContext>& out_context);
+
+    // compiles a single module without cache.
+    // returns the process exit code
+    int compile(const BuildOptions& in_options, AstNode* in_source_code_node, std::vector<Error>& in_errors);
+}
@@ -0,0 +1,597 @@
+#include "comptime.hpp"
+#include "ast_nodes.hpp"
+#include "lexer.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <utility>
+
+// max depth of nested calls executed at compile time
+#define MAX_COMPTIME_CALL_DEPTH 256
+
+static bool is_literal_symbol(const AstNode* in_node) noexcept;
+static bool is_literal_expr(const AstNode* in_node) noexcept;
+static LiteralType get_sized_literal_type(const AstNode* in_literal_expr) noexcept;
+static bool is_f128_type(const AstNode* in_var_def_node) noexcept;
+static AstNode* new_literal_symbol(const AstNode* in_replaced_node, Token* io_value_token) noexcept;
+static void bool_to_bigint(BigInt* dest, const bool in_value) noexcept;
+static bool is_shift_too_large(const BigInt* in_amount) noexcept;
+
+ComptimeEvaluator::ComptimeEvaluator(const AstNode* in_source_code, std::vector<Error>& in_errors)
+    : source_code(in_source_code), errors(in_errors), frames(), globals_in_progress() {
+    assert(in_source_code->node_type == AstNodeType::AstSourceCode);
+}
+
+void ComptimeEvaluator::run_directives(AstNode* in_node) noexcept {
+    switch (in_node->node_type) {
+    case AstNodeType::AstSourceCode:
+        for (auto child : in_node->source_code.children) {
+            run_directives(child);
+        }
+        break;
+    case AstNodeType::AstFuncDef:
+        run_directives(in_node->function_def.block);
+        break;
+    case AstNodeType::AstBlock:
+        for (auto statement : in_node->block.statements) {
+            run_directives(statement);
+        }
+        break;
+    case AstNodeType::AstDirective:
+        // top level #run: the value is discarded
+        if (in_node->directive.directive_type == DirectiveType::Run) {
+            BigInt value = {};
+            (void)evaluate(in_node->directive.expr, &value);
+            bigint_deinit(&value);
+        }
+        break;
+    case AstNodeType::AstVarDef: {
+        if (!in_node->var_def.initializer) {
+            break;
+        }
+        const AstNode* value_node = in_node->var_def.initializer->binary_expr.op2;
+        const bool is_global = in_node->parent && in_node->parent->node_type == AstNodeType::AstSourceCode;
+        const bool is_run = value_node->node_type == AstNodeType::AstDirective;
+
+        // globals need constant initializers, the f128 ones with float literals and the ones made of
+        // sized literals are computed by the constant folder, in the literal type
+        const bool is_float_constant = is_f128_type(in_node) && has_float_literal(value_node);
+        const bool is_sized_constant = get_literal_type(value_node) != LiteralType::None;
+        if (is_run || (is_global && !is_literal_symbol(value_node) && !is_float_constant && !is_sized_constant)) {
+            BigInt value = {};
+            if (evaluate_initializer(in_node, &value)) {
+                replace_initializer(in_node, value);
+            }
+            bigint_deinit(&value);
+        }
+    } break;
+    default:
+        break;
+    }
+}
+
+bool ComptimeEvaluator::evaluate(const AstNode* in_expr, BigInt* out_value) noexcept {
+    switch (in_expr->node_type) {
+    case AstNodeType::AstSymbol:
+        return evaluate_symbol(in_expr, out_value);
+    case AstNodeType::AstBinaryExpr:
+        return evaluate_binary_expr(in_expr, out_value);
+    case AstNodeType::AstUnaryExpr:
+        return evaluate_unary_expr(in_expr, out_value);
+    case AstNodeType::AstFuncCallExpr:
+        return evaluate_func_call(in_expr, out_value);
+    case AstNodeType::AstDirective:
+        if (in_expr->directive.directive_type == DirectiveType::Run) {
+            return evaluate(in_expr->directive.expr, out_value);
+        }
+        return comptime_error(in_expr, "directive '#%s' does not produce a value",
+            get_directive_type_name(in_expr->directive.directive_type).c_str());
+    default:
+        return comptime_error(in_expr, "expression can not be evaluated at compile time");
+    }
+}
+
+bool ComptimeEvaluator::evaluate_symbol(const AstNode* in_node, BigInt* out_value) noexcept {
+    const AstSymbol& symbol = in_node->symbol;
+    switch (symbol.token->id) {
+    case TokenId::INT_LIT:
+        bigint_init_bigint(out_value, &source_code->source_code.literals->get_int(symbol.token->int_lit));
+        return true;
+    case TokenId::UNICODE_CHAR:
+        bigint_init_unsigned(out_value, symbol.token->char_lit);
+        return true;
+    case TokenId::IDENTIFIER:
+        break;
+    default:
+        return comptime_error(in_node, "only integer values are supported at compile time");
+    }
+
+    // local variable or parameter
+    if (Variable* variable = find_variable(symbol.name)) {
+        bigint_init_bigint(out_value, &variable->value);
+        return true;
+    }
+
+    // global variable
+    if (const AstNode* var_def_node = find_global(symbol.name)) {
+        return evaluate_global(var_def_node, out_value);
+    }
+
+    std::string name(symbol.name);
+    return comptime_error(in_node, "use of undeclared identifier '%s'", name.c_str());
+}
+
+bool ComptimeEvaluator::evaluate_binary_expr(const AstNode* in_node, BigInt* out_value) noexcept {
+    const AstBinaryExpr& binary_expr = in_node->binary_expr;
+
+    if (binary_expr.bin_op == BinaryExprType::ASSIGN) {
+        const AstNode* target = binary_expr.op1;
+        if (target->node_type != AstNodeType::AstSymbol || target->symbol.name.empty()) {
+            return comptime_error(target, "expression is not assignable");
+        }
+
+        Variable* variable = find_variable(target->symbol.name);
+        if (!variable) {
+            std::string name(target->symbol.name);
+            return comptime_error(target, "'%s' can not be modified at compile time", name.c_str());
+        }
+
+        if (!evaluate(binary_expr.op2, out_value)) {
+            return false;
+        }
+        // a call in the value can grow the frames and move the variable
+        variable = find_variable(target->symbol.name);
+        bigint_deinit(&variable->value);
+        bigint_init_bigint(&variable->value, out_value);
+        return true;
+    }
+
+    BigInt op1 = {};
+    BigInt op2 = {};
+    const bool result = evaluate(binary_expr.op1, &op1) && evaluate(binary_expr.op2, &op2) &&
+        compute_binary_expr(in_node, &op1, &op2, out_value);
+    bigint_deinit(&op1);
+    bigint_deinit(&op2);
+
+    // the constant folder warns about the overflow
+    if (result) {
+        (void)truncate_to_literal_type(out_value, get_literal_type(in_node));
+    }
+    return result;
+}
+
+bool ComptimeEvaluator::compute_binary_expr(const AstNode* in_node, const BigInt* op1, const BigInt* op2, BigInt* out_value) noexcept {
+    const AstBinaryExpr& binary_expr = in_node->binary_expr;
+
+    const bool is_shift = binary_expr.bin_op == BinaryExprType::LSHIFT || binary_expr.bin_op == BinaryExprType::RSHIFT;
+    if (is_shift && op2->is_negative) {
+        return comptime_error(in_node, "shift amount can not be negative");
+    }
+    if (is_shift && is_shift_too_large(op2)) {
+        return comptime_error(in_node, "shift amount is not less than the widest integer type");
+    }
+    const bool is_division = binary_expr.bin_op == BinaryExprType::DIV || binary_expr.bin_op == BinaryExprType::MOD;
+    if (is_division && op2->digit_count == 0) {
+        return comptime_error(in_node, "division by zero");
+    }
+
+    if (!bigint_binary_op(out_value, binary_expr.bin_op, op1, op2)) {
+        return comptime_error(in_node, "operator not supported at compile time yet");
+    }
+    return true;
+}
+
+bool ComptimeEvaluator::evaluate_unary_expr(const AstNode* in_node, BigInt* out_value) noexcept {
+    const AstUnaryExpr& unary_expr = in_node->unary_expr;
+
+    switch (unary_expr.op) {
+    case UnaryExprType::INC:
+    case UnaryExprType::DEC: {
+        const AstNode* target = unary_expr.expr;
+        Variable* variable = target->node_type == AstNodeType::AstSymbol
+            ? find_variable(target->symbol.name)
+            : nullptr;
+        if (!variable || target->symbol.name.empty()) {
+            return comptime_error(target, "expression can not be modified at compile time");
+        }
+
+        BigInt one;
+        bigint_init_signed(&one, unary_expr.op == UnaryExprType::INC ? 1 : -1);
+        BigInt result;
+        bigint_add(&result, &variable->value, &one);
+        bigint_deinit(&variable->value);
+        variable->value = result;
+        bigint_init_bigint(out_value, &result);
+        return true;
+    }
+    case UnaryExprType::NEG: {
+        BigInt value = {};
+        const bool result = evaluate(unary_expr.expr, &value);
+        if (result) {
+            bigint_negate(out_value, &value);
+            (void)truncate_to_literal_type(out_value, get_literal_type(in_node));
+        }
+        bigint_deinit(&value);
+        return result;
+    }
+    case UnaryExprType::RET:
+        return comptime_error(in_node, "return is not an expression");
+    default:
+        UNREACHEABLE;
+    }
+}
+
+bool ComptimeEvaluator::evaluate_func_call(const AstNode* in_node, BigInt* out_value) noexcept {
+    const AstFuncCallExpr& func_call = in_node->func_call;
+    std::string fn_name(func_call.fn_name);
+
+    const AstNode* func_def_node = find_function(func_call.fn_name);
+    if (!func_def_node) {
+        return comptime_error(in_node, "function '%s' has no body to run at compile time", fn_name.c_str());
+    }
+
+    const AstFuncProto& proto = func_def_node->function_def.proto->function_proto;
+    if (proto.params.size() != func_call.params.size()) {
+        return comptime_error(in_node, "function '%s' expects %zu arguments but %zu were given",
+            fn_name.c_str(), proto.params.size(), func_call.params.size());
+    }
+
+    if (frames.size() >= MAX_COMPTIME_CALL_DEPTH) {
+        return comptime_error(in_node, "compile time call depth exceeded calling '%s'", fn_name.c_str());
+    }
+
+    // arguments are evaluated in the caller frame
+    Frame callee_frame;
+    for (size_t i = 0; i < proto.params.size(); i++) {
+        Variable param = { proto.params[i]->param_decl.name, {} };
+        if (!evaluate(func_call.params[i], &param.value)) {
+            bigint_deinit(&param.value);
+            free_frame(callee_frame);
+            return false;
+        }
+        callee_frame.variables.push_back(param);
+    }
+
+    frames.push_back(std::move(callee_frame));
+    bool result = execute_block(func_def_node->function_def.block->block, out_value);
+    free_frame(frames.back());
+    frames.pop_back();
+
+    return result;
+}
+
+bool ComptimeEvaluator::evaluate_global(const AstNode* in_var_def_node, BigInt* out_value) noexcept {
+    for (auto node : globals_in_progress) {
+        if (node == in_var_def_node) {
+            std::string name(in_var_def_node->var_def.name);
+            return comptime_error(in_var_def_node, "initializer of '%s' depends on itself", name.c_str());
+        }
+    }
+
+    // globals are evaluated without the caller locals in scope
+    std::vector<Frame> caller_frames;
+    caller_frames.swap(frames);
+    globals_in_progress.push_back(in_var_def_node);
+
+    bool result = evaluate_initializer(in_var_def_node, out_value);
+
+    globals_in_progress.pop_back();
+    frames.swap(caller_frames);
+    return result;
+}
+
+bool ComptimeEvaluator::evaluate_initializer(const AstNode* in_var_def_node, BigInt* out_value) noexcept {
+    const AstNode* initializer = in_var_def_node->var_def.initializer;
+    if (!initializer) {
+        // variables are zero initialized
+        bigint_init_unsigned(out_value, 0);
+        return true;
+    }
+    return evaluate(initializer->binary_expr.op2, out_value);
+}
+
+bool ComptimeEvaluator::execute_block(const AstBlock& in_block, BigInt* out_return_value) noexcept {
+    for (auto statement : in_block.statements) {
+        switch (statement->node_type) {
+        case AstNodeType::AstVarDef: {
+            Variable variable = { statement->var_def.name, {} };
+            if (!evaluate_initializer(statement, &variable.value)) {
+                bigint_deinit(&variable.value);
+                return false;
+            }
+            frames.back().variables.push_back(variable);
+        } break;
+        case AstNodeType::AstUnaryExpr:
+            if (statement->unary_expr.op == UnaryExprType::RET) {
+                if (!statement->unary_expr.expr) {
+                    bigint_init_unsigned(out_return_value, 0);
+                    return true;
+                }
+                return evaluate(statement->unary_expr.expr, out_return_value);
+            }
+            LL_FALLTHROUGH
+        default: {
+            BigInt discarded = {};
+            const bool result = evaluate(statement, &discarded);
+            bigint_deinit(&discarded);
+            if (!result) {
+                return false;
+            }
+        } break;
+        }
+    }
+
+    // void functions
+    bigint_init_unsigned(out_return_value, 0);
+    return true;
+}
+
+ComptimeEvaluator::Variable* ComptimeEvaluator::find_variable(std::string_view in_name) noexcept {
+    if (frames.empty() || in_name.empty()) {
+        return nullptr;
+    }
+
+    // last definition shadows the previous ones
+    auto& variables = frames.back().variables;
+    for (auto it = variables.rbegin(); it != variables.rend(); ++it) {
+        if (it->name == in_name) {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
+void ComptimeEvaluator::free_frame(Frame& io_frame) noexcept {
+    for (auto& variable : io_frame.variables) {
+        bigint_deinit(&variable.value);
+    }
+    io_frame.variables.clear();
+}
+
+const AstNode* ComptimeEvaluator::find_function(std::string_view in_name) const noexcept {
+    for (auto child : source_code->source_code.children) {
+        if (child->node_type == AstNodeType::AstFuncDef &&
+            child->function_def.proto->function_proto.name == in_name) {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+const AstNode* ComptimeEvaluator::find_global(std::string_view in_name) const noexcept {
+    for (auto child : source_code->source_code.children) {
+        if (child->node_type == AstNodeType::AstVarDef && child->var_def.name == in_name) {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+void ComptimeEvaluator::replace_initializer(AstNode* in_var_def_node, const BigInt& in_value) noexcept {
+    AstNode* assign_node = in_var_def_node->var_def.initializer;
+    AstNode* old_value_node = assign_node->binary_expr.op2;
+
+    AstNode* value_node = new_comptime_symbol(old_value_node, in_value, LiteralType::None, *source_code->source_code.literals);
+    value_node->parent = assign_node;
+
+    assign_node->binary_expr.op2 = value_node;
+    delete old_value_node;
+}
+
+bool ComptimeEvaluator::comptime_error(const AstNode* in_node, const char* format, ...) noexcept {
+    va_list ap, ap2;
+    va_start(ap, format);
+    va_copy(ap2, ap);
+
+    int len = vsnprintf(nullptr, 0, format, ap);
+    assert(len >= 0);
+    va_end(ap);
+
+    std::string msg(len, '\0');
+    vsnprintf(msg.data(), len + 1, format, ap2);
+    va_end(ap2);
+
+    Error error(ERROR_TYPE::ERROR,
+        in_node->line,
+        in_node->column,
+        std::string(source_code->source_code.file_name), msg);
+    errors.push_back(error);
+    return false;
+}
+
+bool bigint_binary_op(BigInt* dest, const BinaryExprType in_op, const BigInt* op1, const BigInt* op2) noexcept {
+    switch (in_op) {
+    case BinaryExprType::ADD:
+        bigint_add(dest, op1, op2);
+        return true;
+    case BinaryExprType::SUB:
+        bigint_sub(dest, op1, op2);
+        return true;
+    case BinaryExprType::MUL:
+        bigint_mul(dest, op1, op2);
+        return true;
+    case BinaryExprType::DIV:
+        if (op2->digit_count == 0) {
+            return false;
+        }
+        bigint_divmod(dest, nullptr, op1, op2);
+        return true;
+    case BinaryExprType::MOD:
+        if (op2->digit_count == 0) {
+            return false;
+        }
+        bigint_divmod(nullptr, dest, op1, op2);
+        return true;
+    case BinaryExprType::LSHIFT:
+        if (op2->is_negative || is_shift_too_large(op2)) {
+            return false;
+        }
+        bigint_shl(dest, op1, op2);
+        return true;
+    case BinaryExprType::RSHIFT:
+        if (op2->is_negative || is_shift_too_large(op2)) {
+            return false;
+        }
+        bigint_shr(dest, op1, op2);
+        return true;
+    case BinaryExprType::BIT_XOR:
+        bigint_xor(dest, op1, op2);
+        return true;
+    case BinaryExprType::BIT_AND:
+        bigint_and(dest, op1, op2);
+        return true;
+    case BinaryExprType::EQUALS:
+        bool_to_bigint(dest, bigint_cmp(op1, op2) == CmpEQ);
+        return true;
+    case BinaryExprType::NOT_EQUALS:
+        bool_to_bigint(dest, bigint_cmp(op1, op2) != CmpEQ);
+        return true;
+    case BinaryExprType::GREATER_OR_EQUALS:
+        bool_to_bigint(dest, bigint_cmp(op1, op2) != CmpLT);
+        return true;
+    case BinaryExprType::LESS_OR_EQUALS:
+        bool_to_bigint(dest, bigint_cmp(op1, op2) != CmpGT);
+        return true;
+    case BinaryExprType::GREATER:
+        bool_to_bigint(dest, bigint_cmp(op1, op2) == CmpGT);
+        return true;
+    case BinaryExprType::LESS:
+        bool_to_bigint(dest, bigint_cmp(op1, op2) == CmpLT);
+        return true;
+    case BinaryExprType::ASSIGN:
+        return false;
+    default:
+        UNREACHEABLE;
+    }
+}
+
+AstNode* new_comptime_symbol(const AstNode* in_replaced_node, const BigInt& in_value, LiteralType in_lit_type, LiteralPool& io_literals) noexcept {
+    Token* value_token = new Token();
+    value_token->id = TokenId::INT_LIT;
+    value_token->lit_type = in_lit_type;
+    value_token->int_lit = io_literals.add_int(in_value);
+    return new_literal_symbol(in_replaced_node, value_token);
+}
+
+AstNode* new_comptime_symbol(const AstNode* in_replaced_node, const BigFloat& in_value, LiteralPool& io_literals) noexcept {
+    Token* value_token = new Token();
+    value_token->id = TokenId::FLOAT_LIT;
+    value_token->float_lit = io_literals.add_float(in_value);
+    return new_literal_symbol(in_replaced_node, value_token);
+}
+
+// shifting by the bit width or more is undefined at runtime, 128 is the widest integer type.
+// it also keeps a huge amount from allocating its result
+bool is_shift_too_large(const BigInt* in_amount) noexcept {
+    BigInt widest;
+    bigint_init_unsigned(&widest, 128);
+    return bigint_cmp(in_amount, &widest) != CmpLT;
+}
+
+AstNode* new_literal_symbol(const AstNode* in_replaced_node, Token* io_value_token) noexcept {
+    io_value_token->start_line = in_replaced_node->line;
+    io_value_token->start_column = in_replaced_node->column;
+
+    AstNode* value_node = new AstNode(AstNodeType::AstSymbol, in_replaced_node->line, in_replaced_node->column);
+    value_node->symbol.token = io_value_token;
+    value_node->symbol.is_comptime_value = true;
+    value_node->parent = in_replaced_node->parent;
+    return value_node;
+}
+
+bool is_literal_symbol(const AstNode* in_node) noexcept {
+    return in_node->node_type == AstNodeType::AstSymbol && in_node->symbol.name.empty();
+}
+
+bool is_literal_expr(const AstNode* in_node) noexcept {
+    switch (in_node->node_type) {
+    case AstNodeType::AstSymbol:
+        return is_literal_symbol(in_node);
+    case AstNodeType::AstBinaryExpr:
+        return in_node->binary_expr.bin_op != BinaryExprType::ASSIGN &&
+            is_literal_expr(in_node->binary_expr.op1) && is_literal_expr(in_node->binary_expr.op2);
+    case AstNodeType::AstUnaryExpr:
+        return in_node->unary_expr.op == UnaryExprType::NEG && is_literal_expr(in_node->unary_expr.expr);
+    default:
+        return false;
+    }
+}
+
+LiteralType get_literal_type(const AstNode* in_node) noexcept {
+    return is_literal_expr(in_node) ? get_sized_literal_type(in_node) : LiteralType::None;
+}
+
+// an unsized literal takes the type of the sized one, the shift amount doesn't change the type
+LiteralType get_sized_literal_type(const AstNode* in_literal_expr) noexcept {
+    switch (in_literal_expr->node_type) {
+    case AstNodeType::AstSymbol: {
+        const Token* token = in_literal_expr->symbol.token;
+        const bool is_sized = token->id == TokenId::INT_LIT && literal_type_bit_size(token->lit_type) != 0;
+        return is_sized ? token->lit_type : LiteralType::None;
+    }
+    case AstNodeType::AstUnaryExpr:
+        return get_sized_literal_type(in_literal_expr->unary_expr.expr);
+    case AstNodeType::AstBinaryExpr:
+        break;
+    default:
+        return LiteralType::None;
+    }
+
+    const AstBinaryExpr& binary_expr = in_literal_expr->binary_expr;
+    const LiteralType op1_type = get_sized_literal_type(binary_expr.op1);
+    switch (binary_expr.bin_op) {
+    case BinaryExprType::EQUALS:
+    case BinaryExprType::NOT_EQUALS:
+    case BinaryExprType::GREATER_OR_EQUALS:
+    case BinaryExprType::LESS_OR_EQUALS:
+    case BinaryExprType::GREATER:
+    case BinaryExprType::LESS:
+        return LiteralType::None;
+    case BinaryExprType::LSHIFT:
+    case BinaryExprType::RSHIFT:
+        return op1_type;
+    default:
+        break;
+    }
+
+    const LiteralType op2_type = get_sized_literal_type(binary_expr.op2);
+    if (op1_type == LiteralType::None || op1_type == op2_type) {
+        return op2_type;
+    }
+    return op2_type == LiteralType::None ? op1_type : LiteralType::None;
+}
+
+bool truncate_to_literal_type(BigInt* io_value, LiteralType in_lit_type) noexcept {
+    const uint32_t bit_size = literal_type_bit_size(in_lit_type);
+    if (bit_size == 0) {
+        return true;
+    }
+
+    BigInt truncated = {};
+    bigint_truncate(&truncated, io_value, bit_size, literal_type_is_signed(in_lit_type));
+    const bool is_fitting = bigint_cmp(&truncated, io_value) == CmpEQ;
+    bigint_deinit(io_value);
+    *io_value = truncated;
+    return is_fitting;
+}
+
+bool has_float_literal(const AstNode* in_node) noexcept {
+    switch (in_node->node_type) {
+    case AstNodeType::AstSymbol:
+        return in_node->symbol.token->id == TokenId::FLOAT_LIT;
+    case AstNodeType::AstBinaryExpr:
+        return has_float_literal(in_node->binary_expr.op1) || has_float_literal(in_node->binary_expr.op2);
+    case AstNodeType::AstUnaryExpr:
+        return in_node->unary_expr.expr && has_float_literal(in_node->unary_expr.expr);
+    default:
+        return false;
+    }
+}
+
+bool is_f128_type(const AstNode* in_var_def_node) noexcept {
+    const AstType& type = in_var_def_node->var_def.type->ast_type;
+    return type.type_id == AstTypeId::FloatingPoint && type.type_info && type.type_info->bit_size == 128;
+}
+
+void bool_to_bigint(BigInt* dest, const bool in_value) noexcept {
+    bigint_init_unsigned(dest, in_value ? 1 : 0);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "common_defs.hpp"
+#include "bigfloat.hpp"
+#include "bigint.hpp"
+#include <string_view>
+#include <vector>
+
+struct AstNode;
+struct AstBlock;
+struct Error;
+class LiteralPool;
+enum class BinaryExprType;
+enum class LiteralType : uint8_t;
+
+// computes in_op over integer constants, returns false if the operator can't be computed
+// or the result is undefined (division by zero, negative shift or by 128 bits and more)
+bool bigint_binary_op(BigInt* dest, const BinaryExprType in_op, const BigInt* op1, const BigInt* op2) noexcept;
+
+// creates a literal symbol with in_value to replace in_replaced_node, the value is copied to io_literals.
+// in_lit_type is the suffix type the value was computed in
+AstNode* new_comptime_symbol(const AstNode* in_replaced_node, const BigInt& in_value, LiteralType in_lit_type, LiteralPool& io_literals) noexcept;
+AstNode* new_comptime_symbol(const AstNode* in_replaced_node, const BigFloat& in_value, LiteralPool& io_literals) noexcept;
+
+// true if a float literal is an operand of the arithmetic in in_node
+bool has_float_literal(const AstNode* in_node) noexcept;
+
+// the type an expression made of literals is computed in, the one of its sized literals.
+// None if it has other operands, no sized literal or sized literals of different types
+LiteralType get_literal_type(const AstNode* in_node) noexcept;
+
+// wraps io_value to the range of in_lit_type as the runtime does, returns false if it didn't fit
+bool truncate_to_literal_type(BigInt* io_value, LiteralType in_lit_type) noexcept;
+
+/*
+* Tree walking interpreter that executes code at compile time.
+* It evaluates #run directives and global initializers so their
+* results end up in the module as constants.
+* Only integer values are supported for now.
+*/
+class ComptimeEvaluator {
+    struct Variable {
+        std::string_view name;
+        BigInt           value;
+    };
+
+    struct Frame {
+        std::vector<Variable> variables;
+    };
+
+    const AstNode*              source_code;
+    std::vector<Error>&         errors;
+    std::vector<Frame>          frames;
+    std::vector<const AstNode*> globals_in_progress; // used to detect cyclic initializers
+
+public:
+    ComptimeEvaluator(const AstNode* in_source_code, std::vector<Error>& in_errors);
+
+    // evaluates the #run directives and global initializers under in_node
+    // and replaces them with their values.
+    void run_directives(AstNode* in_node) noexcept;
+
+    // returns false and reports an error if the expression can't be evaluated at compile time
+    LL_NODISCARD bool evaluate(const AstNode* in_expr, BigInt* out_value) noexcept;
+
+private:
+    bool evaluate_symbol(const AstNode* in_node, BigInt* out_value) noexcept;
+    bool evaluate_binary_expr(const AstNode* in_node, BigInt* out_value) noexcept;
+    bool compute_binary_expr(const AstNode* in_node, const BigInt* op1, const BigInt* op2, BigInt* out_value) noexcept;
+    bool evaluate_unary_expr(const AstNode* in_node, BigInt* out_value) noexcept;
+    bool evaluate_func_call(const AstNode* in_node, BigInt* out_value) noexcept;
+    bool evaluate_global(const AstNode* in_var_def_node, BigInt* out_value) noexcept;
+    bool evaluate_initializer(const AstNode* in_var_def_node, BigInt* out_value) noexcept;
+    bool execute_block(const AstBlock& in_block, BigInt* out_return_value) noexcept;
+
+    Variable* find_variable(std::string_view in_name) noexcept;
+    // frees the values of the variables in io_frame
+    void free_frame(Frame& io_frame) noexcept;
+    const AstNode* find_function(std::string_view in_name) const noexcept;
+    const AstNode* find_global(std::string_view in_name) const noexcept;
+
+    // replaces the initializer value of in_var_def_node with in_value
+    void replace_initializer(AstNode* in_var_def_node, const BigInt& in_value) noexcept;
+
+    bool comptime_error(const AstNode* in_node, const char* format, ...) noexcept;
+};
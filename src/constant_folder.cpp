@@ -0,0 +1,365 @@
+#include "constant_folder.hpp"
+#include "ast_nodes.hpp"
+#include "comptime.hpp"
+#include "lexer.hpp"
+#include "softfloat.hpp"
+#include <cstdarg>
+#include <cstdio>
+
+static void get_type_limits(const TypeInfo& in_type_info, BigInt* out_min, BigInt* out_max) noexcept;
+static bool is_f128(const AstType& in_type) noexcept;
+static bool is_int_literal(const AstNode* in_node) noexcept;
+
+ConstantFolder::ConstantFolder(const AstNode* in_source_code_node, std::vector<Error>& in_errors)
+    : file_name(in_source_code_node->source_code.file_name), literals(*in_source_code_node->source_code.literals),
+    errors(in_errors), current_function(nullptr) {
+    assert(in_source_code_node->node_type == AstNodeType::AstSourceCode);
+}
+
+void ConstantFolder::fold(AstNode* in_node) noexcept {
+    switch (in_node->node_type) {
+    case AstNodeType::AstSourceCode:
+        for (auto child : in_node->source_code.children) {
+            fold(child);
+        }
+        break;
+    case AstNodeType::AstFuncDef:
+        current_function = in_node;
+        fold(in_node->function_def.block);
+        current_function = nullptr;
+        break;
+    case AstNodeType::AstBlock:
+        for (auto& statement : in_node->block.statements) {
+            if (statement->node_type == AstNodeType::AstVarDef) {
+                fold(statement);
+                continue;
+            }
+            BigInt value = {};
+            (void)fold_expr(statement, &value);
+            bigint_deinit(&value);
+        }
+        break;
+    case AstNodeType::AstVarDef: {
+        if (!in_node->var_def.initializer) {
+            break;
+        }
+        AstNode*& value_node = in_node->var_def.initializer->binary_expr.op2;
+        const AstType& type = in_node->var_def.type->ast_type;
+        const bool is_global = in_node->parent && in_node->parent->node_type == AstNodeType::AstSourceCode;
+        if (is_f128(type)) {
+            float128_t value;
+            const bool is_constant = fold_float_expr(value_node, &value);
+
+            // comptime leaves the f128 globals with float literals to the folder
+            if (!is_constant && is_global) {
+                std::string name(in_node->var_def.name);
+                fold_error(value_node, "initializer of global '%s' is not a constant", name.c_str());
+            }
+            break;
+        }
+
+        // comptime leaves the globals made of sized literals to the folder too
+        const size_t prev_error_count = errors.size();
+        BigInt value = {};
+        if (fold_expr(value_node, &value)) {
+            check_fits_type(value_node, value, type);
+        }
+        else if (is_global && errors.size() == prev_error_count) {
+            std::string name(in_node->var_def.name);
+            fold_error(value_node, "initializer of global '%s' is not a constant", name.c_str());
+        }
+        bigint_deinit(&value);
+    } break;
+    default:
+        break;
+    }
+}
+
+bool ConstantFolder::fold_expr(AstNode*& io_node, BigInt* out_value) noexcept {
+    switch (io_node->node_type) {
+    case AstNodeType::AstSymbol: {
+        const Token* token = io_node->symbol.token;
+        // a literal that doesn't fit its type is not a constant, its error is enough
+        if (token->id == TokenId::INT_LIT) {
+            bigint_init_bigint(out_value, &literals.get_int(token->int_lit));
+            return check_fits_literal_type(io_node, *out_value);
+        }
+        if (token->id == TokenId::UNICODE_CHAR) {
+            bigint_init_unsigned(out_value, token->char_lit);
+            return true;
+        }
+        return false;
+    }
+    case AstNodeType::AstBinaryExpr: {
+        AstBinaryExpr& binary_expr = io_node->binary_expr;
+        if (binary_expr.bin_op == BinaryExprType::ASSIGN) {
+            BigInt value = {};
+            (void)fold_expr(binary_expr.op2, &value);
+            bigint_deinit(&value);
+            return false;
+        }
+
+        BigInt op1 = {};
+        BigInt op2 = {};
+        const bool is_op1_constant = fold_expr(binary_expr.op1, &op1);
+        const bool is_op2_constant = fold_expr(binary_expr.op2, &op2);
+
+        // left for runtime if it can't be computed here
+        const bool is_constant = is_op1_constant && is_op2_constant &&
+            bigint_binary_op(out_value, binary_expr.bin_op, &op1, &op2);
+        bigint_deinit(&op1);
+        bigint_deinit(&op2);
+        if (is_constant) {
+            // the operands were folded to literals
+            const LiteralType lit_type = get_literal_type(io_node);
+            wrap_to_literal_type(io_node, lit_type, out_value);
+            replace_with_constant(io_node, *out_value, lit_type);
+        }
+        return is_constant;
+    }
+    case AstNodeType::AstUnaryExpr: {
+        AstUnaryExpr& unary_expr = io_node->unary_expr;
+        if (unary_expr.op == UnaryExprType::NEG) {
+            // a negated literal fits down to the minimum of its type
+            BigInt value = {};
+            if (is_int_literal(unary_expr.expr)) {
+                bigint_init_bigint(&value, &literals.get_int(unary_expr.expr->symbol.token->int_lit));
+            }
+            else if (!fold_expr(unary_expr.expr, &value)) {
+                bigint_deinit(&value);
+                return false;
+            }
+            bigint_negate(out_value, &value);
+            bigint_deinit(&value);
+            const LiteralType lit_type = get_literal_type(io_node);
+            wrap_to_literal_type(io_node, lit_type, out_value);
+            replace_with_constant(io_node, *out_value, lit_type);
+            return true;
+        }
+
+        if (unary_expr.op == UnaryExprType::RET && unary_expr.expr) {
+            const AstType* return_type = current_function
+                ? &current_function->function_def.proto->function_proto.return_type->ast_type
+                : nullptr;
+            if (return_type && is_f128(*return_type)) {
+                float128_t value;
+                (void)fold_float_expr(unary_expr.expr, &value);
+                return false;
+            }
+
+            BigInt value = {};
+            if (fold_expr(unary_expr.expr, &value) && return_type) {
+                check_fits_type(unary_expr.expr, value, *return_type);
+            }
+            bigint_deinit(&value);
+        }
+        return false;
+    }
+    case AstNodeType::AstFuncCallExpr:
+        for (auto& param : io_node->func_call.params) {
+            BigInt value = {};
+            (void)fold_expr(param, &value);
+            bigint_deinit(&value);
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+bool ConstantFolder::fold_float_expr(AstNode*& io_node, float128_t* out_value) noexcept {
+    // the operations between integers are the integer ones, only their result is converted
+    if (!has_float_literal(io_node)) {
+        BigInt value = {};
+        const bool is_constant = fold_expr(io_node, &value);
+        if (is_constant) {
+            *out_value = bigint_to_f128(&value);
+        }
+        bigint_deinit(&value);
+        return is_constant;
+    }
+
+    switch (io_node->node_type) {
+    case AstNodeType::AstSymbol:
+        *out_value = literals.get_float(io_node->symbol.token->float_lit).value;
+        return true;
+    case AstNodeType::AstBinaryExpr: {
+        AstBinaryExpr& binary_expr = io_node->binary_expr;
+        float128_t op1;
+        float128_t op2;
+        const bool is_op1_constant = fold_float_expr(binary_expr.op1, &op1);
+        const bool is_op2_constant = fold_float_expr(binary_expr.op2, &op2);
+        if (!is_op1_constant || !is_op2_constant) {
+            return false;
+        }
+
+        // division by zero is infinite, the same as at runtime
+        switch (binary_expr.bin_op) {
+        case BinaryExprType::ADD:
+            *out_value = f128_add(op1, op2);
+            break;
+        case BinaryExprType::SUB:
+            *out_value = f128_sub(op1, op2);
+            break;
+        case BinaryExprType::MUL:
+            *out_value = f128_mul(op1, op2);
+            break;
+        case BinaryExprType::DIV:
+            *out_value = f128_div(op1, op2);
+            break;
+        default:
+            return false;
+        }
+        replace_with_constant(io_node, *out_value);
+        return true;
+    }
+    case AstNodeType::AstUnaryExpr: {
+        AstUnaryExpr& unary_expr = io_node->unary_expr;
+        float128_t value;
+        if (unary_expr.op != UnaryExprType::NEG || !fold_float_expr(unary_expr.expr, &value)) {
+            return false;
+        }
+        *out_value = f128_neg(value);
+        replace_with_constant(io_node, *out_value);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void ConstantFolder::replace_with_constant(AstNode*& io_node, const BigInt& in_value, LiteralType in_lit_type) noexcept {
+    replace_node(io_node, new_comptime_symbol(io_node, in_value, in_lit_type, literals));
+}
+
+void ConstantFolder::replace_with_constant(AstNode*& io_node, const float128_t& in_value) noexcept {
+    // the narrower types are rounded from the folded value
+    BigFloat value;
+    value.value = in_value;
+    value.f64_bits = f128_to_f64(in_value);
+    value.f32_bits = f128_to_f32(in_value);
+    value.overflow = f128_is_infinite(in_value);
+    replace_node(io_node, new_comptime_symbol(io_node, value, literals));
+}
+
+void ConstantFolder::replace_node(AstNode*& io_node, AstNode* in_constant_node) noexcept {
+    // operands were folded to literals already
+    if (io_node->node_type == AstNodeType::AstBinaryExpr) {
+        delete io_node->binary_expr.op1;
+        delete io_node->binary_expr.op2;
+    }
+    else if (io_node->node_type == AstNodeType::AstUnaryExpr) {
+        delete io_node->unary_expr.expr;
+    }
+
+    delete io_node;
+    io_node = in_constant_node;
+}
+
+void ConstantFolder::check_fits_type(const AstNode* in_value_node, const BigInt& in_value, const AstType& in_type) noexcept {
+    if (in_type.type_id != AstTypeId::Integer && in_type.type_id != AstTypeId::Bool) {
+        return;
+    }
+
+    const TypeInfo& type_info = *in_type.type_info;
+    std::string type_name(type_info.name);
+
+    if (in_value.is_negative && !type_info.is_signed) {
+        fold_warning(in_value_node, "negative constant converted to unsigned type '%s'", type_name.c_str());
+        return;
+    }
+
+    BigInt min_value;
+    BigInt max_value;
+    get_type_limits(type_info, &min_value, &max_value);
+
+    if (bigint_cmp(&in_value, &min_value) == CmpLT || bigint_cmp(&in_value, &max_value) == CmpGT) {
+        fold_warning(in_value_node, "constant overflows '%s', it will be truncated to %u bits", type_name.c_str(), type_info.bit_size);
+    }
+}
+
+bool ConstantFolder::check_fits_literal_type(const AstNode* in_literal_node, const BigInt& in_value) noexcept {
+    const LiteralType lit_type = in_literal_node->symbol.token->lit_type;
+    if (!literal_type_is_signed(lit_type)) {
+        return true;
+    }
+
+    // the lexer let the magnitude of the minimum through
+    BigInt max_value;
+    bigint_init_unsigned(&max_value, (uint64_t(1) << (literal_type_bit_size(lit_type) - 1)) - 1);
+    if (bigint_cmp(&in_value, &max_value) == CmpGT) {
+        const std::string value = bigint_to_string(&in_value, 10);
+        fold_error(in_literal_node, "integer literal %s doesn't fit in '%s', only its negation does", value.c_str(), literal_type_name(lit_type));
+        return false;
+    }
+    return true;
+}
+
+void ConstantFolder::wrap_to_literal_type(const AstNode* in_node, LiteralType in_lit_type, BigInt* io_value) noexcept {
+    if (!truncate_to_literal_type(io_value, in_lit_type)) {
+        fold_warning(in_node, "constant overflows '%s', it will be truncated to %u bits",
+            literal_type_name(in_lit_type), literal_type_bit_size(in_lit_type));
+    }
+}
+
+void ConstantFolder::fold_warning(const AstNode* in_node, const char* format, ...) noexcept {
+    va_list ap;
+    va_start(ap, format);
+    add_diagnostic(ERROR_TYPE::WARNING_0, in_node, format, ap);
+    va_end(ap);
+}
+
+void ConstantFolder::fold_error(const AstNode* in_node, const char* format, ...) noexcept {
+    va_list ap;
+    va_start(ap, format);
+    add_diagnostic(ERROR_TYPE::ERROR, in_node, format, ap);
+    va_end(ap);
+}
+
+void ConstantFolder::add_diagnostic(ERROR_TYPE in_type, const AstNode* in_node, const char* format, va_list ap) noexcept {
+    va_list ap2;
+    va_copy(ap2, ap);
+
+    int len = vsnprintf(nullptr, 0, format, ap);
+    assert(len >= 0);
+
+    std::string msg(len, '\0');
+    vsnprintf(msg.data(), len + 1, format, ap2);
+    va_end(ap2);
+
+    Error error(in_type,
+        in_node->line,
+        in_node->column,
+        std::string(file_name), msg);
+    errors.push_back(error);
+}
+
+void get_type_limits(const TypeInfo& in_type_info, BigInt* out_min, BigInt* out_max) noexcept {
+    BigInt one;
+    bigint_init_unsigned(&one, 1);
+
+    // 2^(bits - 1) for signed types, 2^bits for unsigned ones
+    BigInt magnitude_bits;
+    bigint_init_unsigned(&magnitude_bits, in_type_info.is_signed ? in_type_info.bit_size - 1 : in_type_info.bit_size);
+    BigInt limit;
+    bigint_shl(&limit, &one, &magnitude_bits);
+
+    BigInt minus_one;
+    bigint_init_signed(&minus_one, -1);
+    bigint_add(out_max, &limit, &minus_one);
+
+    if (in_type_info.is_signed) {
+        bigint_negate(out_min, &limit);
+    }
+    else {
+        bigint_init_unsigned(out_min, 0);
+    }
+}
+
+bool is_f128(const AstType& in_type) noexcept {
+    return in_type.type_id == AstTypeId::FloatingPoint && in_type.type_info && in_type.type_info->bit_size == 128;
+}
+
+bool is_int_literal(const AstNode* in_node) noexcept {
+    return in_node->node_type == AstNodeType::AstSymbol && in_node->symbol.token->id == TokenId::INT_LIT;
+}
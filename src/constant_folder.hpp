@@ -0,0 +1,59 @@
+#pragma once
+#include "common_defs.hpp"
+#include "bigfloat.hpp"
+#include "bigint.hpp"
+#include <cstdarg>
+#include <string_view>
+#include <vector>
+
+struct AstNode;
+struct AstType;
+struct Error;
+class LiteralPool;
+enum class ERROR_TYPE;
+enum class LiteralType : uint8_t;
+
+/*
+* Semantic pass run before IR generation.
+* Replaces expressions made only of integer constants with a single
+* literal and warns about constants that don't fit the type they are
+* stored in, as they will be truncated.
+* Sized literals that only fit negated, ~128b, are errors anywhere else.
+* Operations on sized literals are computed in their type and wrap around.
+* f128 expressions are folded with soft-float, rounded like the runtime.
+*/
+class ConstantFolder {
+    std::string_view    file_name;
+    LiteralPool&        literals;
+    std::vector<Error>& errors;
+    const AstNode*      current_function;
+
+public:
+    ConstantFolder(const AstNode* in_source_code_node, std::vector<Error>& in_errors);
+
+    void fold(AstNode* in_node) noexcept;
+
+private:
+    // folds the constant subtrees of io_node and replaces io_node itself if it's constant.
+    // returns true and the value if io_node is an integer constant.
+    bool fold_expr(AstNode*& io_node, BigInt* out_value) noexcept;
+
+    // folds io_node as a f128 expression. integer subexpressions are folded as integers and then converted.
+    // returns true and the value if io_node is a constant.
+    bool fold_float_expr(AstNode*& io_node, float128_t* out_value) noexcept;
+
+    // replaces io_node with a literal holding in_value
+    void replace_with_constant(AstNode*& io_node, const BigInt& in_value, LiteralType in_lit_type) noexcept;
+    void replace_with_constant(AstNode*& io_node, const float128_t& in_value) noexcept;
+    void replace_node(AstNode*& io_node, AstNode* in_constant_node) noexcept;
+
+    void check_fits_type(const AstNode* in_value_node, const BigInt& in_value, const AstType& in_type) noexcept;
+    // the magnitude of a signed minimum, 128b, only fits negated. returns false if in_value doesn't fit
+    bool check_fits_literal_type(const AstNode* in_literal_node, const BigInt& in_value) noexcept;
+    // wraps io_value to in_lit_type as the runtime does, with a warning if it overflows
+    void wrap_to_literal_type(const AstNode* in_node, LiteralType in_lit_type, BigInt* io_value) noexcept;
+
+    void fold_warning(const AstNode* in_node, const char* format, ...) noexcept;
+    void fold_error(const AstNode* in_node, const char* format, ...) noexcept;
+    void add_diagnostic(ERROR_TYPE in_type, const AstNode* in_node, const char* format, va_list ap) noexcept;
+};
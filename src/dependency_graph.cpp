@@ -0,0 +1,314 @@
+#include "dependency_graph.hpp"
+#include "ast_nodes.hpp"
+#include "cache.hpp"
+#include <algorithm>
+#include <llvm/Support/Endian.h>
+
+// bumped on every layout change
+#define GRAPH_MAGIC     0x47444C4Cu // "LLDG"
+#define GRAPH_VERSION   1u
+
+namespace {
+    class GraphReader {
+        std::string_view bytes;
+
+    public:
+        explicit GraphReader(std::string_view in_bytes) : bytes(in_bytes) {}
+
+        bool read_u32(uint32_t& out_value) noexcept {
+            if (bytes.size() < sizeof(uint32_t)) {
+                return false;
+            }
+            out_value = llvm::support::endian::read32le(bytes.data());
+            bytes.remove_prefix(sizeof(uint32_t));
+            return true;
+        }
+
+        bool read_string(std::string& out_string) noexcept {
+            uint32_t size;
+            if (!read_u32(size) || bytes.size() < size) {
+                return false;
+            }
+            out_string.assign(bytes.data(), size);
+            bytes.remove_prefix(size);
+            return true;
+        }
+
+        bool is_at_end() const noexcept {
+            return bytes.empty();
+        }
+    };
+}
+
+static const std::string_view& get_declaration_name(const AstNode* in_declaration_node) noexcept;
+static bool is_top_level(const AstNode* in_declaration_node) noexcept;
+static void collect_references(const AstNode* in_node, std::vector<std::string>& out_references) noexcept;
+static void add_u32(std::string& io_bytes, uint32_t in_value) noexcept;
+static void add_string(std::string& io_bytes, std::string_view in_string) noexcept;
+
+DependencyGraph::DependencyGraph(const CompilationCache* in_cache)
+    : cache(in_cache) {}
+
+bool DependencyGraph::read_previous(std::string_view in_bytes) noexcept {
+    GraphReader reader(in_bytes);
+    uint32_t magic, version, declaration_count;
+    if (!reader.read_u32(magic) || magic != GRAPH_MAGIC || !reader.read_u32(version) || version != GRAPH_VERSION
+        || !reader.read_u32(declaration_count)) {
+        return false;
+    }
+
+    std::unordered_map<std::string, Declaration> read_declarations;
+    for (uint32_t i = 0; i < declaration_count; i++) {
+        Declaration declaration;
+        uint32_t reference_count, diagnostic_count;
+        if (!reader.read_string(declaration.name) || !reader.read_string(declaration.source_key)
+            || !reader.read_string(declaration.references_key) || !reader.read_u32(reference_count)) {
+            return false;
+        }
+
+        // every element takes 4 bytes at least, the counts of a corrupted file can't allocate much
+        for (uint32_t j = 0; j < reference_count; j++) {
+            std::string reference;
+            if (!reader.read_string(reference)) {
+                return false;
+            }
+            declaration.references.push_back(std::move(reference));
+        }
+
+        if (!reader.read_u32(diagnostic_count)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < diagnostic_count; j++) {
+            Diagnostic diagnostic;
+            uint32_t type;
+            if (!reader.read_u32(type) || type > uint32_t(ERROR_TYPE::ERROR) || !reader.read_u32(diagnostic.line_offset)
+                || !reader.read_u32(diagnostic.column) || !reader.read_string(diagnostic.message)) {
+                return false;
+            }
+            diagnostic.type = ERROR_TYPE(type);
+            declaration.diagnostics.push_back(std::move(diagnostic));
+        }
+
+        std::string name = declaration.name;
+        read_declarations.emplace(std::move(name), std::move(declaration));
+    }
+
+    if (!reader.is_at_end()) {
+        return false;
+    }
+    previous_declarations = std::move(read_declarations);
+    return true;
+}
+
+void DependencyGraph::compare(const AstNode* in_source_code_node) noexcept {
+    assert(in_source_code_node->node_type == AstNodeType::AstSourceCode);
+    const AstSourceCode& source_code = in_source_code_node->source_code;
+    signature_keys.clear();
+    unchanged_functions.clear();
+
+    // a function declared here and by a loaded module has the same signature in both
+    for (auto node : source_code.imported_nodes) {
+        if (node->node_type == AstNodeType::AstFuncProto || node->node_type == AstNodeType::AstVarDef) {
+            signature_keys[get_declaration_name(node)] = cache::get_signature_key(node, source_code);
+        }
+    }
+    for (auto child : source_code.children) {
+        if (child->node_type == AstNodeType::AstFuncDef || child->node_type == AstNodeType::AstFuncProto || child->node_type == AstNodeType::AstVarDef) {
+            signature_keys[get_declaration_name(child)] = cache::get_signature_key(child, source_code);
+        }
+    }
+
+    if (previous_declarations.empty()) {
+        return;
+    }
+
+    for (auto child : source_code.children) {
+        if (child->node_type != AstNodeType::AstFuncDef) {
+            continue;
+        }
+
+        auto previous_it = previous_declarations.find(std::string(get_declaration_name(child)));
+        if (previous_it == previous_declarations.end()) {
+            continue;
+        }
+
+        const Declaration& previous_declaration = previous_it->second;
+        if (previous_declaration.source_key != cache::get_node_key(child, source_code)
+            || previous_declaration.references_key != get_references_key(previous_declaration.references)
+            || !cache->contains(cache::get_key({ previous_declaration.source_key, previous_declaration.references_key }), ".bc")) {
+            continue;
+        }
+
+        unchanged_functions.insert(child);
+        declarations[child] = previous_declaration;
+    }
+}
+
+bool DependencyGraph::is_unchanged(const AstNode* in_func_def_node) const noexcept {
+    return unchanged_functions.count(in_func_def_node) != 0;
+}
+
+void DependencyGraph::get_previous_diagnostics(const AstNode* in_func_def_node, std::string_view in_file_name, std::vector<Error>& out_errors) const noexcept {
+    auto declaration_it = declarations.find(in_func_def_node);
+    assert(declaration_it != declarations.end());
+
+    for (auto& diagnostic : declaration_it->second.diagnostics) {
+        out_errors.push_back(Error(diagnostic.type, in_func_def_node->line + diagnostic.line_offset, diagnostic.column,
+            std::string(in_file_name), diagnostic.message));
+    }
+}
+
+void DependencyGraph::record(const AstNode* in_source_code_node, const std::vector<Error>& in_errors, size_t in_first_error) noexcept {
+    assert(in_source_code_node->node_type == AstNodeType::AstSourceCode);
+    const AstSourceCode& source_code = in_source_code_node->source_code;
+
+    for (size_t i = 0; i < source_code.children.size(); i++) {
+        const AstNode* child = source_code.children[i];
+        if ((child->node_type != AstNodeType::AstFuncDef && child->node_type != AstNodeType::AstVarDef) || is_unchanged(child)) {
+            continue;
+        }
+
+        Declaration declaration;
+        declaration.name = std::string(get_declaration_name(child));
+        declaration.source_key = cache::get_node_key(child, source_code);
+        collect_references(child, declaration.references);
+        std::sort(declaration.references.begin(), declaration.references.end());
+        declaration.references.erase(std::unique(declaration.references.begin(), declaration.references.end()), declaration.references.end());
+        declaration.references_key = get_references_key(declaration.references);
+
+        // a function goes up to the next declaration
+        if (child->node_type == AstNodeType::AstFuncDef) {
+            const size_t end_line = i + 1 < source_code.children.size() ? source_code.children[i + 1]->line : SIZE_MAX;
+            for (size_t j = in_first_error; j < in_errors.size(); j++) {
+                const Error& error = in_errors[j];
+                if (error.line >= child->line && error.line < end_line) {
+                    declaration.diagnostics.push_back(Diagnostic{ error.type, uint32_t(error.line - child->line), uint32_t(error.column), error.message });
+                }
+            }
+        }
+
+        declarations[child] = std::move(declaration);
+    }
+}
+
+std::string DependencyGraph::get_declaration_key(const AstNode* in_declaration_node) const noexcept {
+    auto declaration_it = declarations.find(in_declaration_node);
+    assert(declaration_it != declarations.end());
+    return cache::get_key({ declaration_it->second.source_key, declaration_it->second.references_key });
+}
+
+std::string DependencyGraph::write() const noexcept {
+    std::string bytes;
+    add_u32(bytes, GRAPH_MAGIC);
+    add_u32(bytes, GRAPH_VERSION);
+    add_u32(bytes, uint32_t(declarations.size()));
+
+    for (auto& [node, declaration] : declarations) {
+        add_string(bytes, declaration.name);
+        add_string(bytes, declaration.source_key);
+        add_string(bytes, declaration.references_key);
+        add_u32(bytes, uint32_t(declaration.references.size()));
+        for (auto& reference : declaration.references) {
+            add_string(bytes, reference);
+        }
+        add_u32(bytes, uint32_t(declaration.diagnostics.size()));
+        for (auto& diagnostic : declaration.diagnostics) {
+            add_u32(bytes, uint32_t(diagnostic.type));
+            add_u32(bytes, diagnostic.line_offset);
+            add_u32(bytes, diagnostic.column);
+            add_string(bytes, diagnostic.message);
+        }
+    }
+    return bytes;
+}
+
+// a removed declaration has no signature, so the key changes
+std::string DependencyGraph::get_references_key(const std::vector<std::string>& in_references) const noexcept {
+    std::vector<std::string_view> parts;
+    for (auto& reference : in_references) {
+        auto signature_it = signature_keys.find(reference);
+        parts.push_back(reference);
+        parts.push_back(signature_it != signature_keys.end() ? std::string_view(signature_it->second) : std::string_view());
+    }
+    return cache::get_key(parts);
+}
+
+const std::string_view& get_declaration_name(const AstNode* in_declaration_node) noexcept {
+    switch (in_declaration_node->node_type) {
+    case AstNodeType::AstFuncDef:
+        return in_declaration_node->function_def.proto->function_proto.name;
+    case AstNodeType::AstFuncProto:
+        return in_declaration_node->function_proto.name;
+    case AstNodeType::AstVarDef:
+        return in_declaration_node->var_def.name;
+    default:
+        UNREACHEABLE;
+    }
+}
+
+// locals are declared in a block, the globals of loaded modules have no parent
+bool is_top_level(const AstNode* in_declaration_node) noexcept {
+    switch (in_declaration_node->node_type) {
+    case AstNodeType::AstFuncDef:
+    case AstNodeType::AstFuncProto:
+        return true;
+    case AstNodeType::AstVarDef:
+        return !in_declaration_node->parent || in_declaration_node->parent->node_type == AstNodeType::AstSourceCode;
+    default:
+        return false;
+    }
+}
+
+// the names resolved by the analyzer to top level declarations
+void collect_references(const AstNode* in_node, std::vector<std::string>& out_references) noexcept {
+    if (!in_node) {
+        return;
+    }
+
+    switch (in_node->node_type) {
+    case AstNodeType::AstFuncDef:
+        for (auto statement : in_node->function_def.block->block.statements) {
+            collect_references(statement, out_references);
+        }
+        break;
+    case AstNodeType::AstVarDef:
+        // the name being initialized is not a reference
+        if (in_node->var_def.initializer) {
+            collect_references(in_node->var_def.initializer->binary_expr.op2, out_references);
+        }
+        break;
+    case AstNodeType::AstSymbol:
+        if (in_node->symbol.declaration && is_top_level(in_node->symbol.declaration)) {
+            out_references.push_back(std::string(in_node->symbol.name));
+        }
+        break;
+    case AstNodeType::AstFuncCallExpr:
+        if (in_node->func_call.fn_ref) {
+            out_references.push_back(std::string(in_node->func_call.fn_name));
+        }
+        for (auto param : in_node->func_call.params) {
+            collect_references(param, out_references);
+        }
+        break;
+    case AstNodeType::AstBinaryExpr:
+        collect_references(in_node->binary_expr.op1, out_references);
+        collect_references(in_node->binary_expr.op2, out_references);
+        break;
+    case AstNodeType::AstUnaryExpr:
+        collect_references(in_node->unary_expr.expr, out_references);
+        break;
+    default:
+        break;
+    }
+}
+
+void add_u32(std::string& io_bytes, uint32_t in_value) noexcept {
+    char bytes[sizeof(uint32_t)];
+    llvm::support::endian::write32le(bytes, in_value);
+    io_bytes.append(bytes, sizeof(bytes));
+}
+
+void add_string(std::string& io_bytes, std::string_view in_string) noexcept {
+    add_u32(io_bytes, uint32_t(in_string.size()));
+    io_bytes += in_string;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "common_defs.hpp"
+#include "error.hpp"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class CompilationCache;
+struct AstNode;
+
+/*
+* Top level declarations of a module and the top level names each one
+* references, persisted from one build to the next.
+* A function whose own tree and referenced signatures are the same as in
+* the previous build is unchanged: its body is not analyzed again, its
+* diagnostics are replayed from the graph and its code is linked from
+* the cache. Editing a body or a prototype only rebuilds the functions
+* that reference it.
+*
+* Layout, every field is a little endian uint32 and strings are their
+* size followed by their bytes:
+*   header          magic, version, declaration count
+*   declarations    name, source key, references key,
+*                   reference count, references,
+*                   diagnostic count, diagnostics (type, line offset, column, message)
+*/
+class DependencyGraph {
+    struct Diagnostic {
+        ERROR_TYPE  type;
+        uint32_t    line_offset;    // from the line of the declaration
+        uint32_t    column;
+        std::string message;
+    };
+
+    struct Declaration {
+        std::string                 name;
+        std::string                 source_key;     // the tree of the declaration
+        std::string                 references_key; // the signatures of its references
+        std::vector<std::string>    references;     // sorted, without duplicates
+        std::vector<Diagnostic>     diagnostics;    // of the body
+    };
+
+    const CompilationCache*                                 cache;
+    std::unordered_map<std::string, Declaration>            previous_declarations;  // by name
+    std::unordered_map<std::string_view, std::string>       signature_keys;         // by name
+    std::unordered_map<const AstNode*, Declaration>         declarations;
+    std::unordered_set<const AstNode*>                      unchanged_functions;
+
+public:
+    // the code of unchanged functions must be in in_cache
+    explicit DependencyGraph(const CompilationCache* in_cache);
+
+    // loads the graph written by the previous build. returns false if in_bytes is not a valid graph
+    bool read_previous(std::string_view in_bytes) noexcept;
+
+    // finds the unchanged functions, the top level declarations and the loaded ones must be analyzed already
+    void compare(const AstNode* in_source_code_node) noexcept;
+
+    LL_NODISCARD bool is_unchanged(const AstNode* in_func_def_node) const noexcept;
+
+    // appends the diagnostics the previous build found in an unchanged function, at its current position
+    void get_previous_diagnostics(const AstNode* in_func_def_node, std::string_view in_file_name, std::vector<Error>& out_errors) const noexcept;
+
+    // records the references of the analyzed declarations, the unchanged ones keep the previous ones.
+    // the diagnostics of the analysis are in_errors from in_first_error
+    void record(const AstNode* in_source_code_node, const std::vector<Error>& in_errors, size_t in_first_error) noexcept;
+
+    // key of the code generated for a recorded declaration
+    LL_NODISCARD std::string get_declaration_key(const AstNode* in_declaration_node) const noexcept;
+
+    LL_NODISCARD std::string write() const noexcept;
+
+private:
+    std::string get_references_key(const std::vector<std::string>& in_references) const noexcept;
+};
@@ -0,0 +1,189 @@
+#include "emitter.hpp"
+#include "compiler.hpp"
+#include "console.hpp"
+#include "stats.hpp"
+#include <filesystem>
+#include <mutex>
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/Compression.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+
+// big modules are written in few syscalls
+static constexpr size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+static std::string get_output_path(const std::string& in_output_name, const BuildOptions& in_options, const char* in_extension);
+static std::unique_ptr<llvm::raw_fd_ostream> open_output(const std::string& in_path, const bool in_is_text) noexcept;
+static bool close_output(llvm::raw_fd_ostream& in_output, const std::string& in_path) noexcept;
+static bool write_machine_code(llvm::Module& in_module, llvm::raw_pwrite_stream& in_output, const llvm::CodeGenFileType in_file_type) noexcept;
+static bool write_compressed_ir(const llvm::Module& in_module, const std::string& in_output_name, const BuildOptions& in_options) noexcept;
+
+bool emitter::write_module(llvm::Module& in_module, const std::string& in_output_name, const BuildOptions& in_options) noexcept {
+#ifdef _DEBUG
+    console::WriteLine();
+    in_module.dump();
+#endif
+    // the codegen passes are traced by llvm inside this one
+    llvm::TimeTraceScope trace_scope("Emit", in_output_name);
+    PhaseTimer timer(Phase::Emit);
+
+    if (in_options.compress_ir && !write_compressed_ir(in_module, in_output_name, in_options)) {
+        return false;
+    }
+
+    const char* extension = nullptr;
+    bool is_text = false;
+    switch (in_options.emit_type) {
+    case EmitType::Bitcode:
+        extension = ".bc";
+        break;
+    case EmitType::LlvmIr:
+        extension = ".ll";
+        is_text = true;
+        break;
+    case EmitType::Object:
+        extension = ".o";
+        break;
+    case EmitType::Assembly:
+        extension = ".s";
+        is_text = true;
+        break;
+    default:
+        UNREACHEABLE;
+    }
+
+    const std::string output_path = get_output_path(in_output_name, in_options, extension);
+    auto output = open_output(output_path, is_text);
+    if (!output) {
+        return false;
+    }
+
+    switch (in_options.emit_type) {
+    case EmitType::Bitcode:
+        if (in_options.emit_module_summary) {
+            // summary used by the ThinLTO thin link
+            llvm::ProfileSummaryInfo profile_summary(in_module);
+            llvm::ModuleSummaryIndex summary_index = llvm::buildModuleSummaryIndex(in_module, nullptr, &profile_summary);
+            llvm::WriteBitcodeToFile(in_module, *output, false, &summary_index);
+        } else {
+            llvm::WriteBitcodeToFile(in_module, *output);
+        }
+        break;
+    case EmitType::LlvmIr:
+        in_module.print(*output, nullptr);
+        break;
+    case EmitType::Object:
+        if (!write_machine_code(in_module, *output, llvm::CGFT_ObjectFile)) {
+            return false;
+        }
+        break;
+    case EmitType::Assembly:
+        if (!write_machine_code(in_module, *output, llvm::CGFT_AssemblyFile)) {
+            return false;
+        }
+        break;
+    }
+
+    return close_output(*output, output_path);
+}
+
+std::string get_output_path(const std::string& in_output_name, const BuildOptions& in_options, const char* in_extension) {
+    std::filesystem::path output_path(in_options.output_directory);
+    output_path /= in_output_name + in_extension;
+    return output_path.string();
+}
+
+std::unique_ptr<llvm::raw_fd_ostream> open_output(const std::string& in_path, const bool in_is_text) noexcept {
+    std::error_code error_code;
+    auto output = std::make_unique<llvm::raw_fd_ostream>(in_path, error_code, in_is_text ? llvm::sys::fs::OF_Text : llvm::sys::fs::OF_None);
+    if (error_code) {
+        console::WriteLine("could not open \"" + in_path + "\": " + error_code.message());
+        return nullptr;
+    }
+
+    output->SetBufferSize(OUTPUT_BUFFER_SIZE);
+    return output;
+}
+
+bool close_output(llvm::raw_fd_ostream& in_output, const std::string& in_path) noexcept {
+    in_output.close();
+    if (in_output.has_error()) {
+        console::WriteLine("could not write \"" + in_path + "\": " + in_output.error().message());
+        in_output.clear_error();
+        return false;
+    }
+    return true;
+}
+
+bool write_machine_code(llvm::Module& in_module, llvm::raw_pwrite_stream& in_output, const llvm::CodeGenFileType in_file_type) noexcept {
+    // modules are emitted from several threads
+    static std::once_flag targets_initialized;
+    std::call_once(targets_initialized, [] {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+    });
+
+    const std::string& target_triple = in_module.getTargetTriple();
+    std::string error_msg;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(target_triple, error_msg);
+    if (!target) {
+        console::WriteLine("could not find target \"" + target_triple + "\": " + error_msg);
+        return false;
+    }
+
+    llvm::TargetOptions target_options;
+    std::unique_ptr<llvm::TargetMachine> target_machine(
+        target->createTargetMachine(target_triple, "generic", "", target_options, llvm::Reloc::PIC_));
+    if (!target_machine) {
+        console::WriteLine("could not create a target machine for \"" + target_triple + "\"");
+        return false;
+    }
+    in_module.setDataLayout(target_machine->createDataLayout());
+
+    llvm::legacy::PassManager pass_manager;
+    if (target_machine->addPassesToEmitFile(pass_manager, in_output, nullptr, in_file_type)) {
+        console::WriteLine("target \"" + target_triple + "\" can not emit this file type");
+        return false;
+    }
+    pass_manager.run(in_module);
+    return true;
+}
+
+/*
+* Writes the textual IR compressed with zlib, it's meant to be archived.
+* The output is a plain zlib stream so any zlib tool can read it back.
+*/
+bool write_compressed_ir(const llvm::Module& in_module, const std::string& in_output_name, const BuildOptions& in_options) noexcept {
+    if (!llvm::zlib::isAvailable()) {
+        console::WriteLine("compressed IR requires LLVM built with zlib");
+        return false;
+    }
+
+    std::string module_ir;
+    llvm::raw_string_ostream ir_stream(module_ir);
+    in_module.print(ir_stream, nullptr);
+    ir_stream.flush();
+
+    llvm::SmallVector<char, 0> compressed_ir;
+    if (auto error = llvm::zlib::compress(module_ir, compressed_ir, llvm::zlib::BestSizeCompression)) {
+        console::WriteLine("could not compress the IR: " + llvm::toString(std::move(error)));
+        return false;
+    }
+
+    const std::string output_path = get_output_path(in_output_name, in_options, ".ll.z");
+    auto output = open_output(output_path, false);
+    if (!output) {
+        return false;
+    }
+    output->write(compressed_ir.data(), compressed_ir.size());
+    return close_output(*output, output_path);
+}
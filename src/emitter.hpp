@@ -0,0 +1,18 @@
+#pragma once
+#include "common_defs.hpp"
+#include <string>
+
+namespace llvm {
+    class Module;
+}
+struct BuildOptions;
+
+/*
+* Writes a generated module to disk in the format selected by the
+* build options (bitcode, textual IR, object file or assembly).
+*/
+namespace emitter {
+    // writes <output directory>/<in_output_name>.<ext>.
+    // returns false and prints the reason if the output could not be written
+    LL_NODISCARD bool write_module(llvm::Module& in_module, const std::string& in_output_name, const BuildOptions& in_options) noexcept;
+}
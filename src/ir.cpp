@@ -1,10 +1,17 @@
 #include "ir.hpp"
+#include <llvm/ADT/APSInt.h>
+#include <llvm/Bitcode/BitcodeReader.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 #include "console.hpp"
 #include "lexer.hpp"
+#include "types.hpp"
 
 static llvm::Constant* getConstantDefaultValue(const AstType& in_type, llvm::Type* in_llvm_type);
+static llvm::APInt bigint_to_apint(const BigInt& in_value, const uint32_t in_bit_size);
 
 static const char* GetDataLayout() {
     return "e-m:w-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128";
@@ -14,12 +21,13 @@ static const char * GetTargetTriple() {
     return "x86_64-pc-windows-msvc19.28.29913";
 }
 
-LlvmIrGenerator::LlvmIrGenerator(const std::string& _output_directory, const std::string& _executable_name) 
-: output_file_name(_executable_name), output_directory(_output_directory) {
+LlvmIrGenerator::LlvmIrGenerator(const std::string& _output_directory, const std::string& _executable_name, const LiteralPool& _literals) 
+: output_file_name(_executable_name), output_directory(_output_directory), literals(_literals) {
+    context = new llvm::LLVMContext();
     // create IR builder helper
-    builder = new llvm::IRBuilder<>(context);
+    builder = new llvm::IRBuilder<>(*context);
     // Make the module, which holds all the code.
-    code_module = new llvm::Module(output_file_name, context);
+    code_module = new llvm::Module(output_file_name, *context);
 
     auto dl = llvm::DataLayout(GetDataLayout());
     code_module->setDataLayout(dl);
@@ -29,17 +37,23 @@ LlvmIrGenerator::LlvmIrGenerator(const std::string& _output_directory, const std
 LlvmIrGenerator::~LlvmIrGenerator() {
     delete builder;
     delete code_module;
+    delete context;
 }
 
 void LlvmIrGenerator::generateFuncProto(const AstFuncProto& in_func_proto, AstFuncDef* in_function) {
+    // the analyzer only accepts repeated declarations with the same signature
+    if (!in_function && code_module->getFunction(std::string(in_func_proto.name))) {
+        return;
+    }
+
     // Function return type
-    llvm::Type* returnType = translateType(in_func_proto.return_type->ast_type);
+    llvm::Type* returnType = translateType(in_func_proto.return_type->ast_type.type_info);
 
     // Function parameters
     auto nodeParams = in_func_proto.params;
     std::vector<llvm::Type*> parameters;
     for (auto param : nodeParams) {
-        auto type = translateType(param->param_decl.type->ast_type);
+        auto type = translateType(param->param_decl.type->ast_type.type_info);
         parameters.push_back(type);
     }
 
@@ -49,7 +63,10 @@ void LlvmIrGenerator::generateFuncProto(const AstFuncProto& in_func_proto, AstFu
         : llvm::FunctionType::get(returnType, false);
 
     // Function linkage type
-    llvm::Function::LinkageTypes linkageType = llvm::Function::LinkageTypes::LinkOnceODRLinkage;
+    // functions without body are defined by another module
+    llvm::Function::LinkageTypes linkageType = in_function
+        ? llvm::Function::LinkageTypes::LinkOnceODRLinkage
+        : llvm::Function::LinkageTypes::ExternalLinkage;
 
     // Create the function
     llvm::Function* function = llvm::Function::Create(functionType, linkageType, std::string(in_func_proto.name), code_module);
@@ -62,14 +79,15 @@ void LlvmIrGenerator::generateFuncProto(const AstFuncProto& in_func_proto, AstFu
     
 }
 
-void LlvmIrGenerator::generateFuncBlock(const AstBlock& in_func_block, AstFuncDef& in_function) {
+bool LlvmIrGenerator::generateFuncBlock(const AstBlock& in_func_block, AstFuncDef& in_function) {
+    llvm::TimeTraceScope trace_scope("GenerateFunction", in_function.function->getName());
     // Create a new basic block to start insertion into.
-    llvm::BasicBlock* BB = llvm::BasicBlock::Create(context, "entry", in_function.function);
+    llvm::BasicBlock* BB = llvm::BasicBlock::Create(*context, "entry", in_function.function);
     builder->SetInsertPoint(BB);
 
     // Genereate body and finish the function with the return value
     uint32_t bit_size = in_function.proto->function_proto.return_type->ast_type.type_info->bit_size;
-    llvm::Value* retVal = llvm::ConstantInt::get(context, llvm::APInt(bit_size, std::stol("1"), false));
+    llvm::Value* retVal = llvm::ConstantInt::get(*context, llvm::APInt(bit_size, std::stol("1"), false));
 
     if (retVal)
         builder->CreateRet(retVal);
@@ -89,11 +107,14 @@ void LlvmIrGenerator::generateFuncBlock(const AstBlock& in_func_block, AstFuncDe
 
         // Error reading body, remove function.
         in_function.function->eraseFromParent();
+        in_function.function = nullptr;
+        return false;
     }
+    return true;
 }
 
 void LlvmIrGenerator::generateVarDef(const AstVarDef& in_var_def, const bool is_global) {
-    auto type = translateType(in_var_def.type->ast_type);
+    auto type = translateType(in_var_def.type->ast_type.type_info);
     std::string name = std::string(in_var_def.name);
 
     if (is_global) {
@@ -105,7 +126,8 @@ void LlvmIrGenerator::generateVarDef(const AstVarDef& in_var_def, const bool is_
         if (assignStmntNode) {
             auto& assignStmnt = assignStmntNode->binary_expr;
             assert(assignStmnt.bin_op == BinaryExprType::ASSIGN);
-            init_value = translateConstant(assignStmnt.op2->symbol);
+            assert(assignStmnt.op2->node_type == AstNodeType::AstSymbol);
+            init_value = translateConstant(assignStmnt.op2->symbol, in_var_def.type->ast_type, type);
         } else {
             init_value = getConstantDefaultValue(in_var_def.type->ast_type, type);
         }
@@ -124,81 +146,209 @@ void LlvmIrGenerator::generateVarDef(const AstVarDef& in_var_def, const bool is_
     }
 }
 
-void LlvmIrGenerator::flush() {
-#ifdef _DEBUG
-    console::WriteLine();
-    code_module->dump();
-#endif
+void LlvmIrGenerator::generateExternFuncDecl(std::string_view in_name, const TypeInfo* in_return_type, const std::vector<const TypeInfo*>& in_param_types) {
+    // declared by another loaded module already
+    if (code_module->getFunction(std::string(in_name))) {
+        return;
+    }
 
-    std::error_code error_code;
-    auto llvm_output_file = llvm::raw_fd_ostream(output_directory + output_file_name + ".bc", error_code);
+    std::vector<llvm::Type*> parameters;
+    for (auto param_type : in_param_types) {
+        parameters.push_back(translateType(param_type));
+    }
 
-    llvm::WriteBitcodeToFile(*code_module, llvm_output_file);
+    llvm::FunctionType* functionType = llvm::FunctionType::get(translateType(in_return_type), parameters, false);
+    llvm::Function* function = llvm::Function::Create(functionType, llvm::Function::LinkageTypes::ExternalLinkage, std::string(in_name), code_module);
+    function->setCallingConv(llvm::CallingConv::C);
+}
 
-    llvm_output_file.flush();
-    llvm_output_file.close();
+void LlvmIrGenerator::generateExternVarDecl(std::string_view in_name, const TypeInfo* in_type) {
+    // without initializer it's a declaration
+    code_module->getOrInsertGlobal(std::string(in_name), translateType(in_type));
 }
 
-llvm::Type* LlvmIrGenerator::translateType(AstType& in_type) {
-    switch (in_type.type_id) {
+std::string LlvmIrGenerator::getFunctionBitcode(const AstFuncDef& in_function) {
+    // everything else is cloned as a declaration
+    llvm::ValueToValueMapTy value_map;
+    auto function_module = llvm::CloneModule(*code_module, value_map, [&](const llvm::GlobalValue* in_global) {
+        return in_global == in_function.function;
+    });
+
+    std::string bitcode;
+    llvm::raw_string_ostream bitcode_stream(bitcode);
+    llvm::WriteBitcodeToFile(*function_module, bitcode_stream);
+    bitcode_stream.flush();
+    return bitcode;
+}
+
+bool LlvmIrGenerator::linkFunctionBitcode(AstFuncDef& in_function, const llvm::MemoryBuffer& in_bitcode) {
+    auto function_module = llvm::parseBitcodeFile(in_bitcode.getMemBufferRef(), *context);
+    if (!function_module) {
+        llvm::consumeError(function_module.takeError());
+        return false;
+    }
+
+    const std::string name = in_function.function->getName().str();
+    if (llvm::Linker::linkModules(*code_module, std::move(*function_module))) {
+        return false;
+    }
+
+    // the linker replaces the declaration with the linked definition
+    in_function.function = code_module->getFunction(name);
+    return true;
+}
+
+std::unique_ptr<llvm::Module> LlvmIrGenerator::release_module(std::unique_ptr<llvm::LLVMContext>& out_context) {
+    std::unique_ptr<llvm::Module> module(code_module);
+    out_context.reset(context);
+
+    delete builder;
+    builder = nullptr;
+    code_module = nullptr;
+    context = nullptr;
+
+    return module;
+}
+
+llvm::Type* LlvmIrGenerator::translateType(const TypeInfo* in_type_info) {
+    // types interned after the last resize
+    if (in_type_info->id >= llvm_types.size()) {
+        llvm_types.resize(types::get_type_count(), nullptr);
+    }
+
+    if (!llvm_types[in_type_info->id]) {
+        // not kept as a reference, translating the element type might resize the vector
+        llvm::Type* llvm_type = createType(in_type_info);
+        llvm_types[in_type_info->id] = llvm_type;
+    }
+    return llvm_types[in_type_info->id];
+}
+
+llvm::Type* LlvmIrGenerator::createType(const TypeInfo* in_type_info) {
+    switch (in_type_info->type_id) {
     case AstTypeId::Void:
-        return llvm::Type::getVoidTy(context);
+        return llvm::Type::getVoidTy(*context);
     case AstTypeId::Bool:
-        return llvm::Type::getInt1Ty(context);
+        return llvm::Type::getInt1Ty(*context);
     case AstTypeId::Integer:
-        switch (in_type.type_info->bit_size) {
-        case 8:
-            return llvm::Type::getInt8Ty(context);
-        case 16:
-            return llvm::Type::getInt16Ty(context);
-        case 32:
-            return llvm::Type::getInt32Ty(context);
-        case 64:
-            return llvm::Type::getInt64Ty(context);
-        case 128:
-            return llvm::Type::getInt128Ty(context);
-        default:
-            UNREACHEABLE;
-        } break;
+        return llvm::Type::getIntNTy(*context, in_type_info->bit_size);
     case AstTypeId::FloatingPoint:
-        if (in_type.type_info->bit_size == 32)
-            return llvm::Type::getFloatTy(context);
-        if (in_type.type_info->bit_size == 64)
-            return llvm::Type::getDoubleTy(context);
-        if (in_type.type_info->bit_size == 128)
-            return llvm::Type::getFP128Ty(context);
-        LL_FALLTHROUGH
+        if (in_type_info->bit_size == 32)
+            return llvm::Type::getFloatTy(*context);
+        if (in_type_info->bit_size == 64)
+            return llvm::Type::getDoubleTy(*context);
+        if (in_type_info->bit_size == 128)
+            return llvm::Type::getFP128Ty(*context);
+        UNREACHEABLE;
+    case AstTypeId::Pointer: {
+        // llvm has no void pointers
+        if (in_type_info->element_type->type_id == AstTypeId::Void)
+            return llvm::Type::getInt8PtrTy(*context);
+        return llvm::PointerType::getUnqual(translateType(in_type_info->element_type));
+    }
     default:
+        // TODO: arrays need a length and structs a declaration
         UNREACHEABLE;
     }
 }
 
-llvm::Constant* LlvmIrGenerator::translateConstant(AstSymbol& in_symbol) {
+llvm::Constant* LlvmIrGenerator::translateConstant(const AstSymbol& in_symbol, const AstType& in_type, llvm::Type* in_llvm_type) {
     TokenId r_value_type = in_symbol.token->id;
-    if (r_value_type == TokenId::INT_LIT) {
-        const BigInt& int_val = in_symbol.token->int_lit;
-        llvm::Constant* constant;
-        return constant;
+    if (r_value_type == TokenId::INT_LIT || r_value_type == TokenId::UNICODE_CHAR) {
+        BigInt int_val;
+        if (r_value_type == TokenId::INT_LIT)
+            int_val = literals.get_int(in_symbol.token->int_lit);
+        else
+            bigint_init_unsigned(&int_val, in_symbol.token->char_lit);
+
+        if (in_type.type_id == AstTypeId::FloatingPoint) {
+            llvm::APFloat float_val(in_llvm_type->getFltSemantics());
+            llvm::APInt apint_val = bigint_to_apint(int_val, std::max<uint32_t>(int_val.digit_count, 1) * 64 + 1);
+            float_val.convertFromAPInt(apint_val, true, llvm::APFloat::rmNearestTiesToEven);
+            return llvm::ConstantFP::get(*context, float_val);
+        }
+
+        // a sized literal is a value of its own type, the lexer checked it fits
+        const LiteralType lit_type = r_value_type == TokenId::INT_LIT ? in_symbol.token->lit_type : LiteralType::None;
+        const uint32_t literal_bit_size = literal_type_bit_size(lit_type);
+        if (literal_bit_size != 0) {
+            const llvm::APInt literal_val = bigint_to_apint(int_val, literal_bit_size);
+            return llvm::ConstantInt::get(*context, literal_type_is_signed(lit_type)
+                ? literal_val.sextOrTrunc(in_type.type_info->bit_size)
+                : literal_val.zextOrTrunc(in_type.type_info->bit_size));
+        }
+
+        // the value is truncated to the type size
+        return llvm::ConstantInt::get(*context, bigint_to_apint(int_val, in_type.type_info->bit_size));
     }
     else if (r_value_type == TokenId::FLOAT_LIT) {
-        const BigFloat& float_val = in_symbol.token->float_lit;
-        llvm::Constant* constant;
-        return constant;
-    }
-    else if (r_value_type == TokenId::UNICODE_CHAR) {
-        const uint32_t char_val = in_symbol.token->char_lit;
-        llvm::Constant* constant;
-        return constant;
+        // the literal was rounded to each type from its text, binary128 v[0] holds the low bits
+        const BigFloat& literal = literals.get_float(in_symbol.token->float_lit);
+        llvm::APFloat float_val(llvm::APFloat::IEEEquad(), llvm::APInt(128, { literal.value.v[0], literal.value.v[1] }));
+
+        if (in_type.type_id == AstTypeId::FloatingPoint) {
+            switch (in_type.type_info->bit_size) {
+            case 32:
+                return llvm::ConstantFP::get(*context, llvm::APFloat(llvm::APFloat::IEEEsingle(), llvm::APInt(32, literal.f32_bits)));
+            case 64:
+                return llvm::ConstantFP::get(*context, llvm::APFloat(llvm::APFloat::IEEEdouble(), llvm::APInt(64, literal.f64_bits)));
+            default:
+                bool loses_info;
+                float_val.convert(in_llvm_type->getFltSemantics(), llvm::APFloat::rmNearestTiesToEven, &loses_info);
+                return llvm::ConstantFP::get(*context, float_val);
+            }
+        }
+
+        // the fractional part is discarded
+        llvm::APSInt int_val(in_type.type_info->bit_size, !in_type.type_info->is_signed);
+        bool is_exact;
+        float_val.convertToInteger(int_val, llvm::APFloat::rmTowardZero, &is_exact);
+        return llvm::ConstantInt::get(*context, int_val);
     }
     else if (r_value_type == TokenId::STRING) {
-        // TODO: add support for strings
-        UNREACHEABLE;
+        // the address of the first byte
+        llvm::GlobalVariable* string_global = translateString(in_symbol.token->string_lit);
+        llvm::Constant* zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0);
+        llvm::Constant* indices[] = { zero, zero };
+        llvm::Constant* first_byte = llvm::ConstantExpr::getInBoundsGetElementPtr(string_global->getValueType(), string_global, indices);
+        return llvm::ConstantExpr::getPointerCast(first_byte, in_llvm_type);
     }
  
     // wrong token
     UNREACHEABLE;
 }
 
+llvm::GlobalVariable* LlvmIrGenerator::translateString(uint32_t in_string_lit) {
+    // strings added after the last resize
+    if (in_string_lit >= string_globals.size()) {
+        string_globals.resize(literals.get_string_count(), nullptr);
+    }
+
+    llvm::GlobalVariable*& string_global = string_globals[in_string_lit];
+    if (!string_global) {
+        // equal strings share the pool entry, so each one is emitted once. the address is not significant, llvm may merge them further
+        const std::string_view value = literals.get_string(in_string_lit);
+        llvm::Constant* bytes = llvm::ConstantDataArray::getString(*context, llvm::StringRef(value.data(), value.size()), true);
+        string_global = new llvm::GlobalVariable(*code_module, bytes->getType(), true, llvm::GlobalValue::PrivateLinkage, bytes, ".str");
+        string_global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+        string_global->setAlignment(llvm::Align(1));
+    }
+    return string_global;
+}
+
+llvm::APInt bigint_to_apint(const BigInt& in_value, const uint32_t in_bit_size) {
+    if (in_value.digit_count == 0) {
+        return llvm::APInt(in_bit_size, 0);
+    }
+
+    // extra digits are dropped
+    llvm::APInt value(in_bit_size, llvm::ArrayRef<uint64_t>(bigint_ptr(&in_value), in_value.digit_count));
+    if (in_value.is_negative) {
+        value.negate();
+    }
+    return value;
+}
+
 llvm::Constant* getConstantDefaultValue(const AstType& in_type, llvm::Type* in_llvm_type) {
     switch (in_type.type_id) {
     case AstTypeId::Bool:
@@ -206,6 +356,8 @@ llvm::Constant* getConstantDefaultValue(const AstType& in_type, llvm::Type* in_l
             return llvm::ConstantInt::get(in_llvm_type, 0, in_type.type_info->is_signed);
     case AstTypeId::FloatingPoint:
             return llvm::ConstantFP::get(in_llvm_type, 0.0);
+    case AstTypeId::Pointer:
+            return llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(in_llvm_type));
     case AstTypeId::Void:
     default:
         UNREACHEABLE;
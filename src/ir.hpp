@@ -1,6 +1,9 @@
 #pragma once
+#include <memory>
 #include <string>
+#include <vector>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include "ast_nodes.hpp"
 
 
@@ -8,25 +11,47 @@
 * Translates the AST to LLVM intermediate representation
 */
 class LlvmIrGenerator {
-    llvm::LLVMContext   context;
+    llvm::LLVMContext*  context;
     llvm::IRBuilder<>*  builder;
     // outputs one llvm module per executable
     llvm::Module*       code_module;
+    // translated types indexed by TypeInfo::id, they belong to this context
+    std::vector<llvm::Type*> llvm_types;
+    // one private global per string of the literal pool, created the first time it's used
+    std::vector<llvm::GlobalVariable*> string_globals;
 
     const std::string&  output_file_name;
     const std::string&  output_directory;
+    const LiteralPool&  literals;   // of the module being translated
 
 public:
-    LlvmIrGenerator(const std::string& _output_directory, const std::string& _executable_name);
+    LlvmIrGenerator(const std::string& _output_directory, const std::string& _executable_name, const LiteralPool& _literals);
     ~LlvmIrGenerator();
     
     void generateFuncProto(const AstFuncProto& in_func_proto, AstFuncDef* in_function);
-    void generateFuncBlock(const AstBlock& in_func_block, AstFuncDef& in_function);
+    // returns false if the body was invalid and the function was removed
+    bool generateFuncBlock(const AstBlock& in_func_block, AstFuncDef& in_function);
     void generateVarDef(const AstVarDef& in_var_def, const bool is_global);
-    void flush();
+    // declarations of the symbols defined by another module
+    void generateExternFuncDecl(std::string_view in_name, const TypeInfo* in_return_type, const std::vector<const TypeInfo*>& in_param_types);
+    void generateExternVarDecl(std::string_view in_name, const TypeInfo* in_type);
+
+    // Serialized module with in_function as the only definition.
+    std::string getFunctionBitcode(const AstFuncDef& in_function);
+    // Links a definition written by getFunctionBitcode in place of the function declaration.
+    // returns false if the bitcode is not valid.
+    bool linkFunctionBitcode(AstFuncDef& in_function, const llvm::MemoryBuffer& in_bitcode);
+
+    // Hands the module and its context to the caller (e.g. the JIT).
+    // The generator can not be used after this.
+    std::unique_ptr<llvm::Module> release_module(std::unique_ptr<llvm::LLVMContext>& out_context);
 
 private:
-    llvm::Type* translateType(AstType& in_type);
-    llvm::Constant* translateConstant(AstSymbol& in_symbol);
+    // memoized, the type is only created the first time
+    llvm::Type* translateType(const TypeInfo* in_type_info);
+    llvm::Type* createType(const TypeInfo* in_type_info);
+    llvm::Constant* translateConstant(const AstSymbol& in_symbol, const AstType& in_type, llvm::Type* in_llvm_type);
+    // memoized, the global with the null terminated bytes of the string literal
+    llvm::GlobalVariable* translateString(uint32_t in_string_lit);
 
 };
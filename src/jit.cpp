@@ -0,0 +1,98 @@
+#include "jit.hpp"
+#include "common_defs.hpp"
+#include "console.hpp"
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/TargetSelect.h>
+
+static bool is_valid_entry_point(const llvm::Function* in_function);
+static int call_entry_point(const llvm::Type* in_return_type, llvm::JITTargetAddress in_address);
+
+int jit::run(std::vector<JitModule> in_modules, const std::string& in_entry_point) {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    // the modules must be destroyed before their contexts, so pair them right away
+    std::vector<llvm::Module*> code_modules;
+    std::vector<llvm::orc::ThreadSafeModule> thread_safe_modules;
+    for (auto& jit_module : in_modules) {
+        code_modules.push_back(jit_module.code_module.get());
+        thread_safe_modules.emplace_back(std::move(jit_module.code_module), std::move(jit_module.context));
+    }
+
+    llvm::Function* entry_function = nullptr;
+    for (auto code_module : code_modules) {
+        llvm::Function* function = code_module->getFunction(in_entry_point);
+        if (function && !function->isDeclaration()) {
+            entry_function = function;
+            break;
+        }
+    }
+    if (!entry_function) {
+        console::WriteLine("entry point \"" + in_entry_point + "\" not found");
+        return -1;
+    }
+    if (!is_valid_entry_point(entry_function)) {
+        console::WriteLine("entry point \"" + in_entry_point + "\" must take no parameters and return void or an integer up to 64 bits");
+        return -1;
+    }
+    llvm::Type* return_type = entry_function->getReturnType();
+
+    auto lazy_jit = llvm::orc::LLLazyJITBuilder().create();
+    if (!lazy_jit) {
+        console::WriteLine("could not create the JIT: " + llvm::toString(lazy_jit.takeError()));
+        return -1;
+    }
+
+    for (size_t i = 0; i < thread_safe_modules.size(); i++) {
+        // the generator targets a fixed triple, run with the host one.
+        code_modules[i]->setDataLayout((*lazy_jit)->getDataLayout());
+        code_modules[i]->setTargetTriple((*lazy_jit)->getTargetTriple().str());
+
+        if (auto error = (*lazy_jit)->addLazyIRModule(std::move(thread_safe_modules[i]))) {
+            console::WriteLine("could not add the module to the JIT: " + llvm::toString(std::move(error)));
+            return -1;
+        }
+    }
+
+    auto entry_symbol = (*lazy_jit)->lookup(in_entry_point);
+    if (!entry_symbol) {
+        console::WriteLine("could not resolve \"" + in_entry_point + "\": " + llvm::toString(entry_symbol.takeError()));
+        return -1;
+    }
+
+    // return_type is owned by the context that now lives inside the JIT
+    return call_entry_point(return_type, entry_symbol->getAddress());
+}
+
+bool is_valid_entry_point(const llvm::Function* in_function) {
+    const llvm::Type* return_type = in_function->getReturnType();
+    if (in_function->arg_size() != 0) {
+        return false;
+    }
+    return return_type->isVoidTy() || (return_type->isIntegerTy() && return_type->getIntegerBitWidth() <= 64);
+}
+
+int call_entry_point(const llvm::Type* in_return_type, llvm::JITTargetAddress in_address) {
+    if (in_return_type->isVoidTy()) {
+        llvm::jitTargetAddressToFunction<void(*)()>(in_address)();
+        return 0;
+    }
+
+    // the callee only defines the bits of its own return type
+    switch (in_return_type->getIntegerBitWidth()) {
+    case 1:
+        return llvm::jitTargetAddressToFunction<bool(*)()>(in_address)();
+    case 8:
+        return llvm::jitTargetAddressToFunction<int8_t(*)()>(in_address)();
+    case 16:
+        return llvm::jitTargetAddressToFunction<int16_t(*)()>(in_address)();
+    case 32:
+        return llvm::jitTargetAddressToFunction<int32_t(*)()>(in_address)();
+    case 64:
+        return (int)llvm::jitTargetAddressToFunction<int64_t(*)()>(in_address)();
+    default:
+        UNREACHEABLE;
+    }
+}
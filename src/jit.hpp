@@ -0,0 +1,26 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+    class LLVMContext;
+    class Module;
+}
+
+/*
+* Runs a generated module in-process with the ORC lazy JIT.
+* Functions are compiled the first time they get called, so only
+* the code that actually executes pays for code generation.
+*/
+namespace jit {
+    // a generated module with the context it was created in
+    struct JitModule {
+        std::unique_ptr<llvm::LLVMContext> context;
+        std::unique_ptr<llvm::Module>      code_module;
+    };
+
+    // links every module in the JIT and calls in_entry_point.
+    // returns the entry point return value or -1 if it could not be executed
+    int run(std::vector<JitModule> in_modules, const std::string& in_entry_point);
+}
@@ -1,8 +1,13 @@
 #include "lexer.hpp"
+#include "utf8.hpp"
 #include <fstream>
 #include <cassert>
+#include <algorithm>
 #include <cstdarg>
 #include <unordered_map>
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 
 #define WHITESPACE\
         ' ':\
@@ -101,11 +106,13 @@ static bool is_symbol_char(uint8_t c);
 static bool is_reserved_char(uint8_t c);
 static bool is_float_specifier(uint8_t c);
 static bool is_sign_or_type_specifier(uint8_t c);
+static LiteralType add_literal_specifier(LiteralType in_type, uint8_t c);
 static bool is_exponent_signifier(uint8_t c, int radix);
+static void find_line_starts(const std::string& in_source, std::vector<size_t>& out_line_starts);
 
 Lexer::Lexer(const std::string& _file_name, std::vector<Error>& _errors)
     : file_name(_file_name), errors(_errors), cursor_pos(0L), curr_index(SIZE_MAX),
-    curr_line(0L), curr_column(0L), state(TokenizerState::Start),
+    curr_line(0L), state(TokenizerState::Start),
     radix(10), is_trailing_underscore(false), is_invalid_token(false),
     curr_token(), tokens_vec(), comments_vec()
 {
@@ -129,7 +136,7 @@ Lexer::Lexer(const std::string& _file_name, std::vector<Error>& _errors)
 
 Lexer::Lexer(const std::string& _src_file, const std::string& _file_name, std::vector<Error>& _errors)
     : file_name(_file_name), source(_src_file), errors(_errors), cursor_pos(0L), curr_index(SIZE_MAX),
-    curr_line(0L), curr_column(0L), state(TokenizerState::Start),
+    curr_line(0L), state(TokenizerState::Start),
     radix(10), is_trailing_underscore(false), is_invalid_token(false),
     curr_token(), tokens_vec(), comments_vec()
 {}
@@ -137,6 +144,17 @@ Lexer::Lexer(const std::string& _src_file, const std::string& _file_name, std::v
 // IMPORTANT!: should not be called more than once after the constructor.
 void Lexer::tokenize() noexcept
 {
+    find_line_starts(source, line_starts);
+
+    // the states below decode code points without checking them again
+    const size_t invalid_pos = utf8_validate((const uint8_t*)source.data(), source.size());
+    if (invalid_pos != source.size()) {
+        invalid_utf8_error(invalid_pos);
+        begin_token(TokenId::_EOF);
+        end_token();
+        return;
+    }
+
     // reading file while no errors in it
     for (/*cursor_pos = 0*/; cursor_pos < source.size(); cursor_pos++) {
         unsigned char c = source[cursor_pos];
@@ -164,19 +182,20 @@ void Lexer::tokenize() noexcept
                 begin_token(TokenId::INT_LIT);
                 is_trailing_underscore = false;
                 radix = 10;
-                bigint_init_unsigned(&curr_token.int_lit, 0);
+                literal_digits.clear();
                 break;
             case DIGIT_NON_ZERO:
                 state = TokenizerState::Number;
                 begin_token(TokenId::INT_LIT);
                 is_trailing_underscore = false;
                 radix = 10;
-                bigint_init_unsigned(&curr_token.int_lit, get_digit_value(c));
+                literal_digits.assign(1, get_digit_value(c));
                 break;
                 // we found the beginning of a string literal
             case '"':
                 begin_token(TokenId::STRING);
                 state = TokenizerState::String;
+                string_bytes.clear();
                 break;
                 // we found the beginning of a char literal
             case '\'':
@@ -267,6 +286,7 @@ void Lexer::tokenize() noexcept
             case '.':
                 begin_token(TokenId::FLOAT_LIT);
                 state = TokenizerState::NumberDot;
+                radix = 10;
                 break;
             case '!':
                 begin_token(TokenId::NOT);
@@ -463,6 +483,7 @@ void Lexer::tokenize() noexcept
             uint32_t digit_value = get_digit_value(c);
             if (digit_value >= radix) {
                 if (is_sign_or_type_specifier(c)) {
+                    curr_token.lit_type = add_literal_specifier(LiteralType::None, c);
                     state = TokenizerState::SawSignOrTypeSpec;
                     break;
                 }
@@ -490,21 +511,24 @@ void Lexer::tokenize() noexcept
                     continue;
                 }
             }
-            BigInt digit_value_bi;
-            bigint_init_unsigned(&digit_value_bi, digit_value);
-
-            BigInt radix_bi;
-            bigint_init_unsigned(&radix_bi, radix);
-
-            BigInt multiplied;
-            bigint_mul(&multiplied, &curr_token.int_lit, &radix_bi);
+            uint64_t carry = bigint_digits_mul_add(literal_digits.data(), literal_digits.size(), radix, digit_value);
+            if (carry != 0) {
+                literal_digits.push_back(carry);
+            }
 
-            bigint_add(&curr_token.int_lit, &multiplied, &digit_value_bi);
-            
             break;
         }
         case TokenizerState::SawSignOrTypeSpec:
             if (is_sign_or_type_specifier(c)) {
+                // only a size can follow the u
+                const LiteralType lit_type = add_literal_specifier(curr_token.lit_type, c);
+                if (lit_type == LiteralType::None) {
+                    invalid_char_error(c);
+                    is_invalid_token = true;
+                    state = TokenizerState::Symbol;
+                    break;
+                }
+                curr_token.lit_type = lit_type;
                 end_token();
                 state = TokenizerState::Start;
                 break;
@@ -755,6 +779,12 @@ void Lexer::tokenize() noexcept
                 state = TokenizerState::StringEscape;
                 break;
             default:
+            {
+                // copy the bytes up to the next quote, escape or newline at once
+                const size_t run_end = std::min(source.find_first_of("\"\\\n", cursor_pos), source.size());
+                string_bytes.append(source, cursor_pos, run_end - cursor_pos);
+                cursor_pos = run_end - 1;
+            }
                 break;
             }
             break;
@@ -768,45 +798,19 @@ void Lexer::tokenize() noexcept
             else if (c == '\\') {
                 state = TokenizerState::StringEscape;
             }
-            else if ((c >= 0x80 && c <= 0xbf) || c >= 0xf8) {
-                // 10xxxxxx
-                // 11111xxx
-                invalid_char_error(c);
-            }
-            else if (c >= 0xc0 && c <= 0xdf) {
-                // 110xxxxx
-                curr_token.char_lit = c & 0x1f;
-                remaining_code_units = 1;
-                state = TokenizerState::CharLiteralUnicode;
-            }
-            else if (c >= 0xe0 && c <= 0xef) {
-                // 1110xxxx
-                curr_token.char_lit = c & 0x0f;
-                remaining_code_units = 2;
-                state = TokenizerState::CharLiteralUnicode;
-            }
-            else if (c >= 0xf0 && c <= 0xf7) {
-                // 11110xxx
-                curr_token.char_lit = c & 0x07;
-                remaining_code_units = 3;
-                state = TokenizerState::CharLiteralUnicode;
+            else if (c >= 0x80) {
+                // the source is valid, the whole code point is read at once
+                const size_t length = utf8_decode((const uint8_t*)source.data() + cursor_pos,
+                    source.size() - cursor_pos, &curr_token.char_lit);
+                assert(length != 0);
+                cursor_pos += length - 1;
+                state = TokenizerState::CharLiteralEnd;
             }
             else {
                 curr_token.char_lit = c;
                 state = TokenizerState::CharLiteralEnd;
             }
             break;
-        case TokenizerState::CharLiteralUnicode:
-            if (c <= 0x7f || c >= 0xc0) {
-                invalid_char_error(c);
-            }
-            curr_token.char_lit <<= 6;
-            curr_token.char_lit += c & 0x3f;
-            remaining_code_units--;
-            if (remaining_code_units == 0) {
-                state = TokenizerState::CharLiteralEnd;
-            }
-            break;
         case TokenizerState::CharLiteralEnd:
             switch (c) {
             case '\'':
@@ -875,40 +879,20 @@ void Lexer::tokenize() noexcept
                     tokenize_error("unicode value out of range: %x", char_code);
                     break;
                 }
+                if (char_code >= 0xd800 && char_code <= 0xdfff) {
+                    tokenize_error("unicode surrogate is not a character: %x", char_code);
+                    break;
+                }
                 if (curr_token.id == TokenId::UNICODE_CHAR) {
                     curr_token.char_lit = char_code;
                     state = TokenizerState::CharLiteralEnd;
                 }
-                else if (char_code <= 0x7f) {
-                    // 00000000 00000000 00000000 0xxxxxxx
-                    handle_string_escape((uint8_t)char_code);
-                }
-                else if (char_code <= 0x7ff) {
-                    // 00000000 00000000 00000xxx xx000000
-                    handle_string_escape((uint8_t)(0xc0 | (char_code >> 6)));
-                    // 00000000 00000000 00000000 00xxxxxx
-                    handle_string_escape((uint8_t)(0x80 | (char_code & 0x3f)));
-                }
-                else if (char_code <= 0xffff) {
-                    // 00000000 00000000 xxxx0000 00000000
-                    handle_string_escape((uint8_t)(0xe0 | (char_code >> 12)));
-                    // 00000000 00000000 0000xxxx xx000000
-                    handle_string_escape((uint8_t)(0x80 | ((char_code >> 6) & 0x3f)));
-                    // 00000000 00000000 00000000 00xxxxxx
-                    handle_string_escape((uint8_t)(0x80 | (char_code & 0x3f)));
-                }
-                else if (char_code <= 0x10ffff) {
-                    // 00000000 000xxx00 00000000 00000000
-                    handle_string_escape((uint8_t)(0xf0 | (char_code >> 18)));
-                    // 00000000 000000xx xxxx0000 00000000
-                    handle_string_escape((uint8_t)(0x80 | ((char_code >> 12) & 0x3f)));
-                    // 00000000 00000000 0000xxxx xx000000
-                    handle_string_escape((uint8_t)(0x80 | ((char_code >> 6) & 0x3f)));
-                    // 00000000 00000000 00000000 00xxxxxx
-                    handle_string_escape((uint8_t)(0x80 | (char_code & 0x3f)));
-                }
                 else {
-                    UNREACHEABLE;
+                    uint8_t bytes[4];
+                    const size_t length = utf8_encode(char_code, bytes);
+                    for (size_t i = 0; i < length; i++) {
+                        handle_string_escape(bytes[i]);
+                    }
                 }
                 break;
             }
@@ -1009,13 +993,6 @@ void Lexer::tokenize() noexcept
             UNREACHEABLE;
             break;
         }
-
-        // Handle end of line
-        if (c == '\n')
-            reset_line();
-        // else we just move a column
-        else
-            curr_column++;
     }
     cursor_pos--;
 
@@ -1085,6 +1062,11 @@ const bool Lexer::has_tokens() const noexcept
     return tokens_vec.size() - (curr_index + 1)  != 0;
 }
 
+size_t Lexer::get_token_count() const noexcept
+{
+    return tokens_vec.size();
+}
+
 const Token& Lexer::get_previous_token() const noexcept
 {
     // TODO: insert return statement here
@@ -1106,14 +1088,30 @@ std::string_view Lexer::get_token_value(const Token& token) const noexcept
     return std::string_view(source.begin() + token.start_pos, source.begin() + token.end_pos + 1);
 }
 
+size_t Lexer::line_of(size_t in_offset) const noexcept
+{
+    const size_t offset = std::min(in_offset, source.size());
+    return size_t(std::upper_bound(line_starts.begin(), line_starts.end(), offset) - line_starts.begin()) - 1;
+}
+
+size_t Lexer::column_of(size_t in_offset) const noexcept
+{
+    const size_t offset = std::min(in_offset, source.size());
+    return offset - line_starts[line_of(offset)];
+}
+
 void Lexer::begin_token(const TokenId id) noexcept
 {
     curr_token = Token();
     curr_token.id = id;
-    curr_token.start_line = curr_line;
-    curr_token.start_column = curr_column;
     curr_token.start_pos = cursor_pos;
-    curr_token.file_name = file_name;
+
+    // tokens begin in order, so the line only moves forward. EOF of an empty source is past the end
+    const size_t pos = std::min(cursor_pos, source.size());
+    while (curr_line + 1 < line_starts.size() && line_starts[curr_line + 1] <= pos)
+        curr_line++;
+    curr_token.start_line = curr_line;
+    curr_token.start_column = pos - line_starts[curr_line];
 }
 
 void Lexer::set_token_id(const TokenId id) noexcept
@@ -1124,6 +1122,31 @@ void Lexer::set_token_id(const TokenId id) noexcept
 void Lexer::end_token() noexcept {
     curr_token.end_pos = cursor_pos;
 
+    // the value is kept once the literal is complete
+    if (curr_token.id == TokenId::INT_LIT) {
+        curr_token.int_lit = literals.add_int(literal_digits.data(), literal_digits.size(), false);
+
+        // literals are never negative, a signed one goes up to the magnitude of its minimum so it can be negated.
+        // the folder reports it if it's not
+        const uint32_t bit_size = literal_type_bit_size(curr_token.lit_type);
+        if (bit_size != 0) {
+            BigInt max_magnitude;
+            bigint_init_unsigned(&max_magnitude, literal_type_is_signed(curr_token.lit_type)
+                ? uint64_t(1) << (bit_size - 1)
+                : (uint64_t(1) << bit_size) - 1);
+            if (bigint_cmp(&literals.get_int(curr_token.int_lit), &max_magnitude) == CmpGT) {
+                errors.push_back(Error(ERROR_TYPE::ERROR, curr_token.start_line, curr_token.start_column, file_name,
+                    "integer literal " + std::string(get_token_value(curr_token)) + " doesn't fit in " + literal_type_name(curr_token.lit_type)));
+            }
+        }
+    } else if (curr_token.id == TokenId::STRING) {
+        curr_token.string_lit = literals.add_string(string_bytes);
+    } else if (curr_token.id == TokenId::FLOAT_LIT) {
+        BigFloat value;
+        bigfloat_init_buf(&value, (const uint8_t*)source.data() + curr_token.start_pos, curr_token.end_pos + 1 - curr_token.start_pos);
+        curr_token.float_lit = literals.add_float(value);
+    }
+
     switch (curr_token.id) {
     case TokenId::DOC_COMMENT:
         comments_vec.push_back(curr_token);
@@ -1153,9 +1176,10 @@ void Lexer::end_token_check_is_keyword() noexcept
     }
 }
 
-void Lexer::reset_line() noexcept {
-    curr_line++;
-    curr_column = 0;
+void Lexer::invalid_utf8_error(size_t in_pos) noexcept {
+    char msg[64];
+    snprintf(msg, sizeof(msg), "invalid UTF-8 byte: '\\x%02x'", (uint8_t)source[in_pos]);
+    errors.push_back(Error(ERROR_TYPE::ERROR, line_of(in_pos), column_of(in_pos), file_name, msg));
 }
 
 void Lexer::invalid_char_error(uint8_t c) noexcept {
@@ -1198,8 +1222,8 @@ void Lexer::tokenize_error(const char* format, ...) noexcept {
     va_end(ap);
 
     Error error(ERROR_TYPE::ERROR,
-        curr_line,
-        curr_column,
+        line_of(cursor_pos),
+        column_of(cursor_pos),
         file_name, msg);
 
     errors.push_back(error);
@@ -1212,7 +1236,7 @@ void Lexer::handle_string_escape(uint8_t c) noexcept {
         state = TokenizerState::CharLiteralEnd;
     }
     else if (curr_token.id == TokenId::STRING) {
-        
+        string_bytes.push_back(char(c));
         state = TokenizerState::String;
     }
     else {
@@ -1286,6 +1310,27 @@ bool is_sign_or_type_specifier(uint8_t c) {
     }
 }
 
+// the type of a literal with the suffix in_type followed by c, None if c can't follow in_type
+LiteralType add_literal_specifier(LiteralType in_type, uint8_t c) {
+    const bool is_unsigned = in_type == LiteralType::Unsigned;
+    if (in_type != LiteralType::None && !is_unsigned) {
+        return LiteralType::None;
+    }
+
+    switch (c) {
+    case 'u':
+        return is_unsigned ? LiteralType::None : LiteralType::Unsigned;
+    case 'b':
+        return is_unsigned ? LiteralType::U8 : LiteralType::I8;
+    case 'w':
+        return is_unsigned ? LiteralType::U16 : LiteralType::I16;
+    case 'l':
+        return is_unsigned ? LiteralType::U32 : LiteralType::I32;
+    default:
+        UNREACHEABLE;
+    }
+}
+
 bool is_exponent_signifier(uint8_t c, int radix) {
     if (radix == 16) {
         return c == 'p' || c == 'P';
@@ -1295,6 +1340,47 @@ bool is_exponent_signifier(uint8_t c, int radix) {
     }
 }
 
+#if defined(__x86_64__) || defined(_M_X64)
+static unsigned count_trailing_zeros(unsigned x) {
+    assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(x);
+#else
+    unsigned count = 0;
+    for (; (x & 1) == 0; x >>= 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+#endif
+
+// the first line starts at 0, every other one after a '\n'
+void find_line_starts(const std::string& in_source, std::vector<size_t>& out_line_starts) {
+    out_line_starts.assign(1, 0);
+    const char* data = in_source.data();
+    const size_t size = in_source.size();
+    size_t pos = 0;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    // x86-64 always has SSE2, 16 bytes are compared at once
+    const __m128i new_line = _mm_set1_epi8('\n');
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(data + pos));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, new_line));
+        for (; mask != 0; mask &= mask - 1) {
+            out_line_starts.push_back(pos + count_trailing_zeros(mask) + 1);
+        }
+    }
+#endif
+
+    for (; pos < size; pos++) {
+        if (data[pos] == '\n') {
+            out_line_starts.push_back(pos + 1);
+        }
+    }
+}
+
 static const char* get_escape_shorthand(uint8_t c) {
     switch (c) {
     case '\0':
@@ -1377,6 +1463,45 @@ inline const char * token_id_name(TokenId id) {
     return token_id_names[(size_t)id];
 }
 
+const char * literal_type_name(LiteralType type) {
+    switch (type) {
+    case LiteralType::I8:
+        return "i8";
+    case LiteralType::I16:
+        return "i16";
+    case LiteralType::I32:
+        return "i32";
+    case LiteralType::U8:
+        return "u8";
+    case LiteralType::U16:
+        return "u16";
+    case LiteralType::U32:
+        return "u32";
+    default:
+        return nullptr;
+    }
+}
+
+uint32_t literal_type_bit_size(LiteralType type) {
+    switch (type) {
+    case LiteralType::I8:
+    case LiteralType::U8:
+        return 8;
+    case LiteralType::I16:
+    case LiteralType::U16:
+        return 16;
+    case LiteralType::I32:
+    case LiteralType::U32:
+        return 32;
+    default:
+        return 0;
+    }
+}
+
+bool literal_type_is_signed(LiteralType type) {
+    return type == LiteralType::I8 || type == LiteralType::I16 || type == LiteralType::I32;
+}
+
 size_t token_spaces(const size_t value_size, const size_t id_name_size) {
     return value_size >= id_name_size
         ? value_size - id_name_size
@@ -1,7 +1,7 @@
 #pragma once
 #include <vector>
 #include "error.hpp"
-#include "bigint.hpp"
+#include "literal_pool.hpp"
 
 enum class TokenId {
     HASH,               // #
@@ -75,25 +75,40 @@ enum class TokenId {
 
 const char * token_id_name(TokenId id);
 
-typedef struct { uint64_t v[2]; } float128_t;
-typedef uint32_t Char;
-
-struct BigFloat {
-    float128_t value;
-    bool overflow;
+// the suffix of an integer literal, [u]? [bwl]?
+// b, w and l are 8, 16 and 32 bits, without them the literal takes the size of its context
+enum class LiteralType : uint8_t {
+    None,
+    Unsigned,           // u
+    I8,                 // b
+    I16,                // w
+    I32,                // l
+    U8,                 // ub
+    U16,                // uw
+    U32,                // ul
 };
 
+// the type name of a sized literal, "u8" for ub. null if the literal is not sized
+const char * literal_type_name(LiteralType type);
+// 0 if the literal is not sized
+uint32_t literal_type_bit_size(LiteralType type);
+bool literal_type_is_signed(LiteralType type);
+
+typedef uint32_t Char;
+
+// trivially copyable, literal values are kept by the lexer
 struct Token {
     TokenId       id;
     size_t        start_pos;
     size_t        end_pos;
     size_t        start_line;
     size_t        start_column;
-    std::string   file_name;
+    LiteralType   lit_type;     // suffix of an INT_LIT, checked against the value by the lexer
 
     union {
-        BigInt    int_lit;
-        BigFloat  float_lit;
+        uint32_t  int_lit;      // index in the literal pool of the lexer
+        uint32_t  float_lit;    // index in the literal pool of the lexer
+        uint32_t  string_lit;   // index in the literal pool of the lexer, the same for equal strings
         Char      char_lit;
     };
 
@@ -101,35 +116,8 @@ struct Token {
         : id(TokenId::_EOF),
         start_pos(0L), end_pos(0L),
         start_line(0), start_column(0),
-        file_name(""),
-        int_lit({ 0 }) {}
-
-    ~Token() {}
-
-    Token(const Token& other)
-        : id(other.id), 
-        start_pos(other.start_pos),
-        end_pos(other.end_pos),
-        start_line(other.start_line),
-        start_column(other.start_column),
-        file_name(other.file_name),
-        int_lit(other.int_lit) {}
-
-    Token& operator=(const Token& other) {
-        // self-assignment guard
-        if (this == &other)
-            return *this;
-
-        id = other.id;
-        start_line = other.start_line;
-        start_column = other.start_column;
-        start_pos = other.start_pos;
-        end_pos = other.end_pos;
-        file_name = other.file_name;
-        int_lit = other.int_lit;
-
-        return *this;
-    }
+        lit_type(LiteralType::None),
+        int_lit(0) {}
 
     size_t get_value_size() {
         return (end_pos + 1) - start_pos;
@@ -143,12 +131,10 @@ class Lexer {
     enum class TokenizerState;
 
     size_t cursor_pos;
-    size_t curr_line;
-    size_t curr_column;
+    size_t curr_line;                       // of the token being read, moved forward in line_starts
     mutable size_t curr_index;              // used to consume tokens
 
     size_t char_code_index;         // char_code char counter
-    size_t remaining_code_units;    // used to count bytes in unicode char
     uint32_t radix;                 // used for getting number value.
     uint32_t char_code;             // char_code used accros the char_code state
     bool unicode;                   // is unicode char code
@@ -160,10 +146,14 @@ class Lexer {
 public:
     std::string file_name;
     std::string source;
+    mutable LiteralPool literals;   // compile time values are added after tokenizing
 
 private:
     std::vector<Token>  tokens_vec;
     std::vector<Token>  comments_vec;
+    std::vector<uint64_t> literal_digits;   // of the int literal being read, least significant first
+    std::string         string_bytes;       // of the string literal being read, escapes decoded
+    std::vector<size_t> line_starts;        // offset of the first byte of every line, built before tokenizing
     std::vector<Error>& errors;
 public:
     Lexer(const std::string& _file_name, std::vector<Error>& _errors);
@@ -172,6 +162,9 @@ public:
 
     const bool has_tokens() const noexcept;
 
+    // including the EOF token
+    size_t get_token_count() const noexcept;
+
     const Token& get_previous_token() const noexcept;
 
     // should not be called after EOF token
@@ -182,14 +175,20 @@ public:
 
     std::string_view get_token_value(const Token& token) const noexcept;
 
+    // line of a source offset, by binary search in the line starts. offsets past the end are on the last line
+    LL_NODISCARD size_t line_of(size_t in_offset) const noexcept;
+
+    // column in bytes of a source offset
+    LL_NODISCARD size_t column_of(size_t in_offset) const noexcept;
+
     friend Console print_tokens(Lexer& lexer);
 private:
     void begin_token(const TokenId id) noexcept;
     void set_token_id(const TokenId id) noexcept;
     void end_token() noexcept;
     void end_token_check_is_keyword()  noexcept;
-    void reset_line() noexcept; 
     void is_keyword() noexcept;
+    void invalid_utf8_error(size_t in_pos) noexcept;
     void invalid_char_error(uint8_t c) noexcept;
     void tokenize_error(const char* format, ...) noexcept;
     void handle_string_escape(uint8_t c) noexcept;
@@ -211,7 +210,6 @@ private:
         StringEscapeUnicodeStart,  // saw u inside string_escape
         CharCode,                  // saw x in string_escape or began the unicode escape
         CharLiteral,               //
-        CharLiteralUnicode,        // unicode char
         CharLiteralEnd,            //
         SawStar,                   //
         SawSlash,                  //
@@ -0,0 +1,71 @@
+#include "literal_pool.hpp"
+#include <cassert>
+#include <cstring>
+
+uint32_t LiteralPool::add_int(const uint64_t* in_digits, size_t in_digit_count, bool in_is_negative) noexcept {
+    while (in_digit_count > 0 && in_digits[in_digit_count - 1] == 0) {
+        in_digit_count--;
+    }
+
+    BigInt value;
+    value.digit_count = in_digit_count;
+    value.is_negative = in_is_negative && in_digit_count != 0;
+    if (bigint_is_inline(&value)) {
+        memcpy(value.data.inline_digits, in_digits, sizeof(uint64_t) * in_digit_count);
+    } else {
+        value.data.digits = arena.Allocate<uint64_t>(in_digit_count);
+        memcpy(value.data.digits, in_digits, sizeof(uint64_t) * in_digit_count);
+    }
+
+    int_literals.push_back(value);
+    return uint32_t(int_literals.size() - 1);
+}
+
+uint32_t LiteralPool::add_int(const BigInt& in_value) noexcept {
+    return add_int(bigint_ptr(&in_value), in_value.digit_count, in_value.is_negative);
+}
+
+const BigInt& LiteralPool::get_int(uint32_t in_index) const noexcept {
+    assert(in_index < int_literals.size());
+    return int_literals[in_index];
+}
+
+size_t LiteralPool::get_int_count() const noexcept {
+    return int_literals.size();
+}
+
+uint32_t LiteralPool::add_float(const BigFloat& in_value) noexcept {
+    float_literals.push_back(in_value);
+    return uint32_t(float_literals.size() - 1);
+}
+
+const BigFloat& LiteralPool::get_float(uint32_t in_index) const noexcept {
+    assert(in_index < float_literals.size());
+    return float_literals[in_index];
+}
+
+uint32_t LiteralPool::add_string(std::string_view in_value) noexcept {
+    auto it = string_indices.find(in_value);
+    if (it != string_indices.end()) {
+        return it->second;
+    }
+
+    char* bytes = in_value.empty() ? nullptr : arena.Allocate<char>(in_value.size());
+    if (bytes) {
+        memcpy(bytes, in_value.data(), in_value.size());
+    }
+    const std::string_view value(bytes, in_value.size());
+    const uint32_t index = uint32_t(string_literals.size());
+    string_literals.push_back(value);
+    string_indices.emplace(value, index);
+    return index;
+}
+
+std::string_view LiteralPool::get_string(uint32_t in_index) const noexcept {
+    assert(in_index < string_literals.size());
+    return string_literals[in_index];
+}
+
+size_t LiteralPool::get_string_count() const noexcept {
+    return string_literals.size();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "bigfloat.hpp"
+#include "bigint.hpp"
+#include "common_defs.hpp"
+#include <llvm/Support/Allocator.h>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+* Values of the literals of a module, owned by its lexer.
+* Tokens refer to them by index, so copying a token copies no value.
+* The digits of values that don't fit inline in a BigInt are allocated
+* from an arena that lives as long as the pool: literals never call
+* malloc and are never freed one by one, so they must not be passed to
+* bigint_deinit. Copy them with bigint_init_bigint to compute with them.
+* Strings are kept decoded and once: equal strings share their index.
+*/
+class LiteralPool {
+    llvm::BumpPtrAllocator  arena;
+    std::vector<BigInt>     int_literals;
+    std::vector<BigFloat>   float_literals;
+    std::vector<std::string_view>                   string_literals;    // bytes in the arena
+    std::unordered_map<std::string_view, uint32_t>  string_indices;
+
+public:
+    // returns the index of a new literal with a copy of in_digits (least significant first)
+    uint32_t add_int(const uint64_t* in_digits, size_t in_digit_count, bool in_is_negative) noexcept;
+    uint32_t add_int(const BigInt& in_value) noexcept;
+
+    // the reference is valid until the next literal is added
+    LL_NODISCARD const BigInt& get_int(uint32_t in_index) const noexcept;
+
+    LL_NODISCARD size_t get_int_count() const noexcept;
+
+    uint32_t add_float(const BigFloat& in_value) noexcept;
+    LL_NODISCARD const BigFloat& get_float(uint32_t in_index) const noexcept;
+
+    // returns the index of the string with the bytes in_value, a copy is added the first time
+    uint32_t add_string(std::string_view in_value) noexcept;
+    // the bytes are valid as long as the pool, without a terminating null
+    LL_NODISCARD std::string_view get_string(uint32_t in_index) const noexcept;
+    // distinct strings
+    LL_NODISCARD size_t get_string_count() const noexcept;
+};
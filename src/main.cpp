@@ -1,10 +1,14 @@
 #include <string>
-#include <fstream>
-#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "cache.hpp"
+#include "command_line.hpp"
 #include "console.hpp"
-#include "lexer.hpp"
-#include "parser.hpp"
 #include "compiler.hpp"
+#include "server.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
 
 #ifdef _WIN32
 #include <direct.h>
@@ -14,113 +18,70 @@
 #define GetCurrentDir getcwd
 #endif
 
-#define ARG_SRC_FILE "-s"
-#define ARG_OUT_NAME "-o"
-#define ARG_OUT_DIR  "-O"
+#define ARG_SERVER         "--server"
+#define ARG_CONNECT        "--connect"
+// artifacts the server keeps in memory between jobs
+#define SERVER_CACHE_MEMORY (512u * 1024u * 1024u)
 
 static std::string get_current_dir();
+static int run_command_line(const std::string& in_working_dir, const std::vector<std::string>& in_args, bool in_is_stdin_allowed);
 
 int main(int argc, const char *argv[])
 {
-  namespace fs = std::filesystem;
+  std::vector<std::string> args(argv + 1, argv + argc);
   // get current directory
   auto current_dir_str = get_current_dir();
-  fs::path current_dir_path(current_dir_str);
-  fs::directory_iterator current_dir(current_dir_path);
 
-  std::string source_name;
-  std::string output_name;
-  std::string output_dir_str;
-
-  // arg parsing
-  {
-      for (size_t i = 1; i < argc; i += 2) {
-          const char* option = argv[i];
-          size_t option_len = strlen(option);
-          if (strncmp(option, ARG_SRC_FILE, option_len > 2 ? 2 : option_len) == 0) {
-              source_name = argv[i + 1];
-          }
-          else if (strncmp(option, ARG_OUT_NAME, option_len > 2 ? 2 : option_len) == 0) {
-              output_name = argv[i + 1];
-          }
-          else if (strncmp(option, ARG_OUT_DIR, option_len > 2 ? 2 : option_len) == 0) {
-              output_dir_str = argv[i + 1];
-          }
-          else {
-              std::cout << "bad argument: " << option << std::endl;
-              return -1;
-          }
+  // --server <socket> keeps the compiler running, --connect <socket> <args> runs a command line in it
+  if (!args.empty() && (args[0] == ARG_SERVER || args[0] == ARG_CONNECT)) {
+      if (args.size() < 2) {
+          std::cout << "missing value for argument: " << args[0] << std::endl;
+          return -1;
       }
 
-      if (output_dir_str.empty()) {
-          output_dir_str = current_dir_str;
+      const std::string socket_path = args[1];
+      if (args[0] == ARG_CONNECT) {
+          return server::send_job(socket_path, current_dir_str, std::vector<std::string>(args.begin() + 2, args.end()));
       }
-  }
 
-  // open source file
-  auto file_path = current_dir_path.string() + "\\" + source_name;
-  std::ifstream source_file(file_path);
-  {
-      if (!source_file.is_open()) {
-          // error could not find file
-          std::cout << "could not find file \"" << source_name << "\" in directory \"" << current_dir_str << "\"" << std::endl;
-          return -1;
-      }
-      if (source_file.bad()) {
-          // error corrupted file
-          std::cout << "corrupted file \"" << source_name << std::endl;
-          return -1;
-      }
+      cache::set_memory_limit(SERVER_CACHE_MEMORY);
+      return server::listen(socket_path, [](const std::string& in_working_dir, const std::vector<std::string>& in_args) {
+          // the standard input of the server is not the one of the client
+          const int exit_code = run_command_line(in_working_dir, in_args, false);
+          cache::trim_memory();
+          return exit_code;
+      });
   }
 
-  /*
-  for (auto entry : currentDir) {
-    if (entry.is_regular_file()) {
-      auto fileName = entry.path().filename();
-
-      if (fileName == "build.llang") {
+  return run_command_line(current_dir_str, args, true);
+}
 
-      }
-    }
+// paths are relative to in_working_dir.
+// every source is built in this process, the modules they share are built once
+int run_command_line(const std::string& in_working_dir, const std::vector<std::string>& in_args, bool in_is_stdin_allowed)
+{
+  CommandLine command_line;
+  if (!command_line::parse(in_working_dir, in_args, in_is_stdin_allowed, command_line)) {
+      return -1;
   }
-  */
-
-  std::string source_code;
-  // get source_code
-  {
-      // go to end of file
-      source_file.seekg(0, std::ios::end);
-
-      // Reserve memory
-      source_code.reserve(source_file.tellg());
-
-      // reset file cursor
-      source_file.seekg(0, std::ios::beg);
-
-      // store content in this.source
-      source_code.assign((std::istreambuf_iterator<char>(source_file)), std::istreambuf_iterator<char>());
 
-      // close file
-      source_file.close();
+  if (command_line.read_stdin) {
+      command_line.sources.back().source = std::string((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
   }
 
-  std::vector<Error> errors;
-  Lexer lexer(source_code, source_name, errors);
-  lexer.tokenize();
-  
-  /*
-  auto print_lines = print_tokens(lexer);
-  for (auto line : print_lines)
-      console::WriteLine(line);
-  */
-
-  Parser parser(lexer, errors);
-  auto source_code_node = parser.parse();
-  
-  compiler::compile(output_dir_str, output_name, source_code_node);
-
-  return 0;
-  //return Compiler::compile(build_options);
+  stats::set_enabled(command_line.time_report);
+  if (!command_line.trace_path.empty()) {
+      trace::start();
+  }
+  const int exit_code = compiler::build(command_line.build_options, command_line.sources);
+  if (!command_line.trace_path.empty() && !trace::finish(command_line.trace_path)) {
+      return -1;
+  }
+  if (command_line.time_report) {
+      console::WriteLine(stats::get_report(command_line.time_report_json));
+      stats::set_enabled(false);
+  }
+  return exit_code;
 }
 
 std::string get_current_dir()
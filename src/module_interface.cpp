@@ -0,0 +1,204 @@
+#include "module_interface.hpp"
+#include "ast_nodes.hpp"
+#include <unordered_map>
+#include <vector>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+// bumped on every layout change
+#define INTERFACE_MAGIC     0x46494C4Cu // "LLIF"
+#define INTERFACE_VERSION   1u
+
+#define HEADER_SIZE         (6 * sizeof(uint32_t))
+#define STRING_REF_SIZE     (2 * sizeof(uint32_t))
+#define FUNCTION_SIZE       (2 * STRING_REF_SIZE + 2 * sizeof(uint32_t))
+#define PARAM_SIZE          STRING_REF_SIZE
+#define GLOBAL_SIZE         (2 * STRING_REF_SIZE)
+
+namespace {
+    class InterfaceWriter {
+        std::string functions;
+        std::string params;
+        std::string globals;
+        std::string strings;
+        std::unordered_map<std::string_view, uint32_t> string_offsets;
+        uint32_t function_count = 0;
+        uint32_t param_count = 0;
+        uint32_t global_count = 0;
+
+    public:
+        void add_function(const AstFuncProto& in_proto) noexcept {
+            add_string(functions, in_proto.name);
+            add_string(functions, in_proto.return_type->ast_type.type_info->name);
+            add_u32(functions, param_count);
+            add_u32(functions, uint32_t(in_proto.params.size()));
+            for (auto param : in_proto.params) {
+                add_string(params, param->param_decl.type->ast_type.type_info->name);
+                param_count++;
+            }
+            function_count++;
+        }
+
+        void add_global(const AstVarDef& in_var_def) noexcept {
+            add_string(globals, in_var_def.name);
+            add_string(globals, in_var_def.type->ast_type.type_info->name);
+            global_count++;
+        }
+
+        std::string finish() noexcept {
+            std::string bytes;
+            bytes.reserve(HEADER_SIZE + functions.size() + params.size() + globals.size() + strings.size());
+            add_u32(bytes, INTERFACE_MAGIC);
+            add_u32(bytes, INTERFACE_VERSION);
+            add_u32(bytes, function_count);
+            add_u32(bytes, param_count);
+            add_u32(bytes, global_count);
+            add_u32(bytes, uint32_t(strings.size()));
+            bytes += functions;
+            bytes += params;
+            bytes += globals;
+            bytes += strings;
+            return bytes;
+        }
+
+    private:
+        void add_string(std::string& io_section, std::string_view in_string) noexcept {
+            auto offset_it = string_offsets.find(in_string);
+            if (offset_it == string_offsets.end()) {
+                offset_it = string_offsets.emplace(in_string, uint32_t(strings.size())).first;
+                strings += in_string;
+            }
+            add_u32(io_section, offset_it->second);
+            add_u32(io_section, uint32_t(in_string.size()));
+        }
+
+        static void add_u32(std::string& io_section, uint32_t in_value) noexcept {
+            char bytes[sizeof(uint32_t)];
+            llvm::support::endian::write32le(bytes, in_value);
+            io_section.append(bytes, sizeof(bytes));
+        }
+    };
+}
+
+static uint32_t read_u32(const uint8_t* in_bytes, size_t in_index = 0) noexcept;
+
+ModuleInterface::~ModuleInterface() = default;
+
+std::string ModuleInterface::write(const AstNode* in_source_code_node) noexcept {
+    assert(in_source_code_node->node_type == AstNodeType::AstSourceCode);
+
+    InterfaceWriter writer;
+    for (auto child : in_source_code_node->source_code.children) {
+        switch (child->node_type) {
+        case AstNodeType::AstFuncDef:
+            writer.add_function(child->function_def.proto->function_proto);
+            break;
+        case AstNodeType::AstFuncProto:
+            writer.add_function(child->function_proto);
+            break;
+        case AstNodeType::AstVarDef:
+            writer.add_global(child->var_def);
+            break;
+        default:
+            break;
+        }
+    }
+    return writer.finish();
+}
+
+std::unique_ptr<ModuleInterface> ModuleInterface::open(std::unique_ptr<llvm::MemoryBuffer> in_buffer) noexcept {
+    const size_t buffer_size = in_buffer->getBufferSize();
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(in_buffer->getBufferStart());
+    if (buffer_size < HEADER_SIZE || read_u32(bytes, 0) != INTERFACE_MAGIC || read_u32(bytes, 1) != INTERFACE_VERSION) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ModuleInterface> module_interface(new ModuleInterface());
+    module_interface->function_count = read_u32(bytes, 2);
+    module_interface->param_count = read_u32(bytes, 3);
+    module_interface->global_count = read_u32(bytes, 4);
+    const uint32_t strings_size = read_u32(bytes, 5);
+
+    // 64 bits, the counts of a corrupted file could overflow
+    const uint64_t functions_offset = HEADER_SIZE;
+    const uint64_t params_offset = functions_offset + uint64_t(module_interface->function_count) * FUNCTION_SIZE;
+    const uint64_t globals_offset = params_offset + uint64_t(module_interface->param_count) * PARAM_SIZE;
+    const uint64_t strings_offset = globals_offset + uint64_t(module_interface->global_count) * GLOBAL_SIZE;
+    if (strings_offset + strings_size != buffer_size) {
+        return nullptr;
+    }
+
+    module_interface->functions = bytes + functions_offset;
+    module_interface->params = bytes + params_offset;
+    module_interface->globals = bytes + globals_offset;
+    module_interface->strings = std::string_view(reinterpret_cast<const char*>(bytes + strings_offset), strings_size);
+
+    // every reference is checked once so the getters don't have to
+    auto is_valid_string = [&](const uint8_t* in_string_ref) {
+        return uint64_t(read_u32(in_string_ref, 0)) + read_u32(in_string_ref, 1) <= strings_size;
+    };
+    for (uint32_t i = 0; i < module_interface->function_count; i++) {
+        const uint8_t* function = module_interface->functions + i * FUNCTION_SIZE;
+        const uint64_t params_end = uint64_t(read_u32(function, 4)) + read_u32(function, 5);
+        if (!is_valid_string(function) || !is_valid_string(function + STRING_REF_SIZE) || params_end > module_interface->param_count) {
+            return nullptr;
+        }
+    }
+    for (uint32_t i = 0; i < module_interface->param_count; i++) {
+        if (!is_valid_string(module_interface->params + i * PARAM_SIZE)) {
+            return nullptr;
+        }
+    }
+    for (uint32_t i = 0; i < module_interface->global_count; i++) {
+        const uint8_t* global = module_interface->globals + i * GLOBAL_SIZE;
+        if (!is_valid_string(global) || !is_valid_string(global + STRING_REF_SIZE)) {
+            return nullptr;
+        }
+    }
+
+    module_interface->buffer = std::move(in_buffer);
+    return module_interface;
+}
+
+std::string_view ModuleInterface::get_function_name(uint32_t in_function) const noexcept {
+    assert(in_function < function_count);
+    return get_string(functions + in_function * FUNCTION_SIZE);
+}
+
+std::string_view ModuleInterface::get_return_type(uint32_t in_function) const noexcept {
+    assert(in_function < function_count);
+    return get_string(functions + in_function * FUNCTION_SIZE + STRING_REF_SIZE);
+}
+
+uint32_t ModuleInterface::get_param_count(uint32_t in_function) const noexcept {
+    assert(in_function < function_count);
+    return read_u32(functions + in_function * FUNCTION_SIZE, 5);
+}
+
+std::string_view ModuleInterface::get_param_type(uint32_t in_function, uint32_t in_param) const noexcept {
+    assert(in_param < get_param_count(in_function));
+    const uint32_t first_param = read_u32(functions + in_function * FUNCTION_SIZE, 4);
+    return get_string(params + (first_param + in_param) * PARAM_SIZE);
+}
+
+std::string_view ModuleInterface::get_global_name(uint32_t in_global) const noexcept {
+    assert(in_global < global_count);
+    return get_string(globals + in_global * GLOBAL_SIZE);
+}
+
+std::string_view ModuleInterface::get_global_type(uint32_t in_global) const noexcept {
+    assert(in_global < global_count);
+    return get_string(globals + in_global * GLOBAL_SIZE + STRING_REF_SIZE);
+}
+
+std::string_view ModuleInterface::get_bytes() const noexcept {
+    return std::string_view(buffer->getBufferStart(), buffer->getBufferSize());
+}
+
+std::string_view ModuleInterface::get_string(const uint8_t* in_string_ref) const noexcept {
+    return strings.substr(read_u32(in_string_ref, 0), read_u32(in_string_ref, 1));
+}
+
+uint32_t read_u32(const uint8_t* in_bytes, size_t in_index) noexcept {
+    return llvm::support::endian::read32le(in_bytes + in_index * sizeof(uint32_t));
+}
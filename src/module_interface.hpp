@@ -0,0 +1,64 @@
+#pragma once
+#include "common_defs.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace llvm {
+    class MemoryBuffer;
+}
+struct AstNode;
+
+/*
+* Precompiled interface of a module: the prototypes, global variable types
+* and names other modules need to declare its symbols, nothing else.
+* Written once the module is analyzed and read in place from the mapped
+* file, so loading a module costs time proportional to its interface
+* instead of its source.
+*
+* Layout, every field is a little endian uint32 and strings are an
+* (offset, size) pair into the string table:
+*   header      magic, version, function count, param count, global count, string table size
+*   functions   name, return type, first param, param count
+*   params      type
+*   globals     name, type
+*   strings     interned names, each one is stored once
+*/
+class ModuleInterface {
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    const uint8_t*      functions;
+    const uint8_t*      params;
+    const uint8_t*      globals;
+    std::string_view    strings;
+    uint32_t            function_count;
+    uint32_t            param_count;
+    uint32_t            global_count;
+
+    ModuleInterface() = default;
+
+public:
+    ~ModuleInterface();
+
+    // serializes the interface of an analyzed module
+    LL_NODISCARD static std::string write(const AstNode* in_source_code_node) noexcept;
+
+    // returns nullptr if in_buffer is not an interface of this compiler version
+    LL_NODISCARD static std::unique_ptr<ModuleInterface> open(std::unique_ptr<llvm::MemoryBuffer> in_buffer) noexcept;
+
+    LL_NODISCARD uint32_t get_function_count() const noexcept { return function_count; }
+    LL_NODISCARD std::string_view get_function_name(uint32_t in_function) const noexcept;
+    LL_NODISCARD std::string_view get_return_type(uint32_t in_function) const noexcept;
+    LL_NODISCARD uint32_t get_param_count(uint32_t in_function) const noexcept;
+    LL_NODISCARD std::string_view get_param_type(uint32_t in_function, uint32_t in_param) const noexcept;
+
+    LL_NODISCARD uint32_t get_global_count() const noexcept { return global_count; }
+    LL_NODISCARD std::string_view get_global_name(uint32_t in_global) const noexcept;
+    LL_NODISCARD std::string_view get_global_type(uint32_t in_global) const noexcept;
+
+    // the serialized interface, dependent modules hash it
+    LL_NODISCARD std::string_view get_bytes() const noexcept;
+
+private:
+    std::string_view get_string(const uint8_t* in_string_ref) const noexcept;
+};
@@ -5,3 +5,7 @@ static const char* ERROR_EXPECTED_NUMBER_IDENTIFIER_CHAR_TOKEN  = "expected numb
 static const char* ERROR_EXPECTED_TYPE_EXPR_INSTEAD_OF          = "expected type name, array type '[]' or pointer type '*' instead of '%s'";
 static const char* ERROR_EXPECTED_CLOSING_BRAKET_BEFORE         = "expected clossing bracket ']' before '%s'";
 static const char* ERROR_EXPECTED_NEWLINE_OR_SEMICOLON_AFTER    = "expected new line or semicolor ';' after '%s'";
+static const char* ERROR_EXPECTED_DIRECTIVE_NAME_INSTEAD_OF     = "expected directive name after '#' instead of '%s'";
+static const char* ERROR_UNKNOWN_DIRECTIVE                      = "unknown directive '#%s'";
+static const char* ERROR_EXPECTED_MODULE_NAME_INSTEAD_OF        = "expected module name instead of '%s'";
+static const char* ERROR_DIRECTIVE_HAS_NO_VALUE                 = "directive '#%s' does not produce a value";
@@ -2,8 +2,10 @@
 #include "lexer.hpp"
 #include "ast_nodes.hpp"
 #include "parse_error_msgs.hpp"
+#include "types.hpp"
 #include <stdarg.h>
 #include <cassert>
+#include <llvm/Support/TimeProfiler.h>
 
 static BinaryExprType get_binary_op(const Token& token) noexcept;
 static UnaryExprType get_unary_op(const Token& token) noexcept;
@@ -11,7 +13,6 @@ static bool is_type_start_token(const Token& token) noexcept;
 static bool is_expr_token(const Token& token) noexcept;
 static bool is_symbol_start_char(const char _char) noexcept;
 static bool is_whitespace_char(const char _char) noexcept;
-static AstTypeId get_type_id(std::string_view in_name, TypeInfo** info) noexcept;
 
 //  ('=='|'!=' | '!' | '>=' | '<=' | '<' | '>')
 #define COMPARATIVE_OPERATOR \
@@ -50,7 +51,7 @@ AstNode* Parser::parse() noexcept {
 /*
 * Parses any posible statement in llamacode
 * sourceFile
-*   : (functionProto | functionDef | varDef eos)* _EOF
+*   : (directive | functionProto | functionDef | varDef eos)* _EOF
 *   ;
 */
 AstNode* Parser::parse_source_code() noexcept {
@@ -63,6 +64,9 @@ AstNode* Parser::parse_source_code() noexcept {
     lexer.get_back();
 
     AstNode* source_code_node = new AstNode(AstNodeType::AstSourceCode, first_token.start_line, first_token.start_column);
+    source_code_node->source_code.file_name = lexer.file_name;
+    source_code_node->source_code.source = lexer.source;
+    source_code_node->source_code.literals = &lexer.literals;
     
     for (;;) {
         AstNode* node = nullptr;
@@ -71,9 +75,20 @@ AstNode* Parser::parse_source_code() noexcept {
         if  (token.id == TokenId::_EOF) {
             break;
         }
+        llvm::TimeTraceScope trace_scope("ParseDeclaration", [&] {
+            return lexer.file_name + ":" + std::to_string(token.start_line);
+        });
         
         switch (token.id) {
         
+        case TokenId::HASH: {
+            lexer.get_back(); // token
+            node = parse_basic_directive();
+            if (!node) {
+                skip_statement(token);
+                continue;
+            }
+        } break;
         case TokenId::FN: {
             lexer.get_back(); // token
             node = parse_function_def();
@@ -91,11 +106,12 @@ AstNode* Parser::parse_source_code() noexcept {
                 continue;
             }
 
-            if (is_forbiden_statement(next_token)) {
+            // IDENTIFIER * is a pointer variable, like in function blocks
+            if (!is_type_start_token(next_token) && is_forbiden_statement(next_token)) {
                 continue;
             }
             
-            if (is_new_line_between(token.end_pos, next_token.start_pos)) {
+            if (is_new_line_between(token, next_token)) {
                 // ignore statement of type
                 // IDENTIFIER\n
                 continue;
@@ -104,7 +120,7 @@ AstNode* Parser::parse_source_code() noexcept {
             lexer.get_back(); // token
             node = parse_vardef_stmnt();
             if (!node) {
-                // TODO: handle error
+                skip_statement(token);
                 continue;
             }
         } break;
@@ -118,9 +134,9 @@ AstNode* Parser::parse_source_code() noexcept {
         // handle EOS (end of statement)
         const Token& semicolon_token = lexer.get_next_token();
         if (semicolon_token.id != TokenId::SEMI) {
-            if (token.id != TokenId::_EOF && !is_new_line_between(token.end_pos, semicolon_token.start_pos)) {
+            if (semicolon_token.id != TokenId::_EOF && !is_new_line_between(token, semicolon_token)) {
                 // statement wrong ending
-                parse_error(token, ERROR_EXPECTED_NEWLINE_OR_SEMICOLON_AFTER, lexer.get_token_value(token));
+                parse_error(token, ERROR_EXPECTED_NEWLINE_OR_SEMICOLON_AFTER, std::string(lexer.get_token_value(token)).c_str());
                 delete node;
                 continue;
             }
@@ -136,6 +152,65 @@ AstNode* Parser::parse_source_code() noexcept {
     return source_code_node;
 }
 
+/*
+* Parses a compiler directive
+* directive
+*   : '#' 'run' expression
+*   | '#' 'load' IDENTIFIER
+*   | '#' 'compile_only'
+*   ;
+*/
+AstNode* Parser::parse_basic_directive() noexcept {
+    const Token& hash_token = lexer.get_next_token();
+    if (hash_token.id != TokenId::HASH) {
+        // Bad prediction
+        UNREACHEABLE;
+    }
+
+    const Token& name_token = lexer.get_next_token();
+    if (name_token.id != TokenId::IDENTIFIER) {
+        parse_error(name_token, ERROR_EXPECTED_DIRECTIVE_NAME_INSTEAD_OF, std::string(lexer.get_token_value(name_token)).c_str());
+        lexer.get_back();
+        return nullptr;
+    }
+
+    DirectiveType directive_type;
+    if (!get_directive_type(lexer.get_token_value(name_token), &directive_type)) {
+        parse_error(name_token, ERROR_UNKNOWN_DIRECTIVE, std::string(lexer.get_token_value(name_token)).c_str());
+        return nullptr;
+    }
+
+    AstNode* directive_node = new AstNode(AstNodeType::AstDirective, hash_token.start_line, hash_token.start_column);
+    directive_node->directive.directive_type = directive_type;
+
+    switch (directive_type) {
+    case DirectiveType::Run: {
+        AstNode* expr = parse_expr();
+        if (!expr) {
+            // the expression reported the error, the caller skips the statement
+            delete directive_node;
+            return nullptr;
+        }
+        expr->parent = directive_node;
+        directive_node->directive.expr = expr;
+    } break;
+    case DirectiveType::Load: {
+        const Token& module_token = lexer.get_next_token();
+        if (module_token.id != TokenId::IDENTIFIER) {
+            parse_error(module_token, ERROR_EXPECTED_MODULE_NAME_INSTEAD_OF, std::string(lexer.get_token_value(module_token)).c_str());
+            lexer.get_back();
+            delete directive_node;
+            return nullptr;
+        }
+        directive_node->directive.argument = lexer.get_token_value(module_token);
+    } break;
+    case DirectiveType::CompTimeOnly:
+        break;
+    }
+
+    return directive_node;
+}
+
 /*
 * Parses a function definition
 * functionDef
@@ -230,7 +305,7 @@ AstNode* Parser::parse_function_proto() noexcept {
 
             if (token.id == TokenId::_EOF) {
                 const Token& prev_token = lexer.get_previous_token();
-                parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, lexer.get_token_value(prev_token));
+                parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, std::string(lexer.get_token_value(prev_token)).c_str());
                 delete func_prot_node;
                 return nullptr;
             }
@@ -328,7 +403,7 @@ AstNode* Parser::parse_block() noexcept {
 
         if (token.id == TokenId::_EOF) {
             const Token& prev_token = lexer.get_previous_token();
-            parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, lexer.get_token_value(prev_token));
+            parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, std::string(lexer.get_token_value(prev_token)).c_str());
             delete block_node;
             return nullptr;
         }
@@ -343,11 +418,11 @@ AstNode* Parser::parse_block() noexcept {
 
         const Token& semicolon_token = lexer.get_next_token();
         if (semicolon_token.id != TokenId::SEMI) {
-            bool has_new_line = is_new_line_between(token.end_pos, semicolon_token.start_pos);
+            bool has_new_line = is_new_line_between(token, semicolon_token);
             // checking for r_curly allows for '{stmnt}' as block
             if (semicolon_token.id != TokenId::R_CURLY && !has_new_line) {
                 // statement wrong ending
-                parse_error(token, ERROR_EXPECTED_NEWLINE_OR_SEMICOLON_AFTER, lexer.get_token_value(token));
+                parse_error(token, ERROR_EXPECTED_NEWLINE_OR_SEMICOLON_AFTER, std::string(lexer.get_token_value(token)).c_str());
                 delete stmnt;
                 delete block_node;
                 return nullptr;
@@ -421,7 +496,7 @@ AstNode* Parser::parse_statement() noexcept {
 /*
 * parses a variable definition/initialization
 * varDef
-*   : IDENTIFIER type_name ('=' expression)?
+*   : IDENTIFIER type_name ('=' (expression | runDirective))?
 *   ;
 */
 AstNode* Parser::parse_vardef_stmnt() noexcept {
@@ -445,8 +520,44 @@ AstNode* Parser::parse_vardef_stmnt() noexcept {
     var_def_node->var_def.name = lexer.get_token_value(token_symbol_name);
     var_def_node->var_def.type = type_node;
 
-    if (lexer.get_next_token().id == TokenId::ASSIGN) {
-        // TODO(pablo96): parse assignment
+    const Token& assign_token = lexer.get_next_token();
+    if (assign_token.id == TokenId::ASSIGN) {
+        AstNode* value_node = nullptr;
+        const Token& value_token = lexer.get_next_token();
+        lexer.get_back();
+
+        if (value_token.id == TokenId::HASH) {
+            value_node = parse_basic_directive();
+            if (value_node && value_node->directive.directive_type != DirectiveType::Run) {
+                parse_error(value_token, ERROR_DIRECTIVE_HAS_NO_VALUE, get_directive_type_name(value_node->directive.directive_type).c_str());
+                delete value_node;
+                value_node = nullptr;
+            }
+        }
+        else {
+            value_node = parse_expr();
+        }
+
+        if (!value_node) {
+            // the initializer reported the error, the caller skips the statement
+            delete var_def_node;
+            return nullptr;
+        }
+
+        // initializers are stored as 'name = value'
+        AstNode* name_node = new AstNode(AstNodeType::AstSymbol, token_symbol_name.start_line, token_symbol_name.start_column);
+        name_node->symbol.token = &token_symbol_name;
+        name_node->symbol.name = lexer.get_token_value(token_symbol_name);
+
+        AstNode* assign_node = new AstNode(AstNodeType::AstBinaryExpr, assign_token.start_line, assign_token.start_column);
+        name_node->parent = assign_node;
+        value_node->parent = assign_node;
+        assign_node->binary_expr.op1 = name_node;
+        assign_node->binary_expr.bin_op = BinaryExprType::ASSIGN;
+        assign_node->binary_expr.op2 = value_node;
+
+        assign_node->parent = var_def_node;
+        var_def_node->var_def.initializer = assign_node;
     }
     else {
         lexer.get_back();
@@ -471,7 +582,7 @@ AstNode* Parser::parse_type() noexcept {
         type_node->ast_type.type_id = AstTypeId::Pointer;
         const Token& next_token = lexer.get_next_token();
         if (!is_type_start_token(next_token)) {
-            parse_error(next_token, ERROR_EXPECTED_TYPE_EXPR_INSTEAD_OF, lexer.get_token_value(next_token));
+            parse_error(next_token, ERROR_EXPECTED_TYPE_EXPR_INSTEAD_OF, std::string(lexer.get_token_value(next_token)).c_str());
             lexer.get_back();
             delete type_node;
             return nullptr;
@@ -480,6 +591,7 @@ AstNode* Parser::parse_type() noexcept {
         auto data_tye_node = parse_type();
         data_tye_node->parent = type_node;
         type_node->ast_type.child_type = data_tye_node;
+        type_node->ast_type.type_info = types::get_pointer_type(data_tye_node->ast_type.type_info);
         
         return type_node;
     }
@@ -487,7 +599,7 @@ AstNode* Parser::parse_type() noexcept {
         // ARRAY TYPE
         const Token& r_braket_token = lexer.get_next_token();
         if (r_braket_token.id != TokenId::R_BRACKET) {
-            parse_error(r_braket_token, ERROR_EXPECTED_CLOSING_BRAKET_BEFORE, lexer.get_token_value(r_braket_token));
+            parse_error(r_braket_token, ERROR_EXPECTED_CLOSING_BRAKET_BEFORE, std::string(lexer.get_token_value(r_braket_token)).c_str());
             lexer.get_back();
             return nullptr;
         }
@@ -496,7 +608,7 @@ AstNode* Parser::parse_type() noexcept {
 
         const Token& next_token = lexer.get_next_token();
         if (!is_type_start_token(next_token)) {
-            parse_error(next_token, ERROR_EXPECTED_TYPE_EXPR_INSTEAD_OF, lexer.get_token_value(next_token));
+            parse_error(next_token, ERROR_EXPECTED_TYPE_EXPR_INSTEAD_OF, std::string(lexer.get_token_value(next_token)).c_str());
             lexer.get_back();
             delete type_node;
             return nullptr;
@@ -505,18 +617,20 @@ AstNode* Parser::parse_type() noexcept {
         auto data_tye_node = parse_type();
         data_tye_node->parent = type_node;
         type_node->ast_type.child_type = data_tye_node;
+        type_node->ast_type.type_info = types::get_array_type(data_tye_node->ast_type.type_info);
         
         return type_node;
     }
     else if (token.id == TokenId::IDENTIFIER) {
         AstNode* type_node = new AstNode(AstNodeType::AstType, token.start_line, token.start_column);
-        type_node->ast_type.type_id = get_type_id(lexer.get_token_value(token), &type_node->ast_type.type_info);
+        type_node->ast_type.type_info = types::get_named_type(lexer.get_token_value(token));
+        type_node->ast_type.type_id = type_node->ast_type.type_info->type_id;
         
         return type_node;
     }
     else if (token.id == TokenId::_EOF) {
         const Token& prev_token = lexer.get_previous_token();
-        parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, lexer.get_token_value(prev_token));
+        parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, std::string(lexer.get_token_value(prev_token)).c_str());
         return nullptr;
     }
     // Bad prediction
@@ -607,7 +721,7 @@ AstNode* Parser::parse_expr() noexcept
         auto expression = parse_expr();
         if (lexer.get_next_token().id != TokenId::R_PAREN) {
             const Token& prev_token = lexer.get_previous_token();
-            parse_error(prev_token, ERROR_EXPECTED_R_PAREN_AFTER, lexer.get_token_value(prev_token));
+            parse_error(prev_token, ERROR_EXPECTED_R_PAREN_AFTER, std::string(lexer.get_token_value(prev_token)).c_str());
             return nullptr;
         }
         return expression;
@@ -759,7 +873,7 @@ AstNode* Parser::parse_unary_expr() noexcept {
     
     if (unary_op_token.id == TokenId::_EOF) {
         const Token& prev_token = lexer.get_previous_token();
-        parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, lexer.get_token_value(prev_token));
+        parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, std::string(lexer.get_token_value(prev_token)).c_str());
         return nullptr;
     }
 
@@ -810,6 +924,7 @@ AstNode* Parser::parse_unary_expr() noexcept {
 *   | FLOAT_LIT
 *   | INT_LIT
 *   | UNICODE_CHAR
+*   | STRING
 */
 AstNode* Parser::parse_primary_expr() noexcept {
     const Token& token = lexer.get_next_token();
@@ -817,7 +932,7 @@ AstNode* Parser::parse_primary_expr() noexcept {
 
     if (token.id == TokenId::_EOF) {
         const Token& prev_token = lexer.get_previous_token();
-        parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, lexer.get_token_value(prev_token));
+        parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, std::string(lexer.get_token_value(prev_token)).c_str());
         return nullptr;
     }
 
@@ -839,14 +954,17 @@ AstNode* Parser::parse_primary_expr() noexcept {
         goto parse_literal;
     }
 
-    if (MATCH(&token, TokenId::FLOAT_LIT, TokenId::INT_LIT, TokenId::UNICODE_CHAR)) {
+    if (MATCH(&token, TokenId::FLOAT_LIT, TokenId::INT_LIT, TokenId::UNICODE_CHAR, TokenId::STRING)) {
 parse_literal:
         AstNode* symbol_node = new AstNode(AstNodeType::AstSymbol, token.start_line, token.start_column);
         symbol_node->symbol.token = &token;
+        if (token.id == TokenId::IDENTIFIER) {
+            symbol_node->symbol.name = token_value;
+        }
         return symbol_node;
     }
 
-    parse_error(token, ERROR_EXPECTED_NUMBER_IDENTIFIER_CHAR_TOKEN, token_value, token_id_name(token.id));
+    parse_error(token, ERROR_EXPECTED_NUMBER_IDENTIFIER_CHAR_TOKEN, std::string(token_value).c_str());
     return nullptr;
 }
 
@@ -884,7 +1002,7 @@ AstNode* Parser::parse_function_call() noexcept {
 
         if (token.id == TokenId::_EOF) {
             const Token& prev_token = lexer.get_previous_token();
-            parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, lexer.get_token_value(prev_token));
+            parse_error(prev_token, ERROR_UNEXPECTED_EOF_AFTER, std::string(lexer.get_token_value(prev_token)).c_str());
             delete func_call_node;
             return nullptr;
         }
@@ -908,29 +1026,41 @@ AstNode* Parser::parse_error(const Token& token, const char* format, ...) noexce
     va_start(ap, format);
     va_copy(ap2, ap);
 
-    int len1 = snprintf(nullptr, 0, format, ap);
+    int len1 = vsnprintf(nullptr, 0, format, ap);
     assert(len1 >= 0);
 
-    std::string msg;
-    msg.reserve(len1);
+    std::string msg(len1, '\0');
 
-    int len2 = snprintf(msg.data(), len1, format, ap2);
+    int len2 = vsnprintf(msg.data(), len1 + 1, format, ap2);
     assert(len2 == len1);
 
+    va_end(ap2);
     va_end(ap);
 
     Error error(ERROR_TYPE::ERROR,
         token.start_line,
         token.start_column,
         lexer.file_name, msg);
+    error_vec.push_back(error);
     return nullptr;
 }
 
-bool Parser::is_new_line_between(const size_t start_pos, const size_t end_pos) {
-    auto start_it = lexer.source.begin();
-    auto str_view = std::string_view(start_it + start_pos, start_it + end_pos);
+void Parser::skip_statement(const Token& in_first_token) noexcept {
+    for (;;) {
+        const Token& token = lexer.get_next_token();
+        if (token.id == TokenId::SEMI) {
+            return;
+        }
+        if (token.id == TokenId::_EOF || is_new_line_between(in_first_token, token)) {
+            lexer.get_back();
+            return;
+        }
+    }
+}
 
-    return str_view.find_first_of('\n') != str_view.npos;
+// a token ends on the line it starts, newlines in string literals are errors
+bool Parser::is_new_line_between(const Token& token, const Token& next_token) const noexcept {
+    return token.start_line != next_token.start_line;
 }
 
 bool Parser::is_forbiden_statement(const Token& token) noexcept {
@@ -1036,6 +1166,7 @@ bool is_expr_token(const Token& token) noexcept {
     case TokenId::FLOAT_LIT:
     case TokenId::INT_LIT:
     case TokenId::UNICODE_CHAR:
+    case TokenId::STRING:
     case TokenId::NOT:
     case TokenId::BIT_NOT:
     case TokenId::PLUS_PLUS:
@@ -1081,39 +1212,6 @@ bool is_whitespace_char(const char _char) noexcept {
     }
 }
 
-struct TypeIdAstTypeId {
-    AstTypeId id;
-    TypeInfo info;
-};
-
-std::unordered_map<std::string_view, TypeIdAstTypeId> typesIds = {
-    {"i8",   {AstTypeId::Integer,       {"i8"  , nullptr, 8  , true}}},
-    {"i16",  {AstTypeId::Integer,       {"i16" , nullptr, 16 , true}}},
-    {"i32",  {AstTypeId::Integer,       {"i32" , nullptr, 32 , true}}},
-    {"i64",  {AstTypeId::Integer,       {"i64" , nullptr, 64 , true}}},
-    {"i128", {AstTypeId::Integer,       {"i128", nullptr, 128, true}}},
-    {"u8"  , {AstTypeId::Integer,       {"u8"  , nullptr, 8  , false}}},
-    {"u16" , {AstTypeId::Integer,       {"u16" , nullptr, 16 , false}}},
-    {"u32" , {AstTypeId::Integer,       {"u32" , nullptr, 32 , false}}},
-    {"u64" , {AstTypeId::Integer,       {"u64" , nullptr, 64 , false}}},
-    {"u128", {AstTypeId::Integer,       {"u128", nullptr, 128, false}}},
-    {"f32" , {AstTypeId::FloatingPoint, {"f32" , nullptr, 32 , true}}},
-    {"f64" , {AstTypeId::FloatingPoint, {"f64" , nullptr, 64 , true}}},
-    {"f128", {AstTypeId::FloatingPoint, {"f128", nullptr, 128, true}}},
-    {"void", {AstTypeId::Void,          {"void", nullptr, 0  , false}}},
-    {"bool", {AstTypeId::Bool,          {"bool", nullptr, 1  , false}}}
-};
-
-AstTypeId get_type_id(std::string_view in_name, TypeInfo** info) noexcept {
-    if (typesIds.find(in_name) == typesIds.end()) {
-        (*info)->name = in_name;
-        return AstTypeId::Struct;
-    }
-    auto type_info = typesIds[in_name];
-    *info = new TypeInfo(type_info.info);
-    return type_info.id;
-}
-
 bool match(const Token* token, ...) noexcept {
     va_list vargv;
     va_start(vargv, token);
@@ -23,10 +23,8 @@ public:
     // returns AstSourceCode
     LL_NODISCARD AstNode* parse_source_code() noexcept;
 
-    /*
     // returns AstDirective
     LL_NODISCARD AstNode* parse_basic_directive() noexcept;
-    */
 
     // returns AstFuncDef
     LL_NODISCARD AstNode* parse_function_def() noexcept;
@@ -78,7 +76,11 @@ public:
     
     AstNode* parse_error(const Token& token, const char* format, ...) noexcept;
 
-    bool is_new_line_between(const size_t start_pos, const size_t end_pos);
+    // skips what is left of a statement that failed to parse, up to its ';' or the end of its line
+    void skip_statement(const Token& in_first_token) noexcept;
+
+    // compares the lines the lexer stored, nothing is rescanned
+    bool is_new_line_between(const Token& token, const Token& next_token) const noexcept;
 
     // consumes the forbiden statement, report the error and return true else returns false
     bool is_forbiden_statement(const Token& token) noexcept;
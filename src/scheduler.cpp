@@ -0,0 +1,134 @@
+#include "scheduler.hpp"
+#include "trace.hpp"
+#include <string>
+
+// index of the worker running on this thread, used to push to its own deque
+static thread_local const Scheduler* current_scheduler = nullptr;
+static thread_local size_t current_worker_index = 0;
+
+Scheduler::Scheduler(uint32_t in_thread_count)
+    : queued_tasks(0), pending_tasks(0), next_worker(0), is_stopping(false) {
+    if (in_thread_count == 0) {
+        in_thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for (uint32_t i = 0; i < in_thread_count; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t i = 0; i < in_thread_count; i++) {
+        threads.emplace_back(&Scheduler::run_worker, this, i);
+    }
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        is_stopping = true;
+    }
+    work_available.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void Scheduler::submit(std::function<void()> in_task) noexcept {
+    pending_tasks++;
+
+    const size_t worker_index = current_scheduler == this
+        ? current_worker_index
+        : next_worker++ % workers.size();
+    {
+        // counted under the lock so a worker going to sleep can't miss it.
+        // counted before the push so it never goes below zero when popped right away.
+        std::lock_guard<std::mutex> lock(state_mutex);
+        queued_tasks++;
+    }
+    {
+        Worker& worker = *workers[worker_index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(in_task));
+    }
+    work_available.notify_one();
+}
+
+void Scheduler::wait() noexcept {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    all_done.wait(lock, [this] { return pending_tasks == 0; });
+}
+
+void Scheduler::wait_for(const std::atomic<size_t>& in_counter) noexcept {
+    // the own deque first, where the awaited tasks were pushed
+    const size_t worker_index = current_scheduler == this ? current_worker_index : 0;
+    while (in_counter != 0) {
+        std::function<void()> task;
+        if (pop_task(worker_index, task)) {
+            run_task(task);
+        }
+        else {
+            // the rest are running in other workers
+            std::this_thread::yield();
+        }
+    }
+}
+
+size_t Scheduler::get_worker_count() const noexcept {
+    return workers.size();
+}
+
+void Scheduler::run_worker(size_t in_worker_index) noexcept {
+    current_scheduler = this;
+    current_worker_index = in_worker_index;
+    trace::start_thread("worker " + std::to_string(in_worker_index));
+
+    for (;;) {
+        std::function<void()> task;
+        if (!pop_task(in_worker_index, task)) {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_available.wait(lock, [this] { return is_stopping || queued_tasks != 0; });
+            if (is_stopping && queued_tasks == 0) {
+                trace::finish_thread();
+                return;
+            }
+            continue;
+        }
+
+        run_task(task);
+    }
+}
+
+void Scheduler::run_task(std::function<void()>& io_task) noexcept {
+    io_task();
+
+    if (--pending_tasks == 0) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        all_done.notify_all();
+    }
+}
+
+bool Scheduler::pop_task(size_t in_worker_index, std::function<void()>& out_task) noexcept {
+    const size_t worker_count = workers.size();
+    for (size_t i = 0; i < worker_count; i++) {
+        const size_t victim_index = (in_worker_index + i) % worker_count;
+        Worker& victim = *workers[victim_index];
+
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+
+        // own tasks are taken newest first, stolen ones oldest first
+        if (victim_index == in_worker_index) {
+            out_task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+        } else {
+            out_task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+
+        std::lock_guard<std::mutex> state_lock(state_mutex);
+        queued_tasks--;
+        return true;
+    }
+    return false;
+}
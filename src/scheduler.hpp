@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* Work stealing thread pool.
+* Every worker owns a deque: tasks submitted from a worker go to the
+* back of its own deque and are popped from there (the most recent task
+* has its data in cache), idle workers steal from the front of the others.
+*/
+class Scheduler {
+    struct Worker {
+        std::mutex                          mutex;
+        std::deque<std::function<void()>>   tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread>             threads;
+
+    std::mutex              state_mutex;
+    std::condition_variable work_available;  // wakes idle workers
+    std::condition_variable all_done;        // wakes wait()
+    size_t                  queued_tasks;    // in any deque, guarded by state_mutex
+    std::atomic<size_t>     pending_tasks;   // submitted and not finished yet
+    std::atomic<size_t>     next_worker;     // round robin for tasks submitted from other threads
+    bool                    is_stopping;
+
+public:
+    // 0 uses one thread per hardware thread
+    explicit Scheduler(uint32_t in_thread_count);
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // tasks may submit more tasks
+    void submit(std::function<void()> in_task) noexcept;
+
+    // blocks until every submitted task has finished
+    void wait() noexcept;
+
+    // runs queued tasks on the calling thread until in_counter is zero, the tasks it waits for decrement it.
+    // a task can wait for the tasks it submitted without taking a worker away
+    void wait_for(const std::atomic<size_t>& in_counter) noexcept;
+
+    size_t get_worker_count() const noexcept;
+
+private:
+    void run_worker(size_t in_worker_index) noexcept;
+    void run_task(std::function<void()>& io_task) noexcept;
+    bool pop_task(size_t in_worker_index, std::function<void()>& out_task) noexcept;
+};
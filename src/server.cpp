@@ -0,0 +1,250 @@
+#include "server.hpp"
+#include "console.hpp"
+#include <sstream>
+
+#ifdef _WIN32
+
+int server::listen(const std::string&, const JobHandler&) noexcept {
+    console::WriteLine("the compile server needs Unix domain sockets, it's not supported on this platform");
+    return -1;
+}
+
+int server::send_job(const std::string&, const std::string&, const std::vector<std::string>&) noexcept {
+    console::WriteLine("the compile server needs Unix domain sockets, it's not supported on this platform");
+    return -1;
+}
+
+#else
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// a corrupted size must not make us allocate the world
+#define MAX_MESSAGE_STRINGS 4096
+#define MAX_STRING_SIZE     (64u * 1024u * 1024u)
+
+static bool get_socket_address(const std::string& in_socket_path, sockaddr_un* out_address) noexcept;
+static bool remove_stale_socket(const std::string& in_socket_path, const sockaddr_un& in_address) noexcept;
+static bool send_strings(int in_fd, const std::vector<std::string>& in_strings) noexcept;
+static bool receive_strings(int in_fd, std::vector<std::string>& out_strings) noexcept;
+static bool write_all(int in_fd, const char* in_data, size_t in_size) noexcept;
+static bool read_all(int in_fd, char* out_data, size_t in_size) noexcept;
+
+int server::listen(const std::string& in_socket_path, const JobHandler& in_handler) noexcept {
+    sockaddr_un address;
+    if (!get_socket_address(in_socket_path, &address)) {
+        return -1;
+    }
+
+    if (!remove_stale_socket(in_socket_path, address)) {
+        return -1;
+    }
+
+    int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd < 0) {
+        console::WriteLine("could not create the server socket: " + std::string(strerror(errno)));
+        return -1;
+    }
+
+    if (bind(server_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(server_fd, SOMAXCONN) != 0) {
+        console::WriteLine("could not listen in " + in_socket_path + ": " + strerror(errno));
+        close(server_fd);
+        return -1;
+    }
+    console::WriteLine("listening in " + in_socket_path);
+
+    while (true) {
+        int client_fd = accept(server_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            console::WriteLine("could not accept a client: " + std::string(strerror(errno)));
+            break;
+        }
+
+        std::vector<std::string> request;
+        if (receive_strings(client_fd, request) && !request.empty()) {
+            const std::string working_dir = request.front();
+            request.erase(request.begin());
+
+            // the job output goes to the client
+            std::ostringstream job_output;
+            std::streambuf* server_output = std::cout.rdbuf(job_output.rdbuf());
+            const int exit_code = in_handler(working_dir, request);
+            std::cout.flush();
+            std::cout.rdbuf(server_output);
+
+            // a client that went away is not an error
+            (void)send_strings(client_fd, { std::to_string(exit_code), job_output.str() });
+        }
+        close(client_fd);
+    }
+
+    close(server_fd);
+    unlink(in_socket_path.c_str());
+    return -1;
+}
+
+// a socket left behind by a server that was killed is removed, anything else in the path is kept
+bool remove_stale_socket(const std::string& in_socket_path, const sockaddr_un& in_address) noexcept {
+    struct stat path_stat;
+    if (lstat(in_socket_path.c_str(), &path_stat) != 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        console::WriteLine("could not listen in " + in_socket_path + ": " + strerror(errno));
+        return false;
+    }
+    if (!S_ISSOCK(path_stat.st_mode)) {
+        console::WriteLine("could not listen in " + in_socket_path + ": path exists");
+        return false;
+    }
+
+    // nobody accepts in a stale socket
+    int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe_fd < 0) {
+        console::WriteLine("could not create the server socket: " + std::string(strerror(errno)));
+        return false;
+    }
+    const bool is_alive = connect(probe_fd, reinterpret_cast<const sockaddr*>(&in_address), sizeof(in_address)) == 0;
+    close(probe_fd);
+    if (is_alive) {
+        console::WriteLine("a compile server is already listening in " + in_socket_path);
+        return false;
+    }
+
+    if (unlink(in_socket_path.c_str()) != 0) {
+        console::WriteLine("could not remove the stale socket " + in_socket_path + ": " + strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+int server::send_job(const std::string& in_socket_path, const std::string& in_working_dir, const std::vector<std::string>& in_args) noexcept {
+    sockaddr_un address;
+    if (!get_socket_address(in_socket_path, &address)) {
+        return -1;
+    }
+
+    int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd < 0 || connect(server_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        console::WriteLine("could not connect to the compile server in " + in_socket_path + ": " + strerror(errno));
+        if (server_fd >= 0) {
+            close(server_fd);
+        }
+        return -1;
+    }
+
+    std::vector<std::string> request = { in_working_dir };
+    request.insert(request.end(), in_args.begin(), in_args.end());
+
+    std::vector<std::string> response;
+    const bool is_answered = send_strings(server_fd, request) && receive_strings(server_fd, response) && response.size() == 2;
+    close(server_fd);
+    if (!is_answered) {
+        console::WriteLine("the compile server in " + in_socket_path + " closed the connection");
+        return -1;
+    }
+
+    std::cout << response[1];
+    std::cout.flush();
+    return std::atoi(response[0].c_str());
+}
+
+bool get_socket_address(const std::string& in_socket_path, sockaddr_un* out_address) noexcept {
+    memset(out_address, 0, sizeof(sockaddr_un));
+    out_address->sun_family = AF_UNIX;
+
+    // keeps the null terminator
+    if (in_socket_path.size() >= sizeof(out_address->sun_path)) {
+        console::WriteLine("socket path is too long: " + in_socket_path);
+        return false;
+    }
+    memcpy(out_address->sun_path, in_socket_path.data(), in_socket_path.size());
+    return true;
+}
+
+bool send_strings(int in_fd, const std::vector<std::string>& in_strings) noexcept {
+    std::string message;
+    auto add_size = [&](size_t in_size) {
+        for (size_t i = 0; i < sizeof(uint32_t); i++) {
+            message.push_back(char(uint8_t(in_size >> (i * 8))));
+        }
+    };
+
+    add_size(in_strings.size());
+    for (auto& string : in_strings) {
+        add_size(string.size());
+        message += string;
+    }
+    return write_all(in_fd, message.data(), message.size());
+}
+
+bool receive_strings(int in_fd, std::vector<std::string>& out_strings) noexcept {
+    auto read_size = [&](uint32_t* out_size) {
+        uint8_t bytes[sizeof(uint32_t)];
+        if (!read_all(in_fd, reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+            return false;
+        }
+        *out_size = uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+        return true;
+    };
+
+    uint32_t string_count;
+    if (!read_size(&string_count) || string_count > MAX_MESSAGE_STRINGS) {
+        return false;
+    }
+    out_strings.resize(string_count);
+    for (auto& string : out_strings) {
+        uint32_t string_size;
+        if (!read_size(&string_size) || string_size > MAX_STRING_SIZE) {
+            return false;
+        }
+        string.resize(string_size);
+        if (!read_all(in_fd, string.data(), string_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool write_all(int in_fd, const char* in_data, size_t in_size) noexcept {
+    while (in_size > 0) {
+        // a client that went away must not kill the server with SIGPIPE
+        ssize_t written = send(in_fd, in_data, in_size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        in_data += written;
+        in_size -= size_t(written);
+    }
+    return true;
+}
+
+bool read_all(int in_fd, char* out_data, size_t in_size) noexcept {
+    while (in_size > 0) {
+        ssize_t count = recv(in_fd, out_data, in_size, 0);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        out_data += count;
+        in_size -= size_t(count);
+    }
+    return true;
+}
+
+#endif
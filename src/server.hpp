@@ -0,0 +1,28 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+* Compile server: a long running compiler process serving the command
+* lines of thin clients over a Unix domain socket, so LLVM, the interned
+* types and the cached artifacts stay warm between invocations.
+*
+* Messages are lists of strings, every string prefixed by its little endian
+* uint32 size and the list by its count:
+*   request     working directory, arguments...
+*   response    exit code (decimal), output
+*/
+namespace server {
+    // runs a command line, whatever it writes to std::cout is sent to the client.
+    // returns the exit code
+    using JobHandler = std::function<int(const std::string& in_working_dir, const std::vector<std::string>& in_args)>;
+
+    // serves jobs one at a time until the process is killed.
+    // returns the exit code if the socket can not be used
+    int listen(const std::string& in_socket_path, const JobHandler& in_handler) noexcept;
+
+    // runs a command line in the server listening in in_socket_path and prints its output.
+    // returns the exit code of the job
+    int send_job(const std::string& in_socket_path, const std::string& in_working_dir, const std::vector<std::string>& in_args) noexcept;
+}
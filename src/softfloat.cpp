@@ -0,0 +1,851 @@
+/*
+ * Based on Berkeley SoftFloat Release 3e, by John R. Hauser.
+ * Copyright 2011, 2012, 2013, 2014, 2015, 2016, 2017 The Regents of the
+ * University of California. All rights reserved.
+ * BSD licensed, see http://www.jhauser.us/arithmetic/SoftFloat.html
+ */
+
+#include "softfloat.hpp"
+#include <assert.h>
+
+// significands are kept with the implicit bit at bit 48 of the high word and
+// exponents one under the biased one, so packing adds the implicit bit to them
+#define F128_EXP_MAX        0x7fff
+#define F128_IMPLICIT_BIT   UINT64_C(0x0001000000000000)
+#define F128_FRAC_MASK      UINT64_C(0x0000ffffffffffff)
+#define F128_QUIET_BIT      UINT64_C(0x0000800000000000)
+#define F128_DEFAULT_NAN    UINT64_C(0x7fff800000000000)
+
+struct uint128 {
+    uint64_t v64;
+    uint64_t v0;
+};
+
+// significand and the bits shifted out of it, the highest one is the round bit
+struct uint128_extra {
+    uint64_t extra;
+    uint128  v;
+};
+
+struct exp_sig128 {
+    int32_t exp;
+    uint128 sig;
+};
+
+static float128_t make_f128(uint64_t v64, uint64_t v0);
+static uint64_t pack_to_f128_ui64(bool sign, int32_t exp, uint64_t sig64);
+static bool sign_f128_ui64(uint64_t a64);
+static int32_t exp_f128_ui64(uint64_t a64);
+static uint64_t frac_f128_ui64(uint64_t a64);
+static bool is_nan_f128_ui(uint64_t a64, uint64_t a0);
+static float128_t propagate_nan(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0);
+static int32_t count_leading_zeros_64(uint64_t a);
+static uint128 add_128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0);
+static uint128 sub_128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0);
+static bool lt_128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0);
+static uint128 short_shift_left_128(uint64_t a64, uint64_t a0, uint8_t dist);
+static uint128 short_shift_right_128(uint64_t a64, uint64_t a0, uint8_t dist);
+static uint128 shift_right_jam_128(uint64_t a64, uint64_t a0, uint32_t dist);
+static uint128_extra short_shift_right_jam_128_extra(uint64_t a64, uint64_t a0, uint64_t extra, uint8_t dist);
+static uint128_extra shift_right_jam_128_extra(uint64_t a64, uint64_t a0, uint64_t extra, uint32_t dist);
+static uint64_t shift_right_jam_64(uint64_t a, uint32_t dist);
+static uint128 mul_64_to_128(uint64_t a, uint64_t b);
+static void mul_128_to_256(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0, uint64_t z[4]);
+static exp_sig128 norm_subnormal_f128_sig(uint64_t sig64, uint64_t sig0);
+static float128_t round_pack_to_f128(bool sign, int32_t exp, uint64_t sig64, uint64_t sig0, uint64_t sig_extra);
+static float128_t norm_round_pack_to_f128(bool sign, int32_t exp, uint64_t sig64, uint64_t sig0);
+static uint64_t round_pack_to_f64(bool sign, int32_t exp, uint64_t sig);
+static uint32_t round_pack_to_f32(bool sign, int32_t exp, uint32_t sig);
+static float128_t add_mags_f128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0, bool sign);
+static float128_t sub_mags_f128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0, bool sign);
+
+//==================================================================================
+//          ARITHMETIC
+//==================================================================================
+
+float128_t f128_add(float128_t a, float128_t b) {
+    const bool sign_a = sign_f128_ui64(a.v[1]);
+    const bool sign_b = sign_f128_ui64(b.v[1]);
+    if (sign_a == sign_b) {
+        return add_mags_f128(a.v[1], a.v[0], b.v[1], b.v[0], sign_a);
+    }
+    return sub_mags_f128(a.v[1], a.v[0], b.v[1], b.v[0], sign_a);
+}
+
+float128_t f128_sub(float128_t a, float128_t b) {
+    const bool sign_a = sign_f128_ui64(a.v[1]);
+    const bool sign_b = sign_f128_ui64(b.v[1]);
+    if (sign_a == sign_b) {
+        return sub_mags_f128(a.v[1], a.v[0], b.v[1], b.v[0], sign_a);
+    }
+    return add_mags_f128(a.v[1], a.v[0], b.v[1], b.v[0], sign_a);
+}
+
+float128_t f128_mul(float128_t a, float128_t b) {
+    const bool sign_a = sign_f128_ui64(a.v[1]);
+    int32_t exp_a = exp_f128_ui64(a.v[1]);
+    uint128 sig_a = { frac_f128_ui64(a.v[1]), a.v[0] };
+    const bool sign_b = sign_f128_ui64(b.v[1]);
+    int32_t exp_b = exp_f128_ui64(b.v[1]);
+    uint128 sig_b = { frac_f128_ui64(b.v[1]), b.v[0] };
+    const bool sign_z = sign_a ^ sign_b;
+
+    // infinity times zero is invalid
+    if (exp_a == F128_EXP_MAX) {
+        if ((sig_a.v64 | sig_a.v0) != 0 || (exp_b == F128_EXP_MAX && (sig_b.v64 | sig_b.v0) != 0)) {
+            return propagate_nan(a.v[1], a.v[0], b.v[1], b.v[0]);
+        }
+        if ((uint64_t(exp_b) | sig_b.v64 | sig_b.v0) == 0) {
+            return make_f128(F128_DEFAULT_NAN, 0);
+        }
+        return make_f128(pack_to_f128_ui64(sign_z, F128_EXP_MAX, 0), 0);
+    }
+    if (exp_b == F128_EXP_MAX) {
+        if ((sig_b.v64 | sig_b.v0) != 0) {
+            return propagate_nan(a.v[1], a.v[0], b.v[1], b.v[0]);
+        }
+        if ((uint64_t(exp_a) | sig_a.v64 | sig_a.v0) == 0) {
+            return make_f128(F128_DEFAULT_NAN, 0);
+        }
+        return make_f128(pack_to_f128_ui64(sign_z, F128_EXP_MAX, 0), 0);
+    }
+
+    if (exp_a == 0) {
+        if ((sig_a.v64 | sig_a.v0) == 0) {
+            return make_f128(pack_to_f128_ui64(sign_z, 0, 0), 0);
+        }
+        exp_sig128 norm = norm_subnormal_f128_sig(sig_a.v64, sig_a.v0);
+        exp_a = norm.exp;
+        sig_a = norm.sig;
+    }
+    if (exp_b == 0) {
+        if ((sig_b.v64 | sig_b.v0) == 0) {
+            return make_f128(pack_to_f128_ui64(sign_z, 0, 0), 0);
+        }
+        exp_sig128 norm = norm_subnormal_f128_sig(sig_b.v64, sig_b.v0);
+        exp_b = norm.exp;
+        sig_b = norm.sig;
+    }
+
+    // sig_a * (sig_b << 16) has the implicit bit of b on the high 128 bits, it's added after
+    int32_t exp_z = exp_a + exp_b - 0x4000;
+    sig_a.v64 |= F128_IMPLICIT_BIT;
+    sig_b = short_shift_left_128(sig_b.v64, sig_b.v0, 16);
+    uint64_t product[4];
+    mul_128_to_256(sig_a.v64, sig_a.v0, sig_b.v64, sig_b.v0, product);
+    uint64_t sig_z_extra = product[1] | (product[0] != 0);
+    uint128 sig_z = add_128(product[3], product[2], sig_a.v64, sig_a.v0);
+    if (sig_z.v64 >= (F128_IMPLICIT_BIT << 1)) {
+        exp_z += 1;
+        uint128_extra shifted = short_shift_right_jam_128_extra(sig_z.v64, sig_z.v0, sig_z_extra, 1);
+        sig_z = shifted.v;
+        sig_z_extra = shifted.extra;
+    }
+    return round_pack_to_f128(sign_z, exp_z, sig_z.v64, sig_z.v0, sig_z_extra);
+}
+
+float128_t f128_div(float128_t a, float128_t b) {
+    const bool sign_a = sign_f128_ui64(a.v[1]);
+    int32_t exp_a = exp_f128_ui64(a.v[1]);
+    uint128 sig_a = { frac_f128_ui64(a.v[1]), a.v[0] };
+    const bool sign_b = sign_f128_ui64(b.v[1]);
+    int32_t exp_b = exp_f128_ui64(b.v[1]);
+    uint128 sig_b = { frac_f128_ui64(b.v[1]), b.v[0] };
+    const bool sign_z = sign_a ^ sign_b;
+
+    if (exp_a == F128_EXP_MAX) {
+        if ((sig_a.v64 | sig_a.v0) != 0) {
+            return propagate_nan(a.v[1], a.v[0], b.v[1], b.v[0]);
+        }
+        if (exp_b == F128_EXP_MAX) {
+            if ((sig_b.v64 | sig_b.v0) != 0) {
+                return propagate_nan(a.v[1], a.v[0], b.v[1], b.v[0]);
+            }
+            return make_f128(F128_DEFAULT_NAN, 0);
+        }
+        return make_f128(pack_to_f128_ui64(sign_z, F128_EXP_MAX, 0), 0);
+    }
+    if (exp_b == F128_EXP_MAX) {
+        if ((sig_b.v64 | sig_b.v0) != 0) {
+            return propagate_nan(a.v[1], a.v[0], b.v[1], b.v[0]);
+        }
+        return make_f128(pack_to_f128_ui64(sign_z, 0, 0), 0);
+    }
+
+    // zero divided by zero is invalid, anything else by zero is infinite
+    if (exp_b == 0) {
+        if ((sig_b.v64 | sig_b.v0) == 0) {
+            if ((uint64_t(exp_a) | sig_a.v64 | sig_a.v0) == 0) {
+                return make_f128(F128_DEFAULT_NAN, 0);
+            }
+            return make_f128(pack_to_f128_ui64(sign_z, F128_EXP_MAX, 0), 0);
+        }
+        exp_sig128 norm = norm_subnormal_f128_sig(sig_b.v64, sig_b.v0);
+        exp_b = norm.exp;
+        sig_b = norm.sig;
+    }
+    if (exp_a == 0) {
+        if ((sig_a.v64 | sig_a.v0) == 0) {
+            return make_f128(pack_to_f128_ui64(sign_z, 0, 0), 0);
+        }
+        exp_sig128 norm = norm_subnormal_f128_sig(sig_a.v64, sig_a.v0);
+        exp_a = norm.exp;
+        sig_a = norm.sig;
+    }
+
+    int32_t exp_z = exp_a - exp_b + 0x3ffe;
+    sig_a.v64 |= F128_IMPLICIT_BIT;
+    sig_b.v64 |= F128_IMPLICIT_BIT;
+    uint128 rem = sig_a;
+    if (lt_128(sig_a.v64, sig_a.v0, sig_b.v64, sig_b.v0)) {
+        exp_z -= 1;
+        rem = add_128(sig_a.v64, sig_a.v0, sig_a.v64, sig_a.v0);
+    }
+
+    // sig_b <= rem < 2 * sig_b, long division gives the 113 bits of the quotient,
+    // the round bit and one more, the remainder is sticky
+    uint128 quotient = { 0, 0 };
+    for (int i = 0; i < 115; i += 1) {
+        quotient = short_shift_left_128(quotient.v64, quotient.v0, 1);
+        if (!lt_128(rem.v64, rem.v0, sig_b.v64, sig_b.v0)) {
+            rem = sub_128(rem.v64, rem.v0, sig_b.v64, sig_b.v0);
+            quotient.v0 |= 1;
+        }
+        rem = short_shift_left_128(rem.v64, rem.v0, 1);
+    }
+    const uint64_t sig_z_extra = (quotient.v0 << 62) | ((rem.v64 | rem.v0) != 0);
+    const uint128 sig_z = short_shift_right_128(quotient.v64, quotient.v0, 2);
+    return round_pack_to_f128(sign_z, exp_z, sig_z.v64, sig_z.v0, sig_z_extra);
+}
+
+float128_t f128_neg(float128_t a) {
+    return make_f128(a.v[1] ^ (UINT64_C(1) << 63), a.v[0]);
+}
+
+//==================================================================================
+//          COMPARISON
+//==================================================================================
+
+bool f128_eq(float128_t a, float128_t b) {
+    if (f128_is_nan(a) || f128_is_nan(b)) {
+        return false;
+    }
+    return a.v[0] == b.v[0]
+        && (a.v[1] == b.v[1] || (a.v[0] == 0 && ((a.v[1] | b.v[1]) & ~(UINT64_C(1) << 63)) == 0));
+}
+
+bool f128_lt(float128_t a, float128_t b) {
+    if (f128_is_nan(a) || f128_is_nan(b)) {
+        return false;
+    }
+    const bool sign_a = sign_f128_ui64(a.v[1]);
+    const bool sign_b = sign_f128_ui64(b.v[1]);
+    if (sign_a != sign_b) {
+        return sign_a && ((((a.v[1] | b.v[1]) & ~(UINT64_C(1) << 63)) | a.v[0] | b.v[0]) != 0);
+    }
+    return (a.v[1] != b.v[1] || a.v[0] != b.v[0]) && (sign_a ^ lt_128(a.v[1], a.v[0], b.v[1], b.v[0]));
+}
+
+bool f128_le(float128_t a, float128_t b) {
+    if (f128_is_nan(a) || f128_is_nan(b)) {
+        return false;
+    }
+    const bool sign_a = sign_f128_ui64(a.v[1]);
+    const bool sign_b = sign_f128_ui64(b.v[1]);
+    if (sign_a != sign_b) {
+        return sign_a || ((((a.v[1] | b.v[1]) & ~(UINT64_C(1) << 63)) | a.v[0] | b.v[0]) == 0);
+    }
+    return (a.v[1] == b.v[1] && a.v[0] == b.v[0]) || (sign_a ^ lt_128(a.v[1], a.v[0], b.v[1], b.v[0]));
+}
+
+bool f128_is_nan(float128_t a) {
+    return is_nan_f128_ui(a.v[1], a.v[0]);
+}
+
+bool f128_is_infinite(float128_t a) {
+    return exp_f128_ui64(a.v[1]) == F128_EXP_MAX && frac_f128_ui64(a.v[1]) == 0 && a.v[0] == 0;
+}
+
+//==================================================================================
+//          CONVERSION
+//==================================================================================
+
+float128_t f64_to_f128(uint64_t a) {
+    const bool sign = (a >> 63) != 0;
+    int32_t exp = int32_t((a >> 52) & 0x7ff);
+    uint64_t frac = a & UINT64_C(0x000fffffffffffff);
+
+    if (exp == 0x7ff) {
+        if (frac != 0) {
+            // the payload is kept
+            return make_f128(pack_to_f128_ui64(sign, F128_EXP_MAX, 0) | F128_QUIET_BIT | (frac >> 4), frac << 60);
+        }
+        return make_f128(pack_to_f128_ui64(sign, F128_EXP_MAX, 0), 0);
+    }
+
+    if (exp == 0) {
+        if (frac == 0) {
+            return make_f128(pack_to_f128_ui64(sign, 0, 0), 0);
+        }
+        // the implicit bit of the normalized significand goes to the exponent
+        const int32_t shift_dist = count_leading_zeros_64(frac) - 11;
+        exp = 1 - shift_dist - 1;
+        frac = frac << shift_dist;
+    }
+    const uint128 frac128 = short_shift_left_128(0, frac, 60);
+    return make_f128(pack_to_f128_ui64(sign, exp + 0x3c00, frac128.v64), frac128.v0);
+}
+
+uint64_t f128_to_f64(float128_t a) {
+    const bool sign = sign_f128_ui64(a.v[1]);
+    int32_t exp = exp_f128_ui64(a.v[1]);
+    uint64_t frac64 = frac_f128_ui64(a.v[1]);
+    const uint64_t frac0 = a.v[0];
+
+    if (exp == F128_EXP_MAX) {
+        if ((frac64 | frac0) != 0) {
+            return (uint64_t(sign) << 63) | UINT64_C(0x7ff8000000000000) | (frac64 << 4) | (frac0 >> 60);
+        }
+        return (uint64_t(sign) << 63) | UINT64_C(0x7ff0000000000000);
+    }
+
+    // 62 bits of the fraction, the others are sticky
+    frac64 = (frac64 << 14) | (frac0 >> 50);
+    frac64 |= (frac0 << 14) != 0;
+    if ((uint64_t(exp) | frac64) == 0) {
+        return uint64_t(sign) << 63;
+    }
+    exp -= 0x3c01;
+    if (exp < -0x1000) {
+        exp = -0x1000;
+    }
+    return round_pack_to_f64(sign, exp, frac64 | UINT64_C(0x4000000000000000));
+}
+
+uint32_t f128_to_f32(float128_t a) {
+    const bool sign = sign_f128_ui64(a.v[1]);
+    int32_t exp = exp_f128_ui64(a.v[1]);
+    const uint64_t frac64 = frac_f128_ui64(a.v[1]) | (a.v[0] != 0);
+
+    if (exp == F128_EXP_MAX) {
+        if (frac64 != 0) {
+            return (uint32_t(sign) << 31) | UINT32_C(0x7fc00000) | uint32_t(a.v[1] >> 25 & 0x3fffff);
+        }
+        return (uint32_t(sign) << 31) | UINT32_C(0x7f800000);
+    }
+
+    // 30 bits of the fraction, the others are sticky
+    const uint32_t frac32 = uint32_t((frac64 >> 18) | ((frac64 & 0x3ffff) != 0));
+    if ((uint32_t(exp) | frac32) == 0) {
+        return uint32_t(sign) << 31;
+    }
+    exp -= 0x3f81;
+    if (exp < -0x1000) {
+        exp = -0x1000;
+    }
+    return round_pack_to_f32(sign, exp, frac32 | UINT32_C(0x40000000));
+}
+
+float128_t bigint_to_f128(const BigInt *op) {
+    if (op->digit_count == 0) {
+        return make_f128(0, 0);
+    }
+    // far past the largest finite value
+    if (op->digit_count > (F128_EXP_MAX + 1) / 64 + 2) {
+        return make_f128(pack_to_f128_ui64(op->is_negative, F128_EXP_MAX, 0), 0);
+    }
+
+    // the three highest digits, normalized. the ones under them are sticky
+    const uint64_t *digits = bigint_ptr(op);
+    const size_t count = op->digit_count;
+    uint64_t top[3] = {
+        count >= 3 ? digits[count - 3] : 0,
+        count >= 2 ? digits[count - 2] : 0,
+        digits[count - 1],
+    };
+    bool is_sticky = false;
+    for (size_t i = 0; i + 3 < count; i += 1) {
+        is_sticky |= digits[i] != 0;
+    }
+
+    const int32_t leading_zeros = count_leading_zeros_64(top[2]);
+    if (leading_zeros != 0) {
+        top[2] = (top[2] << leading_zeros) | (top[1] >> (64 - leading_zeros));
+        top[1] = (top[1] << leading_zeros) | (top[0] >> (64 - leading_zeros));
+        top[0] = top[0] << leading_zeros;
+    }
+
+    // the highest bit moves to the implicit one
+    const uint128_extra sig = short_shift_right_jam_128_extra(top[2], top[1], top[0] | is_sticky, 15);
+    const int32_t exp = 0x3ffe + 127 + 64 * (int32_t(count) - 2) - leading_zeros;
+    return round_pack_to_f128(op->is_negative, exp, sig.v.v64, sig.v.v0, sig.extra);
+}
+
+bool f128_to_bigint(BigInt *dest, float128_t a) {
+    const bool sign = sign_f128_ui64(a.v[1]);
+    const int32_t exp = exp_f128_ui64(a.v[1]);
+    if (exp == F128_EXP_MAX) {
+        return false;
+    }
+    // under one
+    if (exp < 0x3fff) {
+        bigint_init_unsigned(dest, 0);
+        return true;
+    }
+
+    // value is sig * 2^shift
+    const uint128 sig = { frac_f128_ui64(a.v[1]) | F128_IMPLICIT_BIT, a.v[0] };
+    const int32_t shift = exp - 0x3fff - 112;
+    if (shift < 0) {
+        const uint128 integer = -shift < 64
+            ? short_shift_right_128(sig.v64, sig.v0, uint8_t(-shift))
+            : uint128{ 0, sig.v64 >> (-shift - 64) };
+        const uint64_t digits[2] = { integer.v0, integer.v64 };
+        bigint_init_data(dest, digits, 2, sign);
+        return true;
+    }
+
+    const uint64_t digits[2] = { sig.v0, sig.v64 };
+    BigInt value;
+    bigint_init_data(&value, digits, 2, sign);
+    BigInt shift_bi;
+    bigint_init_unsigned(&shift_bi, uint64_t(shift));
+    bigint_shl(dest, &value, &shift_bi);
+    return true;
+}
+
+//==================================================================================
+//          INTERNALS
+//==================================================================================
+
+float128_t make_f128(uint64_t v64, uint64_t v0) {
+    float128_t z = { { v0, v64 } };
+    return z;
+}
+
+// the exponent is added, a carry from the significand increments it
+uint64_t pack_to_f128_ui64(bool sign, int32_t exp, uint64_t sig64) {
+    return (uint64_t(sign) << 63) + (uint64_t(exp) << 48) + sig64;
+}
+
+bool sign_f128_ui64(uint64_t a64) {
+    return (a64 >> 63) != 0;
+}
+
+int32_t exp_f128_ui64(uint64_t a64) {
+    return int32_t((a64 >> 48) & F128_EXP_MAX);
+}
+
+uint64_t frac_f128_ui64(uint64_t a64) {
+    return a64 & F128_FRAC_MASK;
+}
+
+bool is_nan_f128_ui(uint64_t a64, uint64_t a0) {
+    return (~a64 & UINT64_C(0x7fff000000000000)) == 0 && (a0 != 0 || (a64 & F128_FRAC_MASK) != 0);
+}
+
+// the first NaN operand, made quiet
+float128_t propagate_nan(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0) {
+    if (is_nan_f128_ui(a64, a0)) {
+        return make_f128(a64 | F128_QUIET_BIT, a0);
+    }
+    return make_f128(b64 | F128_QUIET_BIT, b0);
+}
+
+int32_t count_leading_zeros_64(uint64_t a) {
+    return 64 - int32_t(bigint_digits_bit_count(&a, 1));
+}
+
+uint128 add_128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0) {
+    uint128 z;
+    z.v0 = a0 + b0;
+    z.v64 = a64 + b64 + (z.v0 < a0);
+    return z;
+}
+
+uint128 sub_128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0) {
+    uint128 z;
+    z.v0 = a0 - b0;
+    z.v64 = a64 - b64 - (a0 < b0);
+    return z;
+}
+
+bool lt_128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0) {
+    return a64 < b64 || (a64 == b64 && a0 < b0);
+}
+
+// dist from 1 to 63
+uint128 short_shift_left_128(uint64_t a64, uint64_t a0, uint8_t dist) {
+    assert(dist > 0 && dist < 64);
+    uint128 z;
+    z.v64 = (a64 << dist) | (a0 >> (64 - dist));
+    z.v0 = a0 << dist;
+    return z;
+}
+
+uint128 short_shift_right_128(uint64_t a64, uint64_t a0, uint8_t dist) {
+    assert(dist > 0 && dist < 64);
+    uint128 z;
+    z.v64 = a64 >> dist;
+    z.v0 = (a64 << (64 - dist)) | (a0 >> dist);
+    return z;
+}
+
+// the bits shifted out are ORed into the lowest one
+uint128 shift_right_jam_128(uint64_t a64, uint64_t a0, uint32_t dist) {
+    uint128 z;
+    if (dist == 0) {
+        z.v64 = a64;
+        z.v0 = a0;
+    } else if (dist < 64) {
+        z.v64 = a64 >> dist;
+        z.v0 = (a64 << (64 - dist)) | (a0 >> dist) | ((a0 << (64 - dist)) != 0);
+    } else {
+        z.v64 = 0;
+        if (dist == 64) {
+            z.v0 = a64 | (a0 != 0);
+        } else if (dist < 128) {
+            z.v0 = (a64 >> (dist - 64)) | (((a64 << (128 - dist)) | a0) != 0);
+        } else {
+            z.v0 = (a64 | a0) != 0;
+        }
+    }
+    return z;
+}
+
+uint128_extra short_shift_right_jam_128_extra(uint64_t a64, uint64_t a0, uint64_t extra, uint8_t dist) {
+    assert(dist > 0 && dist < 64);
+    uint128_extra z;
+    z.v.v64 = a64 >> dist;
+    z.v.v0 = (a64 << (64 - dist)) | (a0 >> dist);
+    z.extra = (a0 << (64 - dist)) | (extra != 0);
+    return z;
+}
+
+uint128_extra shift_right_jam_128_extra(uint64_t a64, uint64_t a0, uint64_t extra, uint32_t dist) {
+    if (dist == 0) {
+        uint128_extra z = { extra, { a64, a0 } };
+        return z;
+    }
+    if (dist < 64) {
+        return short_shift_right_jam_128_extra(a64, a0, extra, uint8_t(dist));
+    }
+
+    uint128_extra z;
+    z.v.v64 = 0;
+    if (dist == 64) {
+        z.v.v0 = a64;
+        z.extra = a0;
+    } else {
+        extra |= a0;
+        if (dist < 128) {
+            z.v.v0 = a64 >> (dist - 64);
+            z.extra = a64 << (128 - dist);
+        } else {
+            z.v.v0 = 0;
+            z.extra = dist == 128 ? a64 : (a64 != 0);
+        }
+    }
+    z.extra |= (extra != 0);
+    return z;
+}
+
+uint64_t shift_right_jam_64(uint64_t a, uint32_t dist) {
+    if (dist == 0) {
+        return a;
+    }
+    return dist < 63 ? (a >> dist) | ((a << (64 - dist)) != 0) : (a != 0);
+}
+
+uint128 mul_64_to_128(uint64_t a, uint64_t b) {
+    uint64_t low = a;
+    const uint64_t high = bigint_digits_mul_add(&low, 1, b, 0);
+    uint128 z = { high, low };
+    return z;
+}
+
+// z is least significant first
+void mul_128_to_256(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0, uint64_t z[4]) {
+    const uint128 p0 = mul_64_to_128(a0, b0);
+    const uint128 p64 = mul_64_to_128(a64, b0);
+    const uint128 q64 = mul_64_to_128(a0, b64);
+    const uint128 p128 = mul_64_to_128(a64, b64);
+
+    z[0] = p0.v0;
+    uint128 middle = add_128(0, p0.v64, 0, p64.v0);
+    middle = add_128(middle.v64, middle.v0, 0, q64.v0);
+    z[1] = middle.v0;
+
+    uint128 high = add_128(p128.v64, p128.v0, 0, middle.v64);
+    high = add_128(high.v64, high.v0, 0, p64.v64);
+    high = add_128(high.v64, high.v0, 0, q64.v64);
+    z[2] = high.v0;
+    z[3] = high.v64;
+}
+
+// moves the highest bit of a subnormal significand to the implicit one
+exp_sig128 norm_subnormal_f128_sig(uint64_t sig64, uint64_t sig0) {
+    exp_sig128 z;
+    if (sig64 == 0) {
+        const int32_t shift_dist = count_leading_zeros_64(sig0) - 15;
+        z.exp = -63 - shift_dist;
+        if (shift_dist < 0) {
+            z.sig.v64 = sig0 >> -shift_dist;
+            z.sig.v0 = sig0 << (64 + shift_dist);
+        } else {
+            z.sig.v64 = sig0 << shift_dist;
+            z.sig.v0 = 0;
+        }
+    } else {
+        const int32_t shift_dist = count_leading_zeros_64(sig64) - 15;
+        z.exp = 1 - shift_dist;
+        z.sig = short_shift_left_128(sig64, sig0, uint8_t(shift_dist));
+    }
+    return z;
+}
+
+// exp is one under the biased exponent, sig has the implicit bit and sig_extra the bits under it
+float128_t round_pack_to_f128(bool sign, int32_t exp, uint64_t sig64, uint64_t sig0, uint64_t sig_extra) {
+    bool do_increment = sig_extra >= (UINT64_C(1) << 63);
+    if (uint32_t(exp) >= 0x7ffd) {
+        if (exp < 0) {
+            // subnormal, rounded again after the shift
+            const uint128_extra shifted = shift_right_jam_128_extra(sig64, sig0, sig_extra, uint32_t(-exp));
+            sig64 = shifted.v.v64;
+            sig0 = shifted.v.v0;
+            sig_extra = shifted.extra;
+            exp = 0;
+            do_increment = sig_extra >= (UINT64_C(1) << 63);
+        } else if (exp > 0x7ffd
+            || (exp == 0x7ffd && sig64 == (F128_IMPLICIT_BIT << 1) - 1 && sig0 == UINT64_MAX && do_increment)) {
+            return make_f128(pack_to_f128_ui64(sign, F128_EXP_MAX, 0), 0);
+        }
+    }
+
+    if (do_increment) {
+        const uint128 sig = add_128(sig64, sig0, 0, 1);
+        sig64 = sig.v64;
+        // ties to even
+        sig0 = sig.v0 & ~uint64_t((sig_extra & ~(UINT64_C(1) << 63)) == 0);
+    } else if ((sig64 | sig0) == 0) {
+        exp = 0;
+    }
+    return make_f128(pack_to_f128_ui64(sign, exp, sig64), sig0);
+}
+
+// sig doesn't need to be normalized
+float128_t norm_round_pack_to_f128(bool sign, int32_t exp, uint64_t sig64, uint64_t sig0) {
+    if (sig64 == 0) {
+        exp -= 64;
+        sig64 = sig0;
+        sig0 = 0;
+    }
+    const int32_t shift_dist = count_leading_zeros_64(sig64) - 15;
+    exp -= shift_dist;
+
+    uint64_t sig_extra = 0;
+    if (shift_dist >= 0) {
+        if (shift_dist != 0) {
+            const uint128 sig = short_shift_left_128(sig64, sig0, uint8_t(shift_dist));
+            sig64 = sig.v64;
+            sig0 = sig.v0;
+        }
+        // exact
+        if (uint32_t(exp) < 0x7ffd) {
+            return make_f128(pack_to_f128_ui64(sign, (sig64 | sig0) != 0 ? exp : 0, sig64), sig0);
+        }
+    } else {
+        const uint128_extra sig = short_shift_right_jam_128_extra(sig64, sig0, 0, uint8_t(-shift_dist));
+        sig64 = sig.v.v64;
+        sig0 = sig.v.v0;
+        sig_extra = sig.extra;
+    }
+    return round_pack_to_f128(sign, exp, sig64, sig0, sig_extra);
+}
+
+// sig has the implicit bit at bit 62 and 10 bits to round
+uint64_t round_pack_to_f64(bool sign, int32_t exp, uint64_t sig) {
+    uint32_t round_bits = uint32_t(sig & 0x3ff);
+    if (uint32_t(exp) >= 0x7fd) {
+        if (exp < 0) {
+            sig = shift_right_jam_64(sig, uint32_t(-exp));
+            exp = 0;
+            round_bits = uint32_t(sig & 0x3ff);
+        } else if (exp > 0x7fd || sig + 0x200 >= (UINT64_C(1) << 63)) {
+            return (uint64_t(sign) << 63) | UINT64_C(0x7ff0000000000000);
+        }
+    }
+
+    sig = (sig + 0x200) >> 10;
+    // ties to even
+    sig &= ~uint64_t(round_bits == 0x200);
+    if (sig == 0) {
+        exp = 0;
+    }
+    return (uint64_t(sign) << 63) + (uint64_t(exp) << 52) + sig;
+}
+
+// sig has the implicit bit at bit 30 and 7 bits to round
+uint32_t round_pack_to_f32(bool sign, int32_t exp, uint32_t sig) {
+    uint32_t round_bits = sig & 0x7f;
+    if (uint32_t(exp) >= 0xfd) {
+        if (exp < 0) {
+            sig = uint32_t(shift_right_jam_64(sig, uint32_t(-exp)));
+            exp = 0;
+            round_bits = sig & 0x7f;
+        } else if (exp > 0xfd || sig + 0x40 >= (UINT32_C(1) << 31)) {
+            return (uint32_t(sign) << 31) | UINT32_C(0x7f800000);
+        }
+    }
+
+    sig = (sig + 0x40) >> 7;
+    // ties to even
+    sig &= ~uint32_t(round_bits == 0x40);
+    if (sig == 0) {
+        exp = 0;
+    }
+    return (uint32_t(sign) << 31) + (uint32_t(exp) << 23) + sig;
+}
+
+// a + b with the signs of both equal to sign
+float128_t add_mags_f128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0, bool sign) {
+    const int32_t exp_a = exp_f128_ui64(a64);
+    uint128 sig_a = { frac_f128_ui64(a64), a0 };
+    const int32_t exp_b = exp_f128_ui64(b64);
+    uint128 sig_b = { frac_f128_ui64(b64), b0 };
+    int32_t exp_diff = exp_a - exp_b;
+    int32_t exp_z;
+    uint128 sig_z;
+    uint64_t sig_z_extra = 0;
+
+    if (exp_diff == 0) {
+        if (exp_a == F128_EXP_MAX) {
+            if ((sig_a.v64 | sig_a.v0 | sig_b.v64 | sig_b.v0) != 0) {
+                return propagate_nan(a64, a0, b64, b0);
+            }
+            return make_f128(a64, a0);
+        }
+        sig_z = add_128(sig_a.v64, sig_a.v0, sig_b.v64, sig_b.v0);
+        // two subnormals, the sum may carry to the smallest normal exponent
+        if (exp_a == 0) {
+            return make_f128(pack_to_f128_ui64(sign, 0, sig_z.v64), sig_z.v0);
+        }
+        exp_z = exp_a;
+        sig_z.v64 |= F128_IMPLICIT_BIT << 1;
+    } else {
+        if (exp_diff < 0) {
+            if (exp_b == F128_EXP_MAX) {
+                if ((sig_b.v64 | sig_b.v0) != 0) {
+                    return propagate_nan(a64, a0, b64, b0);
+                }
+                return make_f128(pack_to_f128_ui64(sign, F128_EXP_MAX, 0), 0);
+            }
+            exp_z = exp_b;
+            // subnormals have the exponent of the smallest normal values
+            if (exp_a != 0) {
+                sig_a.v64 |= F128_IMPLICIT_BIT;
+            } else {
+                exp_diff += 1;
+            }
+            const uint128_extra shifted = shift_right_jam_128_extra(sig_a.v64, sig_a.v0, 0, uint32_t(-exp_diff));
+            sig_a = shifted.v;
+            sig_z_extra = shifted.extra;
+        } else {
+            if (exp_a == F128_EXP_MAX) {
+                if ((sig_a.v64 | sig_a.v0) != 0) {
+                    return propagate_nan(a64, a0, b64, b0);
+                }
+                return make_f128(a64, a0);
+            }
+            exp_z = exp_a;
+            if (exp_b != 0) {
+                sig_b.v64 |= F128_IMPLICIT_BIT;
+            } else {
+                exp_diff -= 1;
+            }
+            const uint128_extra shifted = shift_right_jam_128_extra(sig_b.v64, sig_b.v0, 0, uint32_t(exp_diff));
+            sig_b = shifted.v;
+            sig_z_extra = shifted.extra;
+        }
+
+        // the implicit bit of the bigger one, the other was shifted under it
+        sig_z = add_128(sig_a.v64 | F128_IMPLICIT_BIT, sig_a.v0, sig_b.v64, sig_b.v0);
+        exp_z -= 1;
+        if (sig_z.v64 < (F128_IMPLICIT_BIT << 1)) {
+            return round_pack_to_f128(sign, exp_z, sig_z.v64, sig_z.v0, sig_z_extra);
+        }
+        exp_z += 1;
+    }
+
+    const uint128_extra shifted = short_shift_right_jam_128_extra(sig_z.v64, sig_z.v0, sig_z_extra, 1);
+    return round_pack_to_f128(sign, exp_z, shifted.v.v64, shifted.v.v0, shifted.extra);
+}
+
+// a - b with the signs of both equal to sign
+float128_t sub_mags_f128(uint64_t a64, uint64_t a0, uint64_t b64, uint64_t b0, bool sign) {
+    const int32_t exp_a = exp_f128_ui64(a64);
+    uint128 sig_a = { frac_f128_ui64(a64), a0 };
+    const int32_t exp_b = exp_f128_ui64(b64);
+    uint128 sig_b = { frac_f128_ui64(b64), b0 };
+
+    // 4 more bits to round after the cancellation
+    sig_a = short_shift_left_128(sig_a.v64, sig_a.v0, 4);
+    sig_b = short_shift_left_128(sig_b.v64, sig_b.v0, 4);
+    int32_t exp_diff = exp_a - exp_b;
+    int32_t exp_z;
+    uint128 sig_z;
+
+    if (exp_diff == 0) {
+        if (exp_a == F128_EXP_MAX) {
+            if ((sig_a.v64 | sig_a.v0 | sig_b.v64 | sig_b.v0) != 0) {
+                return propagate_nan(a64, a0, b64, b0);
+            }
+            // infinity minus infinity
+            return make_f128(F128_DEFAULT_NAN, 0);
+        }
+        exp_z = exp_a != 0 ? exp_a : 1;
+        if (lt_128(sig_b.v64, sig_b.v0, sig_a.v64, sig_a.v0)) {
+            sig_z = sub_128(sig_a.v64, sig_a.v0, sig_b.v64, sig_b.v0);
+        } else if (lt_128(sig_a.v64, sig_a.v0, sig_b.v64, sig_b.v0)) {
+            sign = !sign;
+            sig_z = sub_128(sig_b.v64, sig_b.v0, sig_a.v64, sig_a.v0);
+        } else {
+            // exact zero is positive when rounding to nearest
+            return make_f128(0, 0);
+        }
+    } else if (exp_diff < 0) {
+        if (exp_b == F128_EXP_MAX) {
+            if ((sig_b.v64 | sig_b.v0) != 0) {
+                return propagate_nan(a64, a0, b64, b0);
+            }
+            return make_f128(pack_to_f128_ui64(!sign, F128_EXP_MAX, 0), 0);
+        }
+        if (exp_a != 0) {
+            sig_a.v64 |= F128_IMPLICIT_BIT << 4;
+        } else {
+            exp_diff += 1;
+        }
+        sig_a = shift_right_jam_128(sig_a.v64, sig_a.v0, uint32_t(-exp_diff));
+        exp_z = exp_b;
+        sig_b.v64 |= F128_IMPLICIT_BIT << 4;
+        sign = !sign;
+        sig_z = sub_128(sig_b.v64, sig_b.v0, sig_a.v64, sig_a.v0);
+    } else {
+        if (exp_a == F128_EXP_MAX) {
+            if ((sig_a.v64 | sig_a.v0) != 0) {
+                return propagate_nan(a64, a0, b64, b0);
+            }
+            return make_f128(a64, a0);
+        }
+        if (exp_b != 0) {
+            sig_b.v64 |= F128_IMPLICIT_BIT << 4;
+        } else {
+            exp_diff -= 1;
+        }
+        sig_b = shift_right_jam_128(sig_b.v64, sig_b.v0, uint32_t(exp_diff));
+        exp_z = exp_a;
+        sig_a.v64 |= F128_IMPLICIT_BIT << 4;
+        sig_z = sub_128(sig_a.v64, sig_a.v0, sig_b.v64, sig_b.v0);
+    }
+    return norm_round_pack_to_f128(sign, exp_z - 5, sig_z.v64, sig_z.v0);
+}
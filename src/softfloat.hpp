@@ -0,0 +1,37 @@
+/*
+ * Based on Berkeley SoftFloat Release 3e, by John R. Hauser.
+ * Copyright 2011, 2012, 2013, 2014, 2015, 2016, 2017 The Regents of the
+ * University of California. All rights reserved.
+ * BSD licensed, see http://www.jhauser.us/arithmetic/SoftFloat.html
+ */
+
+#pragma once
+#include "bigfloat.hpp"
+#include "bigint.hpp"
+#include <stdint.h>
+
+// IEEE binary128 arithmetic in software, to fold f128 constants exactly like the runtime computes them.
+// rounds to nearest, ties to even. NaN results are quiet and no exception flags are raised
+
+float128_t f128_add(float128_t a, float128_t b);
+float128_t f128_sub(float128_t a, float128_t b);
+float128_t f128_mul(float128_t a, float128_t b);
+float128_t f128_div(float128_t a, float128_t b);
+float128_t f128_neg(float128_t a);
+
+// false if either one is NaN, zeros of both signs are equal
+bool f128_eq(float128_t a, float128_t b);
+bool f128_lt(float128_t a, float128_t b);
+bool f128_le(float128_t a, float128_t b);
+
+bool f128_is_nan(float128_t a);
+bool f128_is_infinite(float128_t a);
+
+// from and to the bits of a binary64 and a binary32, widening is exact
+float128_t f64_to_f128(uint64_t a);
+uint64_t f128_to_f64(float128_t a);
+uint32_t f128_to_f32(float128_t a);
+
+float128_t bigint_to_f128(const BigInt *op);
+// truncates towards zero, returns false if a is NaN or infinite
+bool f128_to_bigint(BigInt *dest, float128_t a);
@@ -0,0 +1,218 @@
+#include "stats.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+namespace {
+    struct PhaseStats {
+        std::atomic<uint64_t> wall_ns;
+        std::atomic<uint64_t> cpu_ns;
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> peak_rss;
+    };
+}
+
+static uint64_t get_wall_ns() noexcept;
+static uint64_t get_thread_cpu_ns() noexcept;
+static uint64_t get_peak_rss() noexcept;
+static const char* get_phase_name(Phase in_phase) noexcept;
+
+static std::atomic<bool> is_stats_enabled(false);
+static PhaseStats phase_stats[size_t(Phase::Count)];
+static std::atomic<uint64_t> token_count(0);
+static std::atomic<uint64_t> node_count(0);
+static uint64_t enabled_wall_ns = 0;
+
+// every allocation of the thread, phases count the difference
+static thread_local uint64_t thread_allocations = 0;
+
+// the array and nothrow versions call these ones
+void* operator new(size_t in_size) {
+    thread_allocations++;
+    if (in_size == 0) {
+        in_size = 1;
+    }
+
+    while (true) {
+        void* memory = std::malloc(in_size);
+        if (memory) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* in_memory) noexcept {
+    std::free(in_memory);
+}
+
+void operator delete(void* in_memory, size_t) noexcept {
+    std::free(in_memory);
+}
+
+void stats::set_enabled(bool in_is_enabled) noexcept {
+    if (in_is_enabled) {
+        for (auto& phase : phase_stats) {
+            phase.wall_ns = 0;
+            phase.cpu_ns = 0;
+            phase.allocations = 0;
+            phase.peak_rss = 0;
+        }
+        token_count = 0;
+        node_count = 0;
+        enabled_wall_ns = get_wall_ns();
+    }
+    is_stats_enabled = in_is_enabled;
+}
+
+bool stats::is_enabled() noexcept {
+    return is_stats_enabled.load(std::memory_order_relaxed);
+}
+
+void stats::add_tokens(size_t in_count) noexcept {
+    token_count += in_count;
+}
+
+void stats::add_nodes(size_t in_count) noexcept {
+    node_count += in_count;
+}
+
+std::string stats::get_report(bool in_is_json) noexcept {
+    const double total_ms = double(get_wall_ns() - enabled_wall_ns) / 1e6;
+    const uint64_t peak_rss = get_peak_rss();
+    char line[256];
+    std::string report;
+
+    if (in_is_json) {
+        snprintf(line, sizeof(line), "{\"wall_ms\":%.3f,\"peak_rss_bytes\":%llu,\"tokens\":%llu,\"nodes\":%llu,\"phases\":[",
+            total_ms, (unsigned long long)peak_rss, (unsigned long long)token_count.load(), (unsigned long long)node_count.load());
+        report += line;
+        for (size_t i = 0; i < size_t(Phase::Count); i++) {
+            const PhaseStats& phase = phase_stats[i];
+            snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"peak_rss_bytes\":%llu,\"allocations\":%llu}",
+                i ? "," : "", get_phase_name(Phase(i)), double(phase.wall_ns) / 1e6, double(phase.cpu_ns) / 1e6,
+                (unsigned long long)phase.peak_rss.load(), (unsigned long long)phase.allocations.load());
+            report += line;
+        }
+        report += "]}";
+        return report;
+    }
+
+    report += "===-------------------------------------------------------------------===\n";
+    report += "                         LlamaLang time report\n";
+    report += "===-------------------------------------------------------------------===\n";
+    snprintf(line, sizeof(line), "  Total wall time: %.3f ms, peak RSS: %.1f MiB\n  Tokens: %llu, AST nodes: %llu\n\n",
+        total_ms, double(peak_rss) / (1024 * 1024), (unsigned long long)token_count.load(), (unsigned long long)node_count.load());
+    report += line;
+    report += "   Wall (ms)     CPU (ms)   Peak RSS (MiB)   Allocations   Phase\n";
+    for (size_t i = 0; i < size_t(Phase::Count); i++) {
+        const PhaseStats& phase = phase_stats[i];
+        snprintf(line, sizeof(line), "  %10.3f   %10.3f   %14.1f   %11llu   %s\n",
+            double(phase.wall_ns) / 1e6, double(phase.cpu_ns) / 1e6, double(phase.peak_rss) / (1024 * 1024),
+            (unsigned long long)phase.allocations.load(), get_phase_name(Phase(i)));
+        report += line;
+    }
+    return report;
+}
+
+PhaseTimer::PhaseTimer(Phase in_phase) noexcept
+    : phase(in_phase), is_active(stats::is_enabled()), start_wall_ns(0), start_cpu_ns(0), start_allocations(0) {
+    if (is_active) {
+        start_wall_ns = get_wall_ns();
+        start_cpu_ns = get_thread_cpu_ns();
+        start_allocations = thread_allocations;
+    }
+}
+
+PhaseTimer::~PhaseTimer() noexcept {
+    if (!is_active) {
+        return;
+    }
+
+    PhaseStats& stats = phase_stats[size_t(phase)];
+    stats.wall_ns += get_wall_ns() - start_wall_ns;
+    stats.cpu_ns += get_thread_cpu_ns() - start_cpu_ns;
+    stats.allocations += thread_allocations - start_allocations;
+
+    const uint64_t peak_rss = get_peak_rss();
+    uint64_t phase_peak_rss = stats.peak_rss;
+    while (phase_peak_rss < peak_rss && !stats.peak_rss.compare_exchange_weak(phase_peak_rss, peak_rss)) {}
+}
+
+uint64_t get_wall_ns() noexcept {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+uint64_t get_thread_cpu_ns() noexcept {
+#ifdef _WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+        return 0;
+    }
+    // 100 ns units
+    auto to_ns = [](const FILETIME& in_time) {
+        return ((uint64_t(in_time.dwHighDateTime) << 32) | in_time.dwLowDateTime) * 100;
+    };
+    return to_ns(kernel_time) + to_ns(user_time);
+#else
+    timespec cpu_time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time) != 0) {
+        return 0;
+    }
+    return uint64_t(cpu_time.tv_sec) * 1000000000ull + uint64_t(cpu_time.tv_nsec);
+#endif
+}
+
+// in bytes, the peak of the whole process so far
+uint64_t get_peak_rss() noexcept {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS memory_counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &memory_counters, sizeof(memory_counters))) {
+        return 0;
+    }
+    return memory_counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return uint64_t(usage.ru_maxrss);
+#else
+    // kilobytes
+    return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+const char* get_phase_name(Phase in_phase) noexcept {
+    switch (in_phase) {
+    case Phase::ReadFile:   return "read file";
+    case Phase::Tokenize:   return "tokenize";
+    case Phase::Parse:      return "parse";
+    case Phase::Analyze:    return "analyze";
+    case Phase::Check:      return "check";
+    case Phase::FirstPass:  return "first pass";
+    case Phase::SecondPass: return "second pass";
+    case Phase::Emit:       return "emit";
+    default:
+        UNREACHEABLE;
+    }
+}
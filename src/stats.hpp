@@ -0,0 +1,51 @@
+#pragma once
+#include "common_defs.hpp"
+#include <cstdint>
+#include <string>
+
+// compiler phases measured by --time-report, in pipeline order
+enum class Phase : uint8_t {
+    ReadFile,
+    Tokenize,
+    Parse,
+    Analyze,
+    Check,
+    FirstPass,     // declarations
+    SecondPass,    // function bodies
+    Emit,
+    Count
+};
+
+/*
+* Measurements behind --time-report.
+* Each phase adds up the wall time, thread CPU time and allocations of
+* every scope timed with PhaseTimer, so phases running on several
+* threads at once can add up to more than the build wall time.
+* Disabled, a PhaseTimer does nothing.
+*/
+namespace stats {
+    // enabling clears the previous measurements
+    void set_enabled(bool in_is_enabled) noexcept;
+    LL_NODISCARD bool is_enabled() noexcept;
+
+    void add_tokens(size_t in_count) noexcept;
+    void add_nodes(size_t in_count) noexcept;
+
+    // a table for people or a JSON object for tools
+    LL_NODISCARD std::string get_report(bool in_is_json) noexcept;
+}
+
+class PhaseTimer {
+    Phase       phase;
+    bool        is_active;
+    uint64_t    start_wall_ns;
+    uint64_t    start_cpu_ns;
+    uint64_t    start_allocations;
+
+public:
+    explicit PhaseTimer(Phase in_phase) noexcept;
+    ~PhaseTimer() noexcept;
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
@@ -0,0 +1,179 @@
+#include "symbol_table.hpp"
+#include <llvm/Support/xxhash.h>
+
+#define NAME_TABLE_INITIAL_CAPACITY 64
+#define SCOPE_INITIAL_CAPACITY      8
+
+static uint32_t hash_name(std::string_view in_name) noexcept;
+static uint32_t hash_name_id(uint32_t in_name_id) noexcept;
+// grow before 3/4 of the slots are used, probe sequences stay short
+static bool is_over_load_factor(size_t in_count, size_t in_capacity) noexcept;
+
+NameTable::NameTable(const NameTable* in_parent)
+    : parent(in_parent), slots(NAME_TABLE_INITIAL_CAPACITY, Slot{ {}, 0, INVALID_NAME_ID }) {
+    first_id = parent ? parent->first_id + uint32_t(parent->names.size()) : 0;
+}
+
+uint32_t NameTable::intern(std::string_view in_name) noexcept {
+    const uint32_t hash = hash_name(in_name);
+    uint32_t id = find(in_name, hash);
+    if (id != INVALID_NAME_ID) {
+        return id;
+    }
+
+    if (is_over_load_factor(names.size() + 1, slots.size())) {
+        grow();
+    }
+
+    id = first_id + uint32_t(names.size());
+    names.push_back(in_name);
+
+    const size_t mask = slots.size() - 1;
+    size_t index = hash & mask;
+    while (slots[index].id != INVALID_NAME_ID) {
+        index = (index + 1) & mask;
+    }
+    slots[index] = Slot{ in_name, hash, id };
+    return id;
+}
+
+uint32_t NameTable::find(std::string_view in_name) const noexcept {
+    return find(in_name, hash_name(in_name));
+}
+
+std::string_view NameTable::get_name(uint32_t in_id) const noexcept {
+    if (in_id < first_id) {
+        return parent->get_name(in_id);
+    }
+    return names[in_id - first_id];
+}
+
+uint32_t NameTable::find(std::string_view in_name, uint32_t in_hash) const noexcept {
+    if (parent) {
+        const uint32_t id = parent->find(in_name, in_hash);
+        if (id != INVALID_NAME_ID) {
+            return id;
+        }
+    }
+
+    const size_t mask = slots.size() - 1;
+    for (size_t index = in_hash & mask; slots[index].id != INVALID_NAME_ID; index = (index + 1) & mask) {
+        const Slot& slot = slots[index];
+        if (slot.hash == in_hash && slot.name == in_name) {
+            return slot.id;
+        }
+    }
+    return INVALID_NAME_ID;
+}
+
+void NameTable::grow() noexcept {
+    std::vector<Slot> old_slots(slots.size() * 2, Slot{ {}, 0, INVALID_NAME_ID });
+    old_slots.swap(slots);
+
+    const size_t mask = slots.size() - 1;
+    for (auto& slot : old_slots) {
+        if (slot.id == INVALID_NAME_ID) {
+            continue;
+        }
+        size_t index = slot.hash & mask;
+        while (slots[index].id != INVALID_NAME_ID) {
+            index = (index + 1) & mask;
+        }
+        slots[index] = slot;
+    }
+}
+
+SymbolTable::SymbolTable(const SymbolTable* in_parent)
+    : parent(in_parent) {}
+
+void SymbolTable::push_scope() noexcept {
+    scopes.push_back(Scope{ uint32_t(arena.size()), SCOPE_INITIAL_CAPACITY, 0 });
+    arena.resize(arena.size() + SCOPE_INITIAL_CAPACITY, Slot{ INVALID_NAME_ID, nullptr });
+}
+
+void SymbolTable::pop_scope() noexcept {
+    assert(!scopes.empty());
+    arena.resize(scopes.back().first_slot);
+    scopes.pop_back();
+}
+
+AstNode* SymbolTable::declare(uint32_t in_name_id, AstNode* in_declaration) noexcept {
+    assert(!scopes.empty() && in_name_id != INVALID_NAME_ID);
+    AstNode* previous_declaration = find_in_scope(scopes.back(), in_name_id);
+    if (previous_declaration) {
+        return previous_declaration;
+    }
+
+    if (is_over_load_factor(scopes.back().count + 1, scopes.back().capacity)) {
+        grow_innermost_scope();
+    }
+
+    Scope& scope = scopes.back();
+    const uint32_t mask = scope.capacity - 1;
+    uint32_t index = hash_name_id(in_name_id) & mask;
+    while (arena[scope.first_slot + index].name_id != INVALID_NAME_ID) {
+        index = (index + 1) & mask;
+    }
+    arena[scope.first_slot + index] = Slot{ in_name_id, in_declaration };
+    scope.count++;
+    return nullptr;
+}
+
+AstNode* SymbolTable::find(uint32_t in_name_id) const noexcept {
+    for (auto scope_it = scopes.rbegin(); scope_it != scopes.rend(); ++scope_it) {
+        AstNode* declaration = find_in_scope(*scope_it, in_name_id);
+        if (declaration) {
+            return declaration;
+        }
+    }
+    return parent ? parent->find(in_name_id) : nullptr;
+}
+
+AstNode* SymbolTable::find_in_scope(const Scope& in_scope, uint32_t in_name_id) const noexcept {
+    const uint32_t mask = in_scope.capacity - 1;
+    for (uint32_t index = hash_name_id(in_name_id) & mask; ; index = (index + 1) & mask) {
+        const Slot& slot = arena[in_scope.first_slot + index];
+        if (slot.name_id == in_name_id) {
+            return slot.declaration;
+        }
+        if (slot.name_id == INVALID_NAME_ID) {
+            return nullptr;
+        }
+    }
+}
+
+void SymbolTable::grow_innermost_scope() noexcept {
+    Scope& scope = scopes.back();
+    std::vector<Slot> grown_slots(size_t(scope.capacity) * 2, Slot{ INVALID_NAME_ID, nullptr });
+
+    const uint32_t mask = uint32_t(grown_slots.size()) - 1;
+    for (uint32_t i = 0; i < scope.capacity; i++) {
+        const Slot& slot = arena[scope.first_slot + i];
+        if (slot.name_id == INVALID_NAME_ID) {
+            continue;
+        }
+        uint32_t index = hash_name_id(slot.name_id) & mask;
+        while (grown_slots[index].name_id != INVALID_NAME_ID) {
+            index = (index + 1) & mask;
+        }
+        grown_slots[index] = slot;
+    }
+
+    // the innermost scope is the top of the arena
+    arena.resize(scope.first_slot);
+    arena.insert(arena.end(), grown_slots.begin(), grown_slots.end());
+    scope.capacity = uint32_t(grown_slots.size());
+}
+
+uint32_t hash_name(std::string_view in_name) noexcept {
+    return uint32_t(llvm::xxHash64(llvm::StringRef(in_name.data(), in_name.size())));
+}
+
+uint32_t hash_name_id(uint32_t in_name_id) noexcept {
+    // ids are dense, fibonacci hashing spreads them over the high bits
+    return uint32_t((uint64_t(in_name_id) * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+bool is_over_load_factor(size_t in_count, size_t in_capacity) noexcept {
+    return in_count * 4 > in_capacity * 3;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "common_defs.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+struct AstNode;
+
+#define INVALID_NAME_ID UINT32_MAX
+
+/*
+* Interns names to dense ids so symbol tables compare integers instead of strings.
+* Open addressing with linear probing, the names point to the source.
+* A table can extend a read-only parent: names of the parent keep their ids
+* and new names get ids after the last one of the parent, so threads can
+* extend a shared table without locking it.
+*/
+class NameTable {
+    struct Slot {
+        std::string_view name;
+        uint32_t         hash;
+        uint32_t         id;     // INVALID_NAME_ID if empty
+    };
+
+    const NameTable*              parent;
+    std::vector<Slot>             slots;    // power of two
+    std::vector<std::string_view> names;    // by id - first_id
+    uint32_t                      first_id;
+
+public:
+    explicit NameTable(const NameTable* in_parent = nullptr);
+
+    // returns the id of in_name, it's added if new
+    uint32_t intern(std::string_view in_name) noexcept;
+
+    // returns INVALID_NAME_ID if in_name was never interned
+    LL_NODISCARD uint32_t find(std::string_view in_name) const noexcept;
+
+    LL_NODISCARD std::string_view get_name(uint32_t in_id) const noexcept;
+
+private:
+    uint32_t find(std::string_view in_name, uint32_t in_hash) const noexcept;
+    void grow() noexcept;
+};
+
+/*
+* Chain of scopes mapping name ids to their declarations.
+* Every scope is an open addressing table allocated on top of a single
+* arena, so popping the innermost scope only moves the arena top back.
+* Names are only declared in the innermost scope, which is always at the
+* top of the arena and can grow in place.
+* Lookups not found in any scope continue in the read-only parent table,
+* used for the global scope shared between threads.
+*/
+class SymbolTable {
+    struct Slot {
+        uint32_t name_id;       // INVALID_NAME_ID if empty
+        AstNode* declaration;
+    };
+
+    struct Scope {
+        uint32_t first_slot;
+        uint32_t capacity;      // power of two
+        uint32_t count;
+    };
+
+    const SymbolTable*  parent;
+    std::vector<Slot>   arena;
+    std::vector<Scope>  scopes;
+
+public:
+    explicit SymbolTable(const SymbolTable* in_parent = nullptr);
+
+    void push_scope() noexcept;
+    // O(1), the slots of the scope are given back to the arena
+    void pop_scope() noexcept;
+
+    // returns the declaration already in the innermost scope, in_declaration is not added then
+    AstNode* declare(uint32_t in_name_id, AstNode* in_declaration) noexcept;
+
+    // innermost scope first, then the parent. returns nullptr if not declared
+    LL_NODISCARD AstNode* find(uint32_t in_name_id) const noexcept;
+
+private:
+    AstNode* find_in_scope(const Scope& in_scope, uint32_t in_name_id) const noexcept;
+    void grow_innermost_scope() noexcept;
+};
@@ -0,0 +1,40 @@
+#include "trace.hpp"
+#include "console.hpp"
+#include <atomic>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/TimeProfiler.h>
+
+// every scope is recorded, compiles are short
+#define TRACE_GRANULARITY_US 0
+
+static std::atomic<bool> is_trace_enabled(false);
+
+void trace::start() noexcept {
+    llvm::timeTraceProfilerInitialize(TRACE_GRANULARITY_US, "LlamaLang");
+    is_trace_enabled = true;
+}
+
+void trace::start_thread(const std::string& in_thread_name) noexcept {
+    llvm::set_thread_name(in_thread_name);
+    if (is_trace_enabled) {
+        llvm::timeTraceProfilerInitialize(TRACE_GRANULARITY_US, "LlamaLang");
+    }
+}
+
+void trace::finish_thread() noexcept {
+    if (llvm::timeTraceProfilerEnabled()) {
+        llvm::timeTraceProfilerFinishThread();
+    }
+}
+
+bool trace::finish(const std::string& in_path) noexcept {
+    is_trace_enabled = false;
+
+    auto error = llvm::timeTraceProfilerWrite(in_path, "");
+    llvm::timeTraceProfilerCleanup();
+    if (error) {
+        console::WriteLine("could not write the trace to " + in_path + ": " + llvm::toString(std::move(error)));
+        return false;
+    }
+    return true;
+}
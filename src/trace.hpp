@@ -0,0 +1,22 @@
+#pragma once
+#include "common_defs.hpp"
+#include <string>
+
+/*
+* Chrome trace events behind --trace, viewable in Perfetto or chrome://tracing.
+* Events are recorded with llvm::TimeTraceScope, which also records the
+* LLVM passes, each thread in its own lane.
+*/
+namespace trace {
+    // starts recording in the calling thread
+    void start() noexcept;
+
+    // worker threads record in their own lane, named after in_thread_name
+    void start_thread(const std::string& in_thread_name) noexcept;
+    // the lane is kept for the trace once the thread ends
+    void finish_thread() noexcept;
+
+    // writes every lane to in_path and stops recording, the worker threads must have finished.
+    // returns false if the file could not be written
+    bool finish(const std::string& in_path) noexcept;
+}
@@ -0,0 +1,120 @@
+#include "types.hpp"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+static TypeInfo* new_type_info(AstTypeId in_type_id, std::string_view in_name, uint32_t in_bit_size, bool in_is_signed, TypeInfo* in_element_type) noexcept;
+static TypeInfo* get_derived_type(std::unordered_map<uint32_t, TypeInfo*>& in_derived_types, AstTypeId in_type_id, TypeInfo* in_element_type) noexcept;
+
+// TypeInfos are never moved once created
+static std::deque<TypeInfo> type_infos;
+// struct names outlive the source they come from
+static std::deque<std::string> type_names;
+// name -> builtin or struct type
+static std::unordered_map<std::string_view, TypeInfo*> named_types;
+// element type id -> derived type
+static std::unordered_map<uint32_t, TypeInfo*> pointer_types;
+static std::unordered_map<uint32_t, TypeInfo*> array_types;
+// the parser of each module might intern types at the same time
+static std::mutex types_mutex;
+
+static void register_builtin_types() noexcept {
+    struct BuiltinType {
+        const char* name;
+        AstTypeId   type_id;
+        uint32_t    bit_size;
+        bool        is_signed;
+    };
+
+    static const BuiltinType builtin_types[] = {
+        {"i8",   AstTypeId::Integer,       8  , true},
+        {"i16",  AstTypeId::Integer,       16 , true},
+        {"i32",  AstTypeId::Integer,       32 , true},
+        {"i64",  AstTypeId::Integer,       64 , true},
+        {"i128", AstTypeId::Integer,       128, true},
+        {"u8"  , AstTypeId::Integer,       8  , false},
+        {"u16" , AstTypeId::Integer,       16 , false},
+        {"u32" , AstTypeId::Integer,       32 , false},
+        {"u64" , AstTypeId::Integer,       64 , false},
+        {"u128", AstTypeId::Integer,       128, false},
+        {"f32" , AstTypeId::FloatingPoint, 32 , true},
+        {"f64" , AstTypeId::FloatingPoint, 64 , true},
+        {"f128", AstTypeId::FloatingPoint, 128, true},
+        {"void", AstTypeId::Void,          0  , false},
+        {"bool", AstTypeId::Bool,          1  , false}
+    };
+
+    for (auto& builtin_type : builtin_types) {
+        TypeInfo* type_info = new_type_info(builtin_type.type_id, builtin_type.name, builtin_type.bit_size, builtin_type.is_signed, nullptr);
+        named_types.emplace(type_info->name, type_info);
+    }
+}
+
+TypeInfo* types::get_named_type(std::string_view in_name) noexcept {
+    std::lock_guard<std::mutex> lock(types_mutex);
+    if (named_types.empty()) {
+        register_builtin_types();
+    }
+
+    auto type_it = named_types.find(in_name);
+    if (type_it != named_types.end()) {
+        return type_it->second;
+    }
+
+    std::string_view name = type_names.emplace_back(in_name);
+    TypeInfo* type_info = new_type_info(AstTypeId::Struct, name, 0, false, nullptr);
+    named_types.emplace(name, type_info);
+    return type_info;
+}
+
+TypeInfo* types::get_pointer_type(TypeInfo* in_element_type) noexcept {
+    std::lock_guard<std::mutex> lock(types_mutex);
+    return get_derived_type(pointer_types, AstTypeId::Pointer, in_element_type);
+}
+
+TypeInfo* types::get_array_type(TypeInfo* in_element_type) noexcept {
+    std::lock_guard<std::mutex> lock(types_mutex);
+    return get_derived_type(array_types, AstTypeId::Array, in_element_type);
+}
+
+TypeInfo* types::get_type_by_name(std::string_view in_name) noexcept {
+    if (in_name.substr(0, 1) == "*") {
+        return get_pointer_type(get_type_by_name(in_name.substr(1)));
+    }
+    if (in_name.substr(0, 2) == "[]") {
+        return get_array_type(get_type_by_name(in_name.substr(2)));
+    }
+    return get_named_type(in_name);
+}
+
+uint32_t types::get_type_count() noexcept {
+    std::lock_guard<std::mutex> lock(types_mutex);
+    return uint32_t(type_infos.size());
+}
+
+TypeInfo* new_type_info(AstTypeId in_type_id, std::string_view in_name, uint32_t in_bit_size, bool in_is_signed, TypeInfo* in_element_type) noexcept {
+    TypeInfo& type_info = type_infos.emplace_back();
+    type_info.id = uint32_t(type_infos.size() - 1);
+    type_info.type_id = in_type_id;
+    type_info.name = in_name;
+    type_info.bit_size = in_bit_size;
+    type_info.is_signed = in_is_signed;
+    type_info.element_type = in_element_type;
+    return &type_info;
+}
+
+TypeInfo* get_derived_type(std::unordered_map<uint32_t, TypeInfo*>& in_derived_types, AstTypeId in_type_id, TypeInfo* in_element_type) noexcept {
+    auto type_it = in_derived_types.find(in_element_type->id);
+    if (type_it != in_derived_types.end()) {
+        return type_it->second;
+    }
+
+    // pointers have the size of an address, arrays have no size until they get a length
+    const uint32_t bit_size = in_type_id == AstTypeId::Pointer ? 64 : 0;
+    std::string& name = type_names.emplace_back(in_type_id == AstTypeId::Pointer ? "*" : "[]");
+    name += in_element_type->name;
+    TypeInfo* type_info = new_type_info(in_type_id, name, bit_size, false, in_element_type);
+    in_derived_types.emplace(in_element_type->id, type_info);
+    return type_info;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "ast_nodes.hpp"
+#include <string_view>
+
+/*
+* Interned type table.
+* There is a single TypeInfo per distinct type, so two types are
+* equal only if their TypeInfo pointers are equal.
+* TypeInfo instances live until the process ends.
+*/
+namespace types {
+    // returns the builtin type named in_name or the struct type with that name
+    LL_NODISCARD TypeInfo* get_named_type(std::string_view in_name) noexcept;
+
+    // returns the canonical pointer to in_element_type
+    LL_NODISCARD TypeInfo* get_pointer_type(TypeInfo* in_element_type) noexcept;
+
+    // returns the canonical array of in_element_type
+    LL_NODISCARD TypeInfo* get_array_type(TypeInfo* in_element_type) noexcept;
+
+    // inverse of TypeInfo::name, "*i32" is the pointer to i32
+    LL_NODISCARD TypeInfo* get_type_by_name(std::string_view in_name) noexcept;
+
+    // number of types interned so far, TypeInfo::id is always lower than this
+    LL_NODISCARD uint32_t get_type_count() noexcept;
+}
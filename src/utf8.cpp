@@ -0,0 +1,278 @@
+#include "utf8.hpp"
+#include <cstring>
+
+// x86-64 always has SSE2, the lookup algorithm needs the SSSE3 shuffle and is picked at runtime
+#if defined(__x86_64__) || defined(_M_X64)
+#define LL_UTF8_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define LL_TARGET_SSSE3
+#else
+#define LL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+static size_t validate_scalar(const uint8_t* in_data, size_t in_size) noexcept;
+#if defined(LL_UTF8_SIMD)
+static bool has_ssse3() noexcept;
+LL_TARGET_SSSE3 static size_t validate_ssse3(const uint8_t* in_data, size_t in_size) noexcept;
+LL_TARGET_SSSE3 static __m128i check_block(__m128i in_input, __m128i in_prev_input) noexcept;
+static size_t find_error(const uint8_t* in_data, size_t in_size, size_t in_block_pos) noexcept;
+#endif
+
+size_t utf8_validate(const uint8_t* in_data, size_t in_size) noexcept {
+#if defined(LL_UTF8_SIMD)
+    static const bool is_ssse3_supported = has_ssse3();
+    if (is_ssse3_supported) {
+        return validate_ssse3(in_data, in_size);
+    }
+#endif
+    return validate_scalar(in_data, in_size);
+}
+
+size_t utf8_decode(const uint8_t* in_data, size_t in_size, uint32_t* out_code_point) noexcept {
+    if (in_size == 0) {
+        return 0;
+    }
+
+    const uint8_t lead = in_data[0];
+    if (lead < 0x80) {
+        *out_code_point = lead;
+        return 1;
+    }
+
+    // 0xc0 and 0xc1 can only start overlong sequences, 0xf5 and above values past U+10FFFF
+    size_t length;
+    uint32_t code_point;
+    if (lead >= 0xc2 && lead <= 0xdf) {
+        // 110xxxxx
+        length = 2;
+        code_point = lead & 0x1f;
+    }
+    else if (lead >= 0xe0 && lead <= 0xef) {
+        // 1110xxxx
+        length = 3;
+        code_point = lead & 0x0f;
+    }
+    else if (lead >= 0xf0 && lead <= 0xf4) {
+        // 11110xxx
+        length = 4;
+        code_point = lead & 0x07;
+    }
+    else {
+        return 0;
+    }
+
+    if (length > in_size) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; i++) {
+        // 10xxxxxx
+        if ((in_data[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        code_point = (code_point << 6) | (in_data[i] & 0x3f);
+    }
+
+    const bool is_overlong = (length == 3 && code_point < 0x800) || (length == 4 && code_point < 0x10000);
+    const bool is_surrogate = code_point >= 0xd800 && code_point <= 0xdfff;
+    if (is_overlong || is_surrogate || code_point > 0x10ffff) {
+        return 0;
+    }
+    *out_code_point = code_point;
+    return length;
+}
+
+size_t utf8_encode(uint32_t in_code_point, uint8_t* out_bytes) noexcept {
+    if (in_code_point <= 0x7f) {
+        out_bytes[0] = uint8_t(in_code_point);
+        return 1;
+    }
+    if (in_code_point <= 0x7ff) {
+        out_bytes[0] = uint8_t(0xc0 | (in_code_point >> 6));
+        out_bytes[1] = uint8_t(0x80 | (in_code_point & 0x3f));
+        return 2;
+    }
+    if (in_code_point >= 0xd800 && in_code_point <= 0xdfff) {
+        return 0;
+    }
+    if (in_code_point <= 0xffff) {
+        out_bytes[0] = uint8_t(0xe0 | (in_code_point >> 12));
+        out_bytes[1] = uint8_t(0x80 | ((in_code_point >> 6) & 0x3f));
+        out_bytes[2] = uint8_t(0x80 | (in_code_point & 0x3f));
+        return 3;
+    }
+    if (in_code_point <= 0x10ffff) {
+        out_bytes[0] = uint8_t(0xf0 | (in_code_point >> 18));
+        out_bytes[1] = uint8_t(0x80 | ((in_code_point >> 12) & 0x3f));
+        out_bytes[2] = uint8_t(0x80 | ((in_code_point >> 6) & 0x3f));
+        out_bytes[3] = uint8_t(0x80 | (in_code_point & 0x3f));
+        return 4;
+    }
+    return 0;
+}
+
+size_t validate_scalar(const uint8_t* in_data, size_t in_size) noexcept {
+    size_t pos = 0;
+    while (pos < in_size) {
+        // eight ascii bytes at a time
+        uint64_t word;
+        if (pos + sizeof(word) <= in_size) {
+            memcpy(&word, in_data + pos, sizeof(word));
+            if ((word & 0x8080808080808080ull) == 0) {
+                pos += sizeof(word);
+                continue;
+            }
+        }
+
+        uint32_t code_point;
+        const size_t length = utf8_decode(in_data + pos, in_size - pos, &code_point);
+        if (length == 0) {
+            return pos;
+        }
+        pos += length;
+    }
+    return in_size;
+}
+
+#if defined(LL_UTF8_SIMD)
+
+bool has_ssse3() noexcept {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+/*
+* Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte", the lookup algorithm of simdutf.
+* Every byte is classified by its high nibble, the low nibble of the byte before it and the high nibble of itself.
+* Each error case is a bit, a pair of bytes is wrong when the three lookups agree on one of them.
+*/
+enum : uint8_t {
+    TOO_SHORT       = 1 << 0,   // 11______ 0_______ or 11______ 11______
+    TOO_LONG        = 1 << 1,   // 0_______ 10______
+    OVERLONG_3      = 1 << 2,   // 11100000 100_____
+    TOO_LARGE       = 1 << 3,   // 11110100 1001____ and above
+    SURROGATE       = 1 << 4,   // 11101101 101_____
+    OVERLONG_2      = 1 << 5,   // 1100000_ 10______
+    TOO_LARGE_1000  = 1 << 6,   // 11110101 1000____ and above
+    OVERLONG_4      = 1 << 6,   // 11110000 1000____
+    TWO_CONTS       = 1 << 7,   // 10______ 10______, only an error if it is not the 3rd or 4th byte
+    CARRY           = TOO_SHORT | TOO_LONG | TWO_CONTS,
+};
+
+// indexed by the high nibble of the previous byte
+alignas(16) static const uint8_t byte_1_high_table[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+// indexed by the low nibble of the previous byte
+alignas(16) static const uint8_t byte_1_low_table[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+// indexed by the high nibble of the byte
+alignas(16) static const uint8_t byte_2_high_table[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+// a block ending with one of these bytes needs the next block to complete the sequence
+alignas(16) static const uint8_t incomplete_max[16] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1,
+};
+
+LL_TARGET_SSSE3 size_t validate_ssse3(const uint8_t* in_data, size_t in_size) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i incomplete = _mm_load_si128((const __m128i*)incomplete_max);
+    __m128i prev_input = zero;
+    __m128i prev_incomplete = zero;
+
+    // the last block is padded with zeros, they end any cut sequence with an error
+    for (size_t pos = 0; pos <= in_size; pos += 16) {
+        __m128i input;
+        if (pos + 16 <= in_size) {
+            input = _mm_loadu_si128((const __m128i*)(in_data + pos));
+        } else {
+            alignas(16) uint8_t tail[16] = {};
+            memcpy(tail, in_data + pos, in_size - pos);
+            input = _mm_load_si128((const __m128i*)tail);
+        }
+
+        __m128i error;
+        if (_mm_movemask_epi8(input) == 0) {
+            // only a sequence cut at the end of the previous block can be wrong
+            error = prev_incomplete;
+            prev_incomplete = zero;
+        } else {
+            error = check_block(input, prev_input);
+            prev_incomplete = _mm_subs_epu8(input, incomplete);
+        }
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xffff) {
+            return find_error(in_data, in_size, pos);
+        }
+        prev_input = input;
+    }
+    return in_size;
+}
+
+LL_TARGET_SSSE3 __m128i check_block(__m128i in_input, __m128i in_prev_input) noexcept {
+    const __m128i low_nibble = _mm_set1_epi8(0x0f);
+    const __m128i prev1 = _mm_alignr_epi8(in_input, in_prev_input, 15);
+    const __m128i byte_1_high = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)byte_1_high_table),
+        _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+    const __m128i byte_1_low = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)byte_1_low_table),
+        _mm_and_si128(prev1, low_nibble));
+    const __m128i byte_2_high = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)byte_2_high_table),
+        _mm_and_si128(_mm_srli_epi16(in_input, 4), low_nibble));
+    const __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // two continuations in a row are right after a 3 or 4 bytes lead, only 111_____ and 1111____ reach 0x80
+    const __m128i prev2 = _mm_alignr_epi8(in_input, in_prev_input, 14);
+    const __m128i prev3 = _mm_alignr_epi8(in_input, in_prev_input, 13);
+    const __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(0xe0 - 0x80));
+    const __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(0xf0 - 0x80));
+    const __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(char(0x80)));
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+// the blocks before in_block_pos are valid, the sequence crossing into the block starts at most 3 bytes before it
+size_t find_error(const uint8_t* in_data, size_t in_size, size_t in_block_pos) noexcept {
+    size_t start = in_block_pos >= 3 ? in_block_pos - 3 : 0;
+    while (start < in_block_pos && (in_data[start] & 0xc0) == 0x80) {
+        start++;
+    }
+    return start + validate_scalar(in_data + start, in_size - start);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+#include "common_defs.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* UTF-8 validation and decoding for the lexer.
+* Sources are validated once before tokenizing, so the lexer states can
+* decode code points without checking them again.
+* Overlong encodings, surrogates and values past U+10FFFF are invalid.
+*/
+
+// returns the offset of the first byte that is not part of a valid sequence, in_size if every byte is.
+// blocks of 16 bytes are checked at once where the CPU allows it
+LL_NODISCARD size_t utf8_validate(const uint8_t* in_data, size_t in_size) noexcept;
+
+// decodes the code point starting at in_data.
+// returns its length in bytes, 0 if the sequence is invalid or cut by in_size
+LL_NODISCARD size_t utf8_decode(const uint8_t* in_data, size_t in_size, uint32_t* out_code_point) noexcept;
+
+// writes the encoding of in_code_point to out_bytes, up to 4 bytes.
+// returns its length, 0 for surrogates and values past U+10FFFF
+size_t utf8_encode(uint32_t in_code_point, uint8_t* out_bytes) noexcept;
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include "../../src/analyzer.hpp"
+#include "../../src/ast_nodes.hpp"
+#include "../../src/error.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+#include "../../src/scheduler.hpp"
+
+//==================================================================================
+//          NAME RESOLUTION
+//==================================================================================
+
+TEST(AnalyzerTests, ResolveLocalVariable) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() i32 {\n x i32 = 1\n ret x\n}\n", "ResolveLocalVariable", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_TRUE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto block_node = source_code_node->source_code.children.at(0)->function_def.block;
+    auto var_def_node = block_node->block.statements.at(0);
+    auto ret_node = block_node->block.statements.at(1);
+    ASSERT_EQ(ret_node->unary_expr.expr->symbol.declaration, var_def_node);
+    ASSERT_EQ(var_def_node->var_def.initializer->binary_expr.op1->symbol.declaration, var_def_node);
+}
+
+TEST(AnalyzerTests, ParamShadowsGlobal) {
+    std::vector<Error> errors;
+    Lexer lexer("x i32 = 1\nfn main(x i32) i32 {\n ret x\n}\n", "ParamShadowsGlobal", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_TRUE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto function_node = source_code_node->source_code.children.at(1);
+    auto param_node = function_node->function_def.proto->function_proto.params.at(0);
+    auto ret_node = function_node->function_def.block->block.statements.at(0);
+    ASSERT_EQ(ret_node->unary_expr.expr->symbol.declaration, param_node);
+}
+
+TEST(AnalyzerTests, ResolveFunctionCall) {
+    std::vector<Error> errors;
+    Lexer lexer("fn square(x i64) i64 {\n ret x * x\n}\nfn main() i64 {\n ret square(3)\n}\n", "ResolveFunctionCall", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_TRUE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto square_node = source_code_node->source_code.children.at(0);
+    auto ret_node = source_code_node->source_code.children.at(1)->function_def.block->block.statements.at(0);
+    ASSERT_EQ(ret_node->unary_expr.expr->func_call.fn_ref, square_node);
+}
+
+//==================================================================================
+//          CONVERSIONS
+//==================================================================================
+
+TEST(AnalyzerTests, ImplicitTruncationWarning) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main(a i64) i32 {\n x i32 = a\n ret x\n}\n", "ImplicitTruncationWarning", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_TRUE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors.at(0).type, ERROR_TYPE::WARNING_0);
+    ASSERT_EQ(errors.at(0).line, 1L);
+}
+
+TEST(AnalyzerTests, ImplicitExtension) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main(a i8, b f32) f64 {\n x i64 = a\n ret b\n}\n", "ImplicitExtension", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_TRUE(analyzer.analyze({}));
+    ASSERT_EQ(errors.size(), 0L);
+}
+
+TEST(AnalyzerTests, StringLiteralIsBytePointer) {
+    std::vector<Error> errors;
+    Lexer lexer("greeting *u8 = \"hello\"\n", "StringLiteralIsBytePointer", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_TRUE(analyzer.analyze({}));
+    ASSERT_EQ(errors.size(), 0L);
+}
+
+//==================================================================================
+//          PARALLEL BODIES
+//==================================================================================
+
+TEST(AnalyzerTests, ParallelBodiesMatchSerial) {
+    // one warning and one error per function
+    std::string source = "g i64 = 1\n";
+    for (int i = 0; i < 200; i++) {
+        source += "fn f" + std::to_string(i) + "(a i64) i32 {\n x i32 = a + g\n ret y\n}\n";
+    }
+
+    auto analyze = [&source](Scheduler* io_scheduler, std::vector<Error>& out_errors) {
+        Lexer lexer(source, "ParallelBodiesMatchSerial", out_errors);
+        lexer.tokenize();
+
+        Parser parser(lexer, out_errors);
+        auto source_code_node = parser.parse();
+
+        SemanticAnalyzer analyzer(source_code_node, out_errors);
+        const bool is_valid = analyzer.analyze({}, io_scheduler);
+        delete source_code_node;
+        return is_valid;
+    };
+
+    std::vector<Error> serial_errors;
+    std::vector<Error> parallel_errors;
+    Scheduler scheduler(4);
+    ASSERT_FALSE(analyze(nullptr, serial_errors));
+    ASSERT_FALSE(analyze(&scheduler, parallel_errors));
+
+    ASSERT_EQ(parallel_errors.size(), 400L);
+    ASSERT_EQ(parallel_errors.size(), serial_errors.size());
+    for (size_t i = 0; i < parallel_errors.size(); i++) {
+        ASSERT_EQ(parallel_errors[i].line, serial_errors[i].line);
+        ASSERT_EQ(parallel_errors[i].column, serial_errors[i].column);
+        ASSERT_EQ(parallel_errors[i].type, i % 2 ? ERROR_TYPE::ERROR : ERROR_TYPE::WARNING_0);
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "../../src/analyzer.hpp"
+#include "../../src/ast_nodes.hpp"
+#include "../../src/error.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+
+TEST(AnalyzerSadTests, UndeclaredSymbol) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() i32 {\n ret y\n}\n", "UndeclaredSymbol", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_FALSE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors.at(0).type, ERROR_TYPE::ERROR);
+    ASSERT_EQ(errors.at(0).line, 1L);
+}
+
+TEST(AnalyzerSadTests, LocalOutOfScope) {
+    std::vector<Error> errors;
+    Lexer lexer("fn f() i32 {\n x i32 = 1\n ret x\n}\nfn main() i32 {\n ret x\n}\n", "LocalOutOfScope", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_FALSE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors.at(0).line, 5L);
+}
+
+TEST(AnalyzerSadTests, WrongArgumentCount) {
+    std::vector<Error> errors;
+    Lexer lexer("fn f(a i32) i32 {\n ret a\n}\nfn main() i32 {\n ret f()\n}\n", "WrongArgumentCount", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_FALSE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors.at(0).line, 4L);
+}
+
+TEST(AnalyzerSadTests, Redefinition) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() i32 {\n x i32 = 1\n x i64 = 2\n ret 0\n}\n", "Redefinition", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_FALSE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors.at(0).line, 2L);
+}
+
+TEST(AnalyzerSadTests, ValueReturnedFromVoid) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() void {\n ret 1\n}\n", "ValueReturnedFromVoid", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_FALSE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors.at(0).type, ERROR_TYPE::ERROR);
+}
+
+TEST(AnalyzerSadTests, NegateNonNumeric) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main(s *u8) i32 {\n x *u8 = ~s\n ret 0\n}\n", "NegateNonNumeric", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    SemanticAnalyzer analyzer(source_code_node, errors);
+    ASSERT_FALSE(analyzer.analyze({}));
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors.at(0).message, "operator '~' needs a numeric operand");
+    ASSERT_EQ(errors.at(0).line, 1L);
+}
@@ -0,0 +1,84 @@
+#include "../../src/bigint.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// BigInt micro benchmarks. usage: LlamaLang_bench [min_ms]
+// every operation runs for at least min_ms per size, default 100
+
+using bench_clock = std::chrono::steady_clock;
+
+enum class BenchOp {
+    Add,
+    Mul,
+    Shl
+};
+
+static const char* op_names[] = { "add", "mul", "shl" };
+
+static volatile uint64_t sink;
+
+static void init_random(BigInt* dest, size_t in_limbs, uint64_t* io_state) {
+    std::vector<uint64_t> digits(in_limbs);
+    for (auto& digit : digits) {
+        *io_state = *io_state * 6364136223846793005ull + 1442695040888963407ull;
+        digit = *io_state;
+    }
+    digits.back() |= 1ull << 63;
+    bigint_init_data(dest, digits.data(), in_limbs, false);
+}
+
+static void run_op(BenchOp in_op, const BigInt* in_op1, const BigInt* in_op2, const BigInt* in_shift) {
+    BigInt result;
+    switch (in_op) {
+    case BenchOp::Add:
+        bigint_add(&result, in_op1, in_op2);
+        break;
+    case BenchOp::Mul:
+        bigint_mul(&result, in_op1, in_op2);
+        break;
+    case BenchOp::Shl:
+        bigint_shl(&result, in_op1, in_shift);
+        break;
+    }
+    sink = sink + bigint_ptr(&result)[0];
+    bigint_deinit(&result);
+}
+
+// nanoseconds per operation, doubles the iterations until in_min_ms is reached
+static double time_op(BenchOp in_op, const BigInt* in_op1, const BigInt* in_op2, const BigInt* in_shift, double in_min_ms) {
+    for (size_t iterations = 1;; iterations *= 2) {
+        const auto start = bench_clock::now();
+        for (size_t i = 0; i < iterations; i++)
+            run_op(in_op, in_op1, in_op2, in_shift);
+        const std::chrono::duration<double, std::nano> elapsed = bench_clock::now() - start;
+
+        if (elapsed.count() >= in_min_ms * 1e6)
+            return elapsed.count() / double(iterations);
+    }
+}
+
+int main(int argc, char** argv) {
+    const double min_ms = argc > 1 ? atof(argv[1]) : 100.0;
+    uint64_t state = 1;
+    BigInt shift;
+    bigint_init_unsigned(&shift, 37);
+
+    printf("%-4s %6s %14s %14s\n", "op", "limbs", "ns/op", "Mlimbs/s");
+    for (int op = 0; op < 3; op++) {
+        for (size_t limbs = 1; limbs <= 1024; limbs *= 2) {
+            BigInt op1, op2;
+            init_random(&op1, limbs, &state);
+            init_random(&op2, limbs, &state);
+
+            const double ns = time_op(BenchOp(op), &op1, &op2, &shift, min_ms);
+            // input limbs processed per second
+            printf("%-4s %6zu %14.1f %14.2f\n", op_names[op], limbs, ns, double(limbs) * 1e3 / ns);
+
+            bigint_deinit(&op1);
+            bigint_deinit(&op2);
+        }
+    }
+    return 0;
+}
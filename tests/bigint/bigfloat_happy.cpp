@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "../../src/bigfloat.hpp"
+#include "../../src/lexer.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static BigFloat parse(const std::string& in_text) {
+    BigFloat value;
+    bigfloat_init_buf(&value, (const uint8_t*)in_text.data(), in_text.size());
+    return value;
+}
+
+static uint64_t double_bits(double in_value) {
+    uint64_t bits;
+    memcpy(&bits, &in_value, sizeof(bits));
+    return bits;
+}
+
+static uint32_t float_bits(float in_value) {
+    uint32_t bits;
+    memcpy(&bits, &in_value, sizeof(bits));
+    return bits;
+}
+
+//==================================================================================
+//          DECIMAL
+//==================================================================================
+
+TEST(BigFloatTests, RoundsToEveryType) {
+    BigFloat value = parse("0.1");
+
+    ASSERT_EQ(value.value.v[1], 0x3ffb999999999999ull);
+    ASSERT_EQ(value.value.v[0], 0x999999999999999aull);
+    ASSERT_EQ(value.f64_bits, 0x3fb999999999999aull);
+    ASSERT_EQ(value.f32_bits, 0x3dcccccdu);
+    ASSERT_FALSE(value.overflow);
+}
+
+TEST(BigFloatTests, ExactValues) {
+    BigFloat value = parse("62.0f");
+    ASSERT_EQ(value.value.v[1], 0x4004f00000000000ull);
+    ASSERT_EQ(value.value.v[0], 0L);
+    ASSERT_EQ(value.f64_bits, double_bits(62.0));
+    ASSERT_EQ(value.f32_bits, float_bits(62.0f));
+
+    ASSERT_EQ(parse("1_000.25").f64_bits, double_bits(1000.25));
+    ASSERT_EQ(parse("12e3").f64_bits, double_bits(12000.0));
+    ASSERT_EQ(parse("0.").f64_bits, 0L);
+    ASSERT_EQ(parse("0.").value.v[1], 0L);
+}
+
+TEST(BigFloatTests, TiesToEven) {
+    // 2^53 + 1 is halfway between two doubles
+    ASSERT_EQ(parse("9007199254740993").f64_bits, 0x4340000000000000ull);
+    ASSERT_EQ(parse("9007199254740995").f64_bits, 0x4340000000000002ull);
+    // past 19 digits only the slow path sees the last one
+    ASSERT_EQ(parse("9007199254740993.0000000000000000001").f64_bits, 0x4340000000000001ull);
+    // binary128 has the bits to keep it
+    ASSERT_EQ(parse("9007199254740993").value.v[0], 0x0800000000000000ull);
+}
+
+TEST(BigFloatTests, LimitsOfDouble) {
+    ASSERT_EQ(parse("1.7976931348623157e308").f64_bits, 0x7fefffffffffffffull);
+    ASSERT_EQ(parse("1.7976931348623159e308").f64_bits, 0x7ff0000000000000ull);
+    ASSERT_EQ(parse("4.9e-324").f64_bits, 1L);
+    ASSERT_EQ(parse("2.4703282292062327e-324").f64_bits, 0L);
+    ASSERT_EQ(parse("2.4703282292062328e-324").f64_bits, 1L);
+    ASSERT_EQ(parse("2.2250738585072011e-308").f64_bits, 0x000fffffffffffffull);
+    ASSERT_EQ(parse("3.4028236e38").f32_bits, 0x7f800000u);
+    ASSERT_EQ(parse("1.4e-45").f32_bits, 1u);
+}
+
+TEST(BigFloatTests, LimitsOfBinary128) {
+    BigFloat huge = parse("1e5000");
+    ASSERT_TRUE(huge.overflow);
+    ASSERT_EQ(huge.value.v[1], 0x7fff000000000000ull);
+    ASSERT_EQ(huge.f64_bits, 0x7ff0000000000000ull);
+
+    BigFloat max = parse("1.18973149535723176508575932662800702e4932");
+    ASSERT_FALSE(max.overflow);
+    ASSERT_EQ(max.value.v[1], 0x7ffeffffffffffffull);
+    ASSERT_EQ(max.value.v[0], 0xffffffffffffffffull);
+
+    // the smallest subnormal and the halfway value that rounds to zero
+    BigFloat min = parse("6.4751751194380251109244389582276465525e-4966");
+    ASSERT_EQ(min.value.v[1], 0L);
+    ASSERT_EQ(min.value.v[0], 1L);
+    ASSERT_EQ(parse("3.2e-4966").value.v[0], 0L);
+}
+
+TEST(BigFloatTests, MatchesLibc) {
+    // decimal strings of random doubles with every digit count, the shortest ones
+    // come from the exact path and the longer ones from the approximation
+    uint64_t state = 1;
+    for (int i = 0; i < 20000; i++) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        double random_value;
+        uint64_t random_bits = state >> 2;
+        memcpy(&random_value, &random_bits, sizeof(random_value));
+
+        char text[64];
+        snprintf(text, sizeof(text), "%.*e", int(state % 20), random_value);
+        BigFloat value = parse(text);
+        ASSERT_EQ(value.f64_bits, double_bits(strtod(text, nullptr))) << text;
+        ASSERT_EQ(value.f32_bits, float_bits(strtof(text, nullptr))) << text;
+    }
+}
+
+//==================================================================================
+//          HEXADECIMAL
+//==================================================================================
+
+TEST(BigFloatTests, HexFloats) {
+    ASSERT_EQ(parse("0x1.8p1").f64_bits, double_bits(3.0));
+    ASSERT_EQ(parse("0xff.8").f64_bits, double_bits(255.5));
+    ASSERT_EQ(parse("0x1p-1074").f64_bits, 1L);
+    ASSERT_EQ(parse("0x1p-1075").f64_bits, 0L);
+    ASSERT_EQ(parse("0x1.0000000000001p-1075").f64_bits, 1L);
+    // halfway, the digits past the first 32 still count
+    ASSERT_EQ(parse("0x1.000001p0").f32_bits, 0x3f800000u);
+    ASSERT_EQ(parse("0x1.000001" + std::string(26, '0') + "1p0").f32_bits, 0x3f800001u);
+}
+
+//==================================================================================
+//          LEXER
+//==================================================================================
+
+TEST(BigFloatTests, LexedLiteral) {
+    std::vector<Error> errors;
+    Lexer lexer("1.5e3 0x1p4 .25", "LexedLiteral", errors);
+    lexer.tokenize();
+
+    auto decimal_token = lexer.get_next_token();
+    auto hex_token = lexer.get_next_token();
+    auto fraction_token = lexer.get_next_token();
+
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(decimal_token.id, TokenId::FLOAT_LIT);
+    ASSERT_EQ(lexer.literals.get_float(decimal_token.float_lit).f64_bits, double_bits(1500.0));
+    ASSERT_EQ(hex_token.id, TokenId::FLOAT_LIT);
+    ASSERT_EQ(lexer.literals.get_float(hex_token.float_lit).f32_bits, float_bits(16.0f));
+    ASSERT_EQ(fraction_token.id, TokenId::FLOAT_LIT);
+    ASSERT_EQ(lexer.literals.get_float(fraction_token.float_lit).f64_bits, double_bits(0.25));
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "../../src/bigint.hpp"
+#include "bigint_reference.hpp"
+#include <vector>
+
+static uint64_t next_random(uint64_t* io_state) {
+    *io_state = *io_state * 6364136223846793005ull + 1442695040888963407ull;
+    return *io_state ^ (*io_state >> 29);
+}
+
+// random bytes, runs of zeros and ones make the carries and borrows go far
+static void fill_random(std::vector<uint8_t>& out_bytes, uint64_t* io_state) {
+    const uint64_t pattern = next_random(io_state) % 4;
+    for (auto& byte : out_bytes) {
+        const uint64_t random = next_random(io_state);
+        byte = pattern == 0 ? 0xff : pattern == 1 && random % 4 != 0 ? 0 : uint8_t(random);
+    }
+}
+
+//==================================================================================
+//          INT128
+//==================================================================================
+
+#if defined(__SIZEOF_INT128__)
+static void init_int128(BigInt* dest, __int128 in_value) {
+    const unsigned __int128 magnitude = in_value < 0 ? -(unsigned __int128)in_value : in_value;
+    const uint64_t digits[2] = { uint64_t(magnitude), uint64_t(magnitude >> 64) };
+    bigint_init_data(dest, digits, 2, in_value < 0);
+}
+
+// up to in_max_bits bits and a random sign
+static __int128 random_int128(uint64_t* io_state, unsigned in_max_bits) {
+    const unsigned bits = unsigned(next_random(io_state) % (in_max_bits + 1));
+    unsigned __int128 value = ((unsigned __int128)next_random(io_state) << 64) | next_random(io_state);
+    value = bits == 0 ? 0 : value >> (128 - bits);
+    return next_random(io_state) % 2 == 0 ? __int128(value) : -__int128(value);
+}
+
+TEST(BigIntDifferentialTests, MatchesInt128) {
+    uint64_t state = 1;
+    for (int i = 0; i < 20000; i++) {
+        // sums and differences of 126 bit values fit, as products of 62 bit ones
+        const __int128 a = random_int128(&state, 126);
+        const __int128 b = random_int128(&state, 126);
+        const __int128 small_a = random_int128(&state, 62);
+        const __int128 small_b = random_int128(&state, 62);
+        const unsigned shift = unsigned(next_random(&state) % 64);
+
+        BigInt op1, op2, small_op1, small_op2, shift_bi, result, expected;
+        init_int128(&op1, a);
+        init_int128(&op2, b);
+        init_int128(&small_op1, small_a);
+        init_int128(&small_op2, small_b);
+        bigint_init_unsigned(&shift_bi, shift);
+
+        bigint_add(&result, &op1, &op2);
+        init_int128(&expected, a + b);
+        ASSERT_EQ(result, expected) << "add, case " << i;
+
+        bigint_sub(&result, &op1, &op2);
+        init_int128(&expected, a - b);
+        ASSERT_EQ(result, expected) << "sub, case " << i;
+
+        bigint_mul(&result, &small_op1, &small_op2);
+        init_int128(&expected, small_a * small_b);
+        ASSERT_EQ(result, expected) << "mul, case " << i;
+
+        if (b != 0) {
+            bigint_divmod(&result, nullptr, &op1, &op2);
+            init_int128(&expected, a / b);
+            ASSERT_EQ(result, expected) << "div, case " << i;
+
+            bigint_divmod(nullptr, &result, &op1, &op2);
+            init_int128(&expected, a % b);
+            ASSERT_EQ(result, expected) << "mod, case " << i;
+        }
+
+        bigint_shl(&result, &small_op1, &shift_bi);
+        init_int128(&expected, small_a * (__int128(1) << shift));
+        ASSERT_EQ(result, expected) << "shl, case " << i;
+
+        // arithmetic shift, rounds towards negative infinity
+        bigint_shr(&result, &op1, &shift_bi);
+        init_int128(&expected, a >> shift);
+        ASSERT_EQ(result, expected) << "shr, case " << i;
+
+        bigint_and(&result, &op1, &op2);
+        init_int128(&expected, a & b);
+        ASSERT_EQ(result, expected) << "and, case " << i;
+
+        bigint_or(&result, &op1, &op2);
+        init_int128(&expected, a | b);
+        ASSERT_EQ(result, expected) << "or, case " << i;
+
+        bigint_xor(&result, &op1, &op2);
+        init_int128(&expected, a ^ b);
+        ASSERT_EQ(result, expected) << "xor, case " << i;
+
+        bigint_not(&result, &op1);
+        init_int128(&expected, ~a);
+        ASSERT_EQ(result, expected) << "not, case " << i;
+
+        ASSERT_EQ(bigint_cmp(&op1, &op2), a < b ? CmpLT : a > b ? CmpGT : CmpEQ) << "cmp, case " << i;
+    }
+}
+#endif
+
+//==================================================================================
+//          REFERENCE
+//==================================================================================
+
+TEST(BigIntDifferentialTests, MatchesReference) {
+    // operands up to 48 digits, past the karatsuba threshold
+    uint64_t state = 1;
+    std::vector<uint8_t> input;
+    for (int i = 0; i < 5000; i++) {
+        input.resize(3 + next_random(&state) % (48 * 8 * 2));
+        fill_random(input, &state);
+        input[0] = uint8_t(next_random(&state));
+        input[1] = uint8_t(next_random(&state));
+        input[2] = uint8_t(next_random(&state));
+
+        const std::string mismatch = check_bigint_op(input.data(), input.size());
+        ASSERT_TRUE(mismatch.empty()) << mismatch;
+    }
+}
+
+TEST(BigIntDifferentialTests, LargeProducts) {
+    // karatsuba splits unbalanced and odd sizes too
+    const size_t sizes[][2] = { { 31, 33 }, { 32, 32 }, { 33, 100 }, { 64, 65 }, { 257, 257 }, { 300, 40 }, { 1024, 1024 } };
+    uint64_t state = 7;
+    std::vector<uint8_t> input;
+    for (const auto& size : sizes) {
+        input.resize(3 + (size[0] + size[1]) * 8);
+        fill_random(input, &state);
+        input[0] = uint8_t(ReferenceOp::Mul);
+        input[1] = uint8_t(next_random(&state));
+        input[2] = uint8_t(256 * size[0] / (size[0] + size[1]));
+
+        const std::string mismatch = check_bigint_op(input.data(), input.size());
+        ASSERT_TRUE(mismatch.empty()) << mismatch;
+    }
+}
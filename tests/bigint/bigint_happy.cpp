@@ -0,0 +1,367 @@
+#include <gtest/gtest.h>
+#include "../../src/bigint.hpp"
+#include <vector>
+
+// 2^in_bits - 1
+static void init_all_ones(BigInt* dest, uint64_t in_bits) {
+    BigInt one, bits, power;
+    bigint_init_unsigned(&one, 1);
+    bigint_init_unsigned(&bits, in_bits);
+    bigint_shl(&power, &one, &bits);
+
+    BigInt minus_one;
+    bigint_init_signed(&minus_one, -1);
+    bigint_add(dest, &power, &minus_one);
+    bigint_deinit(&power);
+}
+
+// deterministic digits, none of them zero
+static void init_pattern(BigInt* dest, size_t in_digit_count, uint64_t in_seed) {
+    std::vector<uint64_t> digits(in_digit_count);
+    uint64_t state = in_seed;
+    for (auto& digit : digits) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        digit = state | 1;
+    }
+
+    BigInt shift;
+    bigint_init_unsigned(&shift, 64);
+    bigint_init_unsigned(dest, 0);
+    for (size_t i = digits.size(); i > 0; i--) {
+        BigInt digit;
+        bigint_init_unsigned(&digit, digits[i - 1]);
+        bigint_shl(dest, dest, &shift);
+        bigint_add(dest, dest, &digit);
+    }
+}
+
+TEST(BigIntTests, U128MaxIsInline) {
+    BigInt value;
+    init_all_ones(&value, 128);
+
+    ASSERT_EQ(value.digit_count, 2);
+    ASSERT_TRUE(bigint_is_inline(&value));
+    ASSERT_EQ(bigint_ptr(&value)[0], UINT64_MAX);
+    ASSERT_EQ(bigint_ptr(&value)[1], UINT64_MAX);
+}
+
+TEST(BigIntTests, ProductOf128BitValuesIsInline) {
+    BigInt value;
+    init_all_ones(&value, 128);
+
+    BigInt product;
+    bigint_mul(&product, &value, &value);
+
+    // (2^128 - 1)^2 = 2^256 - 2^129 + 1
+    ASSERT_EQ(product.digit_count, 4);
+    ASSERT_TRUE(bigint_is_inline(&product));
+    const uint64_t* digits = bigint_ptr(&product);
+    ASSERT_EQ(digits[0], 1);
+    ASSERT_EQ(digits[1], 0);
+    ASSERT_EQ(digits[2], UINT64_MAX - 1);
+    ASSERT_EQ(digits[3], UINT64_MAX);
+}
+
+TEST(BigIntTests, LargeValuesGrowToHeap) {
+    BigInt value;
+    init_all_ones(&value, 64 * 9);
+
+    ASSERT_EQ(value.digit_count, 9);
+    ASSERT_FALSE(bigint_is_inline(&value));
+    for (size_t i = 0; i < value.digit_count; i++) {
+        ASSERT_EQ(bigint_ptr(&value)[i], UINT64_MAX);
+    }
+
+    BigInt copy;
+    bigint_init_bigint(&copy, &value);
+    ASSERT_NE(bigint_ptr(&copy), bigint_ptr(&value));
+    ASSERT_TRUE(copy == value);
+
+    bigint_deinit(&copy);
+    bigint_deinit(&value);
+}
+
+TEST(BigIntTests, SmallResultsLeaveTheHeap) {
+    BigInt big, smaller;
+    init_all_ones(&big, 64 * 6);
+    init_all_ones(&smaller, 64 * 6 - 1);
+
+    // (2^384 - 1) - (2^383 - 1) = 2^383, then 2^383 - (2^383 - 1) = 1
+    BigInt negated;
+    bigint_negate(&negated, &smaller);
+    BigInt difference;
+    bigint_add(&difference, &big, &negated);
+    bigint_add(&difference, &difference, &negated);
+
+    BigInt one;
+    bigint_init_unsigned(&one, 1);
+    ASSERT_TRUE(bigint_is_inline(&difference));
+    ASSERT_TRUE(difference == one);
+
+    bigint_deinit(&big);
+    bigint_deinit(&smaller);
+    bigint_deinit(&negated);
+}
+
+TEST(BigIntTests, DestCanBeAnOperand) {
+    BigInt value;
+    bigint_init_unsigned(&value, 3);
+
+    // 3^64 needs 102 bits, 3^256 goes to the heap
+    for (int i = 0; i < 8; i++) {
+        bigint_mul(&value, &value, &value);
+    }
+    ASSERT_FALSE(bigint_is_inline(&value));
+
+    BigInt minus_value;
+    bigint_negate(&minus_value, &value);
+    bigint_add(&value, &value, &minus_value);
+    ASSERT_EQ(value.digit_count, 0);
+    ASSERT_FALSE(value.is_negative);
+
+    bigint_deinit(&minus_value);
+}
+
+TEST(BigIntTests, SignedAddition) {
+    BigInt op1, op2, result, expected;
+    bigint_init_signed(&op1, -5);
+    bigint_init_unsigned(&op2, 3);
+    bigint_add(&result, &op1, &op2);
+    bigint_init_signed(&expected, -2);
+    ASSERT_TRUE(result == expected);
+
+    bigint_add(&result, &op2, &op1);
+    ASSERT_TRUE(result == expected);
+
+    bigint_init_signed(&op2, -3);
+    bigint_add(&result, &op1, &op2);
+    bigint_init_signed(&expected, -8);
+    ASSERT_TRUE(result == expected);
+}
+
+TEST(BigIntTests, Subtraction) {
+    BigInt op1, op2, result, expected;
+    bigint_init_signed(&op1, 3);
+    bigint_init_signed(&op2, 5);
+    bigint_sub(&result, &op1, &op2);
+    bigint_init_signed(&expected, -2);
+    ASSERT_TRUE(result == expected);
+
+    bigint_init_signed(&op1, -3);
+    bigint_sub(&result, &op1, &op2);
+    bigint_init_signed(&expected, -8);
+    ASSERT_TRUE(result == expected);
+
+    bigint_init_unsigned(&op1, 0);
+    bigint_sub(&result, &op1, &op2);
+    bigint_init_signed(&expected, -5);
+    ASSERT_TRUE(result == expected);
+
+    bigint_sub(&result, &op2, &op2);
+    ASSERT_EQ(result.digit_count, 0);
+    ASSERT_FALSE(result.is_negative);
+}
+
+TEST(BigIntTests, DivisionTruncatesTowardsZero) {
+    const int64_t cases[][2] = { { 7, 2 }, { -7, 2 }, { 7, -2 }, { -7, -2 }, { 1, 5 }, { 0, 3 } };
+    for (auto& values : cases) {
+        BigInt op1, op2, quotient, remainder, expected;
+        bigint_init_signed(&op1, values[0]);
+        bigint_init_signed(&op2, values[1]);
+        bigint_divmod(&quotient, &remainder, &op1, &op2);
+
+        bigint_init_signed(&expected, values[0] / values[1]);
+        ASSERT_TRUE(quotient == expected) << values[0] << " / " << values[1];
+        bigint_init_signed(&expected, values[0] % values[1]);
+        ASSERT_TRUE(remainder == expected) << values[0] << " % " << values[1];
+    }
+}
+
+TEST(BigIntTests, LongDivision) {
+    // single digit divisors, two digits, long and equal length operands
+    const size_t sizes[][2] = { { 5, 1 }, { 8, 2 }, { 40, 17 }, { 70, 69 }, { 3, 3 } };
+    for (auto& size : sizes) {
+        BigInt dividend, divisor, quotient, remainder;
+        init_pattern(&dividend, size[0], size[0]);
+        init_pattern(&divisor, size[1], size[1] * 31);
+        bigint_divmod(&quotient, &remainder, &dividend, &divisor);
+
+        // dividend = quotient * divisor + remainder, 0 <= remainder < divisor
+        BigInt product, sum;
+        bigint_mul(&product, &quotient, &divisor);
+        bigint_add(&sum, &product, &remainder);
+        ASSERT_TRUE(sum == dividend) << size[0] << " / " << size[1];
+        ASSERT_FALSE(remainder.is_negative);
+        ASSERT_EQ(bigint_cmp(&remainder, &divisor), CmpLT);
+
+        bigint_deinit(&dividend);
+        bigint_deinit(&divisor);
+        bigint_deinit(&quotient);
+        bigint_deinit(&remainder);
+        bigint_deinit(&product);
+        bigint_deinit(&sum);
+    }
+}
+
+TEST(BigIntTests, DivisionNormalizedTopDigit) {
+    // 2^256 - 1 divided by 2^128 - 1 is 2^128 + 1
+    BigInt dividend, divisor, quotient, remainder;
+    init_all_ones(&dividend, 256);
+    init_all_ones(&divisor, 128);
+    bigint_divmod(&quotient, &remainder, &dividend, &divisor);
+
+    ASSERT_EQ(quotient.digit_count, 3);
+    ASSERT_EQ(bigint_ptr(&quotient)[0], 1);
+    ASSERT_EQ(bigint_ptr(&quotient)[1], 0);
+    ASSERT_EQ(bigint_ptr(&quotient)[2], 1);
+    ASSERT_EQ(remainder.digit_count, 0);
+}
+
+TEST(BigIntTests, KaratsubaMatchesDivision) {
+    // above the karatsuba threshold, balanced and unbalanced
+    const size_t sizes[][2] = { { 64, 64 }, { 100, 40 }, { 300, 97 }, { 33, 32 } };
+    for (auto& size : sizes) {
+        BigInt op1, op2, product, quotient, remainder;
+        init_pattern(&op1, size[0], 7);
+        init_pattern(&op2, size[1], 11);
+        bigint_mul(&product, &op1, &op2);
+        ASSERT_GE(product.digit_count, size[0] + size[1] - 1);
+
+        bigint_divmod(&quotient, &remainder, &product, &op2);
+        ASSERT_TRUE(quotient == op1) << size[0] << " * " << size[1];
+        ASSERT_EQ(remainder.digit_count, 0);
+
+        bigint_deinit(&op1);
+        bigint_deinit(&op2);
+        bigint_deinit(&product);
+        bigint_deinit(&quotient);
+        bigint_deinit(&remainder);
+    }
+}
+
+TEST(BigIntTests, KaratsubaSquare) {
+    // (2^n - 1)^2 = 2^2n - 2^(n+1) + 1
+    BigInt value, square, expected, one, bits, power;
+    init_all_ones(&value, 64 * 80);
+    bigint_mul(&square, &value, &value);
+
+    bigint_init_unsigned(&one, 1);
+    bigint_init_unsigned(&bits, 64 * 160);
+    bigint_shl(&expected, &one, &bits);
+    bigint_init_unsigned(&bits, 64 * 80 + 1);
+    bigint_shl(&power, &one, &bits);
+    bigint_sub(&expected, &expected, &power);
+    bigint_add(&expected, &expected, &one);
+    ASSERT_TRUE(square == expected);
+
+    bigint_deinit(&value);
+    bigint_deinit(&square);
+    bigint_deinit(&expected);
+    bigint_deinit(&power);
+}
+
+TEST(BigIntTests, ShiftRightRoundsDown) {
+    const int64_t cases[][2] = { { 7, 1 }, { -7, 1 }, { -8, 3 }, { -1, 70 }, { 5, 70 }, { -9, 2 } };
+    for (auto& values : cases) {
+        BigInt op1, op2, result, expected;
+        bigint_init_signed(&op1, values[0]);
+        bigint_init_signed(&op2, values[1]);
+        bigint_shr(&result, &op1, &op2);
+
+        bigint_init_signed(&expected, values[1] >= 64 ? (values[0] < 0 ? -1 : 0) : values[0] >> values[1]);
+        ASSERT_TRUE(result == expected) << values[0] << " >> " << values[1];
+    }
+
+    // across digits
+    BigInt value, shift, result;
+    init_all_ones(&value, 200);
+    bigint_init_unsigned(&shift, 72);
+    bigint_shr(&result, &value, &shift);
+    BigInt expected;
+    init_all_ones(&expected, 128);
+    ASSERT_TRUE(result == expected);
+}
+
+TEST(BigIntTests, BitwiseTwosComplement) {
+    const int64_t cases[][2] = { { 12, 10 }, { -12, 10 }, { 12, -10 }, { -12, -10 }, { 0, -1 }, { INT64_MIN, -1 } };
+    for (auto& values : cases) {
+        BigInt op1, op2, result, expected;
+        bigint_init_signed(&op1, values[0]);
+        bigint_init_signed(&op2, values[1]);
+
+        bigint_and(&result, &op1, &op2);
+        bigint_init_signed(&expected, values[0] & values[1]);
+        ASSERT_TRUE(result == expected) << values[0] << " & " << values[1];
+
+        bigint_or(&result, &op1, &op2);
+        bigint_init_signed(&expected, values[0] | values[1]);
+        ASSERT_TRUE(result == expected) << values[0] << " | " << values[1];
+
+        bigint_xor(&result, &op1, &op2);
+        bigint_init_signed(&expected, values[0] ^ values[1]);
+        ASSERT_TRUE(result == expected) << values[0] << " ^ " << values[1];
+
+        bigint_not(&result, &op1);
+        bigint_init_signed(&expected, ~values[0]);
+        ASSERT_TRUE(result == expected) << "~" << values[0];
+    }
+}
+
+TEST(BigIntTests, Truncate) {
+    BigInt value, result, expected;
+
+    // 300 as u8 is 44, as i8 is 44 too
+    bigint_init_unsigned(&value, 300);
+    bigint_truncate(&result, &value, 8, false);
+    bigint_init_unsigned(&expected, 44);
+    ASSERT_TRUE(result == expected);
+
+    // 200 as i8 is -56
+    bigint_init_unsigned(&value, 200);
+    bigint_truncate(&result, &value, 8, true);
+    bigint_init_signed(&expected, -56);
+    ASSERT_TRUE(result == expected);
+
+    // -1 as u128 is 2^128 - 1
+    bigint_init_signed(&value, -1);
+    bigint_truncate(&result, &value, 128, false);
+    init_all_ones(&expected, 128);
+    ASSERT_TRUE(result == expected);
+
+    // 2^128 - 1 as i128 is -1, as i64 too
+    init_all_ones(&value, 128);
+    bigint_truncate(&result, &value, 128, true);
+    bigint_init_signed(&expected, -1);
+    ASSERT_TRUE(result == expected);
+    bigint_truncate(&result, &value, 64, true);
+    ASSERT_TRUE(result == expected);
+
+    // in range values are kept
+    bigint_init_signed(&value, -128);
+    bigint_truncate(&result, &value, 8, true);
+    ASSERT_TRUE(result == value);
+}
+
+TEST(BigIntTests, ToString) {
+    BigInt value;
+    bigint_init_unsigned(&value, 0);
+    ASSERT_EQ(bigint_to_string(&value, 10), "0");
+
+    bigint_init_signed(&value, -255);
+    ASSERT_EQ(bigint_to_string(&value, 10), "-255");
+    ASSERT_EQ(bigint_to_string(&value, 16), "-ff");
+    ASSERT_EQ(bigint_to_string(&value, 2), "-11111111");
+    ASSERT_EQ(bigint_to_string(&value, 36), "-73");
+
+    init_all_ones(&value, 128);
+    ASSERT_EQ(bigint_to_string(&value, 10), "340282366920938463463374607431768211455");
+    ASSERT_EQ(bigint_to_string(&value, 16), "ffffffffffffffffffffffffffffffff");
+
+    // chunks in the middle keep their zeros
+    BigInt one, bits;
+    bigint_init_unsigned(&one, 1);
+    bigint_init_unsigned(&bits, 64);
+    bigint_shl(&value, &one, &bits);
+    ASSERT_EQ(bigint_to_string(&value, 10), "18446744073709551616");
+    ASSERT_EQ(bigint_to_string(&value, 8), "2000000000000000000000");
+}
@@ -0,0 +1,356 @@
+#pragma once
+#include "../../src/bigint.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+#if defined(LLAMALANG_HAS_GMP)
+#include <gmp.h>
+#endif
+
+/*
+* Reference bignum of the BigInt differential tests and fuzzer.
+* GMP when it was found, otherwise a naive signed magnitude on 32 bit
+* limbs, slow but simple enough to be trusted.
+* Divisions truncate and right shifts round towards negative infinity,
+* like the BigInt ones.
+*/
+
+#if defined(LLAMALANG_HAS_GMP)
+struct ReferenceInt {
+    mpz_t value;
+
+    ReferenceInt() { mpz_init(value); }
+    ~ReferenceInt() { mpz_clear(value); }
+    ReferenceInt(const ReferenceInt&) = delete;
+    ReferenceInt& operator=(const ReferenceInt&) = delete;
+};
+
+static inline void reference_init(ReferenceInt* dest, const BigInt* in_value) {
+    mpz_import(dest->value, in_value->digit_count, -1, sizeof(uint64_t), 0, 0, bigint_ptr(in_value));
+    if (in_value->is_negative) {
+        mpz_neg(dest->value, dest->value);
+    }
+}
+
+static inline void reference_to_bigint(BigInt* dest, const ReferenceInt* in_value) {
+    std::vector<uint64_t> digits((mpz_sizeinbase(in_value->value, 2) + 63) / 64 + 1);
+    size_t digit_count = 0;
+    mpz_export(digits.data(), &digit_count, -1, sizeof(uint64_t), 0, 0, in_value->value);
+    bigint_init_data(dest, digits.data(), digit_count, mpz_sgn(in_value->value) < 0);
+}
+
+static inline void reference_add(ReferenceInt* dest, const ReferenceInt* op1, const ReferenceInt* op2) {
+    mpz_add(dest->value, op1->value, op2->value);
+}
+
+static inline void reference_sub(ReferenceInt* dest, const ReferenceInt* op1, const ReferenceInt* op2) {
+    mpz_sub(dest->value, op1->value, op2->value);
+}
+
+static inline void reference_mul(ReferenceInt* dest, const ReferenceInt* op1, const ReferenceInt* op2) {
+    mpz_mul(dest->value, op1->value, op2->value);
+}
+
+static inline void reference_shl(ReferenceInt* dest, const ReferenceInt* op, size_t in_bits) {
+    mpz_mul_2exp(dest->value, op->value, in_bits);
+}
+
+static inline void reference_shr(ReferenceInt* dest, const ReferenceInt* op, size_t in_bits) {
+    mpz_fdiv_q_2exp(dest->value, op->value, in_bits);
+}
+
+// op2 can't be zero
+static inline void reference_divmod(ReferenceInt* quotient, ReferenceInt* remainder, const ReferenceInt* op1, const ReferenceInt* op2) {
+    mpz_tdiv_qr(quotient->value, remainder->value, op1->value, op2->value);
+}
+
+#else
+struct ReferenceInt {
+    std::vector<uint32_t> magnitude; // least significant first, no leading zeros
+    bool is_negative = false;
+};
+
+static inline void reference_normalize(ReferenceInt* dest) {
+    while (!dest->magnitude.empty() && dest->magnitude.back() == 0) {
+        dest->magnitude.pop_back();
+    }
+    if (dest->magnitude.empty()) {
+        dest->is_negative = false;
+    }
+}
+
+static inline int reference_cmp_magnitude(const std::vector<uint32_t>& op1, const std::vector<uint32_t>& op2) {
+    if (op1.size() != op2.size()) {
+        return op1.size() < op2.size() ? -1 : 1;
+    }
+    for (size_t i = op1.size(); i > 0; i--) {
+        if (op1[i - 1] != op2[i - 1]) {
+            return op1[i - 1] < op2[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static inline std::vector<uint32_t> reference_add_magnitude(const std::vector<uint32_t>& op1, const std::vector<uint32_t>& op2) {
+    std::vector<uint32_t> result(std::max(op1.size(), op2.size()) + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < result.size(); i++) {
+        uint64_t sum = carry;
+        sum += i < op1.size() ? op1[i] : 0;
+        sum += i < op2.size() ? op2[i] : 0;
+        result[i] = uint32_t(sum);
+        carry = sum >> 32;
+    }
+    return result;
+}
+
+// op1 >= op2
+static inline std::vector<uint32_t> reference_sub_magnitude(const std::vector<uint32_t>& op1, const std::vector<uint32_t>& op2) {
+    std::vector<uint32_t> result(op1.size());
+    int64_t borrow = 0;
+    for (size_t i = 0; i < op1.size(); i++) {
+        int64_t difference = int64_t(op1[i]) - (i < op2.size() ? op2[i] : 0) - borrow;
+        borrow = difference < 0;
+        result[i] = uint32_t(difference + (borrow << 32));
+    }
+    return result;
+}
+
+static inline void reference_init(ReferenceInt* dest, const BigInt* in_value) {
+    const uint64_t* digits = bigint_ptr(in_value);
+    dest->magnitude.clear();
+    for (size_t i = 0; i < in_value->digit_count; i++) {
+        dest->magnitude.push_back(uint32_t(digits[i]));
+        dest->magnitude.push_back(uint32_t(digits[i] >> 32));
+    }
+    dest->is_negative = in_value->is_negative;
+    reference_normalize(dest);
+}
+
+static inline void reference_to_bigint(BigInt* dest, const ReferenceInt* in_value) {
+    std::vector<uint64_t> digits((in_value->magnitude.size() + 1) / 2);
+    for (size_t i = 0; i < in_value->magnitude.size(); i++) {
+        digits[i / 2] |= uint64_t(in_value->magnitude[i]) << (i % 2 * 32);
+    }
+    bigint_init_data(dest, digits.data(), digits.size(), in_value->is_negative);
+}
+
+static inline void reference_add_signed(ReferenceInt* dest, const ReferenceInt* op1, const ReferenceInt* op2, bool op2_is_negative) {
+    ReferenceInt result;
+    if (op1->is_negative == op2_is_negative) {
+        result.magnitude = reference_add_magnitude(op1->magnitude, op2->magnitude);
+        result.is_negative = op1->is_negative;
+    } else if (reference_cmp_magnitude(op1->magnitude, op2->magnitude) >= 0) {
+        result.magnitude = reference_sub_magnitude(op1->magnitude, op2->magnitude);
+        result.is_negative = op1->is_negative;
+    } else {
+        result.magnitude = reference_sub_magnitude(op2->magnitude, op1->magnitude);
+        result.is_negative = op2_is_negative;
+    }
+    reference_normalize(&result);
+    *dest = result;
+}
+
+static inline void reference_add(ReferenceInt* dest, const ReferenceInt* op1, const ReferenceInt* op2) {
+    reference_add_signed(dest, op1, op2, op2->is_negative);
+}
+
+static inline void reference_sub(ReferenceInt* dest, const ReferenceInt* op1, const ReferenceInt* op2) {
+    reference_add_signed(dest, op1, op2, !op2->is_negative);
+}
+
+static inline void reference_mul(ReferenceInt* dest, const ReferenceInt* op1, const ReferenceInt* op2) {
+    ReferenceInt result;
+    result.magnitude.assign(op1->magnitude.size() + op2->magnitude.size(), 0);
+    for (size_t i = 0; i < op1->magnitude.size(); i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < op2->magnitude.size(); j++) {
+            uint64_t product = uint64_t(op1->magnitude[i]) * op2->magnitude[j] + result.magnitude[i + j] + carry;
+            result.magnitude[i + j] = uint32_t(product);
+            carry = product >> 32;
+        }
+        result.magnitude[i + op2->magnitude.size()] = uint32_t(carry);
+    }
+    result.is_negative = op1->is_negative != op2->is_negative;
+    reference_normalize(&result);
+    *dest = result;
+}
+
+static inline bool reference_bit(const std::vector<uint32_t>& in_magnitude, size_t in_bit) {
+    return in_bit / 32 < in_magnitude.size() && ((in_magnitude[in_bit / 32] >> (in_bit % 32)) & 1) != 0;
+}
+
+static inline void reference_shl(ReferenceInt* dest, const ReferenceInt* op, size_t in_bits) {
+    ReferenceInt result;
+    result.magnitude.assign(op->magnitude.size() + in_bits / 32 + 1, 0);
+    for (size_t bit = 0; bit < op->magnitude.size() * 32; bit++) {
+        if (reference_bit(op->magnitude, bit)) {
+            result.magnitude[(bit + in_bits) / 32] |= uint32_t(1) << ((bit + in_bits) % 32);
+        }
+    }
+    result.is_negative = op->is_negative;
+    reference_normalize(&result);
+    *dest = result;
+}
+
+static inline void reference_shr(ReferenceInt* dest, const ReferenceInt* op, size_t in_bits) {
+    ReferenceInt result;
+    result.magnitude.assign(op->magnitude.size(), 0);
+    bool is_inexact = false;
+    for (size_t bit = 0; bit < op->magnitude.size() * 32; bit++) {
+        if (!reference_bit(op->magnitude, bit)) {
+            continue;
+        }
+        if (bit < in_bits) {
+            is_inexact = true;
+        } else {
+            result.magnitude[(bit - in_bits) / 32] |= uint32_t(1) << ((bit - in_bits) % 32);
+        }
+    }
+    result.is_negative = op->is_negative;
+
+    // negative values round away from zero
+    if (op->is_negative && is_inexact) {
+        result.magnitude = reference_add_magnitude(result.magnitude, { 1 });
+    }
+    reference_normalize(&result);
+    *dest = result;
+}
+
+// op2 can't be zero, one bit at a time
+static inline void reference_divmod(ReferenceInt* quotient, ReferenceInt* remainder, const ReferenceInt* op1, const ReferenceInt* op2) {
+    ReferenceInt q;
+    ReferenceInt r;
+    q.magnitude.assign(op1->magnitude.size(), 0);
+    for (size_t bit = op1->magnitude.size() * 32; bit > 0; bit--) {
+        r.magnitude = reference_add_magnitude(r.magnitude, r.magnitude);
+        if (reference_bit(op1->magnitude, bit - 1)) {
+            r.magnitude[0] |= 1;
+        }
+        reference_normalize(&r);
+        if (reference_cmp_magnitude(r.magnitude, op2->magnitude) >= 0) {
+            r.magnitude = reference_sub_magnitude(r.magnitude, op2->magnitude);
+            reference_normalize(&r);
+            q.magnitude[(bit - 1) / 32] |= uint32_t(1) << ((bit - 1) % 32);
+        }
+    }
+    q.is_negative = op1->is_negative != op2->is_negative;
+    r.is_negative = op1->is_negative;
+    reference_normalize(&q);
+    reference_normalize(&r);
+    *quotient = q;
+    *remainder = r;
+}
+#endif
+
+enum class ReferenceOp {
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Shl,
+    Shr,
+    Count,
+};
+
+// reads in_size bytes as the digits of a value, least significant first
+static inline void bigint_from_bytes(BigInt* dest, const uint8_t* in_data, size_t in_size, bool in_is_negative) {
+    std::vector<uint64_t> digits((in_size + 7) / 8);
+    for (size_t i = 0; i < in_size; i++) {
+        digits[i / 8] |= uint64_t(in_data[i]) << (i % 8 * 8);
+    }
+    bigint_init_data(dest, digits.data(), digits.size(), in_is_negative);
+}
+
+/*
+* Runs an operation on BigInt and on the reference, with the operands
+* decoded from in_data: the operation, the signs, where the first operand
+* ends and then the bytes of both operands.
+* Returns an empty string if the results match, a description otherwise.
+*/
+static inline std::string check_bigint_op(const uint8_t* in_data, size_t in_size) {
+    if (in_size < 3) {
+        return std::string();
+    }
+    const ReferenceOp op = ReferenceOp(in_data[0] % uint8_t(ReferenceOp::Count));
+    const bool is_op1_negative = (in_data[1] & 1) != 0;
+    const bool is_op2_negative = (in_data[1] & 2) != 0;
+    const uint8_t* operands = in_data + 3;
+    const size_t operands_size = in_size - 3;
+    const size_t op1_size = operands_size * in_data[2] / 256;
+
+    BigInt op1;
+    BigInt op2;
+    bigint_from_bytes(&op1, operands, op1_size, is_op1_negative);
+    bigint_from_bytes(&op2, operands + op1_size, operands_size - op1_size, is_op2_negative);
+
+    ReferenceInt reference_op1;
+    ReferenceInt reference_op2;
+    ReferenceInt reference_result;
+    ReferenceInt reference_discarded;
+    reference_init(&reference_op1, &op1);
+    reference_init(&reference_op2, &op2);
+
+    // shifts by up to 4095 bits
+    const size_t shift = op2.digit_count == 0 ? 0 : size_t(bigint_ptr(&op2)[0] % 4096);
+    BigInt shift_bi;
+    bigint_init_unsigned(&shift_bi, shift);
+
+    BigInt result;
+    bigint_init_unsigned(&result, 0);
+    switch (op) {
+    case ReferenceOp::Add:
+        bigint_add(&result, &op1, &op2);
+        reference_add(&reference_result, &reference_op1, &reference_op2);
+        break;
+    case ReferenceOp::Sub:
+        bigint_sub(&result, &op1, &op2);
+        reference_sub(&reference_result, &reference_op1, &reference_op2);
+        break;
+    case ReferenceOp::Mul:
+        bigint_mul(&result, &op1, &op2);
+        reference_mul(&reference_result, &reference_op1, &reference_op2);
+        break;
+    case ReferenceOp::Div:
+    case ReferenceOp::Mod:
+        if (op2.digit_count == 0) {
+            bigint_deinit(&op1);
+            bigint_deinit(&op2);
+            return std::string();
+        }
+        if (op == ReferenceOp::Div) {
+            bigint_divmod(&result, nullptr, &op1, &op2);
+            reference_divmod(&reference_result, &reference_discarded, &reference_op1, &reference_op2);
+        } else {
+            bigint_divmod(nullptr, &result, &op1, &op2);
+            reference_divmod(&reference_discarded, &reference_result, &reference_op1, &reference_op2);
+        }
+        break;
+    case ReferenceOp::Shl:
+        bigint_shl(&result, &op1, &shift_bi);
+        reference_shl(&reference_result, &reference_op1, shift);
+        break;
+    case ReferenceOp::Shr:
+        bigint_shr(&result, &op1, &shift_bi);
+        reference_shr(&reference_result, &reference_op1, shift);
+        break;
+    default:
+        break;
+    }
+
+    BigInt expected;
+    reference_to_bigint(&expected, &reference_result);
+
+    std::string mismatch;
+    if (!(result == expected)) {
+        static const char* op_names[] = { "add", "sub", "mul", "div", "mod", "shl", "shr" };
+        mismatch = std::string(op_names[int(op)]) + " of " + bigint_to_string(&op1, 16) + " and " + bigint_to_string(&op2, 16)
+            + " is " + bigint_to_string(&result, 16) + ", expected " + bigint_to_string(&expected, 16);
+    }
+    bigint_deinit(&op1);
+    bigint_deinit(&op2);
+    bigint_deinit(&result);
+    bigint_deinit(&expected);
+    return mismatch;
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "../../src/softfloat.hpp"
+#include <cstring>
+#include <string>
+
+static float128_t parse(const std::string& in_text) {
+    BigFloat value;
+    bigfloat_init_buf(&value, (const uint8_t*)in_text.data(), in_text.size());
+    return value.value;
+}
+
+static uint64_t double_bits(double in_value) {
+    uint64_t bits;
+    memcpy(&bits, &in_value, sizeof(bits));
+    return bits;
+}
+
+static void expect_f128(float128_t in_value, uint64_t in_high, uint64_t in_low) {
+    EXPECT_EQ(in_value.v[1], in_high);
+    EXPECT_EQ(in_value.v[0], in_low);
+}
+
+//==================================================================================
+//          ARITHMETIC
+//==================================================================================
+
+TEST(SoftFloatTests, RoundsTheResult) {
+    // 1/3 rounds down, 2/3 rounds up
+    expect_f128(f128_div(parse("1"), parse("3")), 0x3ffd555555555555ull, 0x5555555555555555ull);
+    expect_f128(f128_div(parse("2"), parse("3")), 0x3ffe555555555555ull, 0x5555555555555555ull);
+    expect_f128(f128_add(parse("0.1"), parse("0.2")), parse("0.3").v[1], parse("0.3").v[0] + 1);
+    expect_f128(f128_mul(parse("1.5"), f128_neg(parse("2.25"))), f128_neg(parse("3.375")).v[1], parse("3.375").v[0]);
+    expect_f128(f128_sub(parse("1"), parse("1e-40")), parse("0.9999999999999999999999999999999999999999").v[1],
+        parse("0.9999999999999999999999999999999999999999").v[0]);
+}
+
+TEST(SoftFloatTests, TiesToEven) {
+    // 1 + 2^-113 is halfway to the next value, 1 + 3 * 2^-113 to the one after
+    expect_f128(f128_add(parse("1"), parse("0x1p-113")), 0x3fff000000000000ull, 0);
+    expect_f128(f128_add(parse("1"), parse("0x3p-113")), 0x3fff000000000000ull, 2);
+    expect_f128(f128_add(parse("1"), parse("0x1.0000000000000000000000000001p-113")), 0x3fff000000000000ull, 1);
+}
+
+TEST(SoftFloatTests, SpecialValues) {
+    const float128_t zero = parse("0");
+    const float128_t inf = f128_div(parse("1"), zero);
+    ASSERT_TRUE(f128_is_infinite(inf));
+    ASSERT_TRUE(f128_is_infinite(f128_mul(parse("1e4000"), parse("1e4000"))));
+    ASSERT_TRUE(f128_is_nan(f128_sub(inf, inf)));
+    ASSERT_TRUE(f128_is_nan(f128_mul(inf, zero)));
+    ASSERT_TRUE(f128_is_nan(f128_div(zero, zero)));
+    expect_f128(f128_sub(parse("1.5"), parse("1.5")), 0, 0);
+    expect_f128(f128_neg(zero), 0x8000000000000000ull, 0);
+
+    // the smallest subnormal halved rounds to zero, its double stays exact
+    const float128_t min = parse("0x1p-16494");
+    expect_f128(f128_mul(min, parse("0.5")), 0, 0);
+    expect_f128(f128_add(min, min), 0, 2);
+    expect_f128(f128_div(parse("0x1p-16382"), parse("0x1p112")), 0, 1);
+}
+
+TEST(SoftFloatTests, Compare) {
+    const float128_t one = parse("1");
+    const float128_t two = parse("2");
+    const float128_t nan = f128_div(parse("0"), parse("0"));
+
+    ASSERT_TRUE(f128_lt(one, two));
+    ASSERT_FALSE(f128_lt(two, one));
+    ASSERT_TRUE(f128_lt(f128_neg(two), f128_neg(one)));
+    ASSERT_TRUE(f128_le(one, one));
+    ASSERT_TRUE(f128_eq(parse("0"), f128_neg(parse("0"))));
+    ASSERT_FALSE(f128_lt(parse("0"), f128_neg(parse("0"))));
+    ASSERT_FALSE(f128_eq(nan, nan));
+    ASSERT_FALSE(f128_le(nan, one));
+}
+
+#if defined(__SIZEOF_FLOAT128__)
+TEST(SoftFloatTests, MatchesCompiler) {
+    // random operands with close and far exponents, against the compiler binary128 support
+    uint64_t state = 1;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return state;
+    };
+
+    for (int i = 0; i < 20000; i++) {
+        float128_t a = { { next(), next() } };
+        float128_t b = { { next(), next() } };
+        // most exponents close to each other, some subnormals
+        const uint64_t exponent = (next() % 64 == 0) ? 0 : 0x3f00 + next() % 0x200;
+        a.v[1] = (a.v[1] & 0x8000ffffffffffffull) | (exponent << 48);
+        b.v[1] = (b.v[1] & 0x8000ffffffffffffull) | ((0x3f00 + next() % 0x200) << 48);
+
+        __float128 native_a;
+        __float128 native_b;
+        memcpy(&native_a, &a, sizeof(a));
+        memcpy(&native_b, &b, sizeof(b));
+
+        __float128 native_results[4] = { native_a + native_b, native_a - native_b, native_a * native_b, native_a / native_b };
+        float128_t results[4] = { f128_add(a, b), f128_sub(a, b), f128_mul(a, b), f128_div(a, b) };
+        for (int j = 0; j < 4; j++) {
+            float128_t expected;
+            memcpy(&expected, &native_results[j], sizeof(expected));
+            ASSERT_EQ(results[j].v[1], expected.v[1]) << "operation " << j << " of case " << i;
+            ASSERT_EQ(results[j].v[0], expected.v[0]) << "operation " << j << " of case " << i;
+        }
+        ASSERT_EQ(f128_lt(a, b), native_a < native_b);
+
+        double native_double = double(native_a);
+        ASSERT_EQ(f128_to_f64(a), double_bits(native_double));
+        float native_float = float(native_a);
+        uint32_t float_bits;
+        memcpy(&float_bits, &native_float, sizeof(float_bits));
+        ASSERT_EQ(f128_to_f32(a), float_bits);
+    }
+}
+#endif
+
+//==================================================================================
+//          CONVERSION
+//==================================================================================
+
+TEST(SoftFloatTests, DoubleConversion) {
+    const double values[] = { 0.1, -2.5, 1e308, 4.9e-324, 2.2250738585072014e-308, 0.0 };
+    for (double value : values) {
+        const float128_t wide = f64_to_f128(double_bits(value));
+        ASSERT_EQ(f128_to_f64(wide), double_bits(value));
+    }
+    expect_f128(f64_to_f128(double_bits(0.1)), 0x3ffb999999999999ull, 0xa000000000000000ull);
+
+    // rounded once from binary128
+    ASSERT_EQ(f128_to_f64(parse("0.1")), double_bits(0.1));
+    ASSERT_EQ(f128_to_f64(parse("1e400")), 0x7ff0000000000000ull);
+    ASSERT_EQ(f128_to_f64(parse("1e-400")), 0L);
+    ASSERT_EQ(f128_to_f32(parse("0.1")), 0x3dcccccdu);
+}
+
+TEST(SoftFloatTests, BigIntConversion) {
+    BigInt value;
+    bigint_init_signed(&value, -12345);
+    expect_f128(bigint_to_f128(&value), f128_neg(parse("12345")).v[1], parse("12345").v[0]);
+
+    // 2^113 + 1 is halfway, 2^113 + 3 rounds up
+    const uint64_t halfway[2] = { 1, 0x2000000000000ull };
+    bigint_init_data(&value, halfway, 2, false);
+    expect_f128(bigint_to_f128(&value), 0x4070000000000000ull, 0);
+    const uint64_t above[2] = { 3, 0x2000000000000ull };
+    bigint_init_data(&value, above, 2, false);
+    expect_f128(bigint_to_f128(&value), 0x4070000000000000ull, 2);
+
+    BigInt result;
+    ASSERT_TRUE(f128_to_bigint(&result, f128_neg(parse("1234.99"))));
+    bigint_init_signed(&value, -1234);
+    ASSERT_EQ(result, value);
+
+    ASSERT_TRUE(f128_to_bigint(&result, parse("1e30")));
+    ASSERT_EQ(bigint_to_string(&result, 10), "1000000000000000000000000000000");
+    ASSERT_TRUE(f128_to_bigint(&result, parse("0.5")));
+    ASSERT_EQ(result.digit_count, 0L);
+    ASSERT_FALSE(f128_to_bigint(&result, f128_div(parse("1"), parse("0"))));
+}
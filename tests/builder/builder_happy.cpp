@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "../../src/compiler.hpp"
+#include "../captured_output.hpp"
+
+static std::filesystem::path make_build_dir(const std::string& in_name) {
+    auto dir = std::filesystem::temp_directory_path() / in_name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "out");
+    return dir;
+}
+
+static void write_file(const std::filesystem::path& in_path, const std::string& in_contents) {
+    std::ofstream file(in_path, std::ios::binary);
+    file << in_contents;
+}
+
+static BuildOptions make_options(const std::filesystem::path& in_dir) {
+    BuildOptions options;
+    options.output_directory = (in_dir / "out").string();
+    options.thread_count = 4;
+    return options;
+}
+
+//==================================================================================
+//          MODULE GRAPH
+//==================================================================================
+
+TEST(BuilderHappyTests, LoadCycleBuildsEachModule) {
+    auto dir = make_build_dir("builder_happy_load_cycle");
+    write_file(dir / "main.llang", "#load util\nfn main() i32 {\n ret helper()\n}\n");
+    write_file(dir / "util.llang", "#load main\ng u8 = 200 + 100\nfn helper() i32 {\n ret 1\n}\n");
+
+    int result;
+    std::string output;
+    {
+        CapturedOutput captured;
+        result = compiler::build(make_options(dir), { RootSource{ (dir / "main.llang").string(), std::nullopt } });
+        output = captured.stream.str();
+    }
+
+    ASSERT_EQ(result, 0);
+    ASSERT_TRUE(std::filesystem::exists(dir / "out" / "main.bc"));
+    ASSERT_TRUE(std::filesystem::exists(dir / "out" / "util.bc"));
+    ASSERT_NE(output.find("[WARNING_0]util.llang\t:: line: 1\t:: col: 11\t:: constant overflows 'u8'"), std::string::npos);
+    ASSERT_EQ(output.find("main.llang\t::"), std::string::npos);
+}
+
+TEST(BuilderSadTests, LoadedModuleError) {
+    auto dir = make_build_dir("builder_sad_loaded_error");
+    write_file(dir / "main.llang", "#load util\nfn main() i32 {\n ret 0\n}\n");
+    write_file(dir / "util.llang", "#load main\nfn helper() i32 {\n ret nothere\n}\n");
+
+    int result;
+    std::string output;
+    {
+        CapturedOutput captured;
+        result = compiler::build(make_options(dir), { RootSource{ (dir / "main.llang").string(), std::nullopt } });
+        output = captured.stream.str();
+    }
+
+    // the modules without errors are written anyway
+    ASSERT_NE(result, 0);
+    ASSERT_TRUE(std::filesystem::exists(dir / "out" / "main.bc"));
+    ASSERT_FALSE(std::filesystem::exists(dir / "out" / "util.bc"));
+    ASSERT_NE(output.find("[ERROR]util.llang\t:: line: 2"), std::string::npos);
+    ASSERT_EQ(output.find("main.llang\t::"), std::string::npos);
+}
+
+TEST(BuilderSadTests, MissingLoadedModule) {
+    auto dir = make_build_dir("builder_sad_missing_load");
+    write_file(dir / "main.llang", "#load nothere\nfn main() i32 {\n ret 0\n}\n");
+
+    int result;
+    std::string output;
+    {
+        CapturedOutput captured;
+        result = compiler::build(make_options(dir), { RootSource{ (dir / "main.llang").string(), std::nullopt } });
+        output = captured.stream.str();
+    }
+
+    ASSERT_NE(result, 0);
+    ASSERT_FALSE(std::filesystem::exists(dir / "out" / "main.bc"));
+    ASSERT_NE(output.find("could not read module \"nothere\""), std::string::npos);
+}
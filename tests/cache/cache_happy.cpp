@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <llvm/Support/MemoryBuffer.h>
+#include "../../src/ast_nodes.hpp"
+#include "../../src/cache.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+
+struct ParsedSource {
+    std::vector<Error> errors;
+    Lexer lexer;
+    AstNode* source_code_node;
+
+    ParsedSource(const std::string& in_source, const std::string& in_file_name)
+        : errors(), lexer(in_source, in_file_name, errors) {
+        lexer.tokenize();
+        Parser parser(lexer, errors);
+        source_code_node = parser.parse();
+    }
+
+    std::string node_key(size_t index) {
+        return cache::get_node_key(source_code_node->source_code.children.at(index), source_code_node->source_code);
+    }
+
+    std::string signature_key(size_t index) {
+        return cache::get_signature_key(source_code_node->source_code.children.at(index), source_code_node->source_code);
+    }
+};
+
+//==================================================================================
+//          KEYS
+//==================================================================================
+
+TEST(CacheHappyTests, BodyEditKeepsSignatureKey) {
+    ParsedSource original("fn a() i32 {\n ret 1\n}\nfn b() i32 {\n ret 2\n}\n", "BodyEditKeepsSignatureKey");
+    ParsedSource edited("fn a() i32 {\n ret 1\n}\nfn b() i32 {\n ret 3\n}\n", "BodyEditKeepsSignatureKey");
+
+    ASSERT_EQ(original.signature_key(1), edited.signature_key(1));
+    ASSERT_EQ(original.node_key(0), edited.node_key(0));
+    ASSERT_NE(original.node_key(1), edited.node_key(1));
+}
+
+TEST(CacheHappyTests, ProtoEditChangesSignatureKey) {
+    ParsedSource original("fn a() i32 {\n ret 1\n}\nfn b() i32 {\n ret 2\n}\n", "ProtoEditChangesSignatureKey");
+    ParsedSource edited("fn a() i32 {\n ret 1\n}\nfn b() i64 {\n ret 2\n}\n", "ProtoEditChangesSignatureKey");
+
+    ASSERT_NE(original.signature_key(1), edited.signature_key(1));
+    ASSERT_EQ(original.node_key(0), edited.node_key(0));
+}
+
+TEST(CacheHappyTests, WhitespaceKeepsDeclarationKey) {
+    ParsedSource original("fn a() i32 {\n ret 1\n}\n", "WhitespaceKeepsDeclarationKey");
+    ParsedSource edited("\n\nfn a() i32 {\n\n     ret 1\n}\n", "WhitespaceKeepsDeclarationKey");
+
+    ASSERT_EQ(original.node_key(0), edited.node_key(0));
+}
+
+//==================================================================================
+//          STORAGE
+//==================================================================================
+
+TEST(CacheHappyTests, StoreAndLoad) {
+    auto directory = std::filesystem::temp_directory_path() / "llamalang_cache_test";
+    std::filesystem::remove_all(directory);
+    CompilationCache compilation_cache(directory.string());
+
+    ASSERT_EQ(compilation_cache.load("0123abcd", ".bc"), nullptr);
+
+    compilation_cache.store("0123abcd", ".bc", "cached bytes");
+    auto entry = compilation_cache.load("0123abcd", ".bc");
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(entry->getBuffer(), "cached bytes");
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <iostream>
+#include <sstream>
+
+// redirects std::cout while alive, the compiler prints its diagnostics and failures there
+struct CapturedOutput {
+    std::stringstream stream;
+    std::streambuf*   previous;
+
+    CapturedOutput() : stream(), previous(std::cout.rdbuf(stream.rdbuf())) {}
+    ~CapturedOutput() { std::cout.rdbuf(previous); }
+};
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "../../src/command_line.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+static std::string get_working_dir() {
+    const auto working_dir = std::filesystem::temp_directory_path() / "command_line_happy";
+    std::filesystem::create_directories(working_dir);
+    return working_dir.string();
+}
+
+static void write_file(const std::string& in_working_dir, const std::string& in_name, const std::string& in_contents) {
+    std::ofstream file(std::filesystem::path(in_working_dir) / in_name, std::ios::binary);
+    file << in_contents;
+}
+
+static std::string get_path(const std::string& in_working_dir, const std::string& in_name) {
+    return (std::filesystem::path(in_working_dir) / in_name).string();
+}
+
+//==================================================================================
+//          RESPONSE FILES
+//==================================================================================
+
+TEST(CommandLineHappyTests, ResponseFileQuoting) {
+    const std::string working_dir = get_working_dir();
+    write_file(working_dir, "quoting.rsp", "\"my file.llang\" 'other file.llang'\nthird\\ file.llang -O \"out \\\"dir\\\"\" @quoting_inner.rsp");
+    write_file(working_dir, "quoting_inner.rsp", "--run 'main'");
+
+    CommandLine command_line;
+    ASSERT_TRUE(command_line::parse(working_dir, { "first.llang", "@quoting.rsp", "-j2" }, true, command_line));
+
+    ASSERT_EQ(command_line.sources.size(), 4L);
+    ASSERT_EQ(command_line.sources[0].file_path, get_path(working_dir, "first.llang"));
+    ASSERT_EQ(command_line.sources[1].file_path, get_path(working_dir, "my file.llang"));
+    ASSERT_EQ(command_line.sources[2].file_path, get_path(working_dir, "other file.llang"));
+    ASSERT_EQ(command_line.sources[3].file_path, get_path(working_dir, "third file.llang"));
+    ASSERT_EQ(command_line.build_options.output_directory, get_path(working_dir, "out \"dir\""));
+    ASSERT_EQ(command_line.build_options.run_entry_point, "main");
+    ASSERT_EQ(command_line.build_options.thread_count, 2u);
+}
+
+//==================================================================================
+//          OPTIONS
+//==================================================================================
+
+TEST(CommandLineHappyTests, JobCountForms) {
+    const std::string working_dir = get_working_dir();
+
+    CommandLine joined;
+    ASSERT_TRUE(command_line::parse(working_dir, { "-j12", "main.llang" }, true, joined));
+    ASSERT_EQ(joined.build_options.thread_count, 12u);
+
+    CommandLine separate;
+    ASSERT_TRUE(command_line::parse(working_dir, { "-j", "12", "main.llang" }, true, separate));
+    ASSERT_EQ(separate.build_options.thread_count, 12u);
+
+    CommandLine every_thread;
+    ASSERT_TRUE(command_line::parse(working_dir, { "-j0", "main.llang" }, true, every_thread));
+    ASSERT_EQ(every_thread.build_options.thread_count, 0u);
+
+    uint32_t thread_count = 0;
+    ASSERT_TRUE(command_line::parse_thread_count("7", &thread_count));
+    ASSERT_EQ(thread_count, 7u);
+}
+
+TEST(CommandLineHappyTests, DefaultDirectories) {
+    const std::string working_dir = get_working_dir();
+
+    CommandLine command_line;
+    ASSERT_TRUE(command_line::parse(working_dir, { "-s", "main.llang", "-o", "app" }, true, command_line));
+    ASSERT_EQ(command_line.build_options.output_name, "app");
+    ASSERT_EQ(command_line.build_options.output_directory, working_dir);
+    ASSERT_EQ(command_line.build_options.cache_directory, get_path(working_dir, ".llcache"));
+
+    CommandLine no_cache;
+    ASSERT_TRUE(command_line::parse(working_dir, { "main.llang", "--no-cache" }, true, no_cache));
+    ASSERT_TRUE(no_cache.build_options.cache_directory.empty());
+}
+
+TEST(CommandLineHappyTests, StdinIsLastSource) {
+    const std::string working_dir = get_working_dir();
+
+    CommandLine command_line;
+    ASSERT_TRUE(command_line::parse(working_dir, { "--stdin", "main.llang" }, true, command_line));
+    ASSERT_TRUE(command_line.read_stdin);
+    ASSERT_EQ(command_line.sources.size(), 2L);
+    ASSERT_EQ(command_line.sources[1].file_path, get_path(working_dir, "stdin.llang"));
+    ASSERT_TRUE(command_line.sources[1].source.has_value());
+}
+
+TEST(CommandLineHappyTests, SameSourceTwice) {
+    const std::string working_dir = get_working_dir();
+
+    // built once, its output name is not taken by another source
+    CommandLine command_line;
+    ASSERT_TRUE(command_line::parse(working_dir, { "main.llang", "./main.llang", "lib/../main.llang" }, true, command_line));
+    ASSERT_EQ(command_line.sources.size(), 3L);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "../../src/command_line.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+static std::string get_working_dir() {
+    const auto working_dir = std::filesystem::temp_directory_path() / "command_line_sad";
+    std::filesystem::create_directories(working_dir);
+    return working_dir.string();
+}
+
+static void write_file(const std::string& in_working_dir, const std::string& in_name, const std::string& in_contents) {
+    std::ofstream file(std::filesystem::path(in_working_dir) / in_name, std::ios::binary);
+    file << in_contents;
+}
+
+//==================================================================================
+//          RESPONSE FILES
+//==================================================================================
+
+TEST(CommandLineSadTests, ResponseFilesNestedTooDeep) {
+    const std::string working_dir = get_working_dir();
+    write_file(working_dir, "self.rsp", "main.llang @self.rsp");
+
+    CommandLine command_line;
+    ASSERT_FALSE(command_line::parse(working_dir, { "@self.rsp" }, true, command_line));
+
+    // a chain within the limit
+    for (int i = 0; i < 7; i++) {
+        write_file(working_dir, "chain" + std::to_string(i) + ".rsp", "@chain" + std::to_string(i + 1) + ".rsp");
+    }
+    write_file(working_dir, "chain7.rsp", "main.llang");
+    std::vector<std::string> args;
+    ASSERT_TRUE(command_line::expand_response_files(working_dir, { "@chain0.rsp" }, 0, args));
+    ASSERT_EQ(args, std::vector<std::string>{ "main.llang" });
+
+    // one more is too deep
+    args.clear();
+    ASSERT_FALSE(command_line::expand_response_files(working_dir, { "@chain0.rsp" }, 1, args));
+}
+
+TEST(CommandLineSadTests, MissingResponseFile) {
+    CommandLine command_line;
+    ASSERT_FALSE(command_line::parse(get_working_dir(), { "main.llang", "@missing.rsp" }, true, command_line));
+}
+
+//==================================================================================
+//          OPTIONS
+//==================================================================================
+
+TEST(CommandLineSadTests, BadJobCount) {
+    const std::string working_dir = get_working_dir();
+    const std::vector<std::vector<std::string>> bad_args = {
+        { "main.llang", "-jx" },
+        { "main.llang", "-j4x" },
+        { "main.llang", "-j", "-4" },
+        { "main.llang", "-j", "" },
+        { "main.llang", "-j" },
+    };
+    for (auto& args : bad_args) {
+        CommandLine command_line;
+        ASSERT_FALSE(command_line::parse(working_dir, args, true, command_line)) << args.back();
+    }
+
+    uint32_t thread_count;
+    ASSERT_FALSE(command_line::parse_thread_count("", &thread_count));
+    ASSERT_FALSE(command_line::parse_thread_count("99999999999", &thread_count));
+}
+
+TEST(CommandLineSadTests, BadArgument) {
+    const std::string working_dir = get_working_dir();
+
+    CommandLine unknown;
+    ASSERT_FALSE(command_line::parse(working_dir, { "main.llang", "--unknown", "value" }, true, unknown));
+
+    CommandLine emit_type;
+    ASSERT_FALSE(command_line::parse(working_dir, { "main.llang", "--emit=exe" }, true, emit_type));
+
+    // the server's standard input is not the client's
+    CommandLine server_stdin;
+    ASSERT_FALSE(command_line::parse(working_dir, { "--stdin" }, false, server_stdin));
+}
+
+//==================================================================================
+//          SOURCES
+//==================================================================================
+
+TEST(CommandLineSadTests, MissingSource) {
+    CommandLine command_line;
+    ASSERT_FALSE(command_line::parse(get_working_dir(), { "-j4" }, true, command_line));
+}
+
+TEST(CommandLineSadTests, OutputNameWithSeveralSources) {
+    const std::string working_dir = get_working_dir();
+
+    CommandLine command_line;
+    ASSERT_FALSE(command_line::parse(working_dir, { "a.llang", "-s", "b.llang", "-o", "app" }, true, command_line));
+
+    CommandLine with_stdin;
+    ASSERT_FALSE(command_line::parse(working_dir, { "a.llang", "--stdin", "-o", "app" }, true, with_stdin));
+}
+
+TEST(CommandLineSadTests, DuplicateOutputNames) {
+    const std::string working_dir = get_working_dir();
+
+    CommandLine command_line;
+    ASSERT_FALSE(command_line::parse(working_dir, { "a/main.llang", "b/main.llang" }, true, command_line));
+
+    // the extension is not part of the name
+    CommandLine extension;
+    ASSERT_FALSE(command_line::parse(working_dir, { "main.llang", "main.txt" }, true, extension));
+
+    CommandLine with_stdin;
+    ASSERT_FALSE(command_line::parse(working_dir, { "lib/stdin.llang", "--stdin" }, true, with_stdin));
+}
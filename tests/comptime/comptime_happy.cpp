@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "../../src/ast_nodes.hpp"
+#include "../../src/comptime.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+
+static const BigInt& get_global_value(AstNode* source_code_node, size_t index) {
+    auto var_def_node = source_code_node->source_code.children.at(index);
+    auto value_node = var_def_node->var_def.initializer->binary_expr.op2;
+    return source_code_node->source_code.literals->get_int(value_node->symbol.token->int_lit);
+}
+
+//==================================================================================
+//          RUN DIRECTIVE
+//==================================================================================
+
+TEST(ComptimeHappyTests, RunDirectiveCall) {
+    std::vector<Error> errors;
+    Lexer lexer("fn square(x i32) i32 {\n y i32 = x * x\n ret y + 1\n}\ntable i32 = #run square(12)\n", "RunDirectiveCall", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ComptimeEvaluator evaluator(source_code_node, errors);
+    evaluator.run_directives(source_code_node);
+
+    BigInt expected;
+    bigint_init_unsigned(&expected, 145);
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto value_node = source_code_node->source_code.children.at(1)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstSymbol);
+    ASSERT_TRUE(value_node->symbol.is_comptime_value);
+    ASSERT_EQ(get_global_value(source_code_node, 1), expected);
+}
+
+TEST(ComptimeHappyTests, GlobalInitializerExpr) {
+    std::vector<Error> errors;
+    Lexer lexer("a i64 = 3\nb i64 = a * 2 - 10\n", "GlobalInitializerExpr", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ComptimeEvaluator evaluator(source_code_node, errors);
+    evaluator.run_directives(source_code_node);
+
+    BigInt expected;
+    bigint_init_signed(&expected, -4);
+
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(get_global_value(source_code_node, 1), expected);
+}
+
+// the constant folder computes them in the literal type
+TEST(ComptimeHappyTests, SizedGlobalLeftToFolder) {
+    std::vector<Error> errors;
+    Lexer lexer("a u32 = 200ub + 100ub\nb u32 = a + 1ub\n", "SizedGlobalLeftToFolder", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ComptimeEvaluator evaluator(source_code_node, errors);
+    evaluator.run_directives(source_code_node);
+
+    // a is read wrapped to u8
+    BigInt expected;
+    bigint_init_unsigned(&expected, 45);
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto value_node = source_code_node->source_code.children.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstBinaryExpr);
+    ASSERT_EQ(get_global_value(source_code_node, 1), expected);
+}
+
+// values wider than 256 bits live on the heap, they go through assignments, calls and returns
+TEST(ComptimeHappyTests, RunHeapValues) {
+    std::vector<Error> errors;
+    Lexer lexer("fn twice(x i64) i64 {\n ret x + x\n}\nfn grow(x i64) i64 {\n y i64 = x * x * x\n y = twice(y)\n ret y\n}\n"
+        "value i64 = #run grow(1 << 100) / (1 << 100) / (1 << 100) / (1 << 100)\n", "RunHeapValues", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ComptimeEvaluator evaluator(source_code_node, errors);
+    evaluator.run_directives(source_code_node);
+
+    BigInt expected;
+    bigint_init_unsigned(&expected, 2);
+
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(get_global_value(source_code_node, 2), expected);
+}
+
+//==================================================================================
+//          ERRORS
+//==================================================================================
+
+TEST(ComptimeSadTests, RunUndefinedFunction) {
+    std::vector<Error> errors;
+    Lexer lexer("x i32 = #run nothere(1)\n", "RunUndefinedFunction", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ComptimeEvaluator evaluator(source_code_node, errors);
+    evaluator.run_directives(source_code_node);
+
+    ASSERT_EQ(errors.size(), 1L);
+}
+
+TEST(ComptimeSadTests, CyclicGlobalInitializer) {
+    std::vector<Error> errors;
+    Lexer lexer("x i32 = y + 1\ny i32 = x\n", "CyclicGlobalInitializer", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ComptimeEvaluator evaluator(source_code_node, errors);
+    evaluator.run_directives(source_code_node);
+
+    ASSERT_GE(errors.size(), 1L);
+}
+
+TEST(ComptimeSadTests, RunTooLargeShift) {
+    std::vector<Error> errors;
+    Lexer lexer("fn big() i32 {\n ret 1 << 0xFFFFFFFFFFF\n}\nx i32 = #run big()\n", "RunTooLargeShift", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ComptimeEvaluator evaluator(source_code_node, errors);
+    evaluator.run_directives(source_code_node);
+
+    ASSERT_EQ(errors.size(), 1L);
+}
@@ -0,0 +1,319 @@
+#include <gtest/gtest.h>
+#include "../../src/ast_nodes.hpp"
+#include "../../src/constant_folder.hpp"
+#include "../../src/error.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+#include "../../src/softfloat.hpp"
+
+//==================================================================================
+//          FOLDING
+//==================================================================================
+
+TEST(ConstantFolderTests, FoldLocalInitializer) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() i32 {\n x i64 = 1 + 2 * 3\n ret x\n}\n", "FoldLocalInitializer", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    BigInt expected;
+    bigint_init_unsigned(&expected, 7);
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto block_node = source_code_node->source_code.children.at(0)->function_def.block;
+    auto value_node = block_node->block.statements.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstSymbol);
+    ASSERT_TRUE(value_node->symbol.is_comptime_value);
+    ASSERT_EQ(source_code_node->source_code.literals->get_int(value_node->symbol.token->int_lit), expected);
+}
+
+// the intermediate values are wider than 256 bits and live on the heap
+TEST(ConstantFolderTests, FoldHeapValues) {
+    std::vector<Error> errors;
+    // ~2^150 * 2^150 / 2^299
+    Lexer lexer("fn main() i32 {\n x i64 = ~1427247692705959881058285969449495136382746624 * 1427247692705959881058285969449495136382746624"
+        " / 1018517988167243043134222844204689080525734196832968125318070224677190649881668353091698688\n ret x\n}\n",
+        "FoldHeapValues", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    BigInt expected;
+    bigint_init_signed(&expected, -2);
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto block_node = source_code_node->source_code.children.at(0)->function_def.block;
+    auto value_node = block_node->block.statements.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstSymbol);
+    ASSERT_EQ(source_code_node->source_code.literals->get_int(value_node->symbol.token->int_lit), expected);
+}
+
+TEST(ConstantFolderTests, KeepRuntimeOperands) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main(a i32) i32 {\n x i32 = a + 2\n ret x\n}\n", "KeepRuntimeOperands", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto block_node = source_code_node->source_code.children.at(0)->function_def.block;
+    auto value_node = block_node->block.statements.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstBinaryExpr);
+}
+
+TEST(ConstantFolderTests, FoldDivisionAndBitwise) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() i32 {\n x i64 = 100 / 7 % 5 ^ 12 & 10 >> 1\n ret x\n}\n", "FoldDivisionAndBitwise", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto block_node = source_code_node->source_code.children.at(0)->function_def.block;
+    auto value_node = block_node->block.statements.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstSymbol);
+    ASSERT_TRUE(value_node->symbol.is_comptime_value);
+}
+
+TEST(ConstantFolderTests, KeepDivisionByZero) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() i32 {\n x i32 = 1 / 0\n ret x\n}\n", "KeepDivisionByZero", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    auto block_node = source_code_node->source_code.children.at(0)->function_def.block;
+    auto value_node = block_node->block.statements.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstBinaryExpr);
+}
+
+TEST(ConstantFolderTests, KeepTooLargeShift) {
+    // past 64 bits and a shift that would allocate 2^38 digits
+    const char* sources[] = {
+        "fn main() i32 {\n x i32 = 1 << 0x10000000000000000\n ret x\n}\n",
+        "fn main() i32 {\n x i32 = 1 << 0xFFFFFFFFFFF\n ret x\n}\n",
+        "fn main() i32 {\n x i32 = 1 << 128\n ret x\n}\n",
+    };
+    for (const char* source : sources) {
+        std::vector<Error> errors;
+        Lexer lexer(source, "KeepTooLargeShift", errors);
+        lexer.tokenize();
+
+        Parser parser(lexer, errors);
+        auto source_code_node = parser.parse();
+
+        ConstantFolder folder(source_code_node, errors);
+        folder.fold(source_code_node);
+
+        ASSERT_EQ(errors.size(), 0L) << source;
+        auto block_node = source_code_node->source_code.children.at(0)->function_def.block;
+        auto value_node = block_node->block.statements.at(0)->var_def.initializer->binary_expr.op2;
+        ASSERT_EQ(value_node->node_type, AstNodeType::AstBinaryExpr) << source;
+    }
+}
+
+TEST(ConstantFolderTests, FoldF128Global) {
+    std::vector<Error> errors;
+    Lexer lexer("g f128 = 2.0 - 1.0 / 3.0 + 7 / 2\n", "FoldF128Global", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    // 7 / 2 is an integer division
+    BigInt one;
+    BigInt two;
+    BigInt three;
+    bigint_init_unsigned(&one, 1);
+    bigint_init_unsigned(&two, 2);
+    bigint_init_unsigned(&three, 3);
+    const float128_t third = f128_div(bigint_to_f128(&one), bigint_to_f128(&three));
+    const float128_t expected = f128_add(f128_sub(bigint_to_f128(&two), third), bigint_to_f128(&three));
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto value_node = source_code_node->source_code.children.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstSymbol);
+    ASSERT_EQ(value_node->symbol.token->id, TokenId::FLOAT_LIT);
+    const BigFloat& value = source_code_node->source_code.literals->get_float(value_node->symbol.token->float_lit);
+    ASSERT_EQ(value.value.v[1], expected.v[1]);
+    ASSERT_EQ(value.value.v[0], expected.v[0]);
+    ASSERT_EQ(value.f64_bits, f128_to_f64(expected));
+}
+
+TEST(ConstantFolderTests, KeepF64Operations) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() f64 {\n x f64 = 0.1 + 0.2\n ret x\n}\n", "KeepF64Operations", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto block_node = source_code_node->source_code.children.at(0)->function_def.block;
+    auto value_node = block_node->block.statements.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstBinaryExpr);
+}
+
+//==================================================================================
+//          DIAGNOSTICS
+//==================================================================================
+
+TEST(ConstantFolderTests, OverflowWarning) {
+    std::vector<Error> errors;
+    Lexer lexer("g u8 = 200 + 100\n", "OverflowWarning", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors[0].type, ERROR_TYPE::WARNING_0);
+}
+
+TEST(ConstantFolderTests, SizedLiteralsWrap) {
+    std::vector<Error> errors;
+    Lexer lexer("a u32 = 200ub + 100ub\nb i8 = 127b + 1\nc u32 = 255ub + 1ub\nd i32 = 100b + 20b\n", "SizedLiteralsWrap", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    // a, b and c overflow their literal type, not the variable one
+    ASSERT_EQ(errors.size(), 3L);
+    for (size_t i = 0; i < errors.size(); i++) {
+        ASSERT_EQ(errors[i].type, ERROR_TYPE::WARNING_0);
+        ASSERT_EQ(errors[i].line, i);
+    }
+    ASSERT_EQ(errors[0].message, "constant overflows 'u8', it will be truncated to 8 bits");
+
+    const int64_t expected_values[] = { 44, -128, 0, 120 };
+    const LiteralType expected_types[] = { LiteralType::U8, LiteralType::I8, LiteralType::U8, LiteralType::I8 };
+    for (size_t i = 0; i < 4; i++) {
+        auto value_node = source_code_node->source_code.children.at(i)->var_def.initializer->binary_expr.op2;
+        ASSERT_EQ(value_node->node_type, AstNodeType::AstSymbol);
+        ASSERT_EQ(value_node->symbol.token->lit_type, expected_types[i]);
+
+        BigInt expected;
+        bigint_init_signed(&expected, expected_values[i]);
+        ASSERT_EQ(source_code_node->source_code.literals->get_int(value_node->symbol.token->int_lit), expected);
+    }
+}
+
+TEST(ConstantFolderTests, F128GlobalNotConstant) {
+    std::vector<Error> errors;
+    Lexer lexer("k f128 = 1.5 * x\n", "F128GlobalNotConstant", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors[0].type, ERROR_TYPE::ERROR);
+}
+
+TEST(ConstantFolderTests, SizedGlobalNotConstant) {
+    std::vector<Error> errors;
+    Lexer lexer("k u8 = 1ub / 0ub\n", "SizedGlobalNotConstant", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors[0].type, ERROR_TYPE::ERROR);
+    ASSERT_EQ(errors[0].message, "initializer of global 'k' is not a constant");
+}
+
+TEST(ConstantFolderTests, FitsSignedLimits) {
+    std::vector<Error> errors;
+    Lexer lexer("a i8 = 100 + 27\nb u16 = 65535\n", "FitsSignedLimits", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    ASSERT_EQ(errors.size(), 0L);
+}
+
+TEST(ConstantFolderTests, FitsNegatedLiteralMinimum) {
+    std::vector<Error> errors;
+    Lexer lexer("a i8 = ~128b\nb i16 = ~32768w\nc i32 = ~2147483648l\n", "FitsNegatedLiteralMinimum", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    BigInt expected;
+    bigint_init_signed(&expected, -128);
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto value_node = source_code_node->source_code.children.at(0)->var_def.initializer->binary_expr.op2;
+    ASSERT_EQ(value_node->node_type, AstNodeType::AstSymbol);
+    ASSERT_EQ(source_code_node->source_code.literals->get_int(value_node->symbol.token->int_lit), expected);
+}
+
+TEST(ConstantFolderTests, LiteralMinimumNotNegated) {
+    std::vector<Error> errors;
+    Lexer lexer("a i8 = 128b\nb i32 = 2147483648l - 1\nc i32 = ~(32768w + 1)\n", "LiteralMinimumNotNegated", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ConstantFolder folder(source_code_node, errors);
+    folder.fold(source_code_node);
+
+    // the literals are not folded, there's no overflow warning
+    ASSERT_EQ(errors.size(), 3L);
+    ASSERT_EQ(errors[0].type, ERROR_TYPE::ERROR);
+    ASSERT_EQ(errors[0].message, "integer literal 128 doesn't fit in 'i8', only its negation does");
+    ASSERT_EQ(errors[1].type, ERROR_TYPE::ERROR);
+    ASSERT_EQ(errors[1].line, 1L);
+    ASSERT_EQ(errors[2].type, ERROR_TYPE::ERROR);
+    ASSERT_EQ(errors[2].line, 2L);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "../../src/analyzer.hpp"
+#include "../../src/ast_nodes.hpp"
+#include "../../src/cache.hpp"
+#include "../../src/dependency_graph.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+
+// one build of a module, the graph of the previous one is given
+struct GraphBuild {
+    std::vector<Error> errors;
+    Lexer lexer;
+    AstNode* source_code_node;
+    DependencyGraph graph;
+
+    GraphBuild(const std::string& in_source, const CompilationCache& in_cache, const std::string& in_previous_graph)
+        : errors(), lexer(in_source, "GraphBuild", errors), graph(&in_cache) {
+        lexer.tokenize();
+        Parser parser(lexer, errors);
+        source_code_node = parser.parse();
+
+        if (!in_previous_graph.empty()) {
+            graph.read_previous(in_previous_graph);
+        }
+        SemanticAnalyzer analyzer(source_code_node, errors);
+        analyzer.analyze({}, nullptr, &graph);
+        graph.record(source_code_node, errors, 0);
+
+        // the code generator stores every function
+        for (auto child : source_code_node->source_code.children) {
+            if (child->node_type == AstNodeType::AstFuncDef) {
+                in_cache.store(graph.get_declaration_key(child), ".bc", "code");
+            }
+        }
+    }
+
+    ~GraphBuild() {
+        delete source_code_node;
+    }
+
+    bool is_unchanged(size_t index) {
+        return graph.is_unchanged(source_code_node->source_code.children.at(index));
+    }
+};
+
+class DependencyGraphTests : public ::testing::Test {
+protected:
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "llamalang_graph_test";
+    CompilationCache compilation_cache{ directory.string() };
+
+    void SetUp() override {
+        std::filesystem::remove_all(directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+};
+
+TEST_F(DependencyGraphTests, BodyEditOnlyRebuildsItself) {
+    GraphBuild original("fn a() i32 {\n ret 1\n}\nfn b() i32 {\n ret 2\n}\nfn c() i32 {\n ret b()\n}\n", compilation_cache, "");
+    GraphBuild edited("fn a() i32 {\n ret 1\n}\nfn b() i32 {\n ret 3\n}\nfn c() i32 {\n ret b()\n}\n", compilation_cache, original.graph.write());
+
+    ASSERT_TRUE(edited.is_unchanged(0));
+    ASSERT_FALSE(edited.is_unchanged(1));
+    ASSERT_TRUE(edited.is_unchanged(2));
+}
+
+TEST_F(DependencyGraphTests, ProtoEditRebuildsReferences) {
+    GraphBuild original("fn a() i32 {\n ret 1\n}\nfn b() i32 {\n ret 2\n}\nfn c() i64 {\n ret b()\n}\n", compilation_cache, "");
+    GraphBuild edited("fn a() i32 {\n ret 1\n}\nfn b() i64 {\n ret 2\n}\nfn c() i64 {\n ret b()\n}\n", compilation_cache, original.graph.write());
+
+    ASSERT_TRUE(edited.is_unchanged(0));
+    ASSERT_FALSE(edited.is_unchanged(1));
+    ASSERT_FALSE(edited.is_unchanged(2));
+    ASSERT_EQ(edited.errors.size(), 0L);
+}
+
+TEST_F(DependencyGraphTests, GlobalTypeEditRebuildsReferences) {
+    GraphBuild original("g i32 = 1\nfn a() i32 {\n ret g\n}\nfn b() i32 {\n ret 2\n}\n", compilation_cache, "");
+    GraphBuild edited("g i64 = 1\nfn a() i32 {\n ret g\n}\nfn b() i32 {\n ret 2\n}\n", compilation_cache, original.graph.write());
+
+    ASSERT_FALSE(edited.is_unchanged(1));
+    ASSERT_TRUE(edited.is_unchanged(2));
+}
+
+TEST_F(DependencyGraphTests, DiagnosticsAreReplayed) {
+    GraphBuild original("fn a(x i64) i32 {\n y i32 = x\n ret y\n}\n", compilation_cache, "");
+    GraphBuild moved("\n\nfn a(x i64) i32 {\n y i32 = x\n ret y\n}\n", compilation_cache, original.graph.write());
+
+    ASSERT_TRUE(moved.is_unchanged(0));
+    ASSERT_EQ(original.errors.size(), 1L);
+    ASSERT_EQ(moved.errors.size(), 1L);
+    ASSERT_EQ(moved.errors.at(0).type, ERROR_TYPE::WARNING_0);
+    ASSERT_EQ(moved.errors.at(0).line, original.errors.at(0).line + 2);
+    ASSERT_EQ(moved.errors.at(0).message, original.errors.at(0).message);
+}
+
+TEST_F(DependencyGraphTests, RejectCorruptedGraph) {
+    GraphBuild original("fn a() i32 {\n ret 1\n}\n", compilation_cache, "");
+    std::string bytes = original.graph.write();
+
+    DependencyGraph graph(&compilation_cache);
+    ASSERT_TRUE(graph.read_previous(bytes));
+    ASSERT_FALSE(graph.read_previous(bytes.substr(0, bytes.size() - 1)));
+    ASSERT_FALSE(graph.read_previous("LLDG"));
+}
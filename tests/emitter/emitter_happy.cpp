@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <llvm/BinaryFormat/Magic.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Compression.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include "../../src/compiler.hpp"
+#include "../../src/emitter.hpp"
+#include "../captured_output.hpp"
+
+// answer() returning 42, for the host so its machine code can be emitted
+struct TestModule {
+    llvm::LLVMContext             context;
+    std::unique_ptr<llvm::Module> code_module;
+
+    TestModule() : context(), code_module(std::make_unique<llvm::Module>("answer_module", context)) {
+        code_module->setTargetTriple(llvm::sys::getDefaultTargetTriple());
+
+        llvm::IRBuilder<> builder(context);
+        auto function_type = llvm::FunctionType::get(builder.getInt32Ty(), false);
+        auto function = llvm::Function::Create(function_type, llvm::Function::ExternalLinkage, "answer", *code_module);
+        builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", function));
+        builder.CreateRet(builder.getInt32(42));
+    }
+};
+
+static BuildOptions make_options(const std::string& in_name, EmitType in_emit_type) {
+    auto dir = std::filesystem::temp_directory_path() / in_name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    BuildOptions options;
+    options.output_directory = dir.string();
+    options.emit_type = in_emit_type;
+    return options;
+}
+
+static std::unique_ptr<llvm::MemoryBuffer> read_output(const BuildOptions& in_options, const std::string& in_file_name) {
+    auto buffer = llvm::MemoryBuffer::getFile((std::filesystem::path(in_options.output_directory) / in_file_name).string());
+    return buffer ? std::move(*buffer) : nullptr;
+}
+
+//==================================================================================
+//          EMIT TYPES
+//==================================================================================
+
+TEST(EmitterHappyTests, WritesBitcode) {
+    TestModule test_module;
+    auto options = make_options("emitter_happy_bitcode", EmitType::Bitcode);
+    ASSERT_TRUE(emitter::write_module(*test_module.code_module, "answer", options));
+
+    auto buffer = read_output(options, "answer.bc");
+    ASSERT_TRUE(buffer != nullptr);
+    ASSERT_EQ(llvm::identify_magic(buffer->getBuffer()), llvm::file_magic::bitcode);
+
+    llvm::LLVMContext context;
+    auto read_module = llvm::parseBitcodeFile(buffer->getMemBufferRef(), context);
+    ASSERT_TRUE(bool(read_module));
+    ASSERT_TRUE((*read_module)->getFunction("answer") != nullptr);
+
+    auto lto_info = llvm::getBitcodeLTOInfo(buffer->getMemBufferRef());
+    ASSERT_TRUE(bool(lto_info));
+    ASSERT_FALSE(lto_info->HasSummary);
+}
+
+TEST(EmitterHappyTests, WritesModuleSummary) {
+    TestModule test_module;
+    auto options = make_options("emitter_happy_summary", EmitType::Bitcode);
+    options.emit_module_summary = true;
+    ASSERT_TRUE(emitter::write_module(*test_module.code_module, "answer", options));
+
+    auto buffer = read_output(options, "answer.bc");
+    ASSERT_TRUE(buffer != nullptr);
+    auto lto_info = llvm::getBitcodeLTOInfo(buffer->getMemBufferRef());
+    ASSERT_TRUE(bool(lto_info));
+    ASSERT_TRUE(lto_info->HasSummary);
+}
+
+TEST(EmitterHappyTests, WritesLlvmIr) {
+    TestModule test_module;
+    auto options = make_options("emitter_happy_ir", EmitType::LlvmIr);
+    ASSERT_TRUE(emitter::write_module(*test_module.code_module, "answer", options));
+
+    auto buffer = read_output(options, "answer.ll");
+    ASSERT_TRUE(buffer != nullptr);
+    ASSERT_TRUE(buffer->getBuffer().contains("define i32 @answer()"));
+    ASSERT_TRUE(buffer->getBuffer().contains("ret i32 42"));
+}
+
+TEST(EmitterHappyTests, WritesObject) {
+    TestModule test_module;
+    auto options = make_options("emitter_happy_object", EmitType::Object);
+    ASSERT_TRUE(emitter::write_module(*test_module.code_module, "answer", options));
+
+    auto buffer = read_output(options, "answer.o");
+    ASSERT_TRUE(buffer != nullptr);
+    const llvm::file_magic magic = llvm::identify_magic(buffer->getBuffer());
+    ASSERT_TRUE(magic == llvm::file_magic::elf_relocatable || magic == llvm::file_magic::coff_object ||
+        magic == llvm::file_magic::macho_object);
+}
+
+TEST(EmitterHappyTests, WritesAssembly) {
+    TestModule test_module;
+    auto options = make_options("emitter_happy_assembly", EmitType::Assembly);
+    ASSERT_TRUE(emitter::write_module(*test_module.code_module, "answer", options));
+
+    auto buffer = read_output(options, "answer.s");
+    ASSERT_TRUE(buffer != nullptr);
+    ASSERT_TRUE(buffer->getBuffer().contains("answer:"));
+}
+
+// written next to the main output
+TEST(EmitterHappyTests, WritesCompressedIr) {
+    TestModule test_module;
+    auto options = make_options("emitter_happy_compressed", EmitType::Bitcode);
+    options.compress_ir = true;
+
+    if (!llvm::zlib::isAvailable()) {
+        CapturedOutput captured;
+        ASSERT_FALSE(emitter::write_module(*test_module.code_module, "answer", options));
+        return;
+    }
+    ASSERT_TRUE(emitter::write_module(*test_module.code_module, "answer", options));
+    ASSERT_TRUE(read_output(options, "answer.bc") != nullptr);
+
+    auto buffer = read_output(options, "answer.ll.z");
+    ASSERT_TRUE(buffer != nullptr);
+    // the size of the IR is not stored, the zlib stream ends by itself
+    llvm::SmallVector<char, 0> module_ir;
+    ASSERT_FALSE(bool(llvm::zlib::uncompress(buffer->getBuffer(), module_ir, 1 << 16)));
+    ASSERT_TRUE(llvm::StringRef(module_ir.data(), module_ir.size()).contains("define i32 @answer()"));
+}
+
+//==================================================================================
+//          ERRORS
+//==================================================================================
+
+TEST(EmitterSadTests, UnwritableOutputPath) {
+    TestModule test_module;
+    auto options = make_options("emitter_sad_unwritable", EmitType::LlvmIr);
+
+    // the output directory is a regular file
+    const std::string file_path = (std::filesystem::path(options.output_directory) / "file").string();
+    std::ofstream(file_path) << "not a directory";
+    options.output_directory = file_path;
+
+    std::string output;
+    {
+        CapturedOutput captured;
+        ASSERT_FALSE(emitter::write_module(*test_module.code_module, "answer", options));
+        output = captured.stream.str();
+    }
+    ASSERT_NE(output.find("could not open \"" + (std::filesystem::path(file_path) / "answer.ll").string() + "\": "), std::string::npos);
+}
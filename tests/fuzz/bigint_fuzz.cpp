@@ -0,0 +1,14 @@
+#include "../bigint/bigint_reference.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+// libFuzzer target, compares every BigInt operation with the reference bignum.
+// the input holds the operation and both operands, see check_bigint_op
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    const std::string mismatch = check_bigint_op(data, size);
+    if (!mismatch.empty()) {
+        fprintf(stderr, "%s\n", mismatch.c_str());
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include "../../src/jit.hpp"
+#include "../captured_output.hpp"
+
+// a module with in_name() returning in_value, or the result of in_callee() plus in_value
+static jit::JitModule make_module(const std::string& in_name, int32_t in_value, const std::string& in_callee = "") {
+    jit::JitModule jit_module;
+    jit_module.context = std::make_unique<llvm::LLVMContext>();
+    jit_module.code_module = std::make_unique<llvm::Module>(in_name + "_module", *jit_module.context);
+
+    llvm::IRBuilder<> builder(*jit_module.context);
+    auto function_type = llvm::FunctionType::get(builder.getInt32Ty(), false);
+    auto function = llvm::Function::Create(function_type, llvm::Function::ExternalLinkage, in_name, *jit_module.code_module);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(*jit_module.context, "entry", function));
+
+    llvm::Value* value = builder.getInt32(in_value);
+    if (!in_callee.empty()) {
+        auto callee = jit_module.code_module->getOrInsertFunction(in_callee, function_type);
+        value = builder.CreateAdd(builder.CreateCall(callee), value);
+    }
+    builder.CreateRet(value);
+    return jit_module;
+}
+
+static int run_modules(std::vector<jit::JitModule> in_modules, const std::string& in_entry_point, std::string& out_output) {
+    CapturedOutput captured;
+    const int result = jit::run(std::move(in_modules), in_entry_point);
+    out_output = captured.stream.str();
+    return result;
+}
+
+//==================================================================================
+//          RUN
+//==================================================================================
+
+TEST(JitHappyTests, ReturnsEntryPointValue) {
+    std::vector<jit::JitModule> modules;
+    modules.push_back(make_module("answer", 42));
+
+    std::string output;
+    ASSERT_EQ(run_modules(std::move(modules), "answer", output), 42);
+    ASSERT_TRUE(output.empty());
+}
+
+TEST(JitHappyTests, CallsAcrossModules) {
+    std::vector<jit::JitModule> modules;
+    modules.push_back(make_module("answer", 2, "helper"));
+    modules.push_back(make_module("helper", 40));
+
+    std::string output;
+    ASSERT_EQ(run_modules(std::move(modules), "answer", output), 42);
+}
+
+//==================================================================================
+//          ERRORS
+//==================================================================================
+
+TEST(JitSadTests, EntryPointNotFound) {
+    std::vector<jit::JitModule> modules;
+    modules.push_back(make_module("answer", 42));
+
+    std::string output;
+    ASSERT_EQ(run_modules(std::move(modules), "main", output), -1);
+    ASSERT_EQ(output, "entry point \"main\" not found\n");
+}
+
+// only declared here, the body is in no module
+TEST(JitSadTests, DeclaredEntryPointNotFound) {
+    std::vector<jit::JitModule> modules;
+    modules.push_back(make_module("answer", 2, "helper"));
+
+    std::string output;
+    ASSERT_EQ(run_modules(std::move(modules), "helper", output), -1);
+    ASSERT_EQ(output, "entry point \"helper\" not found\n");
+}
+
+TEST(JitSadTests, UnsupportedSignature) {
+    jit::JitModule jit_module;
+    jit_module.context = std::make_unique<llvm::LLVMContext>();
+    jit_module.code_module = std::make_unique<llvm::Module>("params_module", *jit_module.context);
+
+    llvm::IRBuilder<> builder(*jit_module.context);
+    auto function_type = llvm::FunctionType::get(builder.getInt32Ty(), { builder.getInt32Ty() }, false);
+    auto function = llvm::Function::Create(function_type, llvm::Function::ExternalLinkage, "main", *jit_module.code_module);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(*jit_module.context, "entry", function));
+    builder.CreateRet(function->getArg(0));
+
+    std::vector<jit::JitModule> modules;
+    modules.push_back(std::move(jit_module));
+
+    std::string output;
+    ASSERT_EQ(run_modules(std::move(modules), "main", output), -1);
+    ASSERT_EQ(output, "entry point \"main\" must take no parameters and return void or an integer up to 64 bits\n");
+}
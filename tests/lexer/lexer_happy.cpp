@@ -239,7 +239,7 @@ TEST(LexerHappyIntegerTests, IntegerUnderscoreSeparatorTest) {
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
 
@@ -255,39 +255,42 @@ TEST(LexerHappyIntegerTests, IntegerUnsignedSpecifierTest) {
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(int_token.lit_type, LiteralType::Unsigned);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'u');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
 
 TEST(LexerHappyIntegerTests, IntegerByteTypeSpecifierTest) {
     std::vector<Error> errors;
-    Lexer lexer("5415b", "ByteTypeSpecifierTest", errors);
+    Lexer lexer("54b", "ByteTypeSpecifierTest", errors);
     lexer.tokenize();
 
     BigInt okInt;
-    bigint_init_unsigned(&okInt, 5415);
+    bigint_init_unsigned(&okInt, 54);
     auto int_token = lexer.get_next_token();
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(int_token.lit_type, LiteralType::I8);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'b');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
 
 TEST(LexerHappyIntegerTests, IntegerUnsignByteTypeSpecifierTest) {
     std::vector<Error> errors;
-    Lexer lexer("5415ub", "UnsignByteTypeSpecifierTest", errors);
+    Lexer lexer("254ub", "UnsignByteTypeSpecifierTest", errors);
     lexer.tokenize();
 
     BigInt okInt;
-    bigint_init_unsigned(&okInt, 5415);
+    bigint_init_unsigned(&okInt, 254);
     auto int_token = lexer.get_next_token();
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(int_token.lit_type, LiteralType::U8);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos - 1), 'u');
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'b');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
@@ -304,7 +307,8 @@ TEST(LexerHappyIntegerTests, IntegerWordTypeSpecifierTest) {
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(int_token.lit_type, LiteralType::I16);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'w');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
@@ -320,7 +324,8 @@ TEST(LexerHappyIntegerTests, IntegerUnsignWordTypeSpecifierTest) {
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(int_token.lit_type, LiteralType::U16);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos - 1), 'u');
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'w');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
@@ -337,7 +342,8 @@ TEST(LexerHappyIntegerTests, IntegerLongTypeSpecifierTest) {
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(int_token.lit_type, LiteralType::I32);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'l');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
@@ -353,7 +359,7 @@ TEST(LexerHappyIntegerTests, IntegerLongTypeSpecifierSpaceTest) {
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'l');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
@@ -369,7 +375,8 @@ TEST(LexerHappyIntegerTests, IntegerUnsignLongTypeSpecifierTest) {
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(int_token.lit_type, LiteralType::U32);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos - 1), 'u');
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'l');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
@@ -386,13 +393,69 @@ TEST(LexerHappyIntegerTests, IntegerUnderscoreUnsignLongTypeSpecifierTest) {
 
     ASSERT_EQ(errors.size(), 0L);
     ASSERT_EQ(int_token.id, TokenId::INT_LIT);
-    ASSERT_EQ(int_token.int_lit, okInt);
+    ASSERT_EQ(lexer.literals.get_int(int_token.int_lit), okInt);
     ASSERT_EQ(lexer.source.at(int_token.end_pos - 2), '_');
     ASSERT_EQ(lexer.source.at(int_token.end_pos - 1), 'u');
     ASSERT_EQ(lexer.source.at(int_token.end_pos), 'l');
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
 
+TEST(LexerHappyIntegerTests, IntegerTypeSpecifierLimitsTest) {
+    // the largest value of each type, a hex b is a digit
+    std::vector<Error> errors;
+    Lexer lexer("127b 255ub 32767w 0xFFFFuw 2147483647l 0xFFFFFFFFul 0xFFb 12", "TypeSpecifierLimitsTest", errors);
+    lexer.tokenize();
+
+    const LiteralType types[] = { LiteralType::I8, LiteralType::U8, LiteralType::I16, LiteralType::U16, LiteralType::I32, LiteralType::U32,
+        LiteralType::None, LiteralType::None };
+    ASSERT_EQ(errors.size(), 0L);
+    for (auto type : types) {
+        auto int_token = lexer.get_next_token();
+        ASSERT_EQ(int_token.id, TokenId::INT_LIT);
+        ASSERT_EQ(int_token.lit_type, type);
+    }
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
+
+TEST(LexerHappyIntegerTests, IntegerLiteralsByIndexTest) {
+    static_assert(std::is_trivially_copyable<Token>::value, "tokens are copied around by value");
+
+    std::vector<Error> errors;
+    Lexer lexer("7 0 7", "LiteralsByIndexTest", errors);
+    lexer.tokenize();
+
+    auto first_token = lexer.get_next_token();
+    auto second_token = lexer.get_next_token();
+    auto third_token = lexer.get_next_token();
+
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(lexer.literals.get_int_count(), 3L);
+    ASSERT_NE(first_token.int_lit, third_token.int_lit);
+    ASSERT_EQ(bigint_to_string(&lexer.literals.get_int(first_token.int_lit), 10), "7");
+    ASSERT_EQ(bigint_to_string(&lexer.literals.get_int(second_token.int_lit), 10), "0");
+    ASSERT_EQ(lexer.literals.get_int(second_token.int_lit).digit_count, 0L);
+    ASSERT_EQ(bigint_to_string(&lexer.literals.get_int(third_token.int_lit), 10), "7");
+}
+
+TEST(LexerHappyIntegerTests, IntegerHugeLiteralTest) {
+    // 5 digits, more than a BigInt keeps inline
+    const std::string hex_digits = "1" + std::string(64, '0') + "f";
+    std::vector<Error> errors;
+    Lexer lexer("0x" + hex_digits + " 12", "HugeLiteralTest", errors);
+    lexer.tokenize();
+
+    auto huge_token = lexer.get_next_token();
+    auto small_token = lexer.get_next_token();
+    const BigInt& huge_value = lexer.literals.get_int(huge_token.int_lit);
+
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(huge_token.id, TokenId::INT_LIT);
+    ASSERT_EQ(huge_value.digit_count, 5L);
+    ASSERT_EQ(bigint_to_string(&huge_value, 16), hex_digits);
+    ASSERT_EQ(bigint_to_string(&lexer.literals.get_int(small_token.int_lit), 10), "12");
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
+
 //==================================================================================
 //          FLOAT LIT
 //==================================================================================
@@ -636,6 +699,42 @@ TEST(LexerHappyStringCharTests, EscapedCharStringTest) {
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
 
+TEST(LexerHappyStringCharTests, StringDecodedTest) {
+    std::vector<Error> errors;
+    Lexer lexer("\"a\\tb\\x41\\u{00B6}\\u{1F600}\\\"\xC3\xA9\"", "StringDecodedTest", errors);
+    lexer.tokenize();
+
+    auto string_token = lexer.get_next_token();
+
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(string_token.id, TokenId::STRING);
+    ASSERT_EQ(lexer.literals.get_string(string_token.string_lit), "a\tbA\xC2\xB6\xF0\x9F\x98\x80\"\xC3\xA9");
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
+
+TEST(LexerHappyStringCharTests, StringPoolTest) {
+    // equal values share the entry, however they are written
+    std::vector<Error> errors;
+    Lexer lexer("\"hi\" \"ho\" \"hi\" \"h\\x69\" \"\" \"\"", "StringPoolTest", errors);
+    lexer.tokenize();
+
+    uint32_t indices[6];
+    for (auto& index : indices) {
+        auto string_token = lexer.get_next_token();
+        ASSERT_EQ(string_token.id, TokenId::STRING);
+        index = string_token.string_lit;
+    }
+
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(lexer.literals.get_string_count(), 3L);
+    ASSERT_NE(indices[0], indices[1]);
+    ASSERT_EQ(indices[0], indices[2]);
+    ASSERT_EQ(indices[0], indices[3]);
+    ASSERT_EQ(indices[4], indices[5]);
+    ASSERT_EQ(lexer.literals.get_string(indices[1]), "ho");
+    ASSERT_TRUE(lexer.literals.get_string(indices[4]).empty());
+}
+
 TEST(LexerHappyStringCharTests, EscapedCharTest) {
     std::vector<Error> errors;
     Lexer lexer("\'\\r\'", "EscapedCharTest", errors);
@@ -677,6 +776,52 @@ TEST(LexerHappyStringCharTests, EscapedCharUnicodeTest) {
 }
 
 
+//==================================================================================
+//          POSITION
+//==================================================================================
+
+TEST(LexerHappyPositionTests, LineOfTest) {
+    // newlines before, inside and across the 16 bytes blocks
+    std::string source;
+    for (int i = 0; i < 40; i++)
+        source += std::string(i % 19, ' ') + "x" + (i % 3 == 0 ? "\n\n" : "\n");
+    std::vector<Error> errors;
+    Lexer lexer(source, "LineOfTest", errors);
+    lexer.tokenize();
+
+    size_t line = 0, column = 0;
+    for (size_t offset = 0; offset < source.size(); offset++) {
+        ASSERT_EQ(lexer.line_of(offset), line) << "offset " << offset;
+        ASSERT_EQ(lexer.column_of(offset), column) << "offset " << offset;
+        if (source[offset] == '\n') {
+            line++;
+            column = 0;
+        } else {
+            column++;
+        }
+    }
+    // past the end is the empty last line
+    ASSERT_EQ(lexer.line_of(source.size()), line);
+    ASSERT_EQ(lexer.column_of(source.size() + 10), 0L);
+}
+
+TEST(LexerHappyPositionTests, TokenLineColumnTest) {
+    std::vector<Error> errors;
+    Lexer lexer("fn\n  main /* a\n\nb */ x\n\n\t\"y\"", "TokenLineColumnTest", errors);
+    lexer.tokenize();
+
+    const size_t expected[][2] = { { 0, 0 }, { 1, 2 }, { 3, 5 }, { 5, 1 } };
+    for (const auto& position : expected) {
+        auto token = lexer.get_next_token();
+        ASSERT_EQ(token.start_line, position[0]);
+        ASSERT_EQ(token.start_column, position[1]);
+        ASSERT_EQ(lexer.line_of(token.start_pos), position[0]);
+        ASSERT_EQ(lexer.column_of(token.start_pos), position[1]);
+    }
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
+
 //==================================================================================
 //          PRINT
 //==================================================================================
@@ -175,6 +175,51 @@ TEST(LexerSadIntegerTests, IntegerFollowedByIdTest) {
     ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
 }
 
+TEST(LexerSadIntegerTests, IntegerTypeSpecifierOverflowTest) {
+    // one past the largest value of each type, the magnitude of the minimum for the signed ones
+    std::vector<Error> errors;
+    Lexer lexer("129b 256ub 32769w 0x10000uw 2147483649l 0x100000000ul 0x8AEFub", "TypeSpecifierOverflowTest", errors);
+    lexer.tokenize();
+
+    ASSERT_EQ(errors.size(), 7L);
+    ASSERT_EQ(errors[0].message, "integer literal 129b doesn't fit in i8");
+    ASSERT_EQ(errors[6].message, "integer literal 0x8AEFub doesn't fit in u8");
+    ASSERT_EQ(errors[6].column, 54L);
+
+    // the value is kept
+    for (int i = 0; i < 7; i++) {
+        ASSERT_EQ(lexer.get_next_token().id, TokenId::INT_LIT);
+    }
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
+
+TEST(LexerSadIntegerTests, IntegerTypeSpecifierMinimumTest) {
+    // the minimums are written negated, ~128b, the folder reports the ones that are not
+    std::vector<Error> errors;
+    Lexer lexer("128b 32768w 2147483648l 0x80b", "TypeSpecifierMinimumTest", errors);
+    lexer.tokenize();
+
+    ASSERT_EQ(errors.size(), 0L);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(lexer.get_next_token().id, TokenId::INT_LIT);
+    }
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
+
+TEST(LexerSadIntegerTests, IntegerTypeSpecifierOrderTest) {
+    // the u comes first and there is one size
+    const char* sources[] = { "5bu", "5uu", "5bl" };
+    for (auto source : sources) {
+        std::vector<Error> errors;
+        Lexer lexer(source, "TypeSpecifierOrderTest", errors);
+        lexer.tokenize();
+
+        ASSERT_EQ(errors.size(), 1L) << source;
+        ASSERT_EQ(lexer.get_next_token().id, TokenId::ERROR) << source;
+        ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF) << source;
+    }
+}
+
 /*
 TEST(LexerSadIntegerTests, IntegerSignSpecInvalidTypeSpecTest) {
     std::vector<Error> errors;
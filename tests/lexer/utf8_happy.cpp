@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include "../../src/lexer.hpp"
+#include "../../src/utf8.hpp"
+#include <string>
+
+static uint64_t next_random(uint64_t* io_state) {
+    *io_state = *io_state * 6364136223846793005ull + 1442695040888963407ull;
+    return *io_state ^ (*io_state >> 29);
+}
+
+static size_t validate(const std::string& in_text) {
+    return utf8_validate((const uint8_t*)in_text.data(), in_text.size());
+}
+
+// one code point at a time
+static size_t validate_reference(const std::string& in_text) {
+    size_t pos = 0;
+    while (pos < in_text.size()) {
+        uint32_t code_point;
+        const size_t length = utf8_decode((const uint8_t*)in_text.data() + pos, in_text.size() - pos, &code_point);
+        if (length == 0)
+            return pos;
+        pos += length;
+    }
+    return in_text.size();
+}
+
+//==================================================================================
+//          VALIDATE
+//==================================================================================
+
+TEST(Utf8HappyTests, ValidTextTest) {
+    ASSERT_EQ(validate(""), 0L);
+
+    std::string text;
+    for (int i = 0; i < 20; i++)
+        text += "fn main() { ret 'é' + '\xF0\x9F\x98\x80'; } // \xE2\x82\xAC\xC2\xB6\n";
+    ASSERT_EQ(validate(text), text.size());
+
+    // the limits of every length
+    const std::string limits = "\x7F\xC2\x80\xDF\xBF\xE0\xA0\x80\xED\x9F\xBF\xEE\x80\x80\xEF\xBF\xBF\xF0\x90\x80\x80\xF4\x8F\xBF\xBF";
+    ASSERT_EQ(validate(limits), limits.size());
+}
+
+TEST(Utf8HappyTests, InvalidSequenceTest) {
+    const char* invalid[] = {
+        "\x80",                 // lone continuation
+        "\xC0\xAF",             // overlong 2 bytes
+        "\xC1\xBF",
+        "\xE0\x9F\xBF",         // overlong 3 bytes
+        "\xED\xA0\x80",         // surrogate
+        "\xED\xBF\xBF",
+        "\xF0\x8F\xBF\xBF",     // overlong 4 bytes
+        "\xF4\x90\x80\x80",     // past U+10FFFF
+        "\xF5\x80\x80\x80",
+        "\xFF",
+        "\xC2",                 // cut sequences
+        "\xE2\x82",
+        "\xF0\x9F\x98",
+        "\xC2\x41",
+        "\xE2\x82\x41",
+    };
+
+    // before, inside and after the 16 bytes blocks, and in the padded tail
+    const size_t offsets[] = { 0, 1, 13, 14, 15, 16, 17, 31, 63, 64, 100 };
+    for (const char* sequence : invalid) {
+        for (size_t offset : offsets) {
+            const std::string prefix(offset, 'a');
+            const std::string text = prefix + sequence + std::string(40, 'b');
+            ASSERT_EQ(validate(text), offset) << "offset " << offset;
+            ASSERT_EQ(validate(prefix + sequence), offset) << "offset " << offset;
+
+            // after multi byte code points
+            std::string wide;
+            while (wide.size() + 3 <= offset)
+                wide += "\xE2\x82\xAC";
+            wide.append(offset - wide.size(), 'a');
+            ASSERT_EQ(validate(wide + sequence + "\xC3\xA9"), offset) << "offset " << offset;
+        }
+    }
+}
+
+TEST(Utf8HappyTests, MatchesScalarTest) {
+    const std::string pieces[] = { "a", "\n", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xED\x9F\xBF", "\xF4\x8F\xBF\xBF" };
+    uint64_t state = 1;
+    for (int i = 0; i < 20000; i++) {
+        std::string text;
+        const size_t count = next_random(&state) % 64;
+        for (size_t j = 0; j < count; j++)
+            text += pieces[next_random(&state) % 7];
+
+        // a few bytes replaced or cut
+        const size_t mutations = next_random(&state) % 3;
+        for (size_t j = 0; j < mutations && !text.empty(); j++)
+            text[next_random(&state) % text.size()] = char(next_random(&state));
+        if (!text.empty() && next_random(&state) % 4 == 0)
+            text.resize(next_random(&state) % text.size());
+
+        ASSERT_EQ(validate(text), validate_reference(text)) << "case " << i;
+    }
+}
+
+//==================================================================================
+//          ENCODE DECODE
+//==================================================================================
+
+TEST(Utf8HappyTests, RoundTripTest) {
+    for (uint32_t code_point = 0; code_point <= 0x10ffff + 1; code_point++) {
+        uint8_t bytes[4];
+        const size_t length = utf8_encode(code_point, bytes);
+        if ((code_point >= 0xd800 && code_point <= 0xdfff) || code_point > 0x10ffff) {
+            ASSERT_EQ(length, 0L) << code_point;
+            continue;
+        }
+        ASSERT_EQ(length, code_point <= 0x7f ? 1L : code_point <= 0x7ff ? 2L : code_point <= 0xffff ? 3L : 4L);
+
+        uint32_t decoded = 0;
+        ASSERT_EQ(utf8_decode(bytes, length, &decoded), length);
+        ASSERT_EQ(decoded, code_point);
+        ASSERT_EQ(utf8_validate(bytes, length), length);
+        ASSERT_EQ(utf8_decode(bytes, length - 1, &decoded), 0L);
+    }
+}
+
+//==================================================================================
+//          LEXER
+//==================================================================================
+
+TEST(Utf8HappyTests, LexerInvalidSourceTest) {
+    std::vector<Error> errors;
+    Lexer lexer("fn main() {\n    ret 'a\xC0';\n}", "LexerInvalidSourceTest", errors);
+    lexer.tokenize();
+
+    ASSERT_EQ(errors.size(), 1L);
+    ASSERT_EQ(errors[0].line, 1L);
+    ASSERT_EQ(errors[0].column, 10L);
+    ASSERT_EQ(errors[0].message, "invalid UTF-8 byte: '\\xc0'");
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
+
+TEST(Utf8HappyTests, LexerCharLiteralTest) {
+    std::vector<Error> errors;
+    Lexer lexer("'\xC3\xA9' '\xF0\x9F\x98\x80' x", "LexerCharLiteralTest", errors);
+    lexer.tokenize();
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto char_token = lexer.get_next_token();
+    ASSERT_EQ(char_token.id, TokenId::UNICODE_CHAR);
+    ASSERT_EQ(char_token.char_lit, 0xe9u);
+    char_token = lexer.get_next_token();
+    ASSERT_EQ(char_token.id, TokenId::UNICODE_CHAR);
+    ASSERT_EQ(char_token.char_lit, 0x1f600u);
+    ASSERT_EQ(char_token.start_column, 5L);
+
+    // columns count bytes
+    auto symbol_token = lexer.get_next_token();
+    ASSERT_EQ(symbol_token.id, TokenId::IDENTIFIER);
+    ASSERT_EQ(symbol_token.start_column, 12L);
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
+
+TEST(Utf8HappyTests, LexerStringTest) {
+    std::vector<Error> errors;
+    Lexer lexer("\"caf\xC3\xA9 \\u{20AC}\\x41\xF0\x9F\x98\x80\" y", "LexerStringTest", errors);
+    lexer.tokenize();
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto string_token = lexer.get_next_token();
+    ASSERT_EQ(string_token.id, TokenId::STRING);
+    ASSERT_EQ(lexer.literals.get_string(string_token.string_lit), "caf\xC3\xA9 \xE2\x82\xAC" "A\xF0\x9F\x98\x80");
+
+    auto symbol_token = lexer.get_next_token();
+    ASSERT_EQ(symbol_token.id, TokenId::IDENTIFIER);
+    ASSERT_EQ(symbol_token.start_column, 25L);
+    ASSERT_EQ(lexer.get_next_token().id, TokenId::_EOF);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include "../../src/ast_nodes.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/module_interface.hpp"
+#include "../../src/parser.hpp"
+
+static std::string write_interface(const std::string& in_source, const std::string& in_file_name) {
+    std::vector<Error> errors;
+    Lexer lexer(in_source, in_file_name, errors);
+    lexer.tokenize();
+    Parser parser(lexer, errors);
+    AstNode* source_code_node = parser.parse();
+    EXPECT_EQ(errors.size(), 0L);
+
+    std::string bytes = ModuleInterface::write(source_code_node);
+    delete source_code_node;
+    return bytes;
+}
+
+static std::unique_ptr<ModuleInterface> open_interface(const std::string& in_bytes) {
+    return ModuleInterface::open(llvm::MemoryBuffer::getMemBufferCopy(in_bytes));
+}
+
+TEST(ModuleInterfaceHappyTests, RoundTrip) {
+    std::string bytes = write_interface("fn add(a i32, b i64) i64 {\n ret 1\n}\ncount u8 = 3\nfn one() i32 {\n ret 1\n}\n", "RoundTrip");
+    auto module_interface = open_interface(bytes);
+
+    ASSERT_NE(module_interface, nullptr);
+    ASSERT_EQ(module_interface->get_function_count(), 2);
+    ASSERT_EQ(module_interface->get_function_name(0), "add");
+    ASSERT_EQ(module_interface->get_return_type(0), "i64");
+    ASSERT_EQ(module_interface->get_param_count(0), 2);
+    ASSERT_EQ(module_interface->get_param_type(0, 0), "i32");
+    ASSERT_EQ(module_interface->get_param_type(0, 1), "i64");
+    ASSERT_EQ(module_interface->get_function_name(1), "one");
+    ASSERT_EQ(module_interface->get_param_count(1), 0);
+
+    ASSERT_EQ(module_interface->get_global_count(), 1);
+    ASSERT_EQ(module_interface->get_global_name(0), "count");
+    ASSERT_EQ(module_interface->get_global_type(0), "u8");
+    ASSERT_EQ(module_interface->get_bytes(), bytes);
+}
+
+TEST(ModuleInterfaceHappyTests, BodiesAreNotPartOfInterface) {
+    std::string original = write_interface("fn a() i32 {\n ret 1\n}\n", "BodiesAreNotPartOfInterface");
+    std::string edited = write_interface("fn a() i32 {\n\n ret 2\n}\n", "BodiesAreNotPartOfInterface");
+
+    ASSERT_EQ(original, edited);
+}
+
+TEST(ModuleInterfaceHappyTests, NamesAreStoredOnce) {
+    std::string one_function = write_interface("fn a(x i64) i64 {\n ret 1\n}\n", "NamesAreStoredOnce");
+    std::string two_functions = write_interface("fn a(x i64) i64 {\n ret 1\n}\nfn b(x i64) i64 {\n ret 1\n}\n", "NamesAreStoredOnce");
+
+    // only the records and the new name "b" are added
+    const size_t record_size = 24 + 8;
+    ASSERT_EQ(two_functions.size(), one_function.size() + record_size + 1);
+}
+
+TEST(ModuleInterfaceHappyTests, CorruptedInterfaceIsRejected) {
+    std::string bytes = write_interface("fn a(x i64) i64 {\n ret 1\n}\n", "CorruptedInterfaceIsRejected");
+
+    ASSERT_EQ(open_interface(bytes.substr(0, bytes.size() - 1)), nullptr);
+    ASSERT_EQ(open_interface(bytes.substr(0, 3)), nullptr);
+
+    std::string wrong_magic = bytes;
+    wrong_magic[0] = 'X';
+    ASSERT_EQ(open_interface(wrong_magic), nullptr);
+
+    // name offset out of the string table
+    std::string wrong_offset = bytes;
+    wrong_offset[24] = char(0x7F);
+    ASSERT_EQ(open_interface(wrong_offset), nullptr);
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include "../../src/ast_nodes.hpp"
+#include "../../src/error.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+
+//==================================================================================
+//          RESYNCHRONIZATION
+//==================================================================================
+
+TEST(ParserSadStmntTests, BadDirectiveSkipsLine) {
+    std::vector<Error> errors;
+    Lexer lexer("#run )\n#unknown 5 6\n#load 5 x\nx i32 = 1\n", "BadDirectiveSkipsLine", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    // one error per directive, the definition after them is kept
+    ASSERT_EQ(errors.size(), 3L);
+    ASSERT_EQ(errors[0].line, 0L);
+    ASSERT_EQ(errors[1].line, 1L);
+    ASSERT_EQ(errors[2].line, 2L);
+    ASSERT_EQ(source_code_node->source_code.children.size(), 1L);
+    ASSERT_EQ(source_code_node->source_code.children[0]->var_def.name, "x");
+    delete source_code_node;
+}
+
+TEST(ParserSadStmntTests, BadInitializerSkipsToSemicolon) {
+    std::vector<Error> errors;
+    Lexer lexer("x i32 = ) 5 ; y i32 = 2\nz i32 = #load Math\nw i32 = 3\n", "BadInitializerSkipsToSemicolon", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ASSERT_EQ(errors.size(), 2L);
+    ASSERT_EQ(errors[0].line, 0L);
+    ASSERT_EQ(errors[1].line, 1L);
+    ASSERT_EQ(source_code_node->source_code.children.size(), 2L);
+    ASSERT_EQ(source_code_node->source_code.children[0]->var_def.name, "y");
+    ASSERT_EQ(source_code_node->source_code.children[1]->var_def.name, "w");
+    delete source_code_node;
+}
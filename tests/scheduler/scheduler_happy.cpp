@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include "../../src/scheduler.hpp"
+
+TEST(SchedulerHappyTests, RunsEveryTask) {
+    std::atomic<size_t> counter = 0;
+    Scheduler scheduler(4);
+
+    for (size_t i = 0; i < 1000; i++) {
+        scheduler.submit([&counter] { counter++; });
+    }
+    scheduler.wait();
+
+    ASSERT_EQ(counter.load(), 1000L);
+}
+
+TEST(SchedulerHappyTests, WaitsForNestedTasks) {
+    std::atomic<size_t> counter = 0;
+    Scheduler scheduler(3);
+
+    for (size_t i = 0; i < 10; i++) {
+        scheduler.submit([&scheduler, &counter] {
+            for (size_t j = 0; j < 10; j++) {
+                scheduler.submit([&counter] { counter++; });
+            }
+            counter++;
+        });
+    }
+    scheduler.wait();
+
+    ASSERT_EQ(counter.load(), 110L);
+}
+
+TEST(SchedulerHappyTests, ReusedAfterWait) {
+    std::atomic<size_t> counter = 0;
+    Scheduler scheduler(2);
+
+    scheduler.submit([&counter] { counter++; });
+    scheduler.wait();
+    scheduler.submit([&counter] { counter++; });
+    scheduler.wait();
+
+    ASSERT_EQ(counter.load(), 2L);
+}
+
+TEST(SchedulerHappyTests, TaskWaitsForItsTasks) {
+    std::atomic<size_t> counter = 0;
+    bool is_done_first = false;
+    // a single worker, the waiting task has to run the others itself
+    Scheduler scheduler(1);
+
+    scheduler.submit([&scheduler, &counter, &is_done_first] {
+        std::atomic<size_t> pending = 10;
+        for (size_t i = 0; i < 10; i++) {
+            scheduler.submit([&counter, &pending] {
+                counter++;
+                pending--;
+            });
+        }
+        scheduler.wait_for(pending);
+        is_done_first = counter == 10;
+    });
+    scheduler.wait();
+
+    ASSERT_TRUE(is_done_first);
+    ASSERT_EQ(counter.load(), 10L);
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "../../src/server.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int never_called(const std::string&, const std::vector<std::string>&) {
+    return 0;
+}
+
+TEST(ServerSadTests, KeepRegularFile) {
+    const std::string path = "server_sad_regular_file";
+    {
+        std::ofstream file(path);
+        file << "not a socket";
+    }
+
+    ASSERT_EQ(server::listen(path, never_called), -1);
+
+    std::ifstream file(path);
+    std::string content;
+    std::getline(file, content);
+    ASSERT_EQ(content, "not a socket");
+    std::remove(path.c_str());
+}
+
+TEST(ServerSadTests, KeepLiveServer) {
+    const std::string path = "server_sad_live_socket";
+    std::remove(path.c_str());
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(server_fd, 0);
+    ASSERT_EQ(bind(server_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(listen(server_fd, 1), 0);
+
+    ASSERT_EQ(server::listen(path, never_called), -1);
+
+    struct stat path_stat;
+    ASSERT_EQ(lstat(path.c_str(), &path_stat), 0);
+    ASSERT_TRUE(S_ISSOCK(path_stat.st_mode));
+    close(server_fd);
+    unlink(path.c_str());
+}
+#endif
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include "../../src/ast_nodes.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+#include "../../src/stats.hpp"
+
+TEST(StatsHappyTests, CountNodes) {
+    std::vector<Error> errors;
+    Lexer lexer("fn f(a *i64) i32 {\n ret 1 + 2\n}\n", "CountNodes", errors);
+    lexer.tokenize();
+    Parser parser(lexer, errors);
+    AstNode* source_code_node = parser.parse();
+
+    // source, def, proto, param, *i64, i64, i32, block, ret, +, 1, 2
+    ASSERT_EQ(errors.size(), 0L);
+    ASSERT_EQ(count_nodes(source_code_node), 12);
+    delete source_code_node;
+}
+
+TEST(StatsHappyTests, PhaseCountsAllocations) {
+    stats::set_enabled(true);
+    {
+        PhaseTimer timer(Phase::Parse);
+        for (int i = 0; i < 3; i++) {
+            auto allocation = std::make_unique<int>(i);
+        }
+    }
+    stats::add_tokens(7);
+    std::string report = stats::get_report(true);
+    stats::set_enabled(false);
+
+    ASSERT_NE(report.find("\"tokens\":7"), std::string::npos);
+    ASSERT_NE(report.find("{\"name\":\"parse\""), std::string::npos);
+    ASSERT_NE(report.find("\"allocations\":3}"), std::string::npos);
+}
+
+TEST(StatsHappyTests, DisabledTimerMeasuresNothing) {
+    stats::set_enabled(true);
+    stats::set_enabled(false);
+    {
+        PhaseTimer timer(Phase::Emit);
+        auto allocation = std::make_unique<int>(1);
+    }
+    std::string report = stats::get_report(true);
+
+    ASSERT_NE(report.find("{\"name\":\"emit\",\"wall_ms\":0.000,\"cpu_ms\":0.000,\"peak_rss_bytes\":0,\"allocations\":0}"), std::string::npos);
+}
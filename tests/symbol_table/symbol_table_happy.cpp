@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "../../src/ast_nodes.hpp"
+#include "../../src/symbol_table.hpp"
+#include <memory>
+
+TEST(SymbolTableTests, InternIsStable) {
+    NameTable names;
+    const uint32_t id = names.intern("a");
+
+    ASSERT_EQ(names.intern("b"), id + 1);
+    ASSERT_EQ(names.intern("a"), id);
+    ASSERT_EQ(names.find("b"), id + 1);
+    ASSERT_EQ(names.find("c"), INVALID_NAME_ID);
+    ASSERT_EQ(names.get_name(id), "a");
+}
+
+TEST(SymbolTableTests, ChildNamesExtendParent) {
+    NameTable global_names;
+    const uint32_t global_id = global_names.intern("global");
+
+    NameTable local_names(&global_names);
+    const uint32_t local_id = local_names.intern("local");
+
+    ASSERT_EQ(local_names.intern("global"), global_id);
+    ASSERT_GT(local_id, global_id);
+    ASSERT_EQ(local_names.get_name(global_id), "global");
+    ASSERT_EQ(global_names.find("local"), INVALID_NAME_ID);
+}
+
+TEST(SymbolTableTests, InnerScopeShadowsAndPops) {
+    AstNode outer(AstNodeType::AstVarDef, 1, 0);
+    AstNode inner(AstNodeType::AstVarDef, 2, 0);
+    SymbolTable symbols;
+
+    symbols.push_scope();
+    ASSERT_EQ(symbols.declare(0, &outer), nullptr);
+    ASSERT_EQ(symbols.declare(0, &inner), &outer);
+
+    symbols.push_scope();
+    ASSERT_EQ(symbols.declare(0, &inner), nullptr);
+    ASSERT_EQ(symbols.find(0), &inner);
+
+    symbols.pop_scope();
+    ASSERT_EQ(symbols.find(0), &outer);
+    symbols.pop_scope();
+    ASSERT_EQ(symbols.find(0), nullptr);
+}
+
+TEST(SymbolTableTests, ScopeGrowsAndFindsParent) {
+    AstNode global(AstNodeType::AstVarDef, 1, 0);
+    SymbolTable global_symbols;
+    global_symbols.push_scope();
+    global_symbols.declare(1000, &global);
+
+    std::vector<std::unique_ptr<AstNode>> locals;
+    for (uint32_t i = 0; i < 100; i++) {
+        locals.push_back(std::make_unique<AstNode>(AstNodeType::AstVarDef, i, 0));
+    }
+
+    SymbolTable symbols(&global_symbols);
+    symbols.push_scope();
+    for (uint32_t i = 0; i < 100; i++) {
+        ASSERT_EQ(symbols.declare(i, locals[i].get()), nullptr);
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        ASSERT_EQ(symbols.find(i), locals[i].get());
+    }
+    ASSERT_EQ(symbols.find(1000), &global);
+    ASSERT_EQ(symbols.find(1001), nullptr);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include "../../src/compiler.hpp"
+#include "../../src/trace.hpp"
+#include "../captured_output.hpp"
+
+//==================================================================================
+//          CHROME TRACE
+//==================================================================================
+
+TEST(TraceHappyTests, OneLanePerWorker) {
+    auto dir = std::filesystem::temp_directory_path() / "trace_happy_lanes";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "main.llang") << "#load util\nfn main() i32 {\n ret helper()\n}\n";
+    std::ofstream(dir / "util.llang") << "fn helper() i32 {\n ret 1\n}\n";
+
+    BuildOptions options;
+    options.output_directory = dir.string();
+    options.thread_count = 2;
+
+    // the workers finish their lanes when the build returns
+    const std::string trace_path = (dir / "trace.json").string();
+    int result;
+    bool is_trace_written;
+    {
+        CapturedOutput captured;
+        trace::start();
+        result = compiler::build(options, { RootSource{ (dir / "main.llang").string(), std::nullopt } });
+        is_trace_written = trace::finish(trace_path);
+    }
+    ASSERT_EQ(result, 0);
+    ASSERT_TRUE(is_trace_written);
+
+    auto buffer = llvm::MemoryBuffer::getFile(trace_path);
+    ASSERT_TRUE(bool(buffer));
+    auto trace = llvm::json::parse((*buffer)->getBuffer());
+    ASSERT_TRUE(bool(trace));
+    ASSERT_TRUE(trace->getAsObject() != nullptr);
+    const llvm::json::Array* events = trace->getAsObject()->getArray("traceEvents");
+    ASSERT_TRUE(events != nullptr);
+
+    // the lanes are named by the thread_name metadata events
+    std::map<int64_t, std::string> lane_names;
+    for (auto& event : *events) {
+        const llvm::json::Object* object = event.getAsObject();
+        ASSERT_TRUE(object != nullptr);
+        ASSERT_TRUE(object->getInteger("tid").hasValue());
+        if (object->getString("ph") == llvm::StringRef("M") && object->getString("name") == llvm::StringRef("thread_name")) {
+            lane_names[*object->getInteger("tid")] = object->getObject("args")->getString("name")->str();
+        }
+    }
+
+    std::map<std::string, int64_t> worker_lanes;
+    for (auto& [tid, name] : lane_names) {
+        if (name.rfind("worker ", 0) == 0) {
+            ASSERT_TRUE(worker_lanes.emplace(name, tid).second);
+        }
+    }
+    ASSERT_EQ(worker_lanes.size(), 2L);
+    ASSERT_EQ(worker_lanes.count("worker 0"), 1L);
+    ASSERT_EQ(worker_lanes.count("worker 1"), 1L);
+
+    // the modules are built by the workers, each one is emitted once.
+    // the totals LLVM appends have a lane of their own
+    size_t emit_count = 0;
+    for (auto& event : *events) {
+        const llvm::json::Object* object = event.getAsObject();
+        const llvm::StringRef name = object->getString("name").getValueOr("");
+        if (object->getString("ph") != llvm::StringRef("X") || name.startswith("Total ")) {
+            continue;
+        }
+        ASSERT_TRUE(object->getInteger("ts").hasValue());
+        ASSERT_TRUE(object->getInteger("dur").hasValue());
+        const std::string lane_name = lane_names.count(*object->getInteger("tid")) ? lane_names[*object->getInteger("tid")] : "";
+        ASSERT_EQ(lane_name.rfind("worker ", 0), 0L);
+        emit_count += name == "Emit";
+    }
+    ASSERT_EQ(emit_count, 2L);
+}
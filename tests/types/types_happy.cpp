@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "../../src/ast_nodes.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/parser.hpp"
+#include "../../src/types.hpp"
+
+TEST(TypesHappyTests, BuiltinTypeIsInterned) {
+    TypeInfo* first = types::get_named_type("i32");
+    TypeInfo* second = types::get_named_type("i32");
+
+    ASSERT_EQ(first, second);
+    ASSERT_EQ(first->type_id, AstTypeId::Integer);
+    ASSERT_EQ(first->bit_size, 32);
+    ASSERT_TRUE(first->is_signed);
+    ASSERT_NE(first, types::get_named_type("u32"));
+}
+
+TEST(TypesHappyTests, PointerTypeIsInterned) {
+    TypeInfo* element_type = types::get_named_type("u8");
+    TypeInfo* pointer_type = types::get_pointer_type(element_type);
+
+    ASSERT_EQ(pointer_type, types::get_pointer_type(element_type));
+    ASSERT_EQ(pointer_type->type_id, AstTypeId::Pointer);
+    ASSERT_EQ(pointer_type->element_type, element_type);
+    ASSERT_EQ(pointer_type->name, "*u8");
+    ASSERT_NE(pointer_type, types::get_array_type(element_type));
+}
+
+TEST(TypesHappyTests, ParsedTypesShareTypeInfo) {
+    std::vector<Error> errors;
+    Lexer lexer("fn f(a *i64, b *i64) i32 {\n ret 1\n}\n", "ParsedTypesShareTypeInfo", errors);
+    lexer.tokenize();
+
+    Parser parser(lexer, errors);
+    auto source_code_node = parser.parse();
+
+    ASSERT_EQ(errors.size(), 0L);
+    auto& params = source_code_node->source_code.children.at(0)->function_def.proto->function_proto.params;
+    auto a_type = params.at(0)->param_decl.type->ast_type.type_info;
+    auto b_type = params.at(1)->param_decl.type->ast_type.type_info;
+    ASSERT_EQ(a_type, b_type);
+    ASSERT_EQ(a_type, types::get_pointer_type(types::get_named_type("i64")));
+}
+
+TEST(TypesHappyTests, TypeByNameIsInverseOfName) {
+    TypeInfo* pointer_type = types::get_pointer_type(types::get_array_type(types::get_named_type("f32")));
+
+    ASSERT_EQ(pointer_type->name, "*[]f32");
+    ASSERT_EQ(types::get_type_by_name(pointer_type->name), pointer_type);
+    ASSERT_EQ(types::get_type_by_name("u16"), types::get_named_type("u16"));
+}